@@ -0,0 +1,754 @@
+#define RT_DEFINE_USE_CRT
+
+#include <rpr.h>
+#include <rpr_main.h>
+
+#include "zz_bench_baseline.h"
+#include "zz_bench_generator.h"
+
+#include "ast/zz_ast.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "code_generator/zz_function_generator.h"
+#include "code_generator/zz_llvm_error.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "lexer/zz_lexer.h"
+#include "optimizer/zz_optimizer.h"
+#include "options/zz_options.h"
+#include "parser/zz_parser.h"
+
+#define ZZ_BENCH_DEFAULT_ITERATIONS 5
+#define ZZ_BENCH_DEFAULT_TOLERANCE 10
+
+/* Shorter phases are too noisy to be compared with the baseline, in microseconds. */
+#define ZZ_BENCH_MIN_COMPARED_DURATION 1000
+
+enum zz_bench_phase {
+	ZZ_BENCH_PHASE_LEX,
+	ZZ_BENCH_PHASE_PARSE,
+	ZZ_BENCH_PHASE_OPTIMIZE,
+	/* Declarations and bodies of the functions, the expressions being most of the work. */
+	ZZ_BENCH_PHASE_CODEGEN,
+	/* Object file in memory, without passes. */
+	ZZ_BENCH_PHASE_EMIT,
+	ZZ_BENCH_PHASES_COUNT
+};
+
+static const rt_char *const zz_bench_phase_names[] = {
+	[ZZ_BENCH_PHASE_LEX] = _R("lex"),
+	[ZZ_BENCH_PHASE_PARSE] = _R("parse"),
+	[ZZ_BENCH_PHASE_OPTIMIZE] = _R("optimize"),
+	[ZZ_BENCH_PHASE_CODEGEN] = _R("codegen"),
+	[ZZ_BENCH_PHASE_EMIT] = _R("emit")
+};
+
+static const rt_char8 *const zz_bench_phase_names8[] = {
+	[ZZ_BENCH_PHASE_LEX] = "lex",
+	[ZZ_BENCH_PHASE_PARSE] = "parse",
+	[ZZ_BENCH_PHASE_OPTIMIZE] = "optimize",
+	[ZZ_BENCH_PHASE_CODEGEN] = "codegen",
+	[ZZ_BENCH_PHASE_EMIT] = "emit"
+};
+
+/* Keys of the results in the baseline files. */
+static const rt_char8 *const zz_bench_keys[] = {
+	"us",
+	"bytes_per_second",
+	"tokens_per_second",
+	"nodes_per_second"
+};
+
+#define ZZ_BENCH_KEYS_COUNT (sizeof(zz_bench_keys) / sizeof(zz_bench_keys[0]))
+
+struct zz_bench_options {
+	rt_un scale;
+	rt_un iterations;
+	/* Allowed slowdown compared to the baseline, in percent. */
+	rt_un tolerance;
+	const rt_char *baseline_file_path;
+	const rt_char *output_file_path;
+	/* Optimization level of the target machine, like -O2. */
+	const rt_char *optimization_level;
+};
+
+/**
+ * Best durations of the phases of a workload, in microseconds, and the size of its input.
+ */
+struct zz_bench_result {
+	rt_un durations[ZZ_BENCH_PHASES_COUNT];
+	rt_un input_size;
+	rt_un tokens_count;
+	/* Nodes of the parsed AST, before the optimizer. */
+	rt_un nodes_count;
+};
+
+static rt_s zz_bench_display_help(rt_s ret)
+{
+	rt_b error = !ret;
+
+	if (!rt_console_write(_R("stc_bench [OPTIONS]\n"
+				 "\n"
+				 "  --scale=<N>             Multiply the size of the generated inputs by N, 1 by default.\n"
+				 "  --iterations=<N>        Keep the best of N runs of each phase, 5 by default.\n"
+				 "  --write-baseline=<FILE> Write the results to FILE, in JSON.\n"
+				 "  --baseline=<FILE>       Fail if a phase is slower than in FILE.\n"
+				 "  --tolerance=<PERCENT>   Allowed slowdown compared to the baseline, 10 by default.\n"
+				 "  -O0, -O1, -O2, -O3, -Os Optimization level of the emission, -O0 by default.\n"
+				 "\n"
+				 "Times the lexer, the parser, the optimizer, the code generation and the emission of the object file\n"
+				 "on generated inputs: a long expression, deeply nested parenthesis, many functions and huge identifiers.\n"
+				 "Phases shorter than a millisecond are not compared with the baseline.\n"), error))
+		ret = RT_FAILED;
+
+	return ret;
+}
+
+/**
+ * @param value Receives the value of <tt>--name=VALUE</tt>, if <tt>arg</tt> starts with <tt>prefix</tt>.
+ */
+static rt_b zz_bench_get_value(const rt_char *arg, rt_un arg_size, const rt_char *prefix, rt_un prefix_size, const rt_char **value)
+{
+	if (!rt_char_starts_with(arg, arg_size, prefix, prefix_size))
+		return RT_FALSE;
+	*value = &arg[prefix_size];
+	return RT_TRUE;
+}
+
+static rt_s zz_bench_parse_un(const rt_char *value, rt_b allow_zero, rt_un *result)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_convert_to_un(value, result)))
+		goto error;
+	if (RT_UNLIKELY(!allow_zero && !*result)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_bench_parse_options(rt_un argc, const rt_char *argv[], struct zz_bench_options *options, rt_b *help)
+{
+	const rt_char *arg;
+	rt_un arg_size;
+	const rt_char *value;
+	rt_un i;
+	rt_s ret;
+
+	options->scale = 1;
+	options->iterations = ZZ_BENCH_DEFAULT_ITERATIONS;
+	options->tolerance = ZZ_BENCH_DEFAULT_TOLERANCE;
+	options->baseline_file_path = RT_NULL;
+	options->output_file_path = RT_NULL;
+	options->optimization_level = RT_NULL;
+	*help = RT_FALSE;
+
+	for (i = 1; i < argc; i++) {
+		arg = argv[i];
+		arg_size = rt_char_get_size(arg);
+
+		if (rt_char_equals(arg, arg_size, _R("--help"), 6) || rt_char_equals(arg, arg_size, _R("-h"), 2)) {
+			*help = RT_TRUE;
+		} else if (zz_bench_get_value(arg, arg_size, _R("--scale="), 8, &value)) {
+			if (RT_UNLIKELY(!zz_bench_parse_un(value, RT_FALSE, &options->scale)))
+				goto error;
+		} else if (zz_bench_get_value(arg, arg_size, _R("--iterations="), 13, &value)) {
+			if (RT_UNLIKELY(!zz_bench_parse_un(value, RT_FALSE, &options->iterations)))
+				goto error;
+		} else if (zz_bench_get_value(arg, arg_size, _R("--tolerance="), 12, &value)) {
+			if (RT_UNLIKELY(!zz_bench_parse_un(value, RT_TRUE, &options->tolerance)))
+				goto error;
+		} else if (zz_bench_get_value(arg, arg_size, _R("--write-baseline="), 17, &value) && *value) {
+			options->output_file_path = value;
+		} else if (zz_bench_get_value(arg, arg_size, _R("--baseline="), 11, &value) && *value) {
+			options->baseline_file_path = value;
+		} else if (rt_char_starts_with(arg, arg_size, _R("-O"), 2)) {
+			/* Checked by zz_options_parse. */
+			options->optimization_level = arg;
+		} else {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * The options of a compilation of a single file, so that the session has the target machine of <tt>stc</tt>.<br>
+ * <tt>zz_options_free</tt> must be called even if the parsing fails.
+ */
+static rt_s zz_bench_parse_compiler_options(struct zz_bench_options *bench_options, struct zz_options *options, struct rt_heap *heap)
+{
+	const rt_char *args[3];
+	rt_un args_count = 0;
+
+	args[args_count++] = _R("stc");
+	if (bench_options->optimization_level)
+		args[args_count++] = bench_options->optimization_level;
+	args[args_count++] = _R("bench.stc");
+
+	return zz_options_parse(args_count, args, heap, options);
+}
+
+/**
+ * Keep the duration of <tt>phase</tt> from <tt>start</tt> if it is the best one.
+ *
+ * @param start Receives the current time, the start of the next phase.
+ */
+static rt_s zz_bench_end_phase(struct rt_chrono *chrono, enum zz_bench_phase phase, rt_b first, rt_un *start, struct zz_bench_result *result)
+{
+	rt_un now;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &now)))
+		goto error;
+	if (first || now - *start < result->durations[phase])
+		result->durations[phase] = now - *start;
+	*start = now;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_bench_generate_functions(struct zz_ast *ast, struct zz_symbol_table *symbol_table, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder)
+{
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_function_generator_declare(ast, symbol_table, llvm_context, llvm_module, llvm_functions)))
+		goto error;
+
+	for (i = 0; i < ast->functions_count; i++) {
+		if (RT_UNLIKELY(!zz_function_generator_generate(ast, &ast->functions[i], llvm_functions, llvm_context, llvm_builder)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Compile <tt>input</tt> once, like <tt>stc</tt> without passes, timing each phase.
+ *
+ * <p>
+ * The phases use fresh buffers, so each iteration pays the same allocations as a compilation.
+ * </p>
+ */
+static rt_s zz_bench_run_iteration(struct zz_code_generator_session *session, rt_char8 *input, rt_un input_size, struct rt_chrono *chrono, rt_b first, struct zz_bench_result *result, struct zz_diagnostics *diagnostics, struct rt_heap *heap)
+{
+	struct zz_token_buffer token_buffer;
+	struct zz_symbol_table symbol_table;
+	struct zz_ast ast;
+	LLVMValueRef *llvm_functions = RT_NULL;
+	LLVMModuleRef llvm_module = RT_NULL;
+	LLVMMemoryBufferRef llvm_memory_buffer = RT_NULL;
+	rt_char8 *llvm_error_message;
+	rt_un start;
+	rt_s ret;
+
+	zz_token_buffer_create(&token_buffer, heap);
+	zz_symbol_table_create(&symbol_table, heap);
+	zz_ast_create(&ast, heap);
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &start)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_lexer_tokenize(input, input_size, &token_buffer, &symbol_table)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_end_phase(chrono, ZZ_BENCH_PHASE_LEX, first, &start, result)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_parser_parse(input, &token_buffer, &ast)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_end_phase(chrono, ZZ_BENCH_PHASE_PARSE, first, &start, result)))
+		goto error;
+
+	result->input_size = input_size;
+	result->tokens_count = token_buffer.size;
+	result->nodes_count = ast.nodes_count;
+
+	if (RT_UNLIKELY(!zz_optimizer_optimize(&ast)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_end_phase(chrono, ZZ_BENCH_PHASE_OPTIMIZE, first, &start, result)))
+		goto error;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&llvm_functions, (symbol_table.symbols_count ? symbol_table.symbols_count : 1) * sizeof(LLVMValueRef))))
+		goto error;
+	zz_code_generator_session_create_module(session, session->llvm_context, "stc_bench", &llvm_module);
+	if (RT_UNLIKELY(!zz_bench_generate_functions(&ast, &symbol_table, llvm_functions, session->llvm_context, llvm_module, session->llvm_builder)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_end_phase(chrono, ZZ_BENCH_PHASE_CODEGEN, first, &start, result)))
+		goto error;
+
+	if (RT_UNLIKELY(LLVMTargetMachineEmitToMemoryBuffer(session->llvm_target_machine, llvm_module, LLVMObjectFile, &llvm_error_message, &llvm_memory_buffer))) {
+		llvm_memory_buffer = RT_NULL;
+		zz_llvm_error_add_message(diagnostics, llvm_error_message);
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+	if (RT_UNLIKELY(!zz_bench_end_phase(chrono, ZZ_BENCH_PHASE_EMIT, first, &start, result)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (llvm_memory_buffer)
+		LLVMDisposeMemoryBuffer(llvm_memory_buffer);
+	if (llvm_module)
+		LLVMDisposeModule(llvm_module);
+	if (llvm_functions && RT_UNLIKELY(!heap->free(heap, (void**)&llvm_functions) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_free(&ast) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_symbol_table_free(&symbol_table) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_token_buffer_free(&token_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_bench_run_workload(struct zz_code_generator_session *session, enum zz_bench_workload workload, struct zz_bench_options *options, struct rt_chrono *chrono, struct zz_bench_result *result, struct zz_diagnostics *diagnostics, struct rt_heap *heap)
+{
+	rt_char8 *input = RT_NULL;
+	rt_un input_size;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_bench_generator_generate(workload, options->scale, heap, &input, &input_size)))
+		goto error;
+
+	for (i = 0; i < options->iterations; i++) {
+		if (RT_UNLIKELY(!zz_bench_run_iteration(session, input, input_size, chrono, i == 0, result, diagnostics, heap)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (input && RT_UNLIKELY(!heap->free(heap, (void**)&input) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @return <tt>count</tt> per second for <tt>duration</tt> microseconds.
+ */
+static rt_un zz_bench_get_rate(rt_un count, rt_un duration)
+{
+	return (rt_un)((rt_un64)count * 1000000 / (duration ? duration : 1));
+}
+
+/**
+ * Fill the values of the baseline keys of a phase.
+ */
+static void zz_bench_get_values(struct zz_bench_result *result, enum zz_bench_phase phase, rt_un *values)
+{
+	rt_un duration = result->durations[phase];
+
+	values[0] = duration;
+	values[1] = zz_bench_get_rate(result->input_size, duration);
+	values[2] = zz_bench_get_rate(result->tokens_count, duration);
+	values[3] = zz_bench_get_rate(result->nodes_count, duration);
+}
+
+static rt_s zz_bench_get_result_name(enum zz_bench_workload workload, enum zz_bench_phase phase, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	const rt_char *workload_name = zz_bench_generator_get_name(workload);
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_append(workload_name, rt_char_get_size(workload_name), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('/'), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(zz_bench_phase_names[phase], rt_char_get_size(zz_bench_phase_names[phase]), buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Name of the result of <tt>phase</tt> in the baseline files.
+ */
+static rt_s zz_bench_get_result_name8(enum zz_bench_workload workload, enum zz_bench_phase phase, rt_char8 *buffer, rt_un buffer_capacity)
+{
+	const rt_char8 *workload_name = zz_bench_generator_get_name8(workload);
+	rt_un buffer_size = 0;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char8_append(workload_name, rt_char8_get_size(workload_name), buffer, buffer_capacity, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_char('/', buffer, buffer_capacity, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append(zz_bench_phase_names8[phase], rt_char8_get_size(zz_bench_phase_names8[phase]), buffer, buffer_capacity, &buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Append <tt>value</tt> right aligned on <tt>width</tt> characters.
+ */
+static rt_s zz_bench_append_column(rt_un value, rt_un width, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_char digits[64];
+	rt_un digits_size = 0;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_append_un(value, 10, digits, 64, &digits_size)))
+		goto error;
+	while (digits_size < width--) {
+		if (RT_UNLIKELY(!rt_char_append_char(_R(' '), buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char_append(digits, digits_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write a line per phase of <tt>workload</tt>: its duration, then the input bytes, the tokens and the parsed nodes per second.
+ */
+static rt_s zz_bench_write_result(enum zz_bench_workload workload, struct zz_bench_result *result)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE * 2];
+	rt_un buffer_size = 0;
+	rt_un line_start;
+	rt_un values[ZZ_BENCH_KEYS_COUNT];
+	rt_un phase;
+	rt_s ret;
+
+	for (phase = 0; phase < ZZ_BENCH_PHASES_COUNT; phase++) {
+		zz_bench_get_values(result, phase, values);
+
+		line_start = buffer_size;
+		if (RT_UNLIKELY(!zz_bench_get_result_name(workload, phase, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		while (buffer_size - line_start < 26) {
+			if (RT_UNLIKELY(!rt_char_append_char(_R(' '), buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+				goto error;
+		}
+		if (RT_UNLIKELY(!zz_bench_append_column(values[0], 10, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(" us"), 3, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		/* Megabytes per second, with two decimals. */
+		if (RT_UNLIKELY(!zz_bench_append_column(values[1] / 1000000, 7, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_char(_R('.'), buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_char(_R('0') + (values[1] / 100000) % 10, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_char(_R('0') + (values[1] / 10000) % 10, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(" MB/s"), 5, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_append_column(values[2], 12, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(" tokens/s"), 9, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_append_column(values[3], 12, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(" nodes/s\n"), 9, buffer, RT_CHAR_BIG_STRING_SIZE * 2, &buffer_size)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!rt_console_write(buffer, RT_FALSE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_bench_write_baseline(struct zz_bench_result *results, const rt_char *file_path)
+{
+	rt_char8 buffer[RT_CHAR8_BIG_STRING_SIZE * 16];
+	rt_un buffer_size = 0;
+	rt_char8 name[RT_CHAR8_BIG_STRING_SIZE];
+	rt_un values[ZZ_BENCH_KEYS_COUNT];
+	rt_un workload;
+	rt_un phase;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char8_append(ZZ_BENCH_BASELINE_HEADER, ZZ_BENCH_BASELINE_HEADER_SIZE, buffer, sizeof(buffer), &buffer_size)))
+		goto error;
+	for (workload = 0; workload < ZZ_BENCH_WORKLOADS_COUNT; workload++) {
+		for (phase = 0; phase < ZZ_BENCH_PHASES_COUNT; phase++) {
+			if (RT_UNLIKELY(!zz_bench_get_result_name8(workload, phase, name, RT_CHAR8_BIG_STRING_SIZE)))
+				goto error;
+			zz_bench_get_values(&results[workload], phase, values);
+			if (RT_UNLIKELY(!zz_bench_baseline_append_result(name, zz_bench_keys, values, ZZ_BENCH_KEYS_COUNT, !workload && !phase, buffer, sizeof(buffer), &buffer_size)))
+				goto error;
+		}
+	}
+	if (RT_UNLIKELY(!rt_char8_append(ZZ_BENCH_BASELINE_FOOTER, ZZ_BENCH_BASELINE_FOOTER_SIZE, buffer, sizeof(buffer), &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_small_file_write(file_path, RT_SMALL_FILE_MODE_TRUNCATE, buffer, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write the phases slower than the baseline by more than the tolerance.
+ *
+ * @param regressed Set if a phase is slower.
+ */
+static rt_s zz_bench_compare(struct zz_bench_result *results, struct zz_bench_options *options, struct rt_heap *heap, rt_b *regressed)
+{
+	struct zz_bench_baseline baseline;
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size;
+	rt_char8 name[RT_CHAR8_BIG_STRING_SIZE];
+	rt_un baseline_duration;
+	rt_un duration;
+	rt_un workload;
+	rt_un phase;
+	rt_s ret;
+
+	*regressed = RT_FALSE;
+
+	if (RT_UNLIKELY(!zz_bench_baseline_read(&baseline, options->baseline_file_path, heap)))
+		goto error;
+
+	for (workload = 0; workload < ZZ_BENCH_WORKLOADS_COUNT; workload++) {
+		for (phase = 0; phase < ZZ_BENCH_PHASES_COUNT; phase++) {
+			if (RT_UNLIKELY(!zz_bench_get_result_name8(workload, phase, name, RT_CHAR8_BIG_STRING_SIZE)))
+				goto error;
+
+			/* The phases that are not in the baseline are new. */
+			if (!zz_bench_baseline_find(&baseline, name, zz_bench_keys[0], &baseline_duration))
+				continue;
+			if (baseline_duration < ZZ_BENCH_MIN_COMPARED_DURATION)
+				continue;
+
+			duration = results[workload].durations[phase];
+			if ((rt_un64)duration * 100 <= (rt_un64)baseline_duration * (100 + options->tolerance))
+				continue;
+
+			*regressed = RT_TRUE;
+			buffer_size = 0;
+			if (RT_UNLIKELY(!rt_char_append(_R("Regression: "), 12, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_get_result_name(workload, phase, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_char_append(_R(" takes "), 7, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_char_append_un(duration, 10, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_char_append(_R(" us instead of "), 15, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_char_append_un(baseline_duration, 10, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_char_append(_R(" us.\n"), 5, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_console_write(buffer, RT_TRUE)))
+				goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_bench_baseline_free(&baseline) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @param regressed Set if a phase is slower than the baseline.
+ */
+static rt_s zz_bench_run(struct zz_bench_options *options, rt_b *regressed, struct rt_heap *heap)
+{
+	struct zz_options compiler_options;
+	rt_b compiler_options_parsed = RT_FALSE;
+	struct zz_code_generator_session session;
+	rt_b session_created = RT_FALSE;
+	struct zz_diagnostics diagnostics;
+	struct zz_bench_result results[ZZ_BENCH_WORKLOADS_COUNT];
+	struct rt_chrono chrono;
+	rt_un workload;
+	rt_s ret;
+
+	*regressed = RT_FALSE;
+	zz_diagnostics_create(&diagnostics, RT_NULL, heap);
+
+	compiler_options_parsed = RT_TRUE;
+	if (RT_UNLIKELY(!zz_bench_parse_compiler_options(options, &compiler_options, heap))) {
+		zz_diagnostics_add_last_error(&diagnostics, _R("Invalid optimization level: "));
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_code_generator_session_create(&session, &compiler_options, &diagnostics))) {
+		zz_diagnostics_add_last_error(&diagnostics, _R("LLVM initialization failed: "));
+		goto error;
+	}
+	session_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!rt_chrono_create(&chrono)))
+		goto error;
+
+	for (workload = 0; workload < ZZ_BENCH_WORKLOADS_COUNT; workload++) {
+		if (RT_UNLIKELY(!zz_bench_run_workload(&session, workload, options, &chrono, &results[workload], &diagnostics, heap))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("Benchmark failed: "));
+			goto error;
+		}
+		if (RT_UNLIKELY(!zz_bench_write_result(workload, &results[workload])))
+			goto error;
+	}
+
+	if (options->output_file_path) {
+		if (RT_UNLIKELY(!zz_bench_write_baseline(results, options->output_file_path))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("Baseline writing failed: "));
+			goto error;
+		}
+	}
+
+	if (options->baseline_file_path) {
+		if (RT_UNLIKELY(!zz_bench_compare(results, options, heap, regressed))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("Baseline reading failed: "));
+			goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	if (session_created) {
+		session_created = RT_FALSE;
+		if (RT_UNLIKELY(!zz_code_generator_session_free(&session) && ret))
+			goto error;
+	}
+	if (compiler_options_parsed) {
+		compiler_options_parsed = RT_FALSE;
+		if (RT_UNLIKELY(!zz_options_free(&compiler_options) && ret))
+			goto error;
+	}
+	if (RT_UNLIKELY(!zz_diagnostics_write(&diagnostics) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @param regressed Set if a phase is slower than the baseline.
+ */
+static rt_s zz_bench_main(rt_un argc, const rt_char *argv[], rt_b *regressed)
+{
+	struct zz_bench_options options;
+	struct rt_runtime_heap runtime_heap;
+	rt_b runtime_heap_created = RT_FALSE;
+	rt_b help;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_bench_parse_options(argc, argv, &options, &help))) {
+		if (!zz_bench_display_help(RT_FAILED))
+			goto error;
+		goto error;
+	}
+
+	if (help) {
+		if (RT_UNLIKELY(!zz_bench_display_help(RT_OK)))
+			goto error;
+		goto end;
+	}
+
+	if (RT_UNLIKELY(!rt_runtime_heap_create(&runtime_heap)))
+		goto error;
+	runtime_heap_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!zz_bench_run(&options, regressed, &runtime_heap.heap)))
+		goto error;
+
+end:
+	ret = RT_OK;
+free:
+	if (runtime_heap_created) {
+		runtime_heap_created = RT_FALSE;
+		if (RT_UNLIKELY(!runtime_heap.heap.close(&runtime_heap.heap) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_un16 rpr_main(rt_un argc, const rt_char *argv[])
+{
+	rt_b regressed = RT_FALSE;
+	int ret;
+
+	if (zz_bench_main(argc, argv, &regressed) && !regressed)
+		ret = 0;
+	else
+		ret = 1;
+	return ret;
+}
@@ -0,0 +1,117 @@
+#include "zz_bench_baseline.h"
+
+/**
+ * @return The position of <tt>searched</tt> in <tt>data</tt> from <tt>start</tt>, <tt>RT_TYPE_MAX_UN</tt> if it is not found.
+ */
+static rt_un zz_bench_baseline_search(const rt_char8 *data, rt_un data_size, rt_un start, const rt_char8 *searched, rt_un searched_size)
+{
+	rt_un i;
+
+	for (i = start; i + searched_size <= data_size; i++) {
+		if (rt_char8_equals(&data[i], searched_size, searched, searched_size))
+			return i;
+	}
+	return RT_TYPE_MAX_UN;
+}
+
+rt_s zz_bench_baseline_read(struct zz_bench_baseline *baseline, const rt_char *file_path, struct rt_heap *heap)
+{
+	baseline->heap_buffer = RT_NULL;
+	baseline->heap_buffer_capacity = 0;
+	baseline->data = RT_NULL;
+	baseline->data_size = 0;
+	baseline->heap = heap;
+
+	return rt_small_file_read(file_path, RT_NULL, 0, &baseline->heap_buffer, &baseline->heap_buffer_capacity, &baseline->data, &baseline->data_size, heap);
+}
+
+rt_b zz_bench_baseline_find(struct zz_bench_baseline *baseline, const rt_char8 *name, const rt_char8 *key, rt_un *value)
+{
+	rt_char8 searched[RT_CHAR8_BIG_STRING_SIZE];
+	rt_un searched_size = 0;
+	rt_un position;
+	rt_un end;
+
+	if (!rt_char8_append("{\"name\": \"", 10, searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size) ||
+	    !rt_char8_append(name, rt_char8_get_size(name), searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size) ||
+	    !rt_char8_append_char('"', searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size))
+		return RT_FALSE;
+	position = zz_bench_baseline_search(baseline->data, baseline->data_size, 0, searched, searched_size);
+	if (position == RT_TYPE_MAX_UN)
+		return RT_FALSE;
+
+	/* The key is searched in the object of the result only. */
+	end = zz_bench_baseline_search(baseline->data, baseline->data_size, position, "}", 1);
+	if (end == RT_TYPE_MAX_UN)
+		return RT_FALSE;
+
+	searched_size = 0;
+	if (!rt_char8_append_char('"', searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size) ||
+	    !rt_char8_append(key, rt_char8_get_size(key), searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size) ||
+	    !rt_char8_append("\": ", 3, searched, RT_CHAR8_BIG_STRING_SIZE, &searched_size))
+		return RT_FALSE;
+	position = zz_bench_baseline_search(baseline->data, end, position, searched, searched_size);
+	if (position == RT_TYPE_MAX_UN)
+		return RT_FALSE;
+	position += searched_size;
+
+	if (position >= end || baseline->data[position] < '0' || baseline->data[position] > '9')
+		return RT_FALSE;
+	*value = 0;
+	while (position < end && baseline->data[position] >= '0' && baseline->data[position] <= '9') {
+		*value = *value * 10 + (rt_un)(baseline->data[position] - '0');
+		position++;
+	}
+	return RT_TRUE;
+}
+
+rt_s zz_bench_baseline_free(struct zz_bench_baseline *baseline)
+{
+	struct rt_heap *heap = baseline->heap;
+	rt_s ret = RT_OK;
+
+	if (baseline->heap_buffer && RT_UNLIKELY(!heap->free(heap, &baseline->heap_buffer)))
+		ret = RT_FAILED;
+	baseline->heap_buffer_capacity = 0;
+	baseline->data = RT_NULL;
+	baseline->data_size = 0;
+
+	return ret;
+}
+
+rt_s zz_bench_baseline_append_result(const rt_char8 *name, const rt_char8 *const *keys, const rt_un *values, rt_un keys_count, rt_b first, rt_char8 *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_un i;
+	rt_s ret;
+
+	if (!first) {
+		if (RT_UNLIKELY(!rt_char8_append(",\n", 2, buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char8_append("    {\"name\": \"", 14, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append(name, rt_char8_get_size(name), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_char('"', buffer, buffer_capacity, buffer_size)))
+		goto error;
+	for (i = 0; i < keys_count; i++) {
+		if (RT_UNLIKELY(!rt_char8_append(", \"", 3, buffer, buffer_capacity, buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char8_append(keys[i], rt_char8_get_size(keys[i]), buffer, buffer_capacity, buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char8_append("\": ", 3, buffer, buffer_capacity, buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char8_append_un(values[i], 10, buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char8_append_char('}', buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,57 @@
+#ifndef ZZ_BENCH_BASELINE_H
+#define ZZ_BENCH_BASELINE_H
+
+#include <rpr.h>
+
+/**
+ * Results of a previous run, read from a JSON file like:
+ *
+ * <pre>
+ * {
+ *   "results": [
+ *     {"name": "long_expression/lex", "us": 1520, "bytes_per_second": 402368421},
+ *     {"name": "long_expression/parse", "us": 2301, "bytes_per_second": 265797479}
+ *   ]
+ * }
+ * </pre>
+ *
+ * <p>
+ * Each result is an object on its own line, with a unique name and unsigned integer values.<br>
+ * Only the files written by <tt>zz_bench_baseline_append_result</tt> are supported, not any JSON.
+ * </p>
+ */
+struct zz_bench_baseline {
+	void *heap_buffer;
+	rt_un heap_buffer_capacity;
+	rt_char8 *data;
+	rt_un data_size;
+	struct rt_heap *heap;
+};
+
+/**
+ * <tt>zz_bench_baseline_free</tt> must be called even if the reading fails.
+ */
+rt_s zz_bench_baseline_read(struct zz_bench_baseline *baseline, const rt_char *file_path, struct rt_heap *heap);
+
+/**
+ * @return <tt>RT_TRUE</tt> if the result <tt>name</tt> has the value <tt>key</tt>, written in <tt>value</tt>.
+ */
+rt_b zz_bench_baseline_find(struct zz_bench_baseline *baseline, const rt_char8 *name, const rt_char8 *key, rt_un *value);
+
+rt_s zz_bench_baseline_free(struct zz_bench_baseline *baseline);
+
+/**
+ * Append the line of a result, <tt>keys_count</tt> keys and their values.<br>
+ * The results must be surrounded by <tt>ZZ_BENCH_BASELINE_HEADER</tt> and <tt>ZZ_BENCH_BASELINE_FOOTER</tt>.
+ *
+ * @param first Whether it is the first result, not preceded by a comma.
+ */
+rt_s zz_bench_baseline_append_result(const rt_char8 *name, const rt_char8 *const *keys, const rt_un *values, rt_un keys_count, rt_b first, rt_char8 *buffer, rt_un buffer_capacity, rt_un *buffer_size);
+
+#define ZZ_BENCH_BASELINE_HEADER "{\n  \"results\": [\n"
+#define ZZ_BENCH_BASELINE_HEADER_SIZE 17
+
+#define ZZ_BENCH_BASELINE_FOOTER "\n  ]\n}\n"
+#define ZZ_BENCH_BASELINE_FOOTER_SIZE 7
+
+#endif /* ZZ_BENCH_BASELINE_H */
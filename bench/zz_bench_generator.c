@@ -0,0 +1,453 @@
+#include "zz_bench_generator.h"
+
+/* Same input on every run and every platform. */
+#define ZZ_BENCH_GENERATOR_SEED 0x5DEECE66DULL
+
+/* Functions called by the expressions, so that they are not folded. */
+#define ZZ_BENCH_GENERATOR_CALLEES_COUNT 8
+
+#define ZZ_BENCH_GENERATOR_LONG_EXPRESSION_TERMS 50000
+#define ZZ_BENCH_GENERATOR_DEEP_NESTING_DEPTH 10000
+#define ZZ_BENCH_GENERATOR_MANY_FUNCTIONS_COUNT 2000
+#define ZZ_BENCH_GENERATOR_HUGE_IDENTIFIERS_COUNT 64
+#define ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE 4096
+
+/* Terms per line of the long expressions. */
+#define ZZ_BENCH_GENERATOR_LINE_TERMS 16
+
+static const rt_char *const zz_bench_generator_names[] = {
+	[ZZ_BENCH_WORKLOAD_LONG_EXPRESSION] = _R("long_expression"),
+	[ZZ_BENCH_WORKLOAD_DEEP_NESTING] = _R("deep_nesting"),
+	[ZZ_BENCH_WORKLOAD_MANY_FUNCTIONS] = _R("many_functions"),
+	[ZZ_BENCH_WORKLOAD_HUGE_IDENTIFIERS] = _R("huge_identifiers")
+};
+
+static const rt_char8 *const zz_bench_generator_names8[] = {
+	[ZZ_BENCH_WORKLOAD_LONG_EXPRESSION] = "long_expression",
+	[ZZ_BENCH_WORKLOAD_DEEP_NESTING] = "deep_nesting",
+	[ZZ_BENCH_WORKLOAD_MANY_FUNCTIONS] = "many_functions",
+	[ZZ_BENCH_WORKLOAD_HUGE_IDENTIFIERS] = "huge_identifiers"
+};
+
+static const rt_char8 zz_bench_generator_operators[] = "+-*/%";
+
+static const rt_char8 zz_bench_generator_identifier_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+
+struct zz_bench_generator {
+	rt_char8 *data;
+	rt_un size;
+	rt_un capacity;
+	rt_un64 random;
+	struct rt_heap *heap;
+};
+
+/**
+ * Linear congruential generator of Knuth, only the high bits are used.
+ */
+static rt_un zz_bench_generator_next(struct zz_bench_generator *generator, rt_un bound)
+{
+	generator->random = generator->random * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (rt_un)((generator->random >> 33) % bound);
+}
+
+/**
+ * Keeps room for the terminating zero.
+ */
+static rt_s zz_bench_generator_append(struct zz_bench_generator *generator, const rt_char8 *str, rt_un size)
+{
+	struct rt_heap *heap = generator->heap;
+	rt_un capacity;
+	rt_s ret;
+
+	if (generator->size + size + 1 > generator->capacity) {
+		capacity = generator->capacity ? generator->capacity * 2 : 65536;
+		while (capacity < generator->size + size + 1)
+			capacity *= 2;
+		if (generator->data) {
+			if (RT_UNLIKELY(!heap->realloc(heap, (void**)&generator->data, capacity)))
+				goto error;
+		} else {
+			if (RT_UNLIKELY(!heap->alloc(heap, (void**)&generator->data, capacity)))
+				goto error;
+		}
+		generator->capacity = capacity;
+	}
+
+	RT_MEMORY_COPY(str, &generator->data[generator->size], size);
+	generator->size += size;
+	generator->data[generator->size] = 0;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_bench_generator_append_un(struct zz_bench_generator *generator, rt_un value)
+{
+	rt_char8 buffer[64];
+	rt_un buffer_size = 0;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char8_append_un(value, 10, buffer, 64, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, buffer, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Append the name of the function <tt>index</tt>, <tt>prefix</tt> followed by the index.
+ */
+static rt_s zz_bench_generator_append_name(struct zz_bench_generator *generator, const rt_char8 *prefix, rt_un index)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, prefix, rt_char8_get_size(prefix))))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append_un(generator, index)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Define the functions <tt>k0</tt> to <tt>k7</tt>, called by the generated expressions.
+ */
+static rt_s zz_bench_generator_append_callees(struct zz_bench_generator *generator)
+{
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < ZZ_BENCH_GENERATOR_CALLEES_COUNT; i++) {
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn ", 3)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "k", i)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()\n{\n  ", 7)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_un(generator, i + 2)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n}\n\n", 4)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * A literal from 1 to 999, sometimes negated, or a call to a callee.
+ */
+static rt_s zz_bench_generator_append_term(struct zz_bench_generator *generator)
+{
+	rt_s ret;
+
+	if (zz_bench_generator_next(generator, 4) == 0) {
+		if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "k", zz_bench_generator_next(generator, ZZ_BENCH_GENERATOR_CALLEES_COUNT))))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()", 2)))
+			goto error;
+	} else {
+		if (zz_bench_generator_next(generator, 8) == 0) {
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, "-", 1)))
+				goto error;
+		}
+		if (RT_UNLIKELY(!zz_bench_generator_append_un(generator, zz_bench_generator_next(generator, 999) + 1)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Append a binary operator surrounded by spaces.
+ */
+static rt_s zz_bench_generator_append_operator(struct zz_bench_generator *generator)
+{
+	rt_char8 operator[3];
+
+	operator[0] = ' ';
+	operator[1] = zz_bench_generator_operators[zz_bench_generator_next(generator, sizeof(zz_bench_generator_operators) - 1)];
+	operator[2] = ' ';
+	return zz_bench_generator_append(generator, operator, 3);
+}
+
+static rt_s zz_bench_generator_generate_long_expression(struct zz_bench_generator *generator, rt_un scale)
+{
+	rt_un terms_count = ZZ_BENCH_GENERATOR_LONG_EXPRESSION_TERMS * scale;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_bench_generator_append_callees(generator)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn main()\n{\n  ", 14)))
+		goto error;
+
+	for (i = 0; i < terms_count; i++) {
+		if (i) {
+			if (RT_UNLIKELY(!zz_bench_generator_append_operator(generator)))
+				goto error;
+			if (!(i % ZZ_BENCH_GENERATOR_LINE_TERMS)) {
+				if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n  ", 3)))
+					goto error;
+			}
+		}
+		if (RT_UNLIKELY(!zz_bench_generator_append_term(generator)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n}\n", 3)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * <tt>(((k0() + 1) * k3()) - 2)</tt> with <tt>depth</tt> parenthesis.
+ */
+static rt_s zz_bench_generator_generate_deep_nesting(struct zz_bench_generator *generator, rt_un scale)
+{
+	rt_un depth = ZZ_BENCH_GENERATOR_DEEP_NESTING_DEPTH * scale;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_bench_generator_append_callees(generator)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn main()\n{\n  ", 14)))
+		goto error;
+
+	for (i = 0; i < depth; i++) {
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "(", 1)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!zz_bench_generator_append_term(generator)))
+		goto error;
+	for (i = 0; i < depth; i++) {
+		if (RT_UNLIKELY(!zz_bench_generator_append_operator(generator)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_term(generator)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, ")", 1)))
+			goto error;
+		if (!((i + 1) % ZZ_BENCH_GENERATOR_LINE_TERMS)) {
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n  ", 3)))
+				goto error;
+		}
+	}
+
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n}\n", 3)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Each function <tt>f<i>N</i></tt> combines a literal with calls to two of the previous ones, <tt>main</tt> calls the last one.
+ */
+static rt_s zz_bench_generator_generate_many_functions(struct zz_bench_generator *generator, rt_un scale)
+{
+	rt_un functions_count = ZZ_BENCH_GENERATOR_MANY_FUNCTIONS_COUNT * scale;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < functions_count; i++) {
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn ", 3)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "f", i)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()\n{\n  ", 7)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_un(generator, zz_bench_generator_next(generator, 999) + 1)))
+			goto error;
+		if (i) {
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, " * ", 3)))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "f", zz_bench_generator_next(generator, i))))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, "() + ", 5)))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "f", zz_bench_generator_next(generator, i))))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()", 2)))
+				goto error;
+		}
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n}\n\n", 4)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn main()\n{\n  ", 14)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append_name(generator, "f", functions_count - 1)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()\n}\n", 5)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Fill <tt>identifier</tt> with <tt>ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE</tt> random characters, starting with a letter.
+ */
+static void zz_bench_generator_get_huge_identifier(struct zz_bench_generator *generator, rt_char8 *identifier)
+{
+	rt_un i;
+
+	identifier[0] = zz_bench_generator_identifier_chars[zz_bench_generator_next(generator, 52)];
+	for (i = 1; i < ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE; i++)
+		identifier[i] = zz_bench_generator_identifier_chars[zz_bench_generator_next(generator, sizeof(zz_bench_generator_identifier_chars) - 1)];
+}
+
+/**
+ * Each function calls the previous one, <tt>main</tt> calls the last one.<br>
+ * The names are written again at each call, so each identifier token appears twice.
+ */
+static rt_s zz_bench_generator_generate_huge_identifiers(struct zz_bench_generator *generator, rt_un scale)
+{
+	rt_un functions_count = ZZ_BENCH_GENERATOR_HUGE_IDENTIFIERS_COUNT * scale;
+	rt_char8 identifiers[2][ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE];
+	rt_char8 *identifier = RT_NULL;
+	rt_char8 *previous_identifier = RT_NULL;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < functions_count; i++) {
+		identifier = identifiers[i & 1];
+		zz_bench_generator_get_huge_identifier(generator, identifier);
+
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn ", 3)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, identifier, ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()\n{\n  ", 7)))
+			goto error;
+		if (RT_UNLIKELY(!zz_bench_generator_append_un(generator, zz_bench_generator_next(generator, 999) + 1)))
+			goto error;
+		if (previous_identifier) {
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, " + ", 3)))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, previous_identifier, ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE)))
+				goto error;
+			if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()", 2)))
+				goto error;
+		}
+		if (RT_UNLIKELY(!zz_bench_generator_append(generator, "\n}\n\n", 4)))
+			goto error;
+		previous_identifier = identifier;
+	}
+
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "fn main()\n{\n  ", 14)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, identifier, ZZ_BENCH_GENERATOR_HUGE_IDENTIFIER_SIZE)))
+		goto error;
+	if (RT_UNLIKELY(!zz_bench_generator_append(generator, "()\n}\n", 5)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_bench_generator_generate(enum zz_bench_workload workload, rt_un scale, struct rt_heap *heap, rt_char8 **input, rt_un *input_size)
+{
+	struct zz_bench_generator generator;
+	rt_s ret;
+
+	generator.data = RT_NULL;
+	generator.size = 0;
+	generator.capacity = 0;
+	generator.random = ZZ_BENCH_GENERATOR_SEED;
+	generator.heap = heap;
+
+	switch (workload) {
+	case ZZ_BENCH_WORKLOAD_LONG_EXPRESSION:
+		ret = zz_bench_generator_generate_long_expression(&generator, scale);
+		break;
+	case ZZ_BENCH_WORKLOAD_DEEP_NESTING:
+		ret = zz_bench_generator_generate_deep_nesting(&generator, scale);
+		break;
+	case ZZ_BENCH_WORKLOAD_MANY_FUNCTIONS:
+		ret = zz_bench_generator_generate_many_functions(&generator, scale);
+		break;
+	case ZZ_BENCH_WORKLOAD_HUGE_IDENTIFIERS:
+		ret = zz_bench_generator_generate_huge_identifiers(&generator, scale);
+		break;
+	default:
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		ret = RT_FAILED;
+	}
+	if (RT_UNLIKELY(!ret))
+		goto error;
+
+	*input = generator.data;
+	*input_size = generator.size;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	if (generator.data)
+		heap->free(heap, (void**)&generator.data);
+	ret = RT_FAILED;
+	goto free;
+}
+
+const rt_char *zz_bench_generator_get_name(enum zz_bench_workload workload)
+{
+	return zz_bench_generator_names[workload];
+}
+
+const rt_char8 *zz_bench_generator_get_name8(enum zz_bench_workload workload)
+{
+	return zz_bench_generator_names8[workload];
+}
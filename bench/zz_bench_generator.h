@@ -0,0 +1,42 @@
+#ifndef ZZ_BENCH_GENERATOR_H
+#define ZZ_BENCH_GENERATOR_H
+
+#include <rpr.h>
+
+enum zz_bench_workload {
+	/* A main function made of a single expression of literals and calls. */
+	ZZ_BENCH_WORKLOAD_LONG_EXPRESSION,
+	/* An expression whose parenthesis are all nested. */
+	ZZ_BENCH_WORKLOAD_DEEP_NESTING,
+	/* Small functions calling the previous ones. */
+	ZZ_BENCH_WORKLOAD_MANY_FUNCTIONS,
+	/* Functions with names of several kibibytes. */
+	ZZ_BENCH_WORKLOAD_HUGE_IDENTIFIERS,
+	ZZ_BENCH_WORKLOADS_COUNT
+};
+
+/**
+ * Generate a synthetic <tt>.stc</tt> input for <tt>workload</tt>.
+ *
+ * <p>
+ * The random numbers come from a fixed seed, so a workload and a scale always give the same input, on all platforms.<br>
+ * The size of the input grows linearly with <tt>scale</tt>, which must be at least one.
+ * </p>
+ *
+ * <p>
+ * The calls cannot be folded by <tt>zz_optimizer_optimize</tt>, so the code generation and the emission have work whatever the workload.
+ * </p>
+ *
+ * @param input Receives the input, terminated by a zero, to be freed with <tt>heap</tt>.
+ * @param input_size Without the terminating zero.
+ */
+rt_s zz_bench_generator_generate(enum zz_bench_workload workload, rt_un scale, struct rt_heap *heap, rt_char8 **input, rt_un *input_size);
+
+/**
+ * @return The name of <tt>workload</tt>, in lower case with underscores.
+ */
+const rt_char *zz_bench_generator_get_name(enum zz_bench_workload workload);
+
+const rt_char8 *zz_bench_generator_get_name8(enum zz_bench_workload workload);
+
+#endif /* ZZ_BENCH_GENERATOR_H */
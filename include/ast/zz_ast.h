@@ -4,36 +4,171 @@
 #include <rpr.h>
 
 #include "ast/zz_binary_operators.h"
+#include "ast/zz_cpu_levels.h"
 #include "ast/zz_unary_operators.h"
+#include "ast/zz_value_types.h"
 
 enum zz_ast_node_type {
 	ZZ_AST_NODE_TYPE_NUMBER,
 	ZZ_AST_NODE_TYPE_UNARY_OPERATOR,
 	ZZ_AST_NODE_TYPE_BINARY_OPERATOR,
-	ZZ_AST_NODE_TYPE_FUNCTION
+	ZZ_AST_NODE_TYPE_CALL,
+	ZZ_AST_NODE_TYPE_VECTOR,
+	ZZ_AST_NODE_TYPE_EXTRACT,
+	ZZ_AST_NODE_TYPE_SHUFFLE,
+	ZZ_AST_NODE_TYPE_CONVERSION,
+	ZZ_AST_NODE_TYPE_LOCAL,
+	ZZ_AST_NODE_TYPE_ADDRESS,
+	ZZ_AST_NODE_TYPE_LOAD,
+	/* The following ones are statements, they have no value. */
+	ZZ_AST_NODE_TYPE_ASSIGN,
+	ZZ_AST_NODE_TYPE_STORE,
+	ZZ_AST_NODE_TYPE_FOR,
+	ZZ_AST_NODE_TYPE_END_FOR
 };
 
-struct zz_ast_node {
-	enum zz_ast_node_type type;
-	union {
-		struct {
-			rt_n value;
-		} number;
-		struct {
-			enum zz_unary_operator unary_operator;
-			struct zz_ast_node *operand;
-		} unary_operator;
-		struct {
-			enum zz_binary_operator binary_operator;
-			struct zz_ast_node *left;
-			struct zz_ast_node *right;
-		} binary_operator;
-		struct {
-			rt_char *name;
-			rt_un name_size;
-			struct zz_ast_node *body;
-		} function;
-	} u;
+#define ZZ_AST_NODE_TYPE_IS_STATEMENT(type) ((type) >= ZZ_AST_NODE_TYPE_ASSIGN)
+
+/**
+ * The kind of a node packs its type and, for operators, the <tt>enum zz_unary_operator</tt> or <tt>enum zz_binary_operator</tt>.<br>
+ * For vectors and conversions, the operator is the <tt>enum zz_value_type</tt> of the result.
+ */
+#define ZZ_AST_NODE_KIND(type, operator) ((rt_un8)(((type) << 4) | (operator)))
+#define ZZ_AST_NODE_KIND_GET_TYPE(kind) ((kind) >> 4)
+#define ZZ_AST_NODE_KIND_GET_OPERATOR(kind) ((kind) & 0x0F)
+
+/**
+ * The body of a function is made of the nodes from <tt>first_node</tt> to <tt>body</tt>, the root of its result.<br>
+ * Its statements are executed in the order of their nodes, before the result.
+ */
+struct zz_ast_function {
+	/* Symbol id of the name. */
+	rt_un32 name;
+	rt_un32 first_node;
+	rt_un32 body;
+	/* Its local variables are in locals, from first_local. */
+	rt_un32 first_local;
+	rt_un32 locals_count;
+	/* The enum zz_value_type returned by the function. */
+	rt_un8 type;
+	/* Bit i is set if the function has a variant for the enum zz_cpu_level i. */
+	rt_un8 cpu_levels;
 };
 
+/**
+ * A scalar, a vector or an array of them, on the stack of its function.
+ */
+struct zz_ast_local {
+	/* Number of elements of an array, zero for the other variables. */
+	rt_un32 array_size;
+	/* The enum zz_value_type of the variable or of the elements of the array. */
+	rt_un8 type;
+};
+
+/**
+ * A counted loop with its optional hints, zero if not specified.
+ */
+struct zz_ast_loop {
+	/* Local of the loop variable, from the start to the end of the range. */
+	rt_un32 variable;
+	rt_un32 unroll;
+	rt_un32 vectorize;
+	rt_un32 interleave;
+};
+
+/**
+ * Compact AST, as a structure of arrays where nodes are addressed by 32 bits indexes.
+ *
+ * <p>
+ * Node <tt>i</tt> has kind <tt>kinds[i]</tt> and operands <tt>operands[2 * i]</tt> and <tt>operands[2 * i + 1]</tt>:
+ * </p>
+ * <ul>
+ * <li>Number: index of its value in <tt>literals</tt>.</li>
+ * <li>Unary operator: index of its operand.</li>
+ * <li>Binary operator: indexes of its left and right operands.</li>
+ * <li>Call: symbol id of the called function, which takes no arguments.</li>
+ * <li>Vector: index of its first lane in <tt>literals</tt>, the other lanes follow.</li>
+ * <li>Extract: index of the vector and number of the extracted lane.</li>
+ * <li>Shuffle: indexes of its two vectors. Its mask is the vector node just before it, whose lanes are indexes in the concatenation of the two vectors.</li>
+ * <li>Conversion: index of the converted scalar.</li>
+ * <li>Local: index of the variable in <tt>locals</tt>.</li>
+ * <li>Address: index of the array in <tt>locals</tt>, index of the element index.</li>
+ * <li>Load: index of the address.</li>
+ * <li>Assign: index of the variable in <tt>locals</tt>, index of the value. For an array, the value is zero and fills the array.</li>
+ * <li>Store: indexes of the address and of the value.</li>
+ * <li>For: index of the end of the range, index of the loop in <tt>loops</tt>. The variable has been assigned the start, the body follows.</li>
+ * <li>End for: index of the for node, after the body.</li>
+ * </ul>
+ *
+ * <p>
+ * <tt>types[i]</tt> is the <tt>enum zz_value_type</tt> of node <tt>i</tt>, set by the parser once all the functions are known.<br>
+ * The statements are typed as i32, although they have no value.
+ * </p>
+ *
+ * <p>
+ * Nodes are stored in post-order: the operands of a node are always before it.<br>
+ * As a result, a tree can be processed with a simple loop over its range of nodes, without recursion.
+ * </p>
+ */
+struct zz_ast {
+	rt_un8 *kinds;
+	rt_un8 *types;
+	rt_un32 *operands;
+	rt_n *literals;
+	struct zz_ast_function *functions;
+	struct zz_ast_local *locals;
+	struct zz_ast_loop *loops;
+	rt_un nodes_count;
+	rt_un nodes_capacity;
+	rt_un literals_count;
+	rt_un literals_capacity;
+	rt_un functions_count;
+	rt_un functions_capacity;
+	rt_un locals_count;
+	rt_un locals_capacity;
+	rt_un loops_count;
+	rt_un loops_capacity;
+	struct rt_heap *heap;
+};
+
+void zz_ast_create(struct zz_ast *ast, struct rt_heap *heap);
+
+/**
+ * Make sure that the AST can hold <tt>nodes_capacity</tt> nodes without reallocation.
+ */
+rt_s zz_ast_reserve(struct zz_ast *ast, rt_un nodes_capacity);
+
+rt_s zz_ast_add_node(struct zz_ast *ast, rt_un8 kind, rt_un32 first_operand, rt_un32 second_operand, rt_un32 *node);
+
+/**
+ * Add a number node and its literal.
+ */
+rt_s zz_ast_add_number(struct zz_ast *ast, rt_n value, rt_un32 *node);
+
+/**
+ * Add a vector node and the <tt>zz_value_type_get_lanes_count(value_type)</tt> literals of its lanes.
+ */
+rt_s zz_ast_add_vector(struct zz_ast *ast, enum zz_value_type value_type, const rt_n *lanes, rt_un32 *node);
+
+/**
+ * The locals from <tt>first_local</tt> must have been added for this function.
+ *
+ * @param cpu_levels See <tt>struct zz_ast_function</tt>, zero for a function without variants.
+ */
+rt_s zz_ast_add_function(struct zz_ast *ast, rt_un32 name, enum zz_value_type type, rt_un32 first_node, rt_un32 body, rt_un32 first_local, rt_un8 cpu_levels);
+
+/**
+ * @param type <tt>ZZ_VALUE_TYPES_COUNT</tt> if it is not known yet.
+ */
+rt_s zz_ast_add_local(struct zz_ast *ast, enum zz_value_type type, rt_un32 array_size, rt_un32 *local);
+
+rt_s zz_ast_add_loop(struct zz_ast *ast, rt_un32 variable, rt_un32 unroll, rt_un32 vectorize, rt_un32 interleave, rt_un32 *loop);
+
+/**
+ * Memory used by the nodes, literals, functions, locals and loops, in bytes.
+ */
+rt_un zz_ast_get_size(struct zz_ast *ast);
+
+rt_s zz_ast_free(struct zz_ast *ast);
+
 #endif /* ZZ_AST_H */
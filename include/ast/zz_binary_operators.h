@@ -8,7 +8,13 @@ enum zz_binary_operator {
 	ZZ_BINARY_OPERATOR_SUBTRACT,
 	ZZ_BINARY_OPERATOR_MULTIPLY,
 	ZZ_BINARY_OPERATOR_DIVIDE,
-	ZZ_BINARY_OPERATOR_MODULO
+	ZZ_BINARY_OPERATOR_MODULO,
+	/* The following ones are introduced by the optimizer, their right operand is an exponent. */
+	ZZ_BINARY_OPERATOR_SHIFT_LEFT,
+	/* Signed division by a power of two, rounding toward zero like ZZ_BINARY_OPERATOR_DIVIDE. */
+	ZZ_BINARY_OPERATOR_DIVIDE_BY_POWER_OF_TWO,
+	/* Signed remainder of a division by a power of two, with the sign of the dividend like ZZ_BINARY_OPERATOR_MODULO. */
+	ZZ_BINARY_OPERATOR_MODULO_BY_POWER_OF_TWO
 };
 
 #endif /* ZZ_BINARY_OPERATORS_H */
@@ -0,0 +1,27 @@
+#ifndef ZZ_CPU_LEVELS_H
+#define ZZ_CPU_LEVELS_H
+
+#include <rpr.h>
+
+/**
+ * Instruction sets a function can have a variant for, see <tt>multiversion</tt>.<br>
+ * Each level implies the previous ones on the processors that support it.
+ */
+enum zz_cpu_level {
+	ZZ_CPU_LEVEL_SSE4_2,
+	ZZ_CPU_LEVEL_AVX2,
+	ZZ_CPU_LEVEL_AVX512F,
+	ZZ_CPU_LEVELS_COUNT
+};
+
+/**
+ * @return The name of <tt>cpu_level</tt> in the source, like <tt>sse4.2</tt>.
+ */
+const rt_char8 *zz_cpu_level_get_name8(enum zz_cpu_level cpu_level);
+
+/**
+ * @return The level called <tt>name</tt>, or <tt>ZZ_CPU_LEVELS_COUNT</tt> if there is no such level.
+ */
+enum zz_cpu_level zz_cpu_level_find(const rt_char8 *name, rt_un name_size);
+
+#endif /* ZZ_CPU_LEVELS_H */
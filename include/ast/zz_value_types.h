@@ -0,0 +1,50 @@
+#ifndef ZZ_VALUE_TYPES_H
+#define ZZ_VALUE_TYPES_H
+
+#include <rpr.h>
+
+enum zz_value_type {
+	ZZ_VALUE_TYPE_I32,
+	ZZ_VALUE_TYPE_I64,
+	ZZ_VALUE_TYPE_I32X4,
+	ZZ_VALUE_TYPE_I32X8,
+	ZZ_VALUE_TYPE_I64X4,
+	ZZ_VALUE_TYPES_COUNT
+};
+
+/**
+ * Maximum number of lanes of a vector type.
+ */
+#define ZZ_VALUE_TYPE_MAX_LANES_COUNT 8
+
+/**
+ * @return The number of lanes of <tt>value_type</tt>, one for scalars.
+ */
+rt_un zz_value_type_get_lanes_count(enum zz_value_type value_type);
+
+/**
+ * @return The type of the lanes of <tt>value_type</tt>, <tt>value_type</tt> itself for scalars.
+ */
+enum zz_value_type zz_value_type_get_lane_type(enum zz_value_type value_type);
+
+/**
+ * @return The size of a value of type <tt>value_type</tt>, in bytes.
+ */
+rt_un zz_value_type_get_size(enum zz_value_type value_type);
+
+/**
+ * @return The vector type made of <tt>lanes_count</tt> lanes of <tt>lane_type</tt>, or <tt>ZZ_VALUE_TYPES_COUNT</tt> if the language has no such type.
+ */
+enum zz_value_type zz_value_type_get_vector_type(enum zz_value_type lane_type, rt_un lanes_count);
+
+/**
+ * Whether a value of type <tt>source</tt> can be used where a value of type <tt>destination</tt> is expected.
+ *
+ * <p>
+ * A scalar is converted to any type whose lanes are at least as wide, by sign extension then by copy into all the lanes.<br>
+ * Vectors are never converted.
+ * </p>
+ */
+rt_b zz_value_type_is_convertible(enum zz_value_type source, enum zz_value_type destination);
+
+#endif /* ZZ_VALUE_TYPES_H */
@@ -0,0 +1,68 @@
+#ifndef ZZ_OBJECT_CACHE_H
+#define ZZ_OBJECT_CACHE_H
+
+#include <rpr.h>
+
+#include "code_generator/zz_code_generator_session.h"
+#include "options/zz_options.h"
+#include "profile/zz_profile.h"
+
+/* Bump when the objects generated from a same source change. */
+#define ZZ_OBJECT_CACHE_VERSION "stc-1"
+
+/**
+ * 128 bits content hash of a source and of the configuration.
+ */
+struct zz_object_cache_key {
+	rt_un64 low;
+	rt_un64 high;
+};
+
+/**
+ * Directory of object files named after the hash of their source and of everything else that changes them.
+ *
+ * <p>
+ * The key covers the compiler and LLVM versions, the target triple, CPU and features, the optimization level, the pass pipeline and the profiles.<br>
+ * An entry is restored as a hard link, or a copy if linking fails, so that a hit skips the whole pipeline.<br>
+ * As a result, object files must be replaced rather than overwritten, or the entries they are linked to would change.
+ * </p>
+ *
+ * <p>
+ * Entries are only added with atomic links or renames, so that processes and threads can share the directory.<br>
+ * Restoring an entry updates its modification time, the least recently used entries are evicted first.
+ * </p>
+ */
+struct zz_object_cache {
+	const rt_char *directory_path;
+	rt_un max_size;
+	rt_un64 configuration_hash;
+};
+
+/**
+ * Create the cache directory if needed.
+ *
+ * @param session Gives the target, which all the sessions using the cache must share.
+ * @param profile Profile of <tt>--profile-use</tt>, can be null.
+ */
+rt_s zz_object_cache_create(struct zz_object_cache *object_cache, struct zz_options *options, struct zz_code_generator_session *session, struct zz_profile *profile);
+
+void zz_object_cache_get_key(struct zz_object_cache *object_cache, const rt_char8 *source, rt_un source_size, struct zz_object_cache_key *key);
+
+/**
+ * Replace <tt>output_file_path</tt> by a link to, or a copy of, the entry of <tt>key</tt>.
+ *
+ * @param restored Set to false, without failure, on a miss.
+ */
+rt_s zz_object_cache_restore(struct zz_object_cache *object_cache, struct zz_object_cache_key *key, const rt_char *output_file_path, rt_b *restored);
+
+/**
+ * Add <tt>output_file_path</tt> as the entry of <tt>key</tt>.
+ */
+rt_s zz_object_cache_store(struct zz_object_cache *object_cache, struct zz_object_cache_key *key, const rt_char *output_file_path);
+
+/**
+ * If the entries are bigger than the maximum size, delete the least recently used ones down to 90% of it.
+ */
+rt_s zz_object_cache_evict(struct zz_object_cache *object_cache, rt_un *evicted_count, struct rt_heap *heap);
+
+#endif /* ZZ_OBJECT_CACHE_H */
@@ -4,7 +4,53 @@
 #include <rpr.h>
 
 #include "ast/zz_ast.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "options/zz_options.h"
+#include "profile/zz_profile.h"
+#include "stats/zz_stats.h"
+#include "symbol/zz_symbol_table.h"
 
-rt_s zz_code_generator_generate(struct zz_ast_node *root, rt_char *output_file_path);
+/**
+ * Generate a new module in <tt>session</tt>, optimize it then write the artifacts of <tt>--emit</tt>.
+ *
+ * <p>
+ * With <tt>--codegen-units</tt>, the functions are split in several modules with their own context.<br>
+ * They are generated by the calling thread, then optimized and emitted in parallel, each part having its own artifacts.
+ * </p>
+ *
+ * <p>
+ * With <tt>--profile-generate</tt>, each module counts the calls and the branches of its functions, then appends them to the profile file when the program exits.
+ * </p>
+ *
+ * <p>
+ * With <tt>--run</tt>, the module is compiled in memory by the JIT and its <tt>main</tt> function is called instead.
+ * </p>
+ *
+ * @param profile Profile of <tt>--profile-use</tt>, whose counts are attached to the functions before the passes. Can be null.
+ * @param input_file_path The artifacts are named after it, unless <tt>-o</tt> is used.
+ * @param diagnostics Receives the LLVM error messages.
+ * @param stats Can be null.
+ * @param exit_code Receives the value returned by <tt>main</tt> with <tt>--run</tt>, can be null otherwise.
+ */
+rt_s zz_code_generator_generate(struct zz_code_generator_session *session, struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code);
+
+/**
+ * Optimize the program linked by <tt>--lto-link</tt>, then write the artifacts of <tt>--emit</tt>.
+ *
+ * <p>
+ * With a full link, only <tt>main</tt> remains visible outside of the program, the other functions can be inlined and removed.
+ * </p>
+ *
+ * <p>
+ * With a thin link, the functions are split in a partition per job, each optimized and emitted in parallel like a code generation unit.<br>
+ * A partition also receives the small functions of the others, as available externally, so that they can be inlined.
+ * </p>
+ *
+ * @param llvm_module The whole program, in the context of the session. Disposed by this function.
+ * @param input_file_path The artifacts are named after it, unless <tt>-o</tt> is used.
+ * @param stats Can be null.
+ */
+rt_s zz_code_generator_generate_linked(struct zz_code_generator_session *session, LLVMModuleRef llvm_module, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, struct rt_heap *heap);
 
 #endif /* ZZ_CODE_GENERATOR_H */
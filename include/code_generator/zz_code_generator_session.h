@@ -0,0 +1,77 @@
+#ifndef ZZ_CODE_GENERATOR_SESSION_H
+#define ZZ_CODE_GENERATOR_SESSION_H
+
+#include <rpr.h>
+
+#include "diagnostics/zz_diagnostics.h"
+#include "options/zz_options.h"
+
+#include "llvm-c/Core.h"
+#include "llvm-c/Orc.h"
+#include "llvm-c/Target.h"
+#include "llvm-c/TargetMachine.h"
+
+/**
+ * LLVM objects shared by the compilations of a process.
+ *
+ * <p>
+ * The target is initialized and the target machine is created once, for the optimization level and the target options.<br>
+ * The target is the host by default, see <tt>--target</tt>, <tt>--cpu</tt>, <tt>--features</tt>, <tt>--reloc</tt> and <tt>--code-model</tt>.<br>
+ * Each compilation gets its own module, created in the context of the session and disposed by the compilation.
+ * </p>
+ *
+ * <p>
+ * With <tt>--run</tt>, the context belongs to an ORC thread safe context so that the modules can be given to the JIT.
+ * </p>
+ *
+ * <p>
+ * A session must be used by a single thread at a time.<br>
+ * Sessions must be created by a single thread at a time, because the registration of the targets is not thread safe.
+ * </p>
+ */
+struct zz_code_generator_session {
+	/* Owns <tt>llvm_context</tt> with <tt>--run</tt>, null otherwise. */
+	LLVMOrcThreadSafeContextRef llvm_thread_safe_context;
+	LLVMContextRef llvm_context;
+	LLVMBuilderRef llvm_builder;
+	LLVMTargetRef llvm_target;
+	LLVMTargetMachineRef llvm_target_machine;
+	LLVMTargetDataRef llvm_target_data;
+	rt_char8 *llvm_triple;
+	rt_char8 *llvm_cpu_name;
+	rt_char8 *llvm_cpu_features;
+	/* Of the objects, the JIT always uses <tt>LLVMRelocPIC</tt>. */
+	LLVMRelocMode llvm_reloc_mode;
+	LLVMCodeModel llvm_code_model;
+	enum zz_optimization_level optimization_level;
+};
+
+/**
+ * Uses the optimization level, the target options and <tt>--run</tt> of <tt>options</tt>.<br>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if the target of <tt>--target</tt> is unknown.
+ */
+rt_s zz_code_generator_session_create(struct zz_code_generator_session *session, struct zz_options *options, struct zz_diagnostics *diagnostics);
+
+/**
+ * Whether a session created with <tt>options</tt> would be the same as <tt>session</tt>, so that it can be reused.<br>
+ * The target options are compared once resolved, so that for instance a <tt>--target</tt> matching the host one does not matter.
+ */
+rt_s zz_code_generator_session_matches(struct zz_code_generator_session *session, struct zz_options *options, rt_b *matches);
+
+/**
+ * Create a new target machine like the one of the session, for an owner like the JIT.
+ *
+ * @param llvm_reloc_mode The one of the session for objects, <tt>LLVMRelocPIC</tt> for the JIT which can load the code anywhere in the address space.
+ */
+rt_s zz_code_generator_session_create_target_machine(struct zz_code_generator_session *session, LLVMRelocMode llvm_reloc_mode, LLVMTargetMachineRef *llvm_target_machine);
+
+/**
+ * Create an empty module with the triple and the data layout of the session target.
+ *
+ * @param llvm_context The context of the session, or the one of a code generation unit built by another thread.
+ */
+void zz_code_generator_session_create_module(struct zz_code_generator_session *session, LLVMContextRef llvm_context, const rt_char8 *name, LLVMModuleRef *llvm_module);
+
+rt_s zz_code_generator_session_free(struct zz_code_generator_session *session);
+
+#endif /* ZZ_CODE_GENERATOR_SESSION_H */
@@ -7,6 +7,32 @@
 
 #include "llvm-c/Core.h"
 
-rt_s zz_expression_generator_generate(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value);
+/**
+ * @return The LLVM type of <tt>value_type</tt>, a vector type for the vectors.
+ */
+LLVMTypeRef zz_expression_generator_get_type(enum zz_value_type value_type, LLVMContextRef llvm_context);
+
+/**
+ * Convert a scalar to <tt>llvm_type</tt>, by sign extension then by copy into all the lanes if it is a vector type.<br>
+ * <tt>llvm_value</tt> is returned as is if it already has the type.
+ */
+LLVMValueRef zz_expression_generator_convert(LLVMValueRef llvm_value, LLVMTypeRef llvm_type, LLVMBuilderRef llvm_builder);
+
+/**
+ * Generate the statements and the result of <tt>function</tt>, in a single pass over its nodes, from the current position of <tt>llvm_builder</tt>.<br>
+ * The nodes must have been typed by the parser, the vectors are lowered to LLVM vector values and instructions.
+ *
+ * <p>
+ * The variables are allocated on the stack at the current position, which must be in the entry block.<br>
+ * The loops add blocks to the function, <tt>llvm_builder</tt> is left at the end of the last one.
+ * </p>
+ *
+ * <p>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if a called function is not in <tt>llvm_functions</tt>.
+ * </p>
+ *
+ * @param llvm_functions Declarations of the functions of the module, indexed by the symbol id of their name.
+ */
+rt_s zz_expression_generator_generate(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value);
 
 #endif /* ZZ_EXPRESSION_GENERATOR_H */
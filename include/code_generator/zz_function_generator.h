@@ -4,9 +4,29 @@
 #include <rpr.h>
 
 #include "ast/zz_ast.h"
+#include "symbol/zz_symbol_table.h"
 
 #include "llvm-c/Core.h"
 
-rt_s zz_function_generator_generate(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder);
+/**
+ * Add the declarations of all the functions of <tt>ast</tt> to <tt>llvm_module</tt>, so that they can call each other whatever their order.
+ *
+ * <p>
+ * The called functions that are not in <tt>ast</tt> are declared too, they must be defined by another file of the program.<br>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if two functions have the same name.
+ * </p>
+ *
+ * @param llvm_functions Receives the declaration of each function, indexed by the symbol id of its name. Null for the other symbols.
+ */
+rt_s zz_function_generator_declare(struct zz_ast *ast, struct zz_symbol_table *symbol_table, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMValueRef *llvm_functions);
+
+/**
+ * Generate the body of <tt>function</tt>, declared by <tt>zz_function_generator_declare</tt>.
+ *
+ * <p>
+ * A function with CPU levels gets a variant for each of them and a baseline one, the declared function dispatches its calls, see <tt>zz_multiversion_generator_dispatch</tt>.
+ * </p>
+ */
+rt_s zz_function_generator_generate(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder);
 
 #endif /* ZZ_FUNCTION_GENERATOR_H */
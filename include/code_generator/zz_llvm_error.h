@@ -0,0 +1,20 @@
+#ifndef ZZ_LLVM_ERROR_H
+#define ZZ_LLVM_ERROR_H
+
+#include <rpr.h>
+
+#include "diagnostics/zz_diagnostics.h"
+
+#include "llvm-c/Error.h"
+
+/**
+ * Add the message returned by an LLVM function, if any, to <tt>diagnostics</tt> then dispose it.
+ */
+rt_s zz_llvm_error_add_message(struct zz_diagnostics *diagnostics, rt_char8 *llvm_message);
+
+/**
+ * Add the message of <tt>llvm_error</tt> to <tt>diagnostics</tt>, consuming the error.
+ */
+rt_s zz_llvm_error_add(struct zz_diagnostics *diagnostics, LLVMErrorRef llvm_error);
+
+#endif /* ZZ_LLVM_ERROR_H */
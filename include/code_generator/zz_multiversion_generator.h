@@ -0,0 +1,41 @@
+#ifndef ZZ_MULTIVERSION_GENERATOR_H
+#define ZZ_MULTIVERSION_GENERATOR_H
+
+#include <rpr.h>
+
+#include "ast/zz_cpu_levels.h"
+
+#include "llvm-c/Core.h"
+
+/**
+ * Whether the functions of <tt>llvm_module</tt> can have variants, only x86-64 targets have them.<br>
+ * For the other targets, the levels of the functions are ignored.
+ */
+rt_b zz_multiversion_generator_is_supported(LLVMModuleRef llvm_module);
+
+/**
+ * Add an internal function of the type of <tt>llvm_function</tt>, named after it, whose body is then generated for <tt>cpu_level</tt>.
+ *
+ * @param cpu_level <tt>ZZ_CPU_LEVELS_COUNT</tt> for the baseline variant, which runs on all x86-64 processors.
+ */
+rt_s zz_multiversion_generator_add_variant(LLVMValueRef llvm_function, enum zz_cpu_level cpu_level, LLVMContextRef llvm_context, struct rt_heap *heap, LLVMValueRef *llvm_variant);
+
+/**
+ * Generate the body of <tt>llvm_function</tt>, which calls the best of its variants for the processor.
+ *
+ * <p>
+ * The function calls the variant through an internal pointer that initially points to a resolver.<br>
+ * On the first call, the resolver reads the levels supported by the processor with <tt>cpuid</tt>, then sets the pointer to the variant of the highest one and calls it.<br>
+ * Afterwards, a call only costs a load and an indirect jump.
+ * </p>
+ *
+ * <p>
+ * Unlike an ELF <tt>ifunc</tt> or a constructor, this works the same way for COFF objects, shared libraries and <tt>--run</tt>.<br>
+ * Concurrent first calls may all run the resolver, which sets the pointer to the same variant.
+ * </p>
+ *
+ * @param llvm_variants The <tt>ZZ_CPU_LEVELS_COUNT + 1</tt> variants indexed by level, null for the levels without a variant. The baseline variant is the last one and is mandatory.
+ */
+rt_s zz_multiversion_generator_dispatch(LLVMValueRef llvm_function, LLVMValueRef *llvm_variants, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, struct rt_heap *heap);
+
+#endif /* ZZ_MULTIVERSION_GENERATOR_H */
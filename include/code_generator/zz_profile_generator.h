@@ -0,0 +1,34 @@
+#ifndef ZZ_PROFILE_GENERATOR_H
+#define ZZ_PROFILE_GENERATOR_H
+
+#include <rpr.h>
+
+#include "profile/zz_profile.h"
+
+#include "llvm-c/Core.h"
+
+/**
+ * Add the counters of <tt>--profile-generate</tt> to the functions defined in <tt>llvm_module</tt>, before any pass.
+ *
+ * <p>
+ * A function counts its calls, and each of its conditional branches its executions and the times it went to its first successor.<br>
+ * A constructor of the module registers with <tt>atexit</tt> a function that appends the records of the module to <tt>profile_file_path</tt>.
+ * So the profile is only written by programs that return from <tt>main</tt> or call <tt>exit</tt>, and concurrent runs may mix their records.
+ * </p>
+ *
+ * @param profile_file_path Relative to the current directory of the program.
+ */
+rt_s zz_profile_generator_instrument(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, const rt_char *profile_file_path, struct rt_heap *heap);
+
+/**
+ * Attach the counts of <tt>profile</tt> to the functions defined in <tt>llvm_module</tt>, which must be generated like the instrumented ones.
+ *
+ * <p>
+ * Each function receives its entry count, and each conditional branch its weights, so that the passes know the hot and the cold code.<br>
+ * The functions that are not in the profile, or whose branches changed, are left alone.<br>
+ * The summary of the profile is added to the module flags, the passes ignore the counts without it.
+ * </p>
+ */
+void zz_profile_generator_annotate(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, struct zz_profile *profile);
+
+#endif /* ZZ_PROFILE_GENERATOR_H */
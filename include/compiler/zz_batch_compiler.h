@@ -0,0 +1,28 @@
+#ifndef ZZ_BATCH_COMPILER_H
+#define ZZ_BATCH_COMPILER_H
+
+#include <rpr.h>
+
+#include "options/zz_options.h"
+#include "stats/zz_stats.h"
+
+/**
+ * Compile all the input files of <tt>options</tt> in parallel.
+ *
+ * <p>
+ * Each worker has its own LLVM session and its own arena, reset between files.<br>
+ * The error messages of each file are written once the files before it are done, so they are in the order of the inputs.<br>
+ * The files are compiled one at a time with <tt>--trace</tt>, whose output is not buffered.
+ * </p>
+ *
+ * <p>
+ * Fails if a file cannot be compiled, after trying to compile all the others.
+ * </p>
+ *
+ * @param stats Receives the sum of the statistics of the workers, can be null.
+ * @param exit_code Receives the value returned by <tt>main</tt> with <tt>--run</tt>, zero otherwise.
+ * @param heap Must be thread safe.
+ */
+rt_s zz_batch_compiler_compile(struct zz_options *options, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap);
+
+#endif /* ZZ_BATCH_COMPILER_H */
@@ -0,0 +1,28 @@
+#ifndef ZZ_COMPILER_H
+#define ZZ_COMPILER_H
+
+#include <rpr.h>
+
+#include "cache/zz_object_cache.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "options/zz_options.h"
+#include "profile/zz_profile.h"
+#include "stats/zz_stats.h"
+
+/**
+ * Compile <tt>input_file_path</tt> into the artifacts of <tt>--emit</tt>, named after it in the current directory by default, or run it with <tt>--run</tt>.
+ *
+ * <p>
+ * All the data of the compilation come from <tt>heap</tt>.<br>
+ * Error messages are added to <tt>diagnostics</tt>, the statistics are added to <tt>stats</tt>.
+ * </p>
+ *
+ * @param object_cache Skips the compilation if the object file is in the cache, can be null.
+ * @param profile Profile of <tt>--profile-use</tt>, can be null.
+ * @param stats Can be null.
+ * @param exit_code Receives the value returned by <tt>main</tt> with <tt>--run</tt>, can be null otherwise.
+ */
+rt_s zz_compiler_compile(struct zz_code_generator_session *session, struct zz_object_cache *object_cache, struct zz_profile *profile, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap);
+
+#endif /* ZZ_COMPILER_H */
@@ -0,0 +1,21 @@
+#ifndef ZZ_LINKER_H
+#define ZZ_LINKER_H
+
+#include <rpr.h>
+
+#include "options/zz_options.h"
+#include "stats/zz_stats.h"
+
+/**
+ * Link the bitcode files written with <tt>--lto</tt> into a single program, then optimize it as a whole and write its artifacts.
+ *
+ * <p>
+ * The artifacts are named after the first input file, unless <tt>-o</tt> is used.<br>
+ * The error messages are written on the error output, prefixed by the input file path when they concern a single file.
+ * </p>
+ *
+ * @param stats Can be null.
+ */
+rt_s zz_linker_link(struct zz_options *options, struct zz_stats *stats, struct rt_heap *heap);
+
+#endif /* ZZ_LINKER_H */
@@ -0,0 +1,44 @@
+#ifndef ZZ_DIAGNOSTICS_H
+#define ZZ_DIAGNOSTICS_H
+
+#include <rpr.h>
+
+/**
+ * Error messages of a compilation, kept until they are written.
+ *
+ * <p>
+ * Compilations running in parallel write their messages here rather than on the console, so that they can be written in the order of the inputs.
+ * </p>
+ */
+struct zz_diagnostics {
+	rt_char *buffer;
+	rt_un size;
+	rt_un capacity;
+	/* Prefix of all the messages, like the input file path, can be null. */
+	const rt_char *prefix;
+	struct rt_heap *heap;
+};
+
+/**
+ * @param heap Must outlive the compilation, it is not the heap of the compilation.
+ */
+void zz_diagnostics_create(struct zz_diagnostics *diagnostics, const rt_char *prefix, struct rt_heap *heap);
+
+/**
+ * Add a line made of <tt>message</tt> followed by the description of the last error, like <tt>rt_error_message_write_last</tt>.
+ */
+rt_s zz_diagnostics_add_last_error(struct zz_diagnostics *diagnostics, const rt_char *message);
+
+/**
+ * Add a line with a message from LLVM.
+ */
+rt_s zz_diagnostics_add_message8(struct zz_diagnostics *diagnostics, const rt_char8 *message);
+
+/**
+ * Write the messages on the error output and empty the diagnostics.
+ */
+rt_s zz_diagnostics_write(struct zz_diagnostics *diagnostics);
+
+rt_s zz_diagnostics_free(struct zz_diagnostics *diagnostics);
+
+#endif /* ZZ_DIAGNOSTICS_H */
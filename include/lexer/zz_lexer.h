@@ -3,33 +3,22 @@
 
 #include <rpr.h>
 
-enum zz_token_type {
-	ZZ_TOKEN_TYPE_END_OF_FILE,
-	ZZ_TOKEN_TYPE_IDENTIFIER,
-	ZZ_TOKEN_TYPE_FUNCTION,
-	ZZ_TOKEN_TYPE_NUMBER,
-	ZZ_TOKEN_TYPE_PLUS,
-	ZZ_TOKEN_TYPE_MINUS,
-	ZZ_TOKEN_TYPE_ASTERISK,
-	ZZ_TOKEN_TYPE_SLASH,
-	ZZ_TOKEN_TYPE_PERCENT,
-	ZZ_TOKEN_TYPE_OPEN_BRACE,
-	ZZ_TOKEN_TYPE_CLOSE_BRACE,
-	ZZ_TOKEN_TYPE_OPEN_PARENTHESIS,
-	ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS
-};
+#include "lexer/zz_token_buffer.h"
+#include "symbol/zz_symbol_table.h"
 
-struct zz_token {
-	enum zz_token_type type;
-	rt_char *str;
-	rt_un str_size;
-};
+/**
+ * Tokenize the whole <tt>input</tt>, replacing the content of <tt>token_buffer</tt>.
+ *
+ * <p>
+ * The input is UTF-8, must be terminated by a zero and must be smaller than 4 GiB.<br>
+ * Identifiers are interned into <tt>symbol_table</tt>.
+ * </p>
+ */
+rt_s zz_lexer_tokenize(rt_char8 *input, rt_un input_size, struct zz_token_buffer *token_buffer, struct zz_symbol_table *symbol_table);
 
-struct zz_lexer {
-	rt_char *input;
-	struct zz_token current_token;
-};
-
-rt_s zz_lexer_read_next_token(struct zz_lexer *lexer);
+/**
+ * Write the tokens, one per line, used by <tt>--trace=tokens</tt>.
+ */
+rt_s zz_lexer_write_tokens(rt_char8 *input, struct zz_token_buffer *token_buffer, struct rt_heap *heap);
 
 #endif /* ZZ_LEXER_H */
@@ -0,0 +1,75 @@
+#ifndef ZZ_TOKEN_BUFFER_H
+#define ZZ_TOKEN_BUFFER_H
+
+#include <rpr.h>
+
+enum zz_token_type {
+	ZZ_TOKEN_TYPE_END_OF_FILE,
+	ZZ_TOKEN_TYPE_IDENTIFIER,
+	ZZ_TOKEN_TYPE_FUNCTION,
+	ZZ_TOKEN_TYPE_VAR,
+	ZZ_TOKEN_TYPE_FOR,
+	ZZ_TOKEN_TYPE_IN,
+	ZZ_TOKEN_TYPE_UNROLL,
+	ZZ_TOKEN_TYPE_VECTORIZE,
+	ZZ_TOKEN_TYPE_INTERLEAVE,
+	ZZ_TOKEN_TYPE_MULTIVERSION,
+	ZZ_TOKEN_TYPE_SHUFFLE,
+	ZZ_TOKEN_TYPE_I32,
+	ZZ_TOKEN_TYPE_I64,
+	ZZ_TOKEN_TYPE_I32X4,
+	ZZ_TOKEN_TYPE_I32X8,
+	ZZ_TOKEN_TYPE_I64X4,
+	ZZ_TOKEN_TYPE_NUMBER,
+	ZZ_TOKEN_TYPE_PLUS,
+	ZZ_TOKEN_TYPE_MINUS,
+	ZZ_TOKEN_TYPE_ASTERISK,
+	ZZ_TOKEN_TYPE_SLASH,
+	ZZ_TOKEN_TYPE_PERCENT,
+	ZZ_TOKEN_TYPE_OPEN_BRACE,
+	ZZ_TOKEN_TYPE_CLOSE_BRACE,
+	ZZ_TOKEN_TYPE_OPEN_PARENTHESIS,
+	ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS,
+	ZZ_TOKEN_TYPE_OPEN_BRACKET,
+	ZZ_TOKEN_TYPE_CLOSE_BRACKET,
+	ZZ_TOKEN_TYPE_COMMA,
+	ZZ_TOKEN_TYPE_COLON,
+	ZZ_TOKEN_TYPE_SEMICOLON,
+	ZZ_TOKEN_TYPE_EQUALS,
+	ZZ_TOKEN_TYPE_DOT,
+	ZZ_TOKEN_TYPE_DOT_DOT
+};
+
+/**
+ * Tokens of a whole input, as a structure of arrays.
+ *
+ * <p>
+ * Token <tt>i</tt> has type <tt>types[i]</tt> (an <tt>enum zz_token_type</tt>) and is made of the <tt>sizes[i]</tt> bytes at <tt>offsets[i]</tt> in the input.<br>
+ * For identifiers, <tt>symbols[i]</tt> is the symbol id of the token. It is undefined for the other tokens.<br>
+ * The last token is always <tt>ZZ_TOKEN_TYPE_END_OF_FILE</tt>, so the parser can look ahead up to it without bound checks.
+ * </p>
+ *
+ * <p>
+ * The arrays are kept between two tokenizations so that a buffer can be reused across compilations without allocations.
+ * </p>
+ */
+struct zz_token_buffer {
+	rt_un8 *types;
+	rt_un32 *offsets;
+	rt_un32 *sizes;
+	rt_un32 *symbols;
+	rt_un size;
+	rt_un capacity;
+	struct rt_heap *heap;
+};
+
+void zz_token_buffer_create(struct zz_token_buffer *token_buffer, struct rt_heap *heap);
+
+/**
+ * Make sure that the buffer can hold <tt>capacity</tt> tokens.
+ */
+rt_s zz_token_buffer_reserve(struct zz_token_buffer *token_buffer, rt_un capacity);
+
+rt_s zz_token_buffer_free(struct zz_token_buffer *token_buffer);
+
+#endif /* ZZ_TOKEN_BUFFER_H */
@@ -0,0 +1,63 @@
+#ifndef ZZ_ARENA_H
+#define ZZ_ARENA_H
+
+#include <rpr.h>
+
+struct zz_arena_block;
+struct zz_arena_large_block;
+
+/**
+ * Bump allocator implementing the <tt>rt_heap</tt> interface, for the data of a compilation.
+ *
+ * <p>
+ * Areas are carved sequentially from fixed size blocks obtained from a parent heap.<br>
+ * Freeing an area is a no-op, except for the last allocated one which is given back.<br>
+ * The last allocated area is also resized in place by <tt>realloc</tt> when the block has room for it.
+ * </p>
+ *
+ * <p>
+ * Areas larger than a quarter of a block, like the tokens and nodes arrays of big sources, are forwarded to the parent heap.<br>
+ * They can then be resized without copies and they do not waste blocks.
+ * </p>
+ *
+ * <p>
+ * <tt>zz_arena_reset</tt> discards all the areas at once but keeps the blocks for the next compilation.<br>
+ * The blocks are given back to the parent heap by <tt>zz_arena_free</tt> or the <tt>close</tt> function of the heap.
+ * </p>
+ */
+struct zz_arena {
+	struct rt_heap heap;
+	struct rt_heap *parent;
+	/* All the blocks, in usage order. */
+	struct zz_arena_block *first_block;
+	/* Null before the first allocation after a reset. */
+	struct zz_arena_block *current_block;
+	rt_un8 *position;
+	rt_un8 *end;
+	/* Can be given back or resized in place. */
+	rt_un8 *last_area;
+	struct zz_arena_large_block *large_blocks;
+	rt_un block_size;
+	rt_un large_area_size;
+};
+
+/**
+ * @param block_size Size of the blocks requested from <tt>parent</tt>.
+ */
+void zz_arena_create(struct zz_arena *arena, struct rt_heap *parent, rt_un block_size);
+
+/**
+ * Discard all the areas.
+ *
+ * <p>
+ * Constant time except for the large areas, which are given back to the parent heap.
+ * </p>
+ */
+rt_s zz_arena_reset(struct zz_arena *arena);
+
+/**
+ * Give back all the blocks to the parent heap.
+ */
+rt_s zz_arena_free(struct zz_arena *arena);
+
+#endif /* ZZ_ARENA_H */
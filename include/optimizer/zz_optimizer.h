@@ -0,0 +1,25 @@
+#ifndef ZZ_OPTIMIZER_H
+#define ZZ_OPTIMIZER_H
+
+#include <rpr.h>
+
+#include "ast/zz_ast.h"
+
+/**
+ * Simplify the functions of <tt>ast</tt> before code generation, so that less IR reaches LLVM.
+ *
+ * <p>
+ * Values are 32 bits integers wrapping on overflow, like the generated <tt>add</tt>, <tt>sub</tt> and <tt>mul</tt> instructions.<br>
+ * Constant sub-expressions are folded, except divisions and remainders by zero or of the minimum value by -1, which are left to LLVM.<br>
+ * Identities like <tt>x + 0</tt>, <tt>x * 1</tt> or <tt>--x</tt> are removed, as well as <tt>x * 0</tt> and <tt>x % 1</tt> if <tt>x</tt> does not call a function, constants of additions and multiplications chains are gathered,
+ * and multiplications, divisions and remainders by powers of two are replaced by shifts.<br>
+ * Only the i32 operations are simplified, the i64 and vector ones are left to LLVM.
+ * </p>
+ *
+ * <p>
+ * The nodes and literals are then compacted in place, keeping the post-order.
+ * </p>
+ */
+rt_s zz_optimizer_optimize(struct zz_ast *ast);
+
+#endif /* ZZ_OPTIMIZER_H */
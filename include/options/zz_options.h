@@ -0,0 +1,151 @@
+#ifndef ZZ_OPTIONS_H
+#define ZZ_OPTIONS_H
+
+#include <rpr.h>
+
+/**
+ * Flags of the <tt>--trace</tt> option, they can be combined.
+ */
+enum zz_trace {
+	ZZ_TRACE_TOKENS = 1,
+	ZZ_TRACE_IR = 2
+};
+
+/**
+ * Artifacts of the <tt>--emit</tt> option, they can be combined.
+ */
+enum zz_emit {
+	ZZ_EMIT_OBJ = 1,
+	ZZ_EMIT_ASM = 2,
+	ZZ_EMIT_LLVM_IR = 4,
+	ZZ_EMIT_LLVM_BC = 8
+};
+
+/**
+ * Selected by <tt>-O0</tt> to <tt>-O3</tt> and <tt>-Os</tt>, drives both the IR passes and the backend.
+ */
+enum zz_optimization_level {
+	ZZ_OPTIMIZATION_LEVEL_O0,
+	ZZ_OPTIMIZATION_LEVEL_O1,
+	ZZ_OPTIMIZATION_LEVEL_O2,
+	ZZ_OPTIMIZATION_LEVEL_O3,
+	ZZ_OPTIMIZATION_LEVEL_OS
+};
+
+/**
+ * Link-time optimization mode of <tt>--lto</tt> and <tt>--lto-link</tt>.
+ */
+enum zz_lto {
+	ZZ_LTO_NONE,
+	/* The whole program is merged and optimized as a single module. */
+	ZZ_LTO_FULL,
+	/* The merged program is split in partitions optimized in parallel, that import the small functions of the others. */
+	ZZ_LTO_THIN
+};
+
+/**
+ * Relocation model of <tt>--reloc</tt>.
+ */
+enum zz_reloc {
+	/* The one of the target. */
+	ZZ_RELOC_DEFAULT,
+	/* Absolute addresses, for the executables loaded at a fixed address. */
+	ZZ_RELOC_STATIC,
+	/* Position independent code, for the shared libraries and the PIE executables. */
+	ZZ_RELOC_PIC
+};
+
+/**
+ * Code model of <tt>--code-model</tt>, which bounds the size and the addresses of the code and the data.
+ */
+enum zz_code_model {
+	ZZ_CODE_MODEL_DEFAULT,
+	ZZ_CODE_MODEL_TINY,
+	ZZ_CODE_MODEL_SMALL,
+	ZZ_CODE_MODEL_KERNEL,
+	ZZ_CODE_MODEL_MEDIUM,
+	ZZ_CODE_MODEL_LARGE
+};
+
+#define ZZ_OPTIONS_DEFAULT_CACHE_SIZE 1024
+
+/* In the current directory of the instrumented program. */
+#define ZZ_OPTIONS_DEFAULT_PROFILE_FILE_PATH _R("default.stcprof")
+
+struct zz_options {
+	/* From the command line and from the <tt>@file</tt> lists, in order. */
+	const rt_char **input_file_paths;
+	rt_un input_files_count;
+	rt_un input_files_capacity;
+	/* Decoded content of the file lists, that the paths point into. */
+	rt_char **file_lists;
+	rt_un file_lists_count;
+	rt_un file_lists_capacity;
+	rt_b help;
+	rt_b stats;
+	rt_un trace;
+	const rt_char *time_trace_file_path;
+	enum zz_optimization_level optimization_level;
+	/* New pass manager pipeline replacing the one of the optimization level, null if not provided. */
+	const rt_char *passes;
+	/* Target triple of <tt>--target</tt>, null for the host. */
+	const rt_char *target;
+	/* Processor of <tt>--cpu</tt>, null for the one of the host, or a generic one with <tt>--target</tt>. */
+	const rt_char *cpu;
+	/* Features of <tt>--features</tt> like <tt>+avx2,-fma</tt>, applied after the ones of the processor, null if not provided. */
+	const rt_char *features;
+	enum zz_reloc reloc;
+	enum zz_code_model code_model;
+	/* JIT-compile the single input file and run its main function, instead of writing an object file. */
+	rt_b run;
+	/* Flags of <tt>--emit</tt>, only the object file by default. */
+	rt_un emit;
+	/* Path of <tt>-o</tt>, null if not provided or with <tt>-o -</tt>. */
+	const rt_char *output_file_path;
+	/* <tt>-o -</tt>, the single artifact is written to the standard output. */
+	rt_b standard_output;
+	/* With <tt>--lto</tt>, bitcode prepared for the link is written instead of the artifacts, with <tt>--lto-link</tt>, the mode of the link. */
+	enum zz_lto lto;
+	/* The input files are bitcode files written with <tt>--lto</tt>, optimized together into the artifacts. */
+	rt_b lto_link;
+	/* Number of partitions of each module, optimized and emitted in parallel, one by default. */
+	rt_un codegen_units;
+	/* Profile file written by the program of <tt>--profile-generate</tt>, null without it. */
+	const rt_char *profile_generate_file_path;
+	/* Profile file of <tt>--profile-use</tt>, null if not provided. */
+	const rt_char *profile_use_file_path;
+	/* Number of parallel compilations, zero to use all the processors. */
+	rt_un jobs;
+	/* Object cache directory of <tt>--cache</tt>, null if not provided. */
+	const rt_char *cache_directory_path;
+	/* In bytes, from <tt>--cache-size</tt> in mebibytes. */
+	rt_un cache_max_size;
+	/* Socket of <tt>--server</tt>, null if not provided. */
+	const rt_char *server_socket_path;
+	/* Socket of <tt>--client</tt>, null if not provided. */
+	const rt_char *client_socket_path;
+	struct rt_heap *heap;
+};
+
+/**
+ * Fill <tt>options</tt> from the command line arguments.
+ *
+ * <p>
+ * An argument like <tt>@file</tt> adds the paths listed in <tt>file</tt>, one per line, to the input files.<br>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if an argument is unknown or if there is no input file, except with <tt>--server</tt> which takes none.<br>
+ * <tt>--run</tt> and <tt>-o</tt> take a single input file, <tt>-o -</tt> a single artifact.<br>
+ * <tt>--run</tt> and <tt>-o -</tt> take a single code generation unit.<br>
+ * <tt>--lto</tt> only writes bitcode, <tt>--lto-link</tt> takes several input files with <tt>-o</tt> but no <tt>--codegen-units</tt>.<br>
+ * <tt>--profile-generate</tt> and <tt>--profile-use</tt> exclude each other, <tt>--lto-link</tt>, and <tt>--run</tt> for the former.<br>
+ * <tt>--run</tt> executes position independent code on the host, it excludes <tt>--target</tt> and <tt>--reloc</tt>.
+ * </p>
+ *
+ * <p>
+ * <tt>zz_options_free</tt> must be called even if the parsing fails.
+ * </p>
+ */
+rt_s zz_options_parse(rt_un argc, const rt_char *argv[], struct rt_heap *heap, struct zz_options *options);
+
+rt_s zz_options_free(struct zz_options *options);
+
+#endif /* ZZ_OPTIONS_H */
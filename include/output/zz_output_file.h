@@ -0,0 +1,32 @@
+#ifndef ZZ_OUTPUT_FILE_H
+#define ZZ_OUTPUT_FILE_H
+
+#include <rpr.h>
+
+#include "options/zz_options.h"
+
+/**
+ * Path of the <tt>emit</tt> artifact of <tt>input_file_path</tt>, which ends with <tt>.stc</tt>, or with <tt>.bc</tt> with <tt>--lto-link</tt>.
+ *
+ * <p>
+ * The path of <tt>-o</tt> is used as is if a single artifact is emitted.<br>
+ * Otherwise, the extension of the artifact replaces the one of the <tt>-o</tt> path, or of the input file name in the current directory.<br>
+ * The artifacts of the code generation units after the first one have their index before the extension, like <tt>name.1.o</tt>.
+ * </p>
+ *
+ * @param partition Index of the code generation unit.
+ */
+rt_s zz_output_file_get_path(const rt_char *input_file_path, struct zz_options *options, enum zz_emit emit, rt_un partition, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size);
+
+/**
+ * Write a whole artifact with a single write.
+ *
+ * <p>
+ * An existing file is replaced rather than overwritten, as it may be a hard link to an object cache entry.
+ * </p>
+ *
+ * @param file_path The standard output is used if null.
+ */
+rt_s zz_output_file_write(const rt_char *file_path, const rt_char8 *data, rt_un data_size);
+
+#endif /* ZZ_OUTPUT_FILE_H */
@@ -6,6 +6,23 @@
 #include "ast/zz_ast.h"
 #include "lexer/zz_lexer.h"
 
-rt_s zz_parser_parse(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **root);
+/**
+ * Parse the functions of the input then set the type of each node.
+ *
+ * <p>
+ * The body of a function is made of declarations, assignments and loops, then of the expression it returns.<br>
+ * A variable is visible from its declaration to the end of its block, the name of a visible variable cannot be reused.<br>
+ * The return type of a function can be followed by the instruction sets it has variants for, like <tt>multiversion(sse4.2, avx2, avx512f)</tt>.
+ * </p>
+ *
+ * <p>
+ * A scalar operand of a binary operator is converted to the type of the other operand, see <tt>zz_value_type_is_convertible</tt>.<br>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if the types do not match, or if a constant array index is out of the array.
+ * </p>
+ *
+ * @param input The input that has been tokenized into <tt>token_buffer</tt>.
+ * @param ast Receives the functions of the input. Its heap is also used for the working stack of the parser.
+ */
+rt_s zz_parser_parse(rt_char8 *input, struct zz_token_buffer *token_buffer, struct zz_ast *ast);
 
 #endif /* ZZ_PARSER_H */
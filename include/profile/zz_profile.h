@@ -0,0 +1,86 @@
+#ifndef ZZ_PROFILE_H
+#define ZZ_PROFILE_H
+
+#include <rpr.h>
+
+#include "symbol/zz_symbol_table.h"
+
+/* Cutoffs of the detailed summary, like LLVM. */
+#define ZZ_PROFILE_CUTOFFS_COUNT 16
+
+/**
+ * Counters of a function, <tt>counters_count</tt> from <tt>first_counter</tt> in the counters of the profile.
+ *
+ * <p>
+ * The first counter is the number of calls of the function.<br>
+ * Then each conditional branch of the function has two counters: its executions, then the times it went to its first successor.
+ * </p>
+ */
+struct zz_profile_function {
+	rt_un first_counter;
+	rt_un counters_count;
+};
+
+/**
+ * The hottest counts that sum to <tt>cutoff</tt> millionths of the total count are <tt>counts_count</tt> counts of at least <tt>min_count</tt>.
+ */
+struct zz_profile_cutoff {
+	rt_un32 cutoff;
+	rt_un64 min_count;
+	rt_un counts_count;
+};
+
+/**
+ * Profile written by a program built with <tt>--profile-generate</tt>.
+ *
+ * <p>
+ * Each module of the program appends a record per function when the program exits:<br>
+ * the 32 bits size of the name, the name, the 32 bits number of counters then the 64 bits counters, all in the byte order of the program.<br>
+ * The records of a same function, from several runs or several modules, are summed.
+ * Those whose number of counters differs from the first one come from another version of the function and are ignored.
+ * </p>
+ *
+ * <p>
+ * The summary is computed on the function entries and on both edges of the branches, like the LLVM one on the blocks counts.
+ * </p>
+ */
+struct zz_profile {
+	/* Names of the functions, whose symbol ids index the functions. */
+	struct zz_symbol_table symbol_table;
+	struct zz_profile_function *functions;
+	rt_un functions_capacity;
+	rt_un64 *counters;
+	rt_un counters_count;
+	rt_un counters_capacity;
+	rt_un64 total_count;
+	rt_un64 max_count;
+	/* Maximum of the counts that are not function entries. */
+	rt_un64 max_internal_count;
+	rt_un64 max_function_count;
+	rt_un counts_count;
+	struct zz_profile_cutoff cutoffs[ZZ_PROFILE_CUTOFFS_COUNT];
+	struct rt_heap *heap;
+};
+
+/**
+ * Read the profile file, then compute its summary.
+ *
+ * <p>
+ * Fails with <tt>RT_ERROR_BAD_ARGUMENTS</tt> if the file is truncated.<br>
+ * Once read, the profile can be shared by several threads.
+ * </p>
+ *
+ * <p>
+ * <tt>zz_profile_free</tt> must be called even if the reading fails.
+ * </p>
+ */
+rt_s zz_profile_read(struct zz_profile *profile, const rt_char *file_path, struct rt_heap *heap);
+
+/**
+ * @return The counters of the function named <tt>name</tt>, null if it is not in the profile.
+ */
+struct zz_profile_function *zz_profile_find(struct zz_profile *profile, const rt_char8 *name, rt_un name_size);
+
+rt_s zz_profile_free(struct zz_profile *profile);
+
+#endif /* ZZ_PROFILE_H */
@@ -0,0 +1,17 @@
+#ifndef ZZ_COMPILE_CLIENT_H
+#define ZZ_COMPILE_CLIENT_H
+
+#include <rpr.h>
+
+/**
+ * Forward the command line to the server listening at <tt>socket_path</tt> and write its messages.
+ *
+ * <p>
+ * Fails if a file cannot be compiled.
+ * </p>
+ *
+ * @param forwarded Set to false, without failure, if no server is running. The files must then be compiled in process.
+ */
+rt_s zz_compile_client_compile(const rt_char *socket_path, rt_un argc, const rt_char *argv[], rt_b *forwarded, struct rt_heap *heap);
+
+#endif /* ZZ_COMPILE_CLIENT_H */
@@ -0,0 +1,44 @@
+#ifndef ZZ_COMPILE_PROTOCOL_H
+#define ZZ_COMPILE_PROTOCOL_H
+
+#include <rpr.h>
+
+/**
+ * Messages exchanged between <tt>stc --client</tt> and <tt>stc --server</tt>.
+ *
+ * <p>
+ * The client sends a request header followed by zero terminated strings: its current directory then its arguments, without <tt>--client</tt>.<br>
+ * The server answers with a response per input file, followed by its messages, then with a <tt>ZZ_COMPILE_RESPONSE_STATUS_DONE</tt> response.
+ * </p>
+ *
+ * <p>
+ * Both ends are the same executable on the same machine, so the strings are sent as <tt>rt_char</tt> without conversion.
+ * </p>
+ */
+
+/* Changes with the protocol and the size of rt_char. */
+#define ZZ_COMPILE_PROTOCOL_MAGIC (0x5A5A0100 | (rt_un32)sizeof(rt_char))
+
+/* Bigger requests are rejected. */
+#define ZZ_COMPILE_PROTOCOL_MAX_REQUEST_SIZE (16 * 1024 * 1024)
+
+struct zz_compile_request_header {
+	rt_un32 magic;
+	/* Size in bytes of the strings. */
+	rt_un32 size;
+	rt_un32 strings_count;
+};
+
+enum zz_compile_response_status {
+	ZZ_COMPILE_RESPONSE_STATUS_SUCCEEDED,
+	ZZ_COMPILE_RESPONSE_STATUS_FAILED,
+	ZZ_COMPILE_RESPONSE_STATUS_DONE
+};
+
+struct zz_compile_response_header {
+	rt_un32 status;
+	/* Size in bytes of the messages that follow. */
+	rt_un32 size;
+};
+
+#endif /* ZZ_COMPILE_PROTOCOL_H */
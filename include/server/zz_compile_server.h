@@ -0,0 +1,17 @@
+#ifndef ZZ_COMPILE_SERVER_H
+#define ZZ_COMPILE_SERVER_H
+
+#include <rpr.h>
+
+/**
+ * Serve the compilation requests of <tt>stc --client</tt> on a local socket, until an error occurs.
+ *
+ * <p>
+ * The LLVM sessions are created at the first request of each optimization level and target options, and kept for the next ones.<br>
+ * The requests are processed one at a time, in the current directory of the client.<br>
+ * An invalid or interrupted request is reported on the error output of the server, which goes on.
+ * </p>
+ */
+rt_s zz_compile_server_run(const rt_char *socket_path, struct rt_heap *heap);
+
+#endif /* ZZ_COMPILE_SERVER_H */
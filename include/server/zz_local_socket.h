@@ -0,0 +1,55 @@
+#ifndef ZZ_LOCAL_SOCKET_H
+#define ZZ_LOCAL_SOCKET_H
+
+#include <rpr.h>
+
+/**
+ * Stream socket bound to a file path (<tt>AF_UNIX</tt>), to talk with another process of the same machine.
+ *
+ * <p>
+ * Windows supports <tt>AF_UNIX</tt> since Windows 10 1803.
+ * </p>
+ */
+struct zz_local_socket {
+	/* SOCKET under Windows, file descriptor otherwise. */
+	rt_un handle;
+};
+
+/**
+ * Create a socket listening at <tt>socket_path</tt>.
+ *
+ * <p>
+ * A socket file left by a process that is no longer listening is replaced.<br>
+ * Fails if another process is listening at <tt>socket_path</tt>.
+ * </p>
+ */
+rt_s zz_local_socket_listen(struct zz_local_socket *local_socket, const rt_char *socket_path);
+
+/**
+ * Wait for the next client.
+ */
+rt_s zz_local_socket_accept(struct zz_local_socket *listening_socket, struct zz_local_socket *local_socket);
+
+/**
+ * Connect to the process listening at <tt>socket_path</tt>.
+ *
+ * @param connected Set to false, without failure, if no process is listening.
+ */
+rt_s zz_local_socket_connect(struct zz_local_socket *local_socket, const rt_char *socket_path, rt_b *connected);
+
+/**
+ * Send all the <tt>size</tt> bytes of <tt>data</tt>.
+ */
+rt_s zz_local_socket_send(struct zz_local_socket *local_socket, const void *data, rt_un size);
+
+/**
+ * Receive exactly <tt>size</tt> bytes, fails if the connection is closed before.
+ */
+rt_s zz_local_socket_receive(struct zz_local_socket *local_socket, void *data, rt_un size);
+
+/**
+ * Also removes the socket file of a listening socket.
+ */
+rt_s zz_local_socket_close(struct zz_local_socket *local_socket, const rt_char *socket_path);
+
+#endif /* ZZ_LOCAL_SOCKET_H */
@@ -0,0 +1,33 @@
+#ifndef ZZ_SOURCE_FILE_H
+#define ZZ_SOURCE_FILE_H
+
+#include <rpr.h>
+
+/**
+ * Content of a source file, as UTF-8 bytes followed by a zero.
+ *
+ * <p>
+ * The file is memory-mapped when the zero is guaranteed by the mapping: the remainder of the last page is zero filled.<br>
+ * When the file size is a multiple of the page size, the file is read in a heap buffer instead.
+ * </p>
+ *
+ * <p>
+ * The lexer and the AST point into <tt>data</tt>, it must be closed after the compilation.
+ * </p>
+ */
+struct zz_source_file {
+	rt_char8 *data;
+	rt_un size;
+	rt_b mapped;
+	void *heap_buffer;
+	struct rt_heap *heap;
+#ifdef RT_DEFINE_WINDOWS
+	void *mapping_handle;
+#endif
+};
+
+rt_s zz_source_file_open(struct zz_source_file *source_file, const rt_char *file_path, struct rt_heap *heap);
+
+rt_s zz_source_file_close(struct zz_source_file *source_file);
+
+#endif /* ZZ_SOURCE_FILE_H */
@@ -0,0 +1,24 @@
+#ifndef ZZ_COUNTING_HEAP_H
+#define ZZ_COUNTING_HEAP_H
+
+#include <rpr.h>
+
+/**
+ * Heap that forwards to a parent heap while counting the allocated bytes.
+ *
+ * <p>
+ * Each area is prefixed by a small header holding its size so that the live and peak bytes can be tracked.
+ * </p>
+ */
+struct zz_counting_heap {
+	struct rt_heap heap;
+	struct rt_heap *parent;
+	rt_un allocated_bytes;
+	rt_un allocations_count;
+	rt_un live_bytes;
+	rt_un peak_bytes;
+};
+
+void zz_counting_heap_create(struct zz_counting_heap *counting_heap, struct rt_heap *parent);
+
+#endif /* ZZ_COUNTING_HEAP_H */
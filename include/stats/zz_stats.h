@@ -0,0 +1,96 @@
+#ifndef ZZ_STATS_H
+#define ZZ_STATS_H
+
+#include <rpr.h>
+
+enum zz_stats_phase {
+	ZZ_STATS_PHASE_SETUP,
+	ZZ_STATS_PHASE_READ,
+	/* Parsing and merging of the bitcode files with --lto-link. */
+	ZZ_STATS_PHASE_LINK,
+	/* Hash of the source and object cache operations. */
+	ZZ_STATS_PHASE_CACHE,
+	ZZ_STATS_PHASE_LEX,
+	ZZ_STATS_PHASE_PARSE,
+	ZZ_STATS_PHASE_OPTIMIZE,
+	ZZ_STATS_PHASE_CODEGEN,
+	ZZ_STATS_PHASE_PASSES,
+	ZZ_STATS_PHASE_EMIT,
+	/* Execution of main with --run. */
+	ZZ_STATS_PHASE_RUN,
+	ZZ_STATS_PHASES_COUNT
+};
+
+#define ZZ_STATS_EVENTS_CAPACITY 256
+
+/**
+ * A phase execution, in microseconds since the creation of the statistics.
+ */
+struct zz_stats_event {
+	enum zz_stats_phase phase;
+	/* Worker that executed the phase, from one. */
+	rt_un thread;
+	rt_un start;
+	rt_un duration;
+};
+
+/**
+ * Compilation statistics.
+ *
+ * <p>
+ * Instrumented code receives a null pointer when the statistics are disabled so that it only pays a test per phase.
+ * </p>
+ */
+struct zz_stats {
+	struct rt_chrono chrono;
+	rt_un phase_starts[ZZ_STATS_PHASES_COUNT];
+	rt_un phase_durations[ZZ_STATS_PHASES_COUNT];
+	struct zz_stats_event events[ZZ_STATS_EVENTS_CAPACITY];
+	rt_un events_count;
+	rt_un thread;
+	rt_un files_count;
+	rt_un cache_hits;
+	rt_un cache_misses;
+	rt_un cache_evictions;
+	rt_un input_size;
+	rt_un tokens_count;
+	rt_un symbols_count;
+	rt_un ast_nodes_count;
+	rt_un optimized_ast_nodes_count;
+	/* Memory used by the AST, in bytes. */
+	rt_un ast_size;
+	rt_un heap_allocated_bytes;
+	rt_un heap_allocations_count;
+	rt_un heap_peak_bytes;
+};
+
+rt_s zz_stats_create(struct zz_stats *stats);
+
+/**
+ * Statistics of a worker, sharing the time origin of <tt>parent</tt> so that they can be merged into it.
+ *
+ * @param thread Identifies the worker in the timeline, from one.
+ */
+void zz_stats_create_child(struct zz_stats *stats, struct zz_stats *parent, rt_un thread);
+
+/**
+ * Add the durations, counts and events of <tt>child</tt> to <tt>stats</tt>.<br>
+ * The heap counters are not merged, they are specific to each heap.
+ */
+void zz_stats_merge(struct zz_stats *stats, struct zz_stats *child);
+
+rt_s zz_stats_begin_phase(struct zz_stats *stats, enum zz_stats_phase phase);
+
+rt_s zz_stats_end_phase(struct zz_stats *stats, enum zz_stats_phase phase);
+
+/**
+ * Write the statistics on the error output.
+ */
+rt_s zz_stats_write(struct zz_stats *stats);
+
+/**
+ * Write the phases timeline in the Chrome trace event format, to be opened with chrome://tracing or Perfetto.
+ */
+rt_s zz_stats_write_time_trace(struct zz_stats *stats, const rt_char *file_path);
+
+#endif /* ZZ_STATS_H */
@@ -0,0 +1,72 @@
+#ifndef ZZ_SYMBOL_TABLE_H
+#define ZZ_SYMBOL_TABLE_H
+
+#include <rpr.h>
+
+/**
+ * An interned identifier.<br>
+ * Its name is made of <tt>name_size</tt> bytes at <tt>name_offset</tt> in the names of the table, followed by a zero.
+ */
+struct zz_symbol {
+	rt_un32 name_offset;
+	rt_un32 name_size;
+	rt_un32 hash;
+};
+
+/**
+ * The name of the symbol is duplicated so that a lookup does not touch the symbols.
+ */
+struct zz_symbol_table_slot {
+	rt_un32 hash;
+	rt_un32 symbol;
+	rt_un32 name_offset;
+	rt_un32 name_size;
+};
+
+/**
+ * Interning table of the identifiers.
+ *
+ * <p>
+ * Each distinct identifier is given a 32 bits symbol id, in order of first appearance, so that names can be compared as integers.<br>
+ * The slots use open addressing with linear probing and are kept at most half full.
+ * Each slot keeps the hash and the name of its symbol, so that a lookup only touches the slots and the names.
+ * </p>
+ *
+ * <p>
+ * The names are copied, so the symbols outlive the input they come from.
+ * </p>
+ */
+struct zz_symbol_table {
+	struct zz_symbol_table_slot *slots;
+	rt_un slots_capacity;
+	struct zz_symbol *symbols;
+	rt_un symbols_count;
+	rt_un symbols_capacity;
+	rt_char8 *names;
+	rt_un names_size;
+	rt_un names_capacity;
+	struct rt_heap *heap;
+};
+
+/**
+ * The returned name is zero terminated and valid until the next call to <tt>zz_symbol_table_intern</tt>.
+ */
+#define ZZ_SYMBOL_TABLE_GET_NAME(symbol_table, symbol) (&(symbol_table)->names[(symbol_table)->symbols[symbol].name_offset])
+
+void zz_symbol_table_create(struct zz_symbol_table *symbol_table, struct rt_heap *heap);
+
+/**
+ * Find the symbol of <tt>name</tt>, adding it if needed.
+ */
+rt_s zz_symbol_table_intern(struct zz_symbol_table *symbol_table, const rt_char8 *name, rt_un name_size, rt_un32 *symbol);
+
+/**
+ * Find the symbol of <tt>name</tt> without adding it, so that several threads can share the table once it is filled.
+ *
+ * @return False if <tt>name</tt> is not in the table.
+ */
+rt_b zz_symbol_table_find(struct zz_symbol_table *symbol_table, const rt_char8 *name, rt_un name_size, rt_un32 *symbol);
+
+rt_s zz_symbol_table_free(struct zz_symbol_table *symbol_table);
+
+#endif /* ZZ_SYMBOL_TABLE_H */
@@ -0,0 +1,58 @@
+#ifndef ZZ_THREAD_POOL_H
+#define ZZ_THREAD_POOL_H
+
+#include <rpr.h>
+
+struct zz_thread_pool;
+
+/**
+ * Body of a worker, it calls <tt>zz_thread_pool_take_task</tt> until there is no more tasks.
+ *
+ * @param worker Index of the worker, from zero to the workers count excluded.
+ */
+typedef rt_s (*zz_thread_pool_worker_callback_t)(struct zz_thread_pool *thread_pool, rt_un worker);
+
+struct zz_thread_pool_worker;
+
+/**
+ * Runs tasks, identified by their index, on a fixed set of workers.
+ *
+ * <p>
+ * Idle workers take the next task from a shared counter.<br>
+ * Tasks are coarse and independent, a file each, so a lock per task costs nothing and no per-worker queues are needed to balance the load.
+ * </p>
+ *
+ * <p>
+ * The calling thread is the first worker so that a single worker does not create any thread.
+ * </p>
+ */
+struct zz_thread_pool {
+	struct rt_critical_section critical_section;
+	rt_un next_task;
+	rt_un tasks_count;
+	zz_thread_pool_worker_callback_t callback;
+	void *context;
+};
+
+/**
+ * Number of logical processors, at least one.
+ */
+rt_un zz_thread_pool_get_processors_count(void);
+
+/**
+ * Run <tt>callback</tt> on <tt>workers_count</tt> workers and wait for them.
+ *
+ * <p>
+ * Fails if a worker fails.
+ * </p>
+ *
+ * @param context Available to the workers as <tt>thread_pool->context</tt>.
+ */
+rt_s zz_thread_pool_run(struct zz_thread_pool *thread_pool, rt_un workers_count, rt_un tasks_count, zz_thread_pool_worker_callback_t callback, void *context, struct rt_heap *heap);
+
+/**
+ * @param task Set to <tt>RT_TYPE_MAX_UN</tt> when all the tasks have been taken.
+ */
+rt_s zz_thread_pool_take_task(struct zz_thread_pool *thread_pool, rt_un *task);
+
+#endif /* ZZ_THREAD_POOL_H */
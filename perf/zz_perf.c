@@ -0,0 +1,748 @@
+#define RT_DEFINE_USE_CRT
+
+#include <rpr.h>
+#include <rpr_main.h>
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef RT_DEFINE_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "zz_bench_baseline.h"
+
+#define ZZ_PERF_DEFAULT_RUNS 5
+#define ZZ_PERF_DEFAULT_TOLERANCE 10
+
+/* Shorter runs are too noisy for their duration to be compared with the baseline, in microseconds. */
+#define ZZ_PERF_MIN_COMPARED_DURATION 1000
+
+/* Value of the measures that are not available. */
+#define ZZ_PERF_UNAVAILABLE RT_TYPE_MAX_UN
+
+enum zz_perf_measure {
+	/* Wall time from the start of the program to its exit, in microseconds. */
+	ZZ_PERF_MEASURE_DURATION,
+	/* Instructions retired in user mode, only on Linux. */
+	ZZ_PERF_MEASURE_INSTRUCTIONS,
+	/* Cycles in user mode on Linux, of all modes on Windows. */
+	ZZ_PERF_MEASURE_CYCLES,
+	ZZ_PERF_MEASURES_COUNT
+};
+
+static const rt_char *const zz_perf_measure_units[] = {
+	[ZZ_PERF_MEASURE_DURATION] = _R(" us"),
+	[ZZ_PERF_MEASURE_INSTRUCTIONS] = _R(" instructions"),
+	[ZZ_PERF_MEASURE_CYCLES] = _R(" cycles")
+};
+
+/* Keys of the measures in the baseline files. */
+static const rt_char8 *const zz_perf_measure_keys[] = {
+	[ZZ_PERF_MEASURE_DURATION] = "us",
+	[ZZ_PERF_MEASURE_INSTRUCTIONS] = "instructions",
+	[ZZ_PERF_MEASURE_CYCLES] = "cycles"
+};
+
+struct zz_perf_options {
+	rt_un runs;
+	/* Allowed slowdown compared to the baseline, in percent. */
+	rt_un tolerance;
+	const rt_char *baseline_file_path;
+	const rt_char *output_file_path;
+	/* Each program must be faster than the previous one. */
+	rt_b speedup;
+};
+
+static rt_s zz_perf_display_help(rt_s ret)
+{
+	rt_b error = !ret;
+
+	if (!rt_console_write(_R("stc_perf [OPTIONS] {--expected=<VALUE> <PROGRAM>}...\n"
+				 "\n"
+				 "  --runs=<N>              Keep the best measures of N runs of each program, 5 by default.\n"
+				 "  --write-baseline=<FILE> Write the measures to FILE, in JSON.\n"
+				 "  --baseline=<FILE>       Fail if a program is slower than in FILE.\n"
+				 "  --tolerance=<PERCENT>   Allowed slowdown compared to the baseline, 10 by default.\n"
+				 "  --speedup               Fail if a program is not faster than the previous one.\n"
+				 "  --expected=<VALUE>      Exit code of the following programs, from 0 to 255.\n"
+				 "\n"
+				 "Runs each program, compiled by stc, and fails if it does not exit with the expected value.\n"
+				 "The wall time is measured, as well as the instructions and the cycles where the system counts them.\n"
+				 "The programs are named after their file in the baseline.\n"
+				 "Durations shorter than a millisecond are not compared with the baseline.\n"
+				 "With --speedup, the cycles or the instructions are compared where they are counted, the wall time otherwise.\n"), error))
+		ret = RT_FAILED;
+
+	return ret;
+}
+
+/**
+ * @param value Receives the value of <tt>--name=VALUE</tt>, if <tt>arg</tt> starts with <tt>prefix</tt>.
+ */
+static rt_b zz_perf_get_value(const rt_char *arg, rt_un arg_size, const rt_char *prefix, rt_un prefix_size, const rt_char **value)
+{
+	if (!rt_char_starts_with(arg, arg_size, prefix, prefix_size))
+		return RT_FALSE;
+	*value = &arg[prefix_size];
+	return RT_TRUE;
+}
+
+#ifdef RT_DEFINE_WINDOWS
+
+/**
+ * Only the cycles are available, from <tt>QueryProcessCycleTime</tt>.
+ */
+static rt_s zz_perf_run_program(const rt_char *program_path, struct rt_chrono *chrono, rt_un *measures, rt_un *exit_code)
+{
+	STARTUPINFOW startup_info;
+	PROCESS_INFORMATION process_information;
+	rt_b process_created = RT_FALSE;
+	DWORD process_exit_code;
+	ULONG64 cycles;
+	rt_un start;
+	rt_un end;
+	rt_s ret;
+
+	RT_MEMORY_ZERO(&startup_info, sizeof(startup_info));
+	startup_info.cb = sizeof(startup_info);
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &start)))
+		goto error;
+
+	if (RT_UNLIKELY(!CreateProcessW(program_path, RT_NULL, RT_NULL, RT_NULL, FALSE, 0, RT_NULL, RT_NULL, &startup_info, &process_information)))
+		goto error;
+	process_created = RT_TRUE;
+
+	if (RT_UNLIKELY(WaitForSingleObject(process_information.hProcess, INFINITE) != WAIT_OBJECT_0))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &end)))
+		goto error;
+
+	if (RT_UNLIKELY(!GetExitCodeProcess(process_information.hProcess, &process_exit_code)))
+		goto error;
+
+	measures[ZZ_PERF_MEASURE_DURATION] = end - start;
+	measures[ZZ_PERF_MEASURE_INSTRUCTIONS] = ZZ_PERF_UNAVAILABLE;
+	if (QueryProcessCycleTime(process_information.hProcess, &cycles))
+		measures[ZZ_PERF_MEASURE_CYCLES] = (rt_un)cycles;
+	else
+		measures[ZZ_PERF_MEASURE_CYCLES] = ZZ_PERF_UNAVAILABLE;
+	*exit_code = process_exit_code;
+
+	ret = RT_OK;
+free:
+	if (process_created) {
+		process_created = RT_FALSE;
+		if (RT_UNLIKELY(!CloseHandle(process_information.hThread) && ret))
+			goto error;
+		if (RT_UNLIKELY(!CloseHandle(process_information.hProcess) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#else
+
+#ifdef RT_DEFINE_LINUX
+
+/**
+ * Open a counter of the user mode events of <tt>process_id</tt>, enabled when it calls <tt>exec</tt>.
+ *
+ * @return -1 if the counter is not available, for instance in a virtual machine or with a restrictive <tt>perf_event_paranoid</tt>.
+ */
+static int zz_perf_open_counter(pid_t process_id, rt_un64 config)
+{
+	struct perf_event_attr attributes;
+
+	RT_MEMORY_ZERO(&attributes, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.config = config;
+	attributes.disabled = 1;
+	attributes.enable_on_exec = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	return (int)syscall(SYS_perf_event_open, &attributes, process_id, -1, -1, 0);
+}
+
+/**
+ * @return <tt>ZZ_PERF_UNAVAILABLE</tt> if the counter could not be opened or read.
+ */
+static rt_un zz_perf_read_counter(int counter)
+{
+	rt_un64 count;
+
+	if (counter == -1 || read(counter, &count, sizeof(count)) != sizeof(count))
+		return ZZ_PERF_UNAVAILABLE;
+	return (rt_un)count;
+}
+
+#endif
+
+/**
+ * The child waits for the counters to be opened before calling <tt>exec</tt>, which enables them.
+ */
+static rt_s zz_perf_run_program(const rt_char *program_path, struct rt_chrono *chrono, rt_un *measures, rt_un *exit_code)
+{
+	int pipe_fds[2] = { -1, -1 };
+	pid_t process_id = -1;
+	int status;
+	rt_char8 go = 0;
+#ifdef RT_DEFINE_LINUX
+	int instructions_counter = -1;
+	int cycles_counter = -1;
+#endif
+	rt_un start;
+	rt_un end;
+	rt_s ret;
+
+	if (RT_UNLIKELY(pipe(pipe_fds)))
+		goto error;
+
+	process_id = fork();
+	if (RT_UNLIKELY(process_id == -1))
+		goto error;
+	if (!process_id) {
+		close(pipe_fds[1]);
+		if (read(pipe_fds[0], &go, 1) == 1)
+			execl(program_path, program_path, (char*)RT_NULL);
+		_exit(127);
+	}
+	close(pipe_fds[0]);
+	pipe_fds[0] = -1;
+
+#ifdef RT_DEFINE_LINUX
+	instructions_counter = zz_perf_open_counter(process_id, PERF_COUNT_HW_INSTRUCTIONS);
+	cycles_counter = zz_perf_open_counter(process_id, PERF_COUNT_HW_CPU_CYCLES);
+#endif
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &start)))
+		goto error;
+
+	if (RT_UNLIKELY(write(pipe_fds[1], &go, 1) != 1))
+		goto error;
+	close(pipe_fds[1]);
+	pipe_fds[1] = -1;
+
+	if (RT_UNLIKELY(waitpid(process_id, &status, 0) != process_id))
+		goto error;
+	process_id = -1;
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(chrono, &end)))
+		goto error;
+
+	measures[ZZ_PERF_MEASURE_DURATION] = end - start;
+#ifdef RT_DEFINE_LINUX
+	measures[ZZ_PERF_MEASURE_INSTRUCTIONS] = zz_perf_read_counter(instructions_counter);
+	measures[ZZ_PERF_MEASURE_CYCLES] = zz_perf_read_counter(cycles_counter);
+#else
+	measures[ZZ_PERF_MEASURE_INSTRUCTIONS] = ZZ_PERF_UNAVAILABLE;
+	measures[ZZ_PERF_MEASURE_CYCLES] = ZZ_PERF_UNAVAILABLE;
+#endif
+	/* A crash never matches the expected exit code. */
+	if (WIFEXITED(status))
+		*exit_code = WEXITSTATUS(status);
+	else
+		*exit_code = ZZ_PERF_UNAVAILABLE;
+
+	ret = RT_OK;
+free:
+#ifdef RT_DEFINE_LINUX
+	if (cycles_counter != -1)
+		close(cycles_counter);
+	if (instructions_counter != -1)
+		close(instructions_counter);
+#endif
+	if (pipe_fds[0] != -1)
+		close(pipe_fds[0]);
+	if (pipe_fds[1] != -1) {
+		/* The child exits without the go. */
+		close(pipe_fds[1]);
+		pipe_fds[1] = -1;
+	}
+	if (process_id > 0) {
+		waitpid(process_id, &status, 0);
+		process_id = -1;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#endif
+
+/**
+ * Run the program <tt>options->runs</tt> times, keeping the best of each measure.
+ *
+ * @param failed Set if an exit code is not <tt>expected</tt>.
+ */
+static rt_s zz_perf_measure(const rt_char *program_path, rt_un expected, struct zz_perf_options *options, struct rt_chrono *chrono, rt_un *measures, rt_b *failed)
+{
+	rt_un run_measures[ZZ_PERF_MEASURES_COUNT];
+	rt_un exit_code;
+	rt_un i;
+	rt_un j;
+	rt_s ret;
+
+	for (i = 0; i < options->runs; i++) {
+		if (RT_UNLIKELY(!zz_perf_run_program(program_path, chrono, run_measures, &exit_code)))
+			goto error;
+
+		if (exit_code != expected) {
+			*failed = RT_TRUE;
+			goto end;
+		}
+
+		for (j = 0; j < ZZ_PERF_MEASURES_COUNT; j++) {
+			if (!i || run_measures[j] < measures[j])
+				measures[j] = run_measures[j];
+		}
+	}
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * The name of the program is its file name, without the <tt>.exe</tt> extension.
+ */
+static rt_s zz_perf_get_name(const rt_char *program_path, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_file_path_get_name(program_path, rt_char_get_size(program_path), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (rt_char_ends_with(buffer, *buffer_size, _R(".exe"), 4)) {
+		*buffer_size -= 4;
+		buffer[*buffer_size] = 0;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_perf_write_measures(const rt_char *name, rt_un name_size, rt_un *measures)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size = 0;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_append(name, name_size, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	for (i = 0; i < ZZ_PERF_MEASURES_COUNT; i++) {
+		if (measures[i] == ZZ_PERF_UNAVAILABLE)
+			continue;
+		if (RT_UNLIKELY(!rt_char_append_char(_R(' '), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_un(measures[i], 10, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(zz_perf_measure_units[i], rt_char_get_size(zz_perf_measure_units[i]), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char_append_char(_R('\n'), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_console_write(buffer, RT_FALSE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write a message about the program <tt>name</tt> on the error output.
+ */
+static rt_s zz_perf_write_error(const rt_char *prefix, const rt_char *name, rt_un name_size, const rt_char *suffix)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size = 0;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_append(prefix, rt_char_get_size(prefix), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(name, name_size, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(suffix, rt_char_get_size(suffix), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_console_write(buffer, RT_TRUE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write the measures that are slower than the baseline by more than the tolerance.
+ *
+ * @param failed Set if a measure is slower.
+ */
+static rt_s zz_perf_compare(struct zz_bench_baseline *baseline, const rt_char8 *name8, const rt_char *name, rt_un name_size, rt_un *measures, rt_un tolerance, rt_b *failed)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size;
+	rt_un baseline_measure;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < ZZ_PERF_MEASURES_COUNT; i++) {
+		/* The measures that are not in the baseline are new. */
+		if (measures[i] == ZZ_PERF_UNAVAILABLE || !zz_bench_baseline_find(baseline, name8, zz_perf_measure_keys[i], &baseline_measure))
+			continue;
+		if (i == ZZ_PERF_MEASURE_DURATION && baseline_measure < ZZ_PERF_MIN_COMPARED_DURATION)
+			continue;
+		if ((rt_un64)measures[i] * 100 <= (rt_un64)baseline_measure * (100 + tolerance))
+			continue;
+
+		*failed = RT_TRUE;
+		buffer_size = 0;
+		if (RT_UNLIKELY(!rt_char_append(_R(" takes "), 7, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_un(measures[i], 10, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(zz_perf_measure_units[i], rt_char_get_size(zz_perf_measure_units[i]), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(" instead of "), 12, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_un(baseline_measure, 10, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(zz_perf_measure_units[i], rt_char_get_size(zz_perf_measure_units[i]), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append(_R(".\n"), 2, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_perf_write_error(_R("Regression: "), name, name_size, buffer)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Whether <tt>measures</tt> are better than <tt>previous_measures</tt> on the cycles or on the instructions, or on the wall time if neither is counted.
+ */
+static rt_b zz_perf_is_faster(rt_un *measures, rt_un *previous_measures)
+{
+	rt_b counted = RT_FALSE;
+	rt_un i;
+
+	for (i = ZZ_PERF_MEASURE_INSTRUCTIONS; i < ZZ_PERF_MEASURES_COUNT; i++) {
+		if (measures[i] == ZZ_PERF_UNAVAILABLE || previous_measures[i] == ZZ_PERF_UNAVAILABLE)
+			continue;
+		if (measures[i] < previous_measures[i])
+			return RT_TRUE;
+		counted = RT_TRUE;
+	}
+	return !counted && measures[ZZ_PERF_MEASURE_DURATION] < previous_measures[ZZ_PERF_MEASURE_DURATION];
+}
+
+/**
+ * Measure a program, check its exit code and compare it with the baseline and with the previous program, then append its measures to <tt>results</tt>.
+ *
+ * @param baseline Can be null.
+ * @param measures Receives the measures of the program, all unavailable if its exit code is wrong.
+ * @param previous_measures Measures of the previous program compared with <tt>--speedup</tt>, null for the first program.
+ * @param failed Set if the exit code is wrong, if the program is slower than the baseline, or if it is not faster than the previous one with <tt>--speedup</tt>.
+ */
+static rt_s zz_perf_check_program(const rt_char *program_path, rt_un expected, struct zz_perf_options *options, struct zz_bench_baseline *baseline, struct rt_chrono *chrono,
+				  rt_un *measures, rt_un *previous_measures, rt_char8 *results, rt_un results_capacity, rt_un *results_size, rt_b *failed)
+{
+	rt_char name[RT_FILE_PATH_SIZE];
+	rt_un name_size;
+	rt_char8 name8_buffer[RT_FILE_PATH_SIZE];
+	rt_char8 *name8;
+	rt_un name8_size;
+	const rt_char8 *keys[ZZ_PERF_MEASURES_COUNT];
+	rt_un values[ZZ_PERF_MEASURES_COUNT];
+	rt_un values_count = 0;
+	rt_b wrong_exit_code = RT_FALSE;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_perf_get_name(program_path, name, RT_FILE_PATH_SIZE, &name_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_encoding_encode(name, name_size, RT_ENCODING_UTF_8, name8_buffer, RT_FILE_PATH_SIZE, RT_NULL, RT_NULL, &name8, &name8_size, RT_NULL)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_perf_measure(program_path, expected, options, chrono, measures, &wrong_exit_code)))
+		goto error;
+	if (wrong_exit_code) {
+		for (i = 0; i < ZZ_PERF_MEASURES_COUNT; i++)
+			measures[i] = ZZ_PERF_UNAVAILABLE;
+		*failed = RT_TRUE;
+		if (RT_UNLIKELY(!zz_perf_write_error(_R("Wrong exit code: "), name, name_size, _R(".\n"))))
+			goto error;
+		goto end;
+	}
+
+	if (RT_UNLIKELY(!zz_perf_write_measures(name, name_size, measures)))
+		goto error;
+
+	if (baseline) {
+		if (RT_UNLIKELY(!zz_perf_compare(baseline, name8, name, name_size, measures, options->tolerance, failed)))
+			goto error;
+	}
+
+	/* The previous program has already failed if its exit code was wrong. */
+	if (options->speedup && previous_measures && previous_measures[ZZ_PERF_MEASURE_DURATION] != ZZ_PERF_UNAVAILABLE && !zz_perf_is_faster(measures, previous_measures)) {
+		*failed = RT_TRUE;
+		if (RT_UNLIKELY(!zz_perf_write_error(_R("No speedup: "), name, name_size, _R(" is not faster than the previous program.\n"))))
+			goto error;
+	}
+
+	for (i = 0; i < ZZ_PERF_MEASURES_COUNT; i++) {
+		if (measures[i] != ZZ_PERF_UNAVAILABLE) {
+			keys[values_count] = zz_perf_measure_keys[i];
+			values[values_count] = measures[i];
+			values_count++;
+		}
+	}
+	if (RT_UNLIKELY(!zz_bench_baseline_append_result(name8, keys, values, values_count, !*results_size, results, results_capacity, results_size)))
+		goto error;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse the options that apply to all the programs, which must come first.
+ *
+ * @param first_program Receives the index of the first argument that is not such an option.
+ */
+static rt_s zz_perf_parse_options(rt_un argc, const rt_char *argv[], struct zz_perf_options *options, rt_b *help, rt_un *first_program)
+{
+	const rt_char *arg;
+	rt_un arg_size;
+	const rt_char *value;
+	rt_un i;
+	rt_s ret;
+
+	options->runs = ZZ_PERF_DEFAULT_RUNS;
+	options->tolerance = ZZ_PERF_DEFAULT_TOLERANCE;
+	options->baseline_file_path = RT_NULL;
+	options->output_file_path = RT_NULL;
+	options->speedup = RT_FALSE;
+	*help = RT_FALSE;
+
+	for (i = 1; i < argc; i++) {
+		arg = argv[i];
+		arg_size = rt_char_get_size(arg);
+
+		if (rt_char_equals(arg, arg_size, _R("--help"), 6) || rt_char_equals(arg, arg_size, _R("-h"), 2)) {
+			*help = RT_TRUE;
+		} else if (zz_perf_get_value(arg, arg_size, _R("--runs="), 7, &value)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un(value, &options->runs) || !options->runs)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+		} else if (zz_perf_get_value(arg, arg_size, _R("--tolerance="), 12, &value)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un(value, &options->tolerance)))
+				goto error;
+		} else if (zz_perf_get_value(arg, arg_size, _R("--write-baseline="), 17, &value) && *value) {
+			options->output_file_path = value;
+		} else if (zz_perf_get_value(arg, arg_size, _R("--baseline="), 11, &value) && *value) {
+			options->baseline_file_path = value;
+		} else if (rt_char_equals(arg, arg_size, _R("--speedup"), 9)) {
+			options->speedup = RT_TRUE;
+		} else {
+			break;
+		}
+	}
+	*first_program = i;
+
+	if (RT_UNLIKELY(!*help && *first_program == argc)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @param failed Set if a program has a wrong exit code or is slower than the baseline.
+ */
+static rt_s zz_perf_check_programs(rt_un argc, const rt_char *argv[], rt_un first_program, struct zz_perf_options *options, rt_b *failed, struct rt_heap *heap)
+{
+	struct zz_bench_baseline baseline;
+	rt_b baseline_read = RT_FALSE;
+	struct rt_chrono chrono;
+	rt_char8 results[RT_CHAR8_BIG_STRING_SIZE * 16];
+	rt_un results_size = 0;
+	rt_char8 baseline_data[RT_CHAR8_BIG_STRING_SIZE * 16 + ZZ_BENCH_BASELINE_HEADER_SIZE + ZZ_BENCH_BASELINE_FOOTER_SIZE];
+	rt_un baseline_data_size = 0;
+	const rt_char *arg;
+	rt_un arg_size;
+	const rt_char *value;
+	rt_un expected = ZZ_PERF_UNAVAILABLE;
+	/* Of the current and of the previous program, used alternately. */
+	rt_un measures[2][ZZ_PERF_MEASURES_COUNT];
+	rt_un programs_count = 0;
+	rt_un i;
+	rt_s ret;
+
+	if (options->baseline_file_path) {
+		baseline_read = RT_TRUE;
+		if (RT_UNLIKELY(!zz_bench_baseline_read(&baseline, options->baseline_file_path, heap)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!rt_chrono_create(&chrono)))
+		goto error;
+
+	for (i = first_program; i < argc; i++) {
+		arg = argv[i];
+		arg_size = rt_char_get_size(arg);
+
+		if (zz_perf_get_value(arg, arg_size, _R("--expected="), 11, &value)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un(value, &expected) || expected > 255)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+		} else {
+			/* Each program must have an expected exit code. */
+			if (RT_UNLIKELY(expected == ZZ_PERF_UNAVAILABLE)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			if (RT_UNLIKELY(!zz_perf_check_program(arg, expected, options, baseline_read ? &baseline : RT_NULL, &chrono, measures[programs_count % 2], programs_count ? measures[(programs_count - 1) % 2] : RT_NULL, results, sizeof(results), &results_size, failed)))
+				goto error;
+			programs_count++;
+		}
+	}
+
+	if (options->output_file_path) {
+		if (RT_UNLIKELY(!rt_char8_append(ZZ_BENCH_BASELINE_HEADER, ZZ_BENCH_BASELINE_HEADER_SIZE, baseline_data, sizeof(baseline_data), &baseline_data_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char8_append(results, results_size, baseline_data, sizeof(baseline_data), &baseline_data_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char8_append(ZZ_BENCH_BASELINE_FOOTER, ZZ_BENCH_BASELINE_FOOTER_SIZE, baseline_data, sizeof(baseline_data), &baseline_data_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_small_file_write(options->output_file_path, RT_SMALL_FILE_MODE_TRUNCATE, baseline_data, baseline_data_size)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (baseline_read) {
+		baseline_read = RT_FALSE;
+		if (RT_UNLIKELY(!zz_bench_baseline_free(&baseline) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @param failed Set if a program has a wrong exit code or is slower than the baseline.
+ */
+static rt_s zz_perf_main(rt_un argc, const rt_char *argv[], rt_b *failed)
+{
+	struct zz_perf_options options;
+	struct rt_runtime_heap runtime_heap;
+	rt_b runtime_heap_created = RT_FALSE;
+	rt_un first_program;
+	rt_b help;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_perf_parse_options(argc, argv, &options, &help, &first_program))) {
+		if (!zz_perf_display_help(RT_FAILED))
+			goto error;
+		goto error;
+	}
+
+	if (help) {
+		if (RT_UNLIKELY(!zz_perf_display_help(RT_OK)))
+			goto error;
+		goto end;
+	}
+
+	if (RT_UNLIKELY(!rt_runtime_heap_create(&runtime_heap)))
+		goto error;
+	runtime_heap_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!zz_perf_check_programs(argc, argv, first_program, &options, failed, &runtime_heap.heap))) {
+		rt_error_message_write_last(_R("Performance test failed: "));
+		goto error;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	if (runtime_heap_created) {
+		runtime_heap_created = RT_FALSE;
+		if (RT_UNLIKELY(!runtime_heap.heap.close(&runtime_heap.heap) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_un16 rpr_main(rt_un argc, const rt_char *argv[])
+{
+	rt_b failed = RT_FALSE;
+	int ret;
+
+	if (zz_perf_main(argc, argv, &failed) && !failed)
+		ret = 0;
+	else
+		ret = 1;
+	return ret;
+}
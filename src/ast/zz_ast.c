@@ -0,0 +1,304 @@
+#include "ast/zz_ast.h"
+
+#define ZZ_AST_INITIAL_CAPACITY 256
+
+static void *zz_ast_resize(struct rt_heap *heap, void **area, rt_un size)
+{
+	if (*area)
+		return heap->realloc(heap, area, size);
+	else
+		return heap->alloc(heap, area, size);
+}
+
+static rt_un zz_ast_get_grown_capacity(rt_un capacity)
+{
+	return capacity ? capacity * 2 : ZZ_AST_INITIAL_CAPACITY;
+}
+
+void zz_ast_create(struct zz_ast *ast, struct rt_heap *heap)
+{
+	ast->kinds = RT_NULL;
+	ast->types = RT_NULL;
+	ast->operands = RT_NULL;
+	ast->literals = RT_NULL;
+	ast->functions = RT_NULL;
+	ast->locals = RT_NULL;
+	ast->loops = RT_NULL;
+	ast->nodes_count = 0;
+	ast->nodes_capacity = 0;
+	ast->literals_count = 0;
+	ast->literals_capacity = 0;
+	ast->functions_count = 0;
+	ast->functions_capacity = 0;
+	ast->locals_count = 0;
+	ast->locals_capacity = 0;
+	ast->loops_count = 0;
+	ast->loops_capacity = 0;
+	ast->heap = heap;
+}
+
+rt_s zz_ast_reserve(struct zz_ast *ast, rt_un nodes_capacity)
+{
+	struct rt_heap *heap = ast->heap;
+	rt_s ret;
+
+	if (nodes_capacity <= ast->nodes_capacity)
+		goto end;
+
+	if (RT_UNLIKELY(nodes_capacity > RT_TYPE_MAX_UN32)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_ast_resize(heap, (void**)&ast->kinds, nodes_capacity * sizeof(rt_un8))))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_resize(heap, (void**)&ast->types, nodes_capacity * sizeof(rt_un8))))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_resize(heap, (void**)&ast->operands, nodes_capacity * 2 * sizeof(rt_un32))))
+		goto error;
+	ast->nodes_capacity = nodes_capacity;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_node(struct zz_ast *ast, rt_un8 kind, rt_un32 first_operand, rt_un32 second_operand, rt_un32 *node)
+{
+	rt_un index = ast->nodes_count;
+	rt_s ret;
+
+	if (RT_UNLIKELY(index == ast->nodes_capacity)) {
+		if (RT_UNLIKELY(!zz_ast_reserve(ast, zz_ast_get_grown_capacity(ast->nodes_capacity))))
+			goto error;
+	}
+
+	ast->kinds[index] = kind;
+	ast->operands[2 * index] = first_operand;
+	ast->operands[2 * index + 1] = second_operand;
+	ast->nodes_count++;
+	*node = (rt_un32)index;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Make sure that <tt>literals_count</tt> more literals can be added.
+ */
+static rt_s zz_ast_reserve_literals(struct zz_ast *ast, rt_un literals_count)
+{
+	rt_un capacity = ast->literals_capacity;
+	rt_s ret;
+
+	if (RT_UNLIKELY(ast->literals_count + literals_count > capacity)) {
+		do {
+			capacity = zz_ast_get_grown_capacity(capacity);
+		} while (ast->literals_count + literals_count > capacity);
+		if (RT_UNLIKELY(!zz_ast_resize(ast->heap, (void**)&ast->literals, capacity * sizeof(rt_n))))
+			goto error;
+		ast->literals_capacity = capacity;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_number(struct zz_ast *ast, rt_n value, rt_un32 *node)
+{
+	rt_un literal = ast->literals_count;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_ast_reserve_literals(ast, 1)))
+		goto error;
+
+	ast->literals[literal] = value;
+	ast->literals_count++;
+
+	if (RT_UNLIKELY(!zz_ast_add_node(ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_NUMBER, 0), (rt_un32)literal, 0, node)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_vector(struct zz_ast *ast, enum zz_value_type value_type, const rt_n *lanes, rt_un32 *node)
+{
+	rt_un literal = ast->literals_count;
+	rt_un lanes_count = zz_value_type_get_lanes_count(value_type);
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_ast_reserve_literals(ast, lanes_count)))
+		goto error;
+
+	RT_MEMORY_COPY(lanes, &ast->literals[literal], lanes_count * sizeof(rt_n));
+	ast->literals_count += lanes_count;
+
+	if (RT_UNLIKELY(!zz_ast_add_node(ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_VECTOR, value_type), (rt_un32)literal, 0, node)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Make sure that one more item of <tt>item_size</tt> bytes can be added to the small array <tt>items</tt>.
+ */
+static rt_s zz_ast_reserve_item(struct rt_heap *heap, void **items, rt_un item_size, rt_un count, rt_un *capacity)
+{
+	rt_un new_capacity;
+	rt_s ret;
+
+	if (count == *capacity) {
+		/* Few functions, locals and loops compared to nodes. */
+		new_capacity = *capacity ? *capacity * 2 : 8;
+		if (RT_UNLIKELY(!zz_ast_resize(heap, items, new_capacity * item_size)))
+			goto error;
+		*capacity = new_capacity;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_function(struct zz_ast *ast, rt_un32 name, enum zz_value_type type, rt_un32 first_node, rt_un32 body, rt_un32 first_local, rt_un8 cpu_levels)
+{
+	struct zz_ast_function *function;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_ast_reserve_item(ast->heap, (void**)&ast->functions, sizeof(struct zz_ast_function), ast->functions_count, &ast->functions_capacity)))
+		goto error;
+
+	function = &ast->functions[ast->functions_count++];
+	function->name = name;
+	function->first_node = first_node;
+	function->body = body;
+	function->first_local = first_local;
+	function->locals_count = (rt_un32)ast->locals_count - first_local;
+	function->type = type;
+	function->cpu_levels = cpu_levels;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_local(struct zz_ast *ast, enum zz_value_type type, rt_un32 array_size, rt_un32 *local)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_ast_reserve_item(ast->heap, (void**)&ast->locals, sizeof(struct zz_ast_local), ast->locals_count, &ast->locals_capacity)))
+		goto error;
+
+	ast->locals[ast->locals_count].array_size = array_size;
+	ast->locals[ast->locals_count].type = type;
+	*local = (rt_un32)ast->locals_count++;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_ast_add_loop(struct zz_ast *ast, rt_un32 variable, rt_un32 unroll, rt_un32 vectorize, rt_un32 interleave, rt_un32 *loop)
+{
+	struct zz_ast_loop *new_loop;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_ast_reserve_item(ast->heap, (void**)&ast->loops, sizeof(struct zz_ast_loop), ast->loops_count, &ast->loops_capacity)))
+		goto error;
+
+	new_loop = &ast->loops[ast->loops_count];
+	new_loop->variable = variable;
+	new_loop->unroll = unroll;
+	new_loop->vectorize = vectorize;
+	new_loop->interleave = interleave;
+	*loop = (rt_un32)ast->loops_count++;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_un zz_ast_get_size(struct zz_ast *ast)
+{
+	return ast->nodes_count * (2 * sizeof(rt_un8) + 2 * sizeof(rt_un32)) +
+	       ast->literals_count * sizeof(rt_n) +
+	       ast->functions_count * sizeof(struct zz_ast_function) +
+	       ast->locals_count * sizeof(struct zz_ast_local) +
+	       ast->loops_count * sizeof(struct zz_ast_loop);
+}
+
+rt_s zz_ast_free(struct zz_ast *ast)
+{
+	struct rt_heap *heap = ast->heap;
+	rt_s ret = RT_OK;
+
+	if (ast->kinds && RT_UNLIKELY(!heap->free(heap, (void**)&ast->kinds)))
+		ret = RT_FAILED;
+	if (ast->types && RT_UNLIKELY(!heap->free(heap, (void**)&ast->types)))
+		ret = RT_FAILED;
+	if (ast->operands && RT_UNLIKELY(!heap->free(heap, (void**)&ast->operands)))
+		ret = RT_FAILED;
+	if (ast->literals && RT_UNLIKELY(!heap->free(heap, (void**)&ast->literals)))
+		ret = RT_FAILED;
+	if (ast->functions && RT_UNLIKELY(!heap->free(heap, (void**)&ast->functions)))
+		ret = RT_FAILED;
+	if (ast->locals && RT_UNLIKELY(!heap->free(heap, (void**)&ast->locals)))
+		ret = RT_FAILED;
+	if (ast->loops && RT_UNLIKELY(!heap->free(heap, (void**)&ast->loops)))
+		ret = RT_FAILED;
+	ast->nodes_count = 0;
+	ast->nodes_capacity = 0;
+	ast->literals_count = 0;
+	ast->literals_capacity = 0;
+	ast->functions_count = 0;
+	ast->functions_capacity = 0;
+	ast->locals_count = 0;
+	ast->locals_capacity = 0;
+	ast->loops_count = 0;
+	ast->loops_capacity = 0;
+
+	return ret;
+}
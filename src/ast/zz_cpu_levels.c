@@ -0,0 +1,23 @@
+#include "ast/zz_cpu_levels.h"
+
+static const rt_char8 *zz_cpu_levels_names[ZZ_CPU_LEVELS_COUNT] = {
+	[ZZ_CPU_LEVEL_SSE4_2] = "sse4.2",
+	[ZZ_CPU_LEVEL_AVX2] = "avx2",
+	[ZZ_CPU_LEVEL_AVX512F] = "avx512f"
+};
+
+const rt_char8 *zz_cpu_level_get_name8(enum zz_cpu_level cpu_level)
+{
+	return zz_cpu_levels_names[cpu_level];
+}
+
+enum zz_cpu_level zz_cpu_level_find(const rt_char8 *name, rt_un name_size)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_CPU_LEVELS_COUNT; i++) {
+		if (rt_char8_equals(name, name_size, zz_cpu_levels_names[i], rt_char8_get_size(zz_cpu_levels_names[i])))
+			return i;
+	}
+	return ZZ_CPU_LEVELS_COUNT;
+}
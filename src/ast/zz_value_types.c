@@ -0,0 +1,53 @@
+#include "ast/zz_value_types.h"
+
+static const rt_un8 zz_value_types_lanes_counts[ZZ_VALUE_TYPES_COUNT] = {
+	[ZZ_VALUE_TYPE_I32] = 1,
+	[ZZ_VALUE_TYPE_I64] = 1,
+	[ZZ_VALUE_TYPE_I32X4] = 4,
+	[ZZ_VALUE_TYPE_I32X8] = 8,
+	[ZZ_VALUE_TYPE_I64X4] = 4
+};
+
+static const rt_un8 zz_value_types_lane_types[ZZ_VALUE_TYPES_COUNT] = {
+	[ZZ_VALUE_TYPE_I32] = ZZ_VALUE_TYPE_I32,
+	[ZZ_VALUE_TYPE_I64] = ZZ_VALUE_TYPE_I64,
+	[ZZ_VALUE_TYPE_I32X4] = ZZ_VALUE_TYPE_I32,
+	[ZZ_VALUE_TYPE_I32X8] = ZZ_VALUE_TYPE_I32,
+	[ZZ_VALUE_TYPE_I64X4] = ZZ_VALUE_TYPE_I64
+};
+
+rt_un zz_value_type_get_lanes_count(enum zz_value_type value_type)
+{
+	return zz_value_types_lanes_counts[value_type];
+}
+
+enum zz_value_type zz_value_type_get_lane_type(enum zz_value_type value_type)
+{
+	return zz_value_types_lane_types[value_type];
+}
+
+rt_un zz_value_type_get_size(enum zz_value_type value_type)
+{
+	return zz_value_types_lanes_counts[value_type] * (zz_value_types_lane_types[value_type] == ZZ_VALUE_TYPE_I64 ? 8 : 4);
+}
+
+enum zz_value_type zz_value_type_get_vector_type(enum zz_value_type lane_type, rt_un lanes_count)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_VALUE_TYPES_COUNT; i++) {
+		if (zz_value_types_lanes_counts[i] == lanes_count && zz_value_types_lane_types[i] == lane_type && lanes_count > 1)
+			return i;
+	}
+	return ZZ_VALUE_TYPES_COUNT;
+}
+
+rt_b zz_value_type_is_convertible(enum zz_value_type source, enum zz_value_type destination)
+{
+	if (source == destination)
+		return RT_TRUE;
+	if (zz_value_types_lanes_counts[source] != 1)
+		return RT_FALSE;
+	/* An i64 does not fit into i32 lanes. */
+	return source == ZZ_VALUE_TYPE_I32 || zz_value_types_lane_types[destination] == ZZ_VALUE_TYPE_I64;
+}
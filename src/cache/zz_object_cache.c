@@ -0,0 +1,585 @@
+#include "cache/zz_object_cache.h"
+
+#include <stdlib.h>
+
+#include "llvm/Config/llvm-config.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+/* 32 hexadecimal digits and ".o". */
+#define ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE 34
+
+#define ZZ_OBJECT_CACHE_PRIME1 0x9E3779B185EBCA87ull
+#define ZZ_OBJECT_CACHE_PRIME2 0xC2B2AE3D27D4EB4Full
+#define ZZ_OBJECT_CACHE_PRIME3 0x165667B19E3779F9ull
+#define ZZ_OBJECT_CACHE_PRIME4 0x85EBCA77C2B2AE63ull
+#define ZZ_OBJECT_CACHE_PRIME5 0x27D4EB2F165667C5ull
+
+#define ZZ_OBJECT_CACHE_ROTATE(value, count) (((value) << (count)) | ((value) >> (64 - (count))))
+
+struct zz_object_cache_entry {
+	/* Last modification, in an unspecified unit. */
+	rt_un64 time;
+	rt_un size;
+	rt_char name[ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1];
+};
+
+static rt_un64 zz_object_cache_read64(const rt_char8 *data)
+{
+	rt_un64 value;
+
+	RT_MEMORY_COPY(data, &value, sizeof(value));
+	return value;
+}
+
+static rt_un64 zz_object_cache_round(rt_un64 accumulator, rt_un64 input)
+{
+	accumulator += input * ZZ_OBJECT_CACHE_PRIME2;
+	accumulator = ZZ_OBJECT_CACHE_ROTATE(accumulator, 31);
+	return accumulator * ZZ_OBJECT_CACHE_PRIME1;
+}
+
+static rt_un64 zz_object_cache_merge_round(rt_un64 hash, rt_un64 accumulator)
+{
+	hash ^= zz_object_cache_round(0, accumulator);
+	return hash * ZZ_OBJECT_CACHE_PRIME1 + ZZ_OBJECT_CACHE_PRIME4;
+}
+
+/**
+ * XXH64 algorithm: four independent lanes consume 32 bytes per iteration, several gigabytes per second.<br>
+ * The identifiers FNV-1a consumes a byte per iteration, much too slow for whole sources.
+ */
+static rt_un64 zz_object_cache_hash(const void *data, rt_un size, rt_un64 seed)
+{
+	const rt_char8 *position = (const rt_char8*)data;
+	const rt_char8 *end = position + size;
+	rt_un64 accumulators[4];
+	rt_un64 hash;
+	rt_un32 value32;
+	rt_un i;
+
+	if (size >= 32) {
+		accumulators[0] = seed + ZZ_OBJECT_CACHE_PRIME1 + ZZ_OBJECT_CACHE_PRIME2;
+		accumulators[1] = seed + ZZ_OBJECT_CACHE_PRIME2;
+		accumulators[2] = seed;
+		accumulators[3] = seed - ZZ_OBJECT_CACHE_PRIME1;
+		while (end - position >= 32) {
+			for (i = 0; i < 4; i++)
+				accumulators[i] = zz_object_cache_round(accumulators[i], zz_object_cache_read64(&position[i * 8]));
+			position += 32;
+		}
+		hash = ZZ_OBJECT_CACHE_ROTATE(accumulators[0], 1) + ZZ_OBJECT_CACHE_ROTATE(accumulators[1], 7) +
+		       ZZ_OBJECT_CACHE_ROTATE(accumulators[2], 12) + ZZ_OBJECT_CACHE_ROTATE(accumulators[3], 18);
+		for (i = 0; i < 4; i++)
+			hash = zz_object_cache_merge_round(hash, accumulators[i]);
+	} else {
+		hash = seed + ZZ_OBJECT_CACHE_PRIME5;
+	}
+	hash += size;
+
+	while (end - position >= 8) {
+		hash ^= zz_object_cache_round(0, zz_object_cache_read64(position));
+		hash = ZZ_OBJECT_CACHE_ROTATE(hash, 27) * ZZ_OBJECT_CACHE_PRIME1 + ZZ_OBJECT_CACHE_PRIME4;
+		position += 8;
+	}
+	if (end - position >= 4) {
+		RT_MEMORY_COPY(position, &value32, sizeof(value32));
+		hash ^= value32 * ZZ_OBJECT_CACHE_PRIME1;
+		hash = ZZ_OBJECT_CACHE_ROTATE(hash, 23) * ZZ_OBJECT_CACHE_PRIME2 + ZZ_OBJECT_CACHE_PRIME3;
+		position += 4;
+	}
+	while (position < end) {
+		hash ^= (*position) * ZZ_OBJECT_CACHE_PRIME5;
+		hash = ZZ_OBJECT_CACHE_ROTATE(hash, 11) * ZZ_OBJECT_CACHE_PRIME1;
+		position++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= ZZ_OBJECT_CACHE_PRIME2;
+	hash ^= hash >> 29;
+	hash *= ZZ_OBJECT_CACHE_PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/**
+ * Append <tt>value</tt> as 16 hexadecimal digits.
+ */
+static rt_s zz_object_cache_append_hex(rt_un64 value, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_un digit;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < 16; i++) {
+		digit = (value >> (60 - i * 4)) & 0xF;
+		if (RT_UNLIKELY(!rt_char_append_char(digit < 10 ? _R('0') + digit : _R('a') + digit - 10, buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_object_cache_get_file_path(struct zz_object_cache *object_cache, const rt_char *name, rt_un name_size, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_s ret;
+
+	*buffer_size = 0;
+	if (RT_UNLIKELY(!rt_char_append(object_cache->directory_path, rt_char_get_size(object_cache->directory_path), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_file_path_append_separator(buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(name, name_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_object_cache_get_entry_path(struct zz_object_cache *object_cache, struct zz_object_cache_key *key, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_char name[ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1];
+	rt_un name_size = 0;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_object_cache_append_hex(key->high, name, ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1, &name_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_object_cache_append_hex(key->low, name, ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1, &name_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(_R(".o"), 2, name, ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1, &name_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_object_cache_get_file_path(object_cache, name, name_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_object_cache_link(const rt_char *existing_file_path, const rt_char *new_file_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return CreateHardLinkW(new_file_path, existing_file_path, RT_NULL);
+#else
+	return !link(existing_file_path, new_file_path);
+#endif
+}
+
+/**
+ * Replace <tt>destination_file_path</tt> atomically.
+ */
+static rt_s zz_object_cache_rename(const rt_char *source_file_path, const rt_char *destination_file_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return MoveFileExW(source_file_path, destination_file_path, MOVEFILE_REPLACE_EXISTING);
+#else
+	return !rename(source_file_path, destination_file_path);
+#endif
+}
+
+static rt_s zz_object_cache_delete_if_exists(const rt_char *file_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return DeleteFileW(file_path) || GetLastError() == ERROR_FILE_NOT_FOUND;
+#else
+	return !unlink(file_path) || errno == ENOENT;
+#endif
+}
+
+/**
+ * Mark an entry as recently used.
+ */
+static rt_s zz_object_cache_touch(const rt_char *file_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	HANDLE file_handle;
+	FILETIME now;
+	rt_s ret;
+
+	file_handle = CreateFileW(file_path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, RT_NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, RT_NULL);
+	if (RT_UNLIKELY(file_handle == INVALID_HANDLE_VALUE))
+		goto error;
+	GetSystemTimeAsFileTime(&now);
+	ret = SetFileTime(file_handle, RT_NULL, RT_NULL, &now);
+	if (RT_UNLIKELY(!CloseHandle(file_handle) && ret))
+		goto error;
+
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+#else
+	return !utime(file_path, RT_NULL);
+#endif
+}
+
+/**
+ * Identifies the process in the names of the temporary files.
+ */
+static rt_un zz_object_cache_get_process_id(void)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return GetCurrentProcessId();
+#else
+	return getpid();
+#endif
+}
+
+rt_s zz_object_cache_create(struct zz_object_cache *object_cache, struct zz_options *options, struct zz_code_generator_session *session, struct zz_profile *profile)
+{
+	rt_un8 optimization_level = (rt_un8)options->optimization_level;
+	rt_un8 reloc_mode = (rt_un8)session->llvm_reloc_mode;
+	rt_un8 code_model = (rt_un8)session->llvm_code_model;
+	rt_un64 hash;
+	rt_s ret;
+
+	object_cache->directory_path = options->cache_directory_path;
+	object_cache->max_size = options->cache_max_size;
+
+	/* Each item is hashed with its size, seeded by the previous ones, so that the items boundaries matter. */
+	hash = zz_object_cache_hash(ZZ_OBJECT_CACHE_VERSION, sizeof(ZZ_OBJECT_CACHE_VERSION) - 1, 0);
+	hash = zz_object_cache_hash(LLVM_VERSION_STRING, sizeof(LLVM_VERSION_STRING) - 1, hash);
+	hash = zz_object_cache_hash(session->llvm_triple, rt_char8_get_size(session->llvm_triple), hash);
+	hash = zz_object_cache_hash(session->llvm_cpu_name, rt_char8_get_size(session->llvm_cpu_name), hash);
+	hash = zz_object_cache_hash(session->llvm_cpu_features, rt_char8_get_size(session->llvm_cpu_features), hash);
+	hash = zz_object_cache_hash(&reloc_mode, sizeof(reloc_mode), hash);
+	hash = zz_object_cache_hash(&code_model, sizeof(code_model), hash);
+	hash = zz_object_cache_hash(&optimization_level, sizeof(optimization_level), hash);
+	if (options->passes)
+		hash = zz_object_cache_hash(options->passes, rt_char_get_size(options->passes) * sizeof(rt_char), hash);
+	else
+		hash = zz_object_cache_hash(RT_NULL, 0, hash);
+	/* The instrumented objects embed the path of the profile. */
+	if (options->profile_generate_file_path)
+		hash = zz_object_cache_hash(options->profile_generate_file_path, rt_char_get_size(options->profile_generate_file_path) * sizeof(rt_char), hash);
+	else
+		hash = zz_object_cache_hash(RT_NULL, 0, hash);
+	if (profile) {
+		hash = zz_object_cache_hash(profile->symbol_table.names, profile->symbol_table.names_size, hash);
+		hash = zz_object_cache_hash(profile->functions, profile->symbol_table.symbols_count * sizeof(struct zz_profile_function), hash);
+		hash = zz_object_cache_hash(profile->counters, profile->counters_count * sizeof(rt_un64), hash);
+	} else {
+		hash = zz_object_cache_hash(RT_NULL, 0, hash);
+	}
+	object_cache->configuration_hash = hash;
+
+	if (RT_UNLIKELY(!rt_file_system_create_dirs(object_cache->directory_path)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+void zz_object_cache_get_key(struct zz_object_cache *object_cache, const rt_char8 *source, rt_un source_size, struct zz_object_cache_key *key)
+{
+	key->low = zz_object_cache_hash(source, source_size, object_cache->configuration_hash);
+	key->high = zz_object_cache_hash(source, source_size, object_cache->configuration_hash ^ ZZ_OBJECT_CACHE_PRIME3);
+}
+
+rt_s zz_object_cache_restore(struct zz_object_cache *object_cache, struct zz_object_cache_key *key, const rt_char *output_file_path, rt_b *restored)
+{
+	rt_char entry_path[RT_FILE_PATH_SIZE];
+	rt_un entry_path_size;
+	rt_s ret;
+
+	*restored = RT_FALSE;
+
+	if (RT_UNLIKELY(!zz_object_cache_get_entry_path(object_cache, key, entry_path, RT_FILE_PATH_SIZE, &entry_path_size)))
+		goto error;
+
+	if (!rt_file_system_is_file(entry_path))
+		goto end;
+
+	if (RT_UNLIKELY(!zz_object_cache_delete_if_exists(output_file_path)))
+		goto error;
+
+	/* The entry may be evicted by another process at any time, the file is then compiled. */
+	if (zz_object_cache_link(entry_path, output_file_path) || rt_file_system_copy_file(entry_path, output_file_path, RT_TRUE)) {
+		/* The eviction order is best effort, there is no reason to fail the compilation. */
+		zz_object_cache_touch(entry_path);
+		*restored = RT_TRUE;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_object_cache_store(struct zz_object_cache *object_cache, struct zz_object_cache_key *key, const rt_char *output_file_path)
+{
+	rt_char entry_path[RT_FILE_PATH_SIZE];
+	rt_un entry_path_size;
+	rt_char temporary_path[RT_FILE_PATH_SIZE];
+	rt_un temporary_path_size;
+	rt_b temporary_created = RT_FALSE;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_object_cache_get_entry_path(object_cache, key, entry_path, RT_FILE_PATH_SIZE, &entry_path_size)))
+		goto error;
+
+	/* Linking is atomic and fails if another compilation has just added the same entry. */
+	if (zz_object_cache_link(output_file_path, entry_path))
+		goto end;
+
+	/* Otherwise, copy to a temporary file of this process and output, then rename it. */
+	temporary_path_size = entry_path_size;
+	RT_MEMORY_COPY(entry_path, temporary_path, (entry_path_size + 1) * sizeof(rt_char));
+	if (RT_UNLIKELY(!rt_char_append_char(_R('.'), temporary_path, RT_FILE_PATH_SIZE, &temporary_path_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_object_cache_append_hex(zz_object_cache_get_process_id() ^ zz_object_cache_hash(output_file_path, rt_char_get_size(output_file_path) * sizeof(rt_char), 0), temporary_path, RT_FILE_PATH_SIZE, &temporary_path_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(_R(".tmp"), 4, temporary_path, RT_FILE_PATH_SIZE, &temporary_path_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_file_system_copy_file(output_file_path, temporary_path, RT_TRUE)))
+		goto error;
+	temporary_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!zz_object_cache_rename(temporary_path, entry_path)))
+		goto error;
+	temporary_created = RT_FALSE;
+
+end:
+	ret = RT_OK;
+free:
+	if (temporary_created) {
+		temporary_created = RT_FALSE;
+		if (RT_UNLIKELY(!rt_file_system_delete_file(temporary_path) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_object_cache_add_entry(struct zz_object_cache_entry **entries, rt_un *entries_count, rt_un *entries_capacity, const rt_char *name, rt_un64 time, rt_un size, struct rt_heap *heap)
+{
+	struct zz_object_cache_entry *entry;
+	rt_un capacity;
+	rt_s ret;
+
+	if (*entries_count == *entries_capacity) {
+		capacity = *entries_capacity ? *entries_capacity * 2 : 256;
+		if (*entries) {
+			if (RT_UNLIKELY(!heap->realloc(heap, (void**)entries, capacity * sizeof(struct zz_object_cache_entry))))
+				goto error;
+		} else {
+			if (RT_UNLIKELY(!heap->alloc(heap, (void**)entries, capacity * sizeof(struct zz_object_cache_entry))))
+				goto error;
+		}
+		*entries_capacity = capacity;
+	}
+
+	entry = &(*entries)[(*entries_count)++];
+	entry->time = time;
+	entry->size = size;
+	RT_MEMORY_COPY(name, entry->name, (ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE + 1) * sizeof(rt_char));
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Entries are recognized by the size of their names, other files are ignored.
+ */
+static rt_b zz_object_cache_is_entry(const rt_char *name)
+{
+	rt_un name_size = rt_char_get_size(name);
+
+	return name_size == ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE && rt_char_ends_with(name, name_size, _R(".o"), 2);
+}
+
+#ifdef RT_DEFINE_WINDOWS
+
+static rt_s zz_object_cache_list_entries(struct zz_object_cache *object_cache, struct zz_object_cache_entry **entries, rt_un *entries_count, rt_un *entries_capacity, struct rt_heap *heap)
+{
+	rt_char pattern[RT_FILE_PATH_SIZE];
+	rt_un pattern_size;
+	WIN32_FIND_DATAW find_data;
+	HANDLE find_handle = INVALID_HANDLE_VALUE;
+	rt_un64 time;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_object_cache_get_file_path(object_cache, _R("*.o"), 3, pattern, RT_FILE_PATH_SIZE, &pattern_size)))
+		goto error;
+
+	find_handle = FindFirstFileW(pattern, &find_data);
+	if (find_handle == INVALID_HANDLE_VALUE) {
+		if (RT_UNLIKELY(GetLastError() != ERROR_FILE_NOT_FOUND))
+			goto error;
+		goto end;
+	}
+	do {
+		if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY || !zz_object_cache_is_entry(find_data.cFileName))
+			continue;
+		time = ((rt_un64)find_data.ftLastWriteTime.dwHighDateTime << 32) | find_data.ftLastWriteTime.dwLowDateTime;
+		if (RT_UNLIKELY(!zz_object_cache_add_entry(entries, entries_count, entries_capacity, find_data.cFileName, time, ((rt_un64)find_data.nFileSizeHigh << 32) | find_data.nFileSizeLow, heap)))
+			goto error;
+	} while (FindNextFileW(find_handle, &find_data));
+	if (RT_UNLIKELY(GetLastError() != ERROR_NO_MORE_FILES))
+		goto error;
+
+end:
+	ret = RT_OK;
+free:
+	if (find_handle != INVALID_HANDLE_VALUE) {
+		if (RT_UNLIKELY(!FindClose(find_handle) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#else
+
+static rt_s zz_object_cache_list_entries(struct zz_object_cache *object_cache, struct zz_object_cache_entry **entries, rt_un *entries_count, rt_un *entries_capacity, struct rt_heap *heap)
+{
+	rt_char file_path[RT_FILE_PATH_SIZE];
+	rt_un file_path_size;
+	struct stat file_status;
+	struct dirent *directory_entry;
+	DIR *directory;
+	DIR *directory_to_close;
+	rt_s ret;
+
+	directory = opendir(object_cache->directory_path);
+	if (RT_UNLIKELY(!directory))
+		goto error;
+
+	while (RT_TRUE) {
+		errno = 0;
+		directory_entry = readdir(directory);
+		if (!directory_entry) {
+			if (RT_UNLIKELY(errno))
+				goto error;
+			break;
+		}
+		if (!zz_object_cache_is_entry(directory_entry->d_name))
+			continue;
+
+		if (RT_UNLIKELY(!zz_object_cache_get_file_path(object_cache, directory_entry->d_name, ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE, file_path, RT_FILE_PATH_SIZE, &file_path_size)))
+			goto error;
+		/* Evicted by another process in the meantime. */
+		if (stat(file_path, &file_status) || !S_ISREG(file_status.st_mode))
+			continue;
+		if (RT_UNLIKELY(!zz_object_cache_add_entry(entries, entries_count, entries_capacity, directory_entry->d_name, file_status.st_mtime, file_status.st_size, heap)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (directory) {
+		directory_to_close = directory;
+		directory = RT_NULL;
+		if (RT_UNLIKELY(closedir(directory_to_close) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#endif
+
+static int zz_object_cache_compare_entries(const void *entry1, const void *entry2)
+{
+	rt_un64 time1 = ((const struct zz_object_cache_entry*)entry1)->time;
+	rt_un64 time2 = ((const struct zz_object_cache_entry*)entry2)->time;
+
+	return (time1 > time2) - (time1 < time2);
+}
+
+rt_s zz_object_cache_evict(struct zz_object_cache *object_cache, rt_un *evicted_count, struct rt_heap *heap)
+{
+	struct zz_object_cache_entry *entries = RT_NULL;
+	rt_un entries_count = 0;
+	rt_un entries_capacity = 0;
+	rt_char file_path[RT_FILE_PATH_SIZE];
+	rt_un file_path_size;
+	rt_un target_size;
+	rt_un size = 0;
+	rt_un i;
+	rt_s ret;
+
+	*evicted_count = 0;
+
+	if (RT_UNLIKELY(!zz_object_cache_list_entries(object_cache, &entries, &entries_count, &entries_capacity, heap)))
+		goto error;
+
+	for (i = 0; i < entries_count; i++)
+		size += entries[i].size;
+	if (size <= object_cache->max_size)
+		goto end;
+
+	/* Some room is made so that the next runs do not evict again right away. */
+	target_size = object_cache->max_size / 10 * 9;
+	qsort(entries, entries_count, sizeof(struct zz_object_cache_entry), &zz_object_cache_compare_entries);
+	for (i = 0; i < entries_count && size > target_size; i++) {
+		if (RT_UNLIKELY(!zz_object_cache_get_file_path(object_cache, entries[i].name, ZZ_OBJECT_CACHE_ENTRY_NAME_SIZE, file_path, RT_FILE_PATH_SIZE, &file_path_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_object_cache_delete_if_exists(file_path)))
+			goto error;
+		size -= entries[i].size;
+		(*evicted_count)++;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	if (entries && RT_UNLIKELY(!heap->free(heap, (void**)&entries) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -1,26 +1,151 @@
 #include "code_generator/zz_code_generator.h"
 
 #include "code_generator/zz_function_generator.h"
+#include "code_generator/zz_llvm_error.h"
+#include "code_generator/zz_profile_generator.h"
+#include "output/zz_output_file.h"
+#include "thread/zz_thread_pool.h"
 
-#include "llvm-c/Core.h"
-#include "llvm-c/Target.h"
-#include "llvm-c/TargetMachine.h"
+#include "llvm-c/BitReader.h"
+#include "llvm-c/BitWriter.h"
+#include "llvm-c/LLJIT.h"
+#include "llvm-c/Transforms/PassBuilder.h"
 
-static rt_s zz_code_generator_handle_llvm_error_message(rt_char8 *llvm_error)
+/* Signature of the main function of the sources. */
+typedef rt_n32 (*zz_code_generator_main_t)(void);
+
+/* Like the instructions limit of the ThinLTO function import. */
+#define ZZ_CODE_GENERATOR_IMPORT_LIMIT 100
+
+/**
+ * Default pipelines of a compilation, and of the compilation and link steps of <tt>--lto</tt>.
+ */
+enum zz_code_generator_pipeline {
+	ZZ_CODE_GENERATOR_PIPELINE_DEFAULT,
+	ZZ_CODE_GENERATOR_PIPELINE_LTO_PRE_LINK,
+	ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO_PRE_LINK,
+	ZZ_CODE_GENERATOR_PIPELINE_LTO,
+	ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO
+};
+
+static const rt_char8 *const zz_code_generator_pipelines[][ZZ_OPTIMIZATION_LEVEL_OS + 1] = {
+	[ZZ_CODE_GENERATOR_PIPELINE_DEFAULT] = {
+		[ZZ_OPTIMIZATION_LEVEL_O0] = "default<O0>",
+		[ZZ_OPTIMIZATION_LEVEL_O1] = "default<O1>",
+		[ZZ_OPTIMIZATION_LEVEL_O2] = "default<O2>",
+		[ZZ_OPTIMIZATION_LEVEL_O3] = "default<O3>",
+		[ZZ_OPTIMIZATION_LEVEL_OS] = "default<Os>"
+	},
+	[ZZ_CODE_GENERATOR_PIPELINE_LTO_PRE_LINK] = {
+		[ZZ_OPTIMIZATION_LEVEL_O0] = "lto-pre-link<O0>",
+		[ZZ_OPTIMIZATION_LEVEL_O1] = "lto-pre-link<O1>",
+		[ZZ_OPTIMIZATION_LEVEL_O2] = "lto-pre-link<O2>",
+		[ZZ_OPTIMIZATION_LEVEL_O3] = "lto-pre-link<O3>",
+		[ZZ_OPTIMIZATION_LEVEL_OS] = "lto-pre-link<Os>"
+	},
+	[ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO_PRE_LINK] = {
+		[ZZ_OPTIMIZATION_LEVEL_O0] = "thinlto-pre-link<O0>",
+		[ZZ_OPTIMIZATION_LEVEL_O1] = "thinlto-pre-link<O1>",
+		[ZZ_OPTIMIZATION_LEVEL_O2] = "thinlto-pre-link<O2>",
+		[ZZ_OPTIMIZATION_LEVEL_O3] = "thinlto-pre-link<O3>",
+		[ZZ_OPTIMIZATION_LEVEL_OS] = "thinlto-pre-link<Os>"
+	},
+	[ZZ_CODE_GENERATOR_PIPELINE_LTO] = {
+		[ZZ_OPTIMIZATION_LEVEL_O0] = "lto<O0>",
+		[ZZ_OPTIMIZATION_LEVEL_O1] = "lto<O1>",
+		[ZZ_OPTIMIZATION_LEVEL_O2] = "lto<O2>",
+		[ZZ_OPTIMIZATION_LEVEL_O3] = "lto<O3>",
+		[ZZ_OPTIMIZATION_LEVEL_OS] = "lto<Os>"
+	},
+	[ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO] = {
+		[ZZ_OPTIMIZATION_LEVEL_O0] = "thinlto<O0>",
+		[ZZ_OPTIMIZATION_LEVEL_O1] = "thinlto<O1>",
+		[ZZ_OPTIMIZATION_LEVEL_O2] = "thinlto<O2>",
+		[ZZ_OPTIMIZATION_LEVEL_O3] = "thinlto<O3>",
+		[ZZ_OPTIMIZATION_LEVEL_OS] = "thinlto<Os>"
+	}
+};
+
+/**
+ * A defined function of the program linked by <tt>--lto-link=thin</tt>.
+ */
+struct zz_code_generator_lto_function {
+	/* Unit that emits the function. */
+	rt_un partition;
+	rt_un instructions_count;
+};
+
+/**
+ * Part of the functions of a module, generated in its own context so that it can be optimized and emitted by another thread.
+ *
+ * <p>
+ * The other functions of the module are only declared in it.<br>
+ * The artifacts are kept in memory until all the units are built, then written by the calling thread.
+ * </p>
+ */
+struct zz_code_generator_unit {
+	/* The context of the session if there is a single unit. */
+	LLVMContextRef llvm_context;
+	rt_b llvm_context_owned;
+	LLVMModuleRef llvm_module;
+	/* The target machine of the session if there is a single unit. */
+	LLVMTargetMachineRef llvm_target_machine;
+	rt_b llvm_target_machine_owned;
+	rt_un first_function;
+	rt_un functions_count;
+	rt_char8 *llvm_ir;
+	LLVMMemoryBufferRef llvm_bitcode;
+	LLVMMemoryBufferRef llvm_assembly;
+	LLVMMemoryBufferRef llvm_object;
+	/* Errors of the build, added to the diagnostics by the calling thread. */
+	LLVMErrorRef llvm_error;
+	rt_char8 *llvm_error_message;
+	/* Null if the unit is built by another thread. */
+	struct zz_stats *stats;
+};
+
+struct zz_code_generator_build {
+	struct zz_code_generator_unit *units;
+	struct zz_options *options;
+	/* Pipeline to run on each unit, null to skip the passes. */
+	const rt_char8 *passes;
+	/* Program of <tt>--lto-link=thin</tt> that each unit parses, null otherwise. */
+	LLVMMemoryBufferRef llvm_bitcode;
+	/* Defined functions of <tt>llvm_bitcode</tt>, in the order of the module. */
+	struct zz_code_generator_lto_function *lto_functions;
+};
+
+/**
+ * Pipeline of <tt>--passes</tt> or the default one of the optimization level and of the <tt>--lto</tt> step, null if no passes must be run.<br>
+ * Nothing is run at <tt>-O0</tt> without <tt>--passes</tt>, the pipeline would only contain the always inliner.
+ *
+ * @param heap_buffer Pipelines can be long, the heap is used if needed. Must be freed by the caller.
+ */
+static rt_s zz_code_generator_get_passes(struct zz_options *options, rt_char8 *buffer, void **heap_buffer, rt_un *heap_buffer_capacity, struct rt_heap *heap, const rt_char8 **passes)
 {
+	enum zz_code_generator_pipeline pipeline;
+	rt_char8 *output;
+	rt_un output_size;
 	rt_s ret;
 
-	if (llvm_error) {
-		if (RT_UNLIKELY(!rt_console8_write_error(llvm_error, RT_ENCODING_SYSTEM_DEFAULT)))
-			goto error;
-		if (RT_UNLIKELY(!rt_console8_write_error("\n", RT_ENCODING_SYSTEM_DEFAULT)))
+	if (options->passes) {
+		if (RT_UNLIKELY(!rt_encoding_encode(options->passes, rt_char_get_size(options->passes), RT_ENCODING_SYSTEM_DEFAULT, buffer, RT_CHAR8_BIG_STRING_SIZE, heap_buffer, heap_buffer_capacity, &output, &output_size, heap)))
 			goto error;
+		*passes = output;
+	} else if (options->optimization_level == ZZ_OPTIMIZATION_LEVEL_O0) {
+		*passes = RT_NULL;
+	} else {
+		if (!options->lto)
+			pipeline = ZZ_CODE_GENERATOR_PIPELINE_DEFAULT;
+		else if (options->lto_link)
+			pipeline = (options->lto == ZZ_LTO_THIN) ? ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO : ZZ_CODE_GENERATOR_PIPELINE_LTO;
+		else
+			pipeline = (options->lto == ZZ_LTO_THIN) ? ZZ_CODE_GENERATOR_PIPELINE_THIN_LTO_PRE_LINK : ZZ_CODE_GENERATOR_PIPELINE_LTO_PRE_LINK;
+		*passes = zz_code_generator_pipelines[pipeline][options->optimization_level];
 	}
 
 	ret = RT_OK;
 free:
-	if (llvm_error)
-		LLVMDisposeMessage(llvm_error);
 	return ret;
 
 error:
@@ -28,53 +153,328 @@ error:
 	goto free;
 }
 
-static rt_s zz_code_generator_generate_do(struct zz_ast_node *root, rt_char *output_file_path, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder)
+/**
+ * Run <tt>passes</tt> with the new pass manager.<br>
+ * Does not use the diagnostics nor the heap so that it can be called by any thread.
+ *
+ * @param llvm_error Receives the error of LLVM, if any.
+ */
+static rt_s zz_code_generator_run_passes(LLVMModuleRef llvm_module, LLVMTargetMachineRef llvm_target_machine, const rt_char8 *passes, enum zz_optimization_level optimization_level, LLVMErrorRef *llvm_error)
 {
-	LLVMTargetRef target;
-	rt_char8 *llvm_error;
-	rt_char8 output_file_path8[RT_FILE_PATH_SIZE];
-	rt_un output_file_path8_size;
-	rt_char8 *output;
+	LLVMPassBuilderOptionsRef llvm_pass_builder_options;
 	rt_s ret;
 
-	/* TODO: For now, we assume that the root is a function. Later it will be a module. */
-	if (RT_UNLIKELY(!zz_function_generator_generate(root, llvm_context, llvm_module, llvm_builder)))
+	llvm_pass_builder_options = LLVMCreatePassBuilderOptions();
+
+	/* Same choices as clang. */
+	LLVMPassBuilderOptionsSetLoopVectorization(llvm_pass_builder_options, optimization_level == ZZ_OPTIMIZATION_LEVEL_O2 || optimization_level == ZZ_OPTIMIZATION_LEVEL_O3 || optimization_level == ZZ_OPTIMIZATION_LEVEL_OS);
+	LLVMPassBuilderOptionsSetSLPVectorization(llvm_pass_builder_options, optimization_level == ZZ_OPTIMIZATION_LEVEL_O2 || optimization_level == ZZ_OPTIMIZATION_LEVEL_O3 || optimization_level == ZZ_OPTIMIZATION_LEVEL_OS);
+	LLVMPassBuilderOptionsSetLoopUnrolling(llvm_pass_builder_options, optimization_level != ZZ_OPTIMIZATION_LEVEL_O0);
+
+	*llvm_error = LLVMRunPasses(llvm_module, passes, llvm_target_machine, llvm_pass_builder_options);
+	LLVMDisposePassBuilderOptions(llvm_pass_builder_options);
+	if (RT_UNLIKELY(*llvm_error)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
+	}
 
-	if (RT_UNLIKELY(LLVMInitializeNativeTarget())) {
-		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Declare all the functions of <tt>ast</tt> in <tt>llvm_module</tt>, then generate the <tt>functions_count</tt> ones from <tt>first_function</tt>.<br>
+ * Then add the counters of <tt>--profile-generate</tt>, or the counts of <tt>--profile-use</tt>, to the generated functions.
+ *
+ * @param profile Profile of <tt>--profile-use</tt>, can be null.
+ * @param llvm_functions Working array with an item per symbol.
+ */
+static rt_s zz_code_generator_generate_functions(struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, struct zz_options *options, rt_un first_function, rt_un functions_count, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder)
+{
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_function_generator_declare(ast, symbol_table, llvm_context, llvm_module, llvm_functions)))
 		goto error;
+
+	for (i = first_function; i < first_function + functions_count; i++) {
+		if (RT_UNLIKELY(!zz_function_generator_generate(ast, &ast->functions[i], llvm_functions, llvm_context, llvm_builder)))
+			goto error;
+	}
+
+	if (options->profile_generate_file_path) {
+		if (RT_UNLIKELY(!zz_profile_generator_instrument(llvm_context, llvm_module, llvm_builder, options->profile_generate_file_path, ast->heap)))
+			goto error;
+	} else if (profile) {
+		zz_profile_generator_annotate(llvm_context, llvm_module, profile);
 	}
-	if (RT_UNLIKELY(LLVMInitializeNativeAsmPrinter())) {
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_code_generator_emit_to_memory_buffer(struct zz_code_generator_unit *unit, LLVMModuleRef llvm_module, LLVMCodeGenFileType llvm_file_type, LLVMMemoryBufferRef *llvm_memory_buffer)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(LLVMTargetMachineEmitToMemoryBuffer(unit->llvm_target_machine, llvm_module, llvm_file_type, &unit->llvm_error_message, llvm_memory_buffer))) {
+		*llvm_memory_buffer = RT_NULL;
 		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
 		goto error;
 	}
 
-	if (RT_UNLIKELY(LLVMGetTargetFromTriple(LLVMGetDefaultTargetTriple(), &target, &llvm_error))) {
-		zz_code_generator_handle_llvm_error_message(llvm_error);
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Generate the artifacts of <tt>--emit</tt> in memory.
+ *
+ * <p>
+ * The IR artifacts are generated first, as the backend prepares the module in place.<br>
+ * When both are requested, the assembly is generated from a clone so that the object file comes from the original module.
+ * </p>
+ */
+static rt_s zz_code_generator_emit(struct zz_code_generator_unit *unit, struct zz_options *options)
+{
+	LLVMModuleRef llvm_clone = RT_NULL;
+	rt_s ret;
+
+	if (options->emit & ZZ_EMIT_LLVM_IR)
+		unit->llvm_ir = LLVMPrintModuleToString(unit->llvm_module);
+
+	if (options->emit & ZZ_EMIT_LLVM_BC)
+		unit->llvm_bitcode = LLVMWriteBitcodeToMemoryBuffer(unit->llvm_module);
+
+	if (options->emit & ZZ_EMIT_ASM) {
+		if (options->emit & ZZ_EMIT_OBJ)
+			llvm_clone = LLVMCloneModule(unit->llvm_module);
+		if (RT_UNLIKELY(!zz_code_generator_emit_to_memory_buffer(unit, llvm_clone ? llvm_clone : unit->llvm_module, LLVMAssemblyFile, &unit->llvm_assembly)))
+			goto error;
+	}
+
+	if (options->emit & ZZ_EMIT_OBJ) {
+		if (RT_UNLIKELY(!zz_code_generator_emit_to_memory_buffer(unit, unit->llvm_module, LLVMObjectFile, &unit->llvm_object)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (llvm_clone)
+		LLVMDisposeModule(llvm_clone);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_un zz_code_generator_count_instructions(LLVMValueRef llvm_function)
+{
+	LLVMBasicBlockRef llvm_block;
+	LLVMValueRef llvm_instruction;
+	rt_un result = 0;
+
+	for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+		for (llvm_instruction = LLVMGetFirstInstruction(llvm_block); llvm_instruction; llvm_instruction = LLVMGetNextInstruction(llvm_instruction))
+			result++;
+	}
+	return result;
+}
+
+/**
+ * Turn a function definition into a declaration.
+ *
+ * <p>
+ * The instructions can be used by other blocks and the blocks by the terminators, so the uses are removed first.
+ * </p>
+ */
+static void zz_code_generator_delete_body(LLVMValueRef llvm_function)
+{
+	LLVMBasicBlockRef llvm_block;
+	LLVMValueRef llvm_instruction;
+	LLVMTypeRef llvm_type;
+
+	for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+		for (llvm_instruction = LLVMGetFirstInstruction(llvm_block); llvm_instruction; llvm_instruction = LLVMGetNextInstruction(llvm_instruction)) {
+			llvm_type = LLVMTypeOf(llvm_instruction);
+			if (LLVMGetTypeKind(llvm_type) != LLVMVoidTypeKind)
+				LLVMReplaceAllUsesWith(llvm_instruction, LLVMGetUndef(llvm_type));
+		}
+	}
+	for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+		llvm_instruction = LLVMGetBasicBlockTerminator(llvm_block);
+		if (llvm_instruction)
+			LLVMInstructionEraseFromParent(llvm_instruction);
+	}
+	while ((llvm_block = LLVMGetFirstBasicBlock(llvm_function)))
+		LLVMDeleteBasicBlock(llvm_block);
+}
+
+/**
+ * Parse the program of <tt>--lto-link=thin</tt> in the context of the unit, then keep the definitions of its partition.
+ *
+ * <p>
+ * The small functions of the other partitions are kept as available externally, to be inlined but not emitted.<br>
+ * The others become declarations, resolved by the final link like the globals, that the first partition defines.
+ * </p>
+ */
+static rt_s zz_code_generator_import_partition(struct zz_code_generator_build *build, struct zz_code_generator_unit *unit, rt_un partition)
+{
+	struct zz_code_generator_lto_function *lto_function = build->lto_functions;
+	LLVMValueRef llvm_function;
+	LLVMValueRef llvm_global;
+	LLVMValueRef next_llvm_global;
+	rt_s ret;
+
+	if (RT_UNLIKELY(LLVMParseBitcodeInContext2(unit->llvm_context, build->llvm_bitcode, &unit->llvm_module))) {
+		unit->llvm_module = RT_NULL;
 		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
 		goto error;
 	}
 
-	LLVMTargetMachineRef target_machine = LLVMCreateTargetMachine(
-		target,
-		LLVMGetDefaultTargetTriple(),
-		LLVMGetHostCPUName(),
-		LLVMGetHostCPUFeatures(),
-		LLVMCodeGenLevelDefault,
-		LLVMRelocDefault,
-		LLVMCodeModelDefault
-	);
+	for (llvm_function = LLVMGetFirstFunction(unit->llvm_module); llvm_function; llvm_function = LLVMGetNextFunction(llvm_function)) {
+		if (LLVMIsDeclaration(llvm_function))
+			continue;
+		if (lto_function->partition != partition) {
+			if (lto_function->instructions_count <= ZZ_CODE_GENERATOR_IMPORT_LIMIT)
+				LLVMSetLinkage(llvm_function, LLVMAvailableExternallyLinkage);
+			else
+				zz_code_generator_delete_body(llvm_function);
+		}
+		lto_function++;
+	}
+
+	if (partition) {
+		for (llvm_global = LLVMGetFirstGlobal(unit->llvm_module); llvm_global; llvm_global = next_llvm_global) {
+			next_llvm_global = LLVMGetNextGlobal(llvm_global);
+			if (LLVMIsDeclaration(llvm_global))
+				continue;
+			/* The constructors must be registered once. */
+			if (LLVMGetLinkage(llvm_global) == LLVMAppendingLinkage)
+				LLVMDeleteGlobal(llvm_global);
+			/* The constants can still be folded. */
+			else if (LLVMIsGlobalConstant(llvm_global))
+				LLVMSetLinkage(llvm_global, LLVMAvailableExternallyLinkage);
+			else
+				LLVMSetInitializer(llvm_global, RT_NULL);
+		}
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Optimize then emit a unit, only touching the LLVM objects of the unit.
+ */
+static rt_s zz_code_generator_build_unit(struct zz_code_generator_build *build, struct zz_code_generator_unit *unit)
+{
+	struct zz_options *options = build->options;
+	struct zz_stats *stats = unit->stats;
+	rt_s ret;
+
+	if (build->llvm_bitcode) {
+		if (RT_UNLIKELY(!zz_code_generator_import_partition(build, unit, unit - build->units)))
+			goto error;
+	}
+
+	if (build->passes) {
+		if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_PASSES)))
+			goto error;
+		if (RT_UNLIKELY(!zz_code_generator_run_passes(unit->llvm_module, unit->llvm_target_machine, build->passes, options->optimization_level, &unit->llvm_error)))
+			goto error;
+		if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_PASSES)))
+			goto error;
+	}
+
+	/* The units are built by the calling thread with --trace. */
+	if (options->trace & ZZ_TRACE_IR)
+		LLVMDumpModule(unit->llvm_module);
 
-	LLVMSetModuleDataLayout(llvm_module, LLVMCreateTargetDataLayout(target_machine));
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_EMIT)))
+		goto error;
 
-	if (RT_UNLIKELY(!rt_encoding_encode(output_file_path, rt_char_get_size(output_file_path), RT_ENCODING_SYSTEM_DEFAULT, output_file_path8, RT_FILE_PATH_SIZE, RT_NULL, RT_NULL, &output, &output_file_path8_size, RT_NULL)))
+	if (RT_UNLIKELY(!zz_code_generator_emit(unit, options)))
 		goto error;
 
-	if (RT_UNLIKELY(LLVMTargetMachineEmitToFile(target_machine, llvm_module, output_file_path8, LLVMObjectFile, &llvm_error))) {
-		zz_code_generator_handle_llvm_error_message(llvm_error);
-		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_EMIT)))
 		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Build units until there is none left, a failed unit does not stop the others.
+ */
+static rt_s zz_code_generator_worker_callback(struct zz_thread_pool *thread_pool, rt_un worker_index)
+{
+	struct zz_code_generator_build *build = (struct zz_code_generator_build*)thread_pool->context;
+	rt_un unit;
+	rt_s ret = RT_OK;
+
+	(void)worker_index;
+
+	while (RT_TRUE) {
+		if (RT_UNLIKELY(!zz_thread_pool_take_task(thread_pool, &unit)))
+			goto error;
+		if (unit == RT_TYPE_MAX_UN)
+			break;
+		if (RT_UNLIKELY(!zz_code_generator_build_unit(build, &build->units[unit])))
+			ret = RT_FAILED;
+	}
+
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write the artifact of kind <tt>emit</tt> at the path derived from <tt>input_file_path</tt>, or to the standard output.
+ */
+static rt_s zz_code_generator_write(const rt_char *input_file_path, struct zz_options *options, enum zz_emit emit, rt_un partition, const rt_char8 *data, rt_un data_size)
+{
+	rt_char output_file_path[RT_FILE_PATH_SIZE];
+	rt_un output_file_path_size;
+	rt_s ret;
+
+	if (options->standard_output) {
+		if (RT_UNLIKELY(!zz_output_file_write(RT_NULL, data, data_size)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_output_file_get_path(input_file_path, options, emit, partition, output_file_path, RT_FILE_PATH_SIZE, &output_file_path_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_output_file_write(output_file_path, data, data_size)))
+			goto error;
 	}
 
 	ret = RT_OK;
@@ -86,32 +486,638 @@ error:
 	goto free;
 }
 
-rt_s zz_code_generator_generate(struct zz_ast_node *root, rt_char *output_file_path)
+/**
+ * Write the artifacts of the units, each with a single write.
+ */
+static rt_s zz_code_generator_write_units(struct zz_code_generator_unit *units, rt_un units_count, const rt_char *input_file_path, struct zz_options *options)
 {
-	LLVMContextRef llvm_context;
-	LLVMModuleRef llvm_module;
-	LLVMBuilderRef llvm_builder;
+	struct zz_code_generator_unit *unit;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < units_count; i++) {
+		unit = &units[i];
+		if (unit->llvm_ir) {
+			if (RT_UNLIKELY(!zz_code_generator_write(input_file_path, options, ZZ_EMIT_LLVM_IR, i, unit->llvm_ir, rt_char8_get_size(unit->llvm_ir))))
+				goto error;
+		}
+		if (unit->llvm_bitcode) {
+			if (RT_UNLIKELY(!zz_code_generator_write(input_file_path, options, ZZ_EMIT_LLVM_BC, i, LLVMGetBufferStart(unit->llvm_bitcode), LLVMGetBufferSize(unit->llvm_bitcode))))
+				goto error;
+		}
+		if (unit->llvm_assembly) {
+			if (RT_UNLIKELY(!zz_code_generator_write(input_file_path, options, ZZ_EMIT_ASM, i, LLVMGetBufferStart(unit->llvm_assembly), LLVMGetBufferSize(unit->llvm_assembly))))
+				goto error;
+		}
+		if (unit->llvm_object) {
+			if (RT_UNLIKELY(!zz_code_generator_write(input_file_path, options, ZZ_EMIT_OBJ, i, LLVMGetBufferStart(unit->llvm_object), LLVMGetBufferSize(unit->llvm_object))))
+				goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Split the functions in <tt>units_count</tt> ranges with about the same number of nodes, then generate the module of each unit.
+ *
+ * <p>
+ * With a single unit, the context and the target machine of the session are used.
+ * </p>
+ */
+static rt_s zz_code_generator_create_units(struct zz_code_generator_session *session, struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, struct zz_options *options, struct zz_code_generator_unit *units, rt_un units_count, LLVMValueRef *llvm_functions, struct zz_stats *stats)
+{
+	struct zz_code_generator_unit *unit;
+	LLVMBuilderRef llvm_builder = RT_NULL;
+	rt_un function = 0;
+	rt_un nodes_limit;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < units_count; i++) {
+		unit = &units[i];
+
+		/* The unit ends once it reaches its share of the nodes, keeping a function for each following unit. */
+		unit->first_function = function;
+		nodes_limit = (rt_un)((rt_un64)ast->nodes_count * (i + 1) / units_count);
+		do {
+			function++;
+		} while (function < ast->functions_count - (units_count - i - 1) && ast->functions[function].first_node < nodes_limit);
+		if (i == units_count - 1)
+			function = ast->functions_count;
+		unit->functions_count = function - unit->first_function;
+
+		if (units_count == 1) {
+			unit->llvm_context = session->llvm_context;
+			unit->llvm_target_machine = session->llvm_target_machine;
+			unit->stats = stats;
+			llvm_builder = session->llvm_builder;
+		} else {
+			unit->llvm_context = LLVMContextCreate();
+			unit->llvm_context_owned = RT_TRUE;
+			if (RT_UNLIKELY(!zz_code_generator_session_create_target_machine(session, session->llvm_reloc_mode, &unit->llvm_target_machine)))
+				goto error;
+			unit->llvm_target_machine_owned = RT_TRUE;
+			llvm_builder = LLVMCreateBuilderInContext(unit->llvm_context);
+		}
+
+		zz_code_generator_session_create_module(session, unit->llvm_context, "stc_module", &unit->llvm_module);
+		if (RT_UNLIKELY(!zz_code_generator_generate_functions(ast, symbol_table, profile, options, unit->first_function, unit->functions_count, llvm_functions, unit->llvm_context, unit->llvm_module, llvm_builder)))
+			goto error;
+
+		if (units_count > 1) {
+			LLVMDisposeBuilder(llvm_builder);
+			llvm_builder = RT_NULL;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	if (llvm_builder && units_count > 1)
+		LLVMDisposeBuilder(llvm_builder);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static void zz_code_generator_free_units(struct zz_code_generator_unit *units, rt_un units_count)
+{
+	struct zz_code_generator_unit *unit;
+	rt_un i;
+
+	for (i = 0; i < units_count; i++) {
+		unit = &units[i];
+		if (unit->llvm_error)
+			LLVMConsumeError(unit->llvm_error);
+		if (unit->llvm_error_message)
+			LLVMDisposeMessage(unit->llvm_error_message);
+		if (unit->llvm_object)
+			LLVMDisposeMemoryBuffer(unit->llvm_object);
+		if (unit->llvm_assembly)
+			LLVMDisposeMemoryBuffer(unit->llvm_assembly);
+		if (unit->llvm_bitcode)
+			LLVMDisposeMemoryBuffer(unit->llvm_bitcode);
+		if (unit->llvm_ir)
+			LLVMDisposeMessage(unit->llvm_ir);
+		if (unit->llvm_module)
+			LLVMDisposeModule(unit->llvm_module);
+		if (unit->llvm_target_machine_owned)
+			LLVMDisposeTargetMachine(unit->llvm_target_machine);
+		if (unit->llvm_context_owned)
+			LLVMContextDispose(unit->llvm_context);
+	}
+}
+
+/**
+ * Add the errors of the units to the diagnostics.
+ */
+static rt_s zz_code_generator_add_unit_errors(struct zz_code_generator_unit *units, rt_un units_count, struct zz_diagnostics *diagnostics)
+{
+	struct zz_code_generator_unit *unit;
+	rt_un i;
+	rt_s ret = RT_OK;
+
+	for (i = 0; i < units_count; i++) {
+		unit = &units[i];
+		if (unit->llvm_error) {
+			if (RT_UNLIKELY(!zz_llvm_error_add(diagnostics, unit->llvm_error)))
+				ret = RT_FAILED;
+			unit->llvm_error = RT_NULL;
+		}
+		if (unit->llvm_error_message) {
+			if (RT_UNLIKELY(!zz_llvm_error_add_message(diagnostics, unit->llvm_error_message)))
+				ret = RT_FAILED;
+			unit->llvm_error_message = RT_NULL;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Build a single unit on the calling thread or several ones in parallel, then write their artifacts.
+ *
+ * <p>
+ * With several units, the passes and the backend run in the emit phase of the statistics.
+ * </p>
+ */
+static rt_s zz_code_generator_build_units(struct zz_code_generator_build *build, rt_un units_count, const rt_char *input_file_path, struct zz_stats *stats, struct rt_heap *heap)
+{
+	struct zz_options *options = build->options;
+	struct zz_thread_pool thread_pool;
+	rt_un workers_count;
+	rt_s ret;
+
+	if (units_count == 1) {
+		if (RT_UNLIKELY(!zz_code_generator_build_unit(build, &build->units[0])))
+			goto error;
+	} else {
+		if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_EMIT)))
+			goto error;
+
+		/* The traces must not be interleaved. */
+		workers_count = (options->trace & ZZ_TRACE_IR) ? 1 : zz_thread_pool_get_processors_count();
+		if (workers_count > units_count)
+			workers_count = units_count;
+		if (RT_UNLIKELY(!zz_thread_pool_run(&thread_pool, workers_count, units_count, &zz_code_generator_worker_callback, build, heap))) {
+			/* The errors of the workers are not visible from this thread. */
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			goto error;
+		}
+
+		if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_EMIT)))
+			goto error;
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_EMIT)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_code_generator_write_units(build->units, units_count, input_file_path, options)))
+		goto error;
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_EMIT)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Generate the units, then build them.
+ */
+static rt_s zz_code_generator_generate_units(struct zz_code_generator_session *session, struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats)
+{
+	struct rt_heap *heap = ast->heap;
+	struct zz_code_generator_build build;
+	struct zz_code_generator_unit *units = RT_NULL;
+	rt_un units_count;
+	LLVMValueRef *llvm_functions = RT_NULL;
+	rt_char8 passes_buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *passes_heap_buffer = RT_NULL;
+	rt_un passes_heap_buffer_capacity = 0;
+	rt_s ret;
+
+	units_count = options->codegen_units;
+	if (units_count > ast->functions_count)
+		units_count = ast->functions_count ? ast->functions_count : 1;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&units, units_count * sizeof(struct zz_code_generator_unit))))
+		goto error;
+	RT_MEMORY_ZERO(units, units_count * sizeof(struct zz_code_generator_unit));
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&llvm_functions, (symbol_table->symbols_count ? symbol_table->symbols_count : 1) * sizeof(LLVMValueRef))))
+		goto error;
+
+	build.units = units;
+	build.options = options;
+	build.llvm_bitcode = RT_NULL;
+	build.lto_functions = RT_NULL;
+	if (RT_UNLIKELY(!zz_code_generator_get_passes(options, passes_buffer, &passes_heap_buffer, &passes_heap_buffer_capacity, heap, &build.passes)))
+		goto error;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_code_generator_create_units(session, ast, symbol_table, profile, options, units, units_count, llvm_functions, stats)))
+		goto error;
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_code_generator_build_units(&build, units_count, input_file_path, stats, heap)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (units) {
+		if (RT_UNLIKELY(!zz_code_generator_add_unit_errors(units, units_count, diagnostics) && ret))
+			goto error;
+		zz_code_generator_free_units(units, units_count);
+		if (RT_UNLIKELY(!heap->free(heap, (void**)&units) && ret))
+			goto error;
+	}
+	if (llvm_functions && RT_UNLIKELY(!heap->free(heap, (void**)&llvm_functions) && ret))
+		goto error;
+	if (passes_heap_buffer && RT_UNLIKELY(!heap->free(heap, &passes_heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_b zz_code_generator_is_main(LLVMValueRef llvm_global)
+{
+	const rt_char8 *name;
+	size_t name_size;
+
+	name = LLVMGetValueName2(llvm_global, &name_size);
+	return rt_char8_equals(name, name_size, "main", 4);
+}
+
+/**
+ * The whole program is known, nothing but <tt>main</tt> can reference its functions and globals.<br>
+ * Once internal, they can be inlined then removed, or optimized for their callers.
+ */
+static void zz_code_generator_internalize(LLVMModuleRef llvm_module)
+{
+	LLVMValueRef llvm_global;
+
+	for (llvm_global = LLVMGetFirstFunction(llvm_module); llvm_global; llvm_global = LLVMGetNextFunction(llvm_global)) {
+		if (!LLVMIsDeclaration(llvm_global) && !zz_code_generator_is_main(llvm_global)) {
+			LLVMSetLinkage(llvm_global, LLVMInternalLinkage);
+			LLVMSetVisibility(llvm_global, LLVMDefaultVisibility);
+		}
+	}
+	for (llvm_global = LLVMGetFirstGlobal(llvm_module); llvm_global; llvm_global = LLVMGetNextGlobal(llvm_global)) {
+		/* Like the constructors of --profile-generate, the appending globals are read by the linker. */
+		if (!LLVMIsDeclaration(llvm_global) && LLVMGetLinkage(llvm_global) != LLVMAppendingLinkage) {
+			LLVMSetLinkage(llvm_global, LLVMInternalLinkage);
+			LLVMSetVisibility(llvm_global, LLVMDefaultVisibility);
+		}
+	}
+}
+
+/**
+ * Local functions and globals may be referenced from other partitions, they become hidden external ones.
+ */
+static void zz_code_generator_promote(LLVMValueRef llvm_global)
+{
+	LLVMLinkage llvm_linkage = LLVMGetLinkage(llvm_global);
+
+	if (llvm_linkage == LLVMInternalLinkage || llvm_linkage == LLVMPrivateLinkage) {
+		LLVMSetLinkage(llvm_global, LLVMExternalLinkage);
+		LLVMSetVisibility(llvm_global, LLVMHiddenVisibility);
+	}
+}
+
+/**
+ * Split the defined functions in contiguous partitions with about the same number of instructions, keeping a function for each following partition.
+ */
+static void zz_code_generator_split_program(LLVMModuleRef llvm_module, struct zz_code_generator_lto_function *lto_functions, rt_un functions_count, rt_un partitions_count)
+{
+	LLVMValueRef llvm_global;
+	rt_un64 instructions_count = 0;
+	rt_un64 previous_instructions_count = 0;
+	rt_un partition = 0;
+	rt_un partition_functions_count = 0;
+	rt_un i = 0;
+
+	for (llvm_global = LLVMGetFirstFunction(llvm_module); llvm_global; llvm_global = LLVMGetNextFunction(llvm_global)) {
+		if (LLVMIsDeclaration(llvm_global))
+			continue;
+		zz_code_generator_promote(llvm_global);
+		lto_functions[i].instructions_count = zz_code_generator_count_instructions(llvm_global);
+		instructions_count += lto_functions[i].instructions_count;
+		i++;
+	}
+	for (llvm_global = LLVMGetFirstGlobal(llvm_module); llvm_global; llvm_global = LLVMGetNextGlobal(llvm_global))
+		zz_code_generator_promote(llvm_global);
+
+	for (i = 0; i < functions_count; i++) {
+		if (partition_functions_count && partition < partitions_count - 1 &&
+		    (previous_instructions_count >= instructions_count * (partition + 1) / partitions_count || functions_count - i == partitions_count - 1 - partition)) {
+			partition++;
+			partition_functions_count = 0;
+		}
+		lto_functions[i].partition = partition;
+		partition_functions_count++;
+		previous_instructions_count += lto_functions[i].instructions_count;
+	}
+}
+
+static rt_un zz_code_generator_count_definitions(LLVMModuleRef llvm_module)
+{
+	LLVMValueRef llvm_function;
+	rt_un result = 0;
+
+	for (llvm_function = LLVMGetFirstFunction(llvm_module); llvm_function; llvm_function = LLVMGetNextFunction(llvm_function)) {
+		if (!LLVMIsDeclaration(llvm_function))
+			result++;
+	}
+	return result;
+}
+
+rt_s zz_code_generator_generate_linked(struct zz_code_generator_session *session, LLVMModuleRef llvm_module, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, struct rt_heap *heap)
+{
+	struct zz_code_generator_build build;
+	struct zz_code_generator_unit *units = RT_NULL;
+	rt_un units_count = 1;
+	rt_un functions_count = 0;
+	rt_char8 passes_buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *passes_heap_buffer = RT_NULL;
+	rt_un passes_heap_buffer_capacity = 0;
+	struct zz_code_generator_unit *unit;
+	rt_un i;
+	rt_s ret;
+
+	build.units = RT_NULL;
+	build.options = options;
+	build.llvm_bitcode = RT_NULL;
+	build.lto_functions = RT_NULL;
+	if (RT_UNLIKELY(!zz_code_generator_get_passes(options, passes_buffer, &passes_heap_buffer, &passes_heap_buffer_capacity, heap, &build.passes)))
+		goto error;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+		goto error;
+
+	if (options->lto == ZZ_LTO_THIN) {
+		functions_count = zz_code_generator_count_definitions(llvm_module);
+		units_count = options->jobs ? options->jobs : zz_thread_pool_get_processors_count();
+		if (units_count > functions_count)
+			units_count = functions_count ? functions_count : 1;
+	}
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&units, units_count * sizeof(struct zz_code_generator_unit))))
+		goto error;
+	RT_MEMORY_ZERO(units, units_count * sizeof(struct zz_code_generator_unit));
+	build.units = units;
+
+	if (units_count == 1) {
+		if (options->lto == ZZ_LTO_FULL)
+			zz_code_generator_internalize(llvm_module);
+		units[0].llvm_context = session->llvm_context;
+		units[0].llvm_module = llvm_module;
+		llvm_module = RT_NULL;
+		units[0].llvm_target_machine = session->llvm_target_machine;
+		units[0].stats = stats;
+	} else {
+		/* Each unit parses the whole program in its own context, by its own thread. */
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)&build.lto_functions, functions_count * sizeof(struct zz_code_generator_lto_function))))
+			goto error;
+		zz_code_generator_split_program(llvm_module, build.lto_functions, functions_count, units_count);
+		build.llvm_bitcode = LLVMWriteBitcodeToMemoryBuffer(llvm_module);
+		LLVMDisposeModule(llvm_module);
+		llvm_module = RT_NULL;
+
+		for (i = 0; i < units_count; i++) {
+			unit = &units[i];
+			unit->llvm_context = LLVMContextCreate();
+			unit->llvm_context_owned = RT_TRUE;
+			if (RT_UNLIKELY(!zz_code_generator_session_create_target_machine(session, session->llvm_reloc_mode, &unit->llvm_target_machine)))
+				goto error;
+			unit->llvm_target_machine_owned = RT_TRUE;
+		}
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_code_generator_build_units(&build, units_count, input_file_path, stats, heap)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (units) {
+		if (RT_UNLIKELY(!zz_code_generator_add_unit_errors(units, units_count, diagnostics) && ret))
+			goto error;
+		zz_code_generator_free_units(units, units_count);
+		if (RT_UNLIKELY(!heap->free(heap, (void**)&units) && ret))
+			goto error;
+	}
+	if (build.llvm_bitcode) {
+		LLVMDisposeMemoryBuffer(build.llvm_bitcode);
+		build.llvm_bitcode = RT_NULL;
+	}
+	if (build.lto_functions && RT_UNLIKELY(!heap->free(heap, (void**)&build.lto_functions) && ret))
+		goto error;
+	if (llvm_module) {
+		LLVMDisposeModule(llvm_module);
+		llvm_module = RT_NULL;
+	}
+	if (passes_heap_buffer && RT_UNLIKELY(!heap->free(heap, &passes_heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Give the module to an ORC LLJIT, then call its <tt>main</tt> function.
+ *
+ * <p>
+ * The JIT has its own target machine, with the settings of the session but position independent code.<br>
+ * The symbols of the process, like the C library, are visible to the JIT-compiled code.
+ * </p>
+ *
+ * @param llvm_module Owned by the JIT, set to null.
+ */
+static rt_s zz_code_generator_execute(struct zz_code_generator_session *session, LLVMModuleRef *llvm_module, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code)
+{
+	LLVMTargetMachineRef llvm_target_machine = RT_NULL;
+	LLVMOrcLLJITBuilderRef llvm_jit_builder;
+	LLVMOrcLLJITRef llvm_jit = RT_NULL;
+	LLVMOrcDefinitionGeneratorRef llvm_generator;
+	LLVMOrcJITDylibRef llvm_dylib;
+	LLVMOrcThreadSafeModuleRef llvm_thread_safe_module;
+	LLVMOrcExecutorAddress address;
+	zz_code_generator_main_t main_function;
+	LLVMErrorRef llvm_error;
 	rt_s ret;
 
-	llvm_context = LLVMContextCreate();
-	llvm_module = LLVMModuleCreateWithName("stc_module");
-	llvm_builder = LLVMCreateBuilderInContext(llvm_context);
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_EMIT)))
+		goto error;
 
-	if (RT_UNLIKELY(!zz_code_generator_generate_do(root, output_file_path, llvm_context, llvm_module, llvm_builder)))
+	if (RT_UNLIKELY(!zz_code_generator_session_create_target_machine(session, LLVMRelocPIC, &llvm_target_machine)))
 		goto error;
 
-	/* TODO: Temporary. Maybe I should add a flag parameter so that the IR can be displayed or put in a file. */
-	LLVMDumpModule(llvm_module);
+	/* The builder owns the target machine, the JIT owns the builder. */
+	llvm_jit_builder = LLVMOrcCreateLLJITBuilder();
+	LLVMOrcLLJITBuilderSetJITTargetMachineBuilder(llvm_jit_builder, LLVMOrcJITTargetMachineBuilderCreateFromTargetMachine(llvm_target_machine));
+	llvm_target_machine = RT_NULL;
+	llvm_error = LLVMOrcCreateLLJIT(&llvm_jit, llvm_jit_builder);
+	if (RT_UNLIKELY(llvm_error)) {
+		llvm_jit = RT_NULL;
+		zz_llvm_error_add(diagnostics, llvm_error);
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+	llvm_dylib = LLVMOrcLLJITGetMainJITDylib(llvm_jit);
+
+	llvm_error = LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(&llvm_generator, LLVMOrcLLJITGetGlobalPrefix(llvm_jit), RT_NULL, RT_NULL);
+	if (RT_UNLIKELY(llvm_error)) {
+		zz_llvm_error_add(diagnostics, llvm_error);
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+	LLVMOrcJITDylibAddGenerator(llvm_dylib, llvm_generator);
+
+	/* The JIT owns the module, even on failure. */
+	llvm_thread_safe_module = LLVMOrcCreateNewThreadSafeModule(*llvm_module, session->llvm_thread_safe_context);
+	*llvm_module = RT_NULL;
+	llvm_error = LLVMOrcLLJITAddLLVMIRModule(llvm_jit, llvm_dylib, llvm_thread_safe_module);
+	if (RT_UNLIKELY(llvm_error)) {
+		zz_llvm_error_add(diagnostics, llvm_error);
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+
+	/* Compiles the module. */
+	llvm_error = LLVMOrcLLJITLookup(llvm_jit, &address, "main");
+	if (RT_UNLIKELY(llvm_error)) {
+		zz_llvm_error_add(diagnostics, llvm_error);
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_EMIT)))
+			goto error;
+		if (RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_RUN)))
+			goto error;
+	}
+
+	main_function = (zz_code_generator_main_t)(rt_un)address;
+	*exit_code = main_function();
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_RUN)))
+		goto error;
 
 	ret = RT_OK;
 free:
-	LLVMDisposeBuilder(llvm_builder);
-	LLVMDisposeModule(llvm_module);
-	LLVMContextDispose(llvm_context);
+	if (llvm_jit) {
+		llvm_error = LLVMOrcDisposeLLJIT(llvm_jit);
+		llvm_jit = RT_NULL;
+		if (RT_UNLIKELY(llvm_error)) {
+			zz_llvm_error_add(diagnostics, llvm_error);
+			if (ret) {
+				rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+				goto error;
+			}
+		}
+	}
+	if (llvm_target_machine)
+		LLVMDisposeTargetMachine(llvm_target_machine);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Generate the whole module in the context of the session, then run it with the JIT.
+ */
+static rt_s zz_code_generator_generate_and_execute(struct zz_code_generator_session *session, struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code)
+{
+	struct rt_heap *heap = ast->heap;
+	LLVMModuleRef llvm_module = RT_NULL;
+	LLVMValueRef *llvm_functions = RT_NULL;
+	rt_char8 passes_buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *passes_heap_buffer = RT_NULL;
+	rt_un passes_heap_buffer_capacity = 0;
+	const rt_char8 *passes;
+	LLVMErrorRef llvm_error;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&llvm_functions, (symbol_table->symbols_count ? symbol_table->symbols_count : 1) * sizeof(LLVMValueRef))))
+		goto error;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+		goto error;
+
+	zz_code_generator_session_create_module(session, session->llvm_context, "stc_module", &llvm_module);
+	if (RT_UNLIKELY(!zz_code_generator_generate_functions(ast, symbol_table, profile, options, 0, ast->functions_count, llvm_functions, session->llvm_context, llvm_module, session->llvm_builder)))
+		goto error;
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_CODEGEN)))
+			goto error;
+		if (RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_PASSES)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_code_generator_get_passes(options, passes_buffer, &passes_heap_buffer, &passes_heap_buffer_capacity, heap, &passes)))
+		goto error;
+	if (passes && RT_UNLIKELY(!zz_code_generator_run_passes(llvm_module, session->llvm_target_machine, passes, options->optimization_level, &llvm_error))) {
+		zz_llvm_error_add(diagnostics, llvm_error);
+		goto error;
+	}
 
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_PASSES)))
+		goto error;
+
+	if (options->trace & ZZ_TRACE_IR)
+		LLVMDumpModule(llvm_module);
+
+	if (RT_UNLIKELY(!zz_code_generator_execute(session, &llvm_module, diagnostics, stats, exit_code)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (llvm_module)
+		LLVMDisposeModule(llvm_module);
+	if (llvm_functions && RT_UNLIKELY(!heap->free(heap, (void**)&llvm_functions) && ret))
+		goto error;
+	if (passes_heap_buffer && RT_UNLIKELY(!heap->free(heap, &passes_heap_buffer) && ret))
+		goto error;
 	return ret;
 
 error:
 	ret = RT_FAILED;
 	goto free;
 }
+
+rt_s zz_code_generator_generate(struct zz_code_generator_session *session, struct zz_ast *ast, struct zz_symbol_table *symbol_table, struct zz_profile *profile, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code)
+{
+	if (options->run)
+		return zz_code_generator_generate_and_execute(session, ast, symbol_table, profile, options, diagnostics, stats, exit_code);
+	else
+		return zz_code_generator_generate_units(session, ast, symbol_table, profile, input_file_path, options, diagnostics, stats);
+}
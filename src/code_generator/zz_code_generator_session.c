@@ -0,0 +1,346 @@
+#include "code_generator/zz_code_generator_session.h"
+
+#include "code_generator/zz_llvm_error.h"
+
+static const LLVMCodeGenOptLevel zz_code_generator_session_codegen_levels[] = {
+	[ZZ_OPTIMIZATION_LEVEL_O0] = LLVMCodeGenLevelNone,
+	[ZZ_OPTIMIZATION_LEVEL_O1] = LLVMCodeGenLevelLess,
+	[ZZ_OPTIMIZATION_LEVEL_O2] = LLVMCodeGenLevelDefault,
+	[ZZ_OPTIMIZATION_LEVEL_O3] = LLVMCodeGenLevelAggressive,
+	[ZZ_OPTIMIZATION_LEVEL_OS] = LLVMCodeGenLevelDefault
+};
+
+static const LLVMRelocMode zz_code_generator_session_reloc_modes[] = {
+	[ZZ_RELOC_DEFAULT] = LLVMRelocDefault,
+	[ZZ_RELOC_STATIC] = LLVMRelocStatic,
+	[ZZ_RELOC_PIC] = LLVMRelocPIC
+};
+
+static const LLVMCodeModel zz_code_generator_session_code_models[] = {
+	[ZZ_CODE_MODEL_DEFAULT] = LLVMCodeModelDefault,
+	[ZZ_CODE_MODEL_TINY] = LLVMCodeModelTiny,
+	[ZZ_CODE_MODEL_SMALL] = LLVMCodeModelSmall,
+	[ZZ_CODE_MODEL_KERNEL] = LLVMCodeModelKernel,
+	[ZZ_CODE_MODEL_MEDIUM] = LLVMCodeModelMedium,
+	[ZZ_CODE_MODEL_LARGE] = LLVMCodeModelLarge
+};
+
+/**
+ * The backend optimizes according to the optimization level.
+ */
+rt_s zz_code_generator_session_create_target_machine(struct zz_code_generator_session *session, LLVMRelocMode llvm_reloc_mode, LLVMTargetMachineRef *llvm_target_machine)
+{
+	rt_s ret;
+
+	*llvm_target_machine = LLVMCreateTargetMachine(
+		session->llvm_target,
+		session->llvm_triple,
+		session->llvm_cpu_name,
+		session->llvm_cpu_features,
+		zz_code_generator_session_codegen_levels[session->optimization_level],
+		llvm_reloc_mode,
+		session->llvm_code_model
+	);
+	if (RT_UNLIKELY(!*llvm_target_machine)) {
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Copy <tt>option</tt> into a string to be disposed with <tt>LLVMDisposeMessage</tt>, like the ones returned by LLVM.
+ *
+ * @param prefix If not null nor empty, followed by a comma then by <tt>option</tt> in the copy.
+ */
+static rt_s zz_code_generator_session_copy_option(const rt_char *option, const rt_char8 *prefix, struct rt_heap *heap, rt_char8 **llvm_message)
+{
+	rt_char8 buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *heap_buffer = RT_NULL;
+	rt_un heap_buffer_capacity = 0;
+	rt_char8 *joined = RT_NULL;
+	rt_char8 *output;
+	rt_un output_size;
+	rt_un prefix_size;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_encoding_encode(option, rt_char_get_size(option), RT_ENCODING_SYSTEM_DEFAULT, buffer, RT_CHAR8_BIG_STRING_SIZE, &heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
+		goto error;
+
+	if (prefix && *prefix) {
+		prefix_size = rt_char8_get_size(prefix);
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)&joined, prefix_size + 1 + output_size + 1)))
+			goto error;
+		RT_MEMORY_COPY(prefix, joined, prefix_size);
+		joined[prefix_size] = ',';
+		RT_MEMORY_COPY(output, &joined[prefix_size + 1], output_size + 1);
+		*llvm_message = LLVMCreateMessage(joined);
+	} else {
+		*llvm_message = LLVMCreateMessage(output);
+	}
+
+	ret = RT_OK;
+free:
+	if (joined && RT_UNLIKELY(!heap->free(heap, (void**)&joined) && ret))
+		goto error;
+	if (heap_buffer && RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Triple, processor and features of <tt>--target</tt>, <tt>--cpu</tt> and <tt>--features</tt>, the ones of the host by default.
+ *
+ * <p>
+ * Without <tt>--cpu</tt>, the processor is the one of the host, or a generic one with <tt>--target</tt>.<br>
+ * The features of the host are only used with its processor, <tt>--features</tt> then applies after them.<br>
+ * With <tt>--cpu</tt>, the code does not depend on the machine that compiles it.
+ * </p>
+ *
+ * The strings must be disposed with <tt>LLVMDisposeMessage</tt>, even on failure.
+ */
+static rt_s zz_code_generator_session_get_target_strings(struct zz_options *options, rt_char8 **llvm_triple, rt_char8 **llvm_cpu_name, rt_char8 **llvm_cpu_features)
+{
+	rt_char8 *llvm_host_cpu_features = RT_NULL;
+	const rt_char8 *cpu_features = RT_NULL;
+	rt_char8 *llvm_target = RT_NULL;
+	rt_s ret;
+
+	*llvm_triple = RT_NULL;
+	*llvm_cpu_name = RT_NULL;
+	*llvm_cpu_features = RT_NULL;
+
+	if (options->target) {
+		if (RT_UNLIKELY(!zz_code_generator_session_copy_option(options->target, RT_NULL, options->heap, &llvm_target)))
+			goto error;
+		*llvm_triple = LLVMNormalizeTargetTriple(llvm_target);
+	} else {
+		*llvm_triple = LLVMGetDefaultTargetTriple();
+	}
+
+	if (options->cpu) {
+		if (RT_UNLIKELY(!zz_code_generator_session_copy_option(options->cpu, RT_NULL, options->heap, llvm_cpu_name)))
+			goto error;
+		/* LLVM only warns about an unknown processor, but then aborts on x86-64 as the processor brings the 64 bits support. */
+		if (rt_char8_get_size(*llvm_triple) >= 6 && rt_char8_equals(*llvm_triple, 6, "x86_64", 6))
+			cpu_features = "+64bit";
+	} else if (options->target) {
+		*llvm_cpu_name = LLVMCreateMessage("generic");
+	} else {
+		*llvm_cpu_name = LLVMGetHostCPUName();
+		llvm_host_cpu_features = LLVMGetHostCPUFeatures();
+		cpu_features = llvm_host_cpu_features;
+	}
+
+	if (options->features) {
+		if (RT_UNLIKELY(!zz_code_generator_session_copy_option(options->features, cpu_features, options->heap, llvm_cpu_features)))
+			goto error;
+	} else {
+		*llvm_cpu_features = LLVMCreateMessage(cpu_features ? cpu_features : "");
+	}
+
+	ret = RT_OK;
+free:
+	if (llvm_host_cpu_features) {
+		LLVMDisposeMessage(llvm_host_cpu_features);
+		llvm_host_cpu_features = RT_NULL;
+	}
+	if (llvm_target) {
+		LLVMDisposeMessage(llvm_target);
+		llvm_target = RT_NULL;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static void zz_code_generator_session_dispose_target_strings(rt_char8 *llvm_triple, rt_char8 *llvm_cpu_name, rt_char8 *llvm_cpu_features)
+{
+	if (llvm_cpu_features)
+		LLVMDisposeMessage(llvm_cpu_features);
+	if (llvm_cpu_name)
+		LLVMDisposeMessage(llvm_cpu_name);
+	if (llvm_triple)
+		LLVMDisposeMessage(llvm_triple);
+}
+
+/**
+ * Only the native target is registered unless <tt>--target</tt> is given, as the other ones take time to initialize.
+ */
+static rt_s zz_code_generator_session_create_target(struct zz_code_generator_session *session, struct zz_options *options, struct zz_diagnostics *diagnostics)
+{
+	rt_char8 *llvm_error;
+	rt_s ret;
+
+	if (options->target) {
+		LLVMInitializeAllTargetInfos();
+		LLVMInitializeAllTargets();
+		LLVMInitializeAllTargetMCs();
+		LLVMInitializeAllAsmPrinters();
+		/* For the inline assembly of the multiversioned functions. */
+		LLVMInitializeAllAsmParsers();
+	} else {
+		if (RT_UNLIKELY(LLVMInitializeNativeTarget())) {
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			goto error;
+		}
+		if (RT_UNLIKELY(LLVMInitializeNativeAsmPrinter())) {
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			goto error;
+		}
+		/* For the inline assembly of the multiversioned functions. */
+		if (RT_UNLIKELY(LLVMInitializeNativeAsmParser())) {
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			goto error;
+		}
+	}
+
+	if (RT_UNLIKELY(!zz_code_generator_session_get_target_strings(options, &session->llvm_triple, &session->llvm_cpu_name, &session->llvm_cpu_features)))
+		goto error;
+	if (RT_UNLIKELY(LLVMGetTargetFromTriple(session->llvm_triple, &session->llvm_target, &llvm_error))) {
+		zz_llvm_error_add_message(diagnostics, llvm_error);
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_code_generator_session_create_target_machine(session, session->llvm_reloc_mode, &session->llvm_target_machine)))
+		goto error;
+	session->llvm_target_data = LLVMCreateTargetDataLayout(session->llvm_target_machine);
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_code_generator_session_create(struct zz_code_generator_session *session, struct zz_options *options, struct zz_diagnostics *diagnostics)
+{
+	rt_s ret;
+
+	session->llvm_thread_safe_context = RT_NULL;
+	session->llvm_context = RT_NULL;
+	session->llvm_builder = RT_NULL;
+	session->llvm_target = RT_NULL;
+	session->llvm_target_machine = RT_NULL;
+	session->llvm_target_data = RT_NULL;
+	session->llvm_triple = RT_NULL;
+	session->llvm_cpu_name = RT_NULL;
+	session->llvm_cpu_features = RT_NULL;
+	session->optimization_level = options->optimization_level;
+	session->llvm_reloc_mode = zz_code_generator_session_reloc_modes[options->reloc];
+	session->llvm_code_model = zz_code_generator_session_code_models[options->code_model];
+
+	if (RT_UNLIKELY(!zz_code_generator_session_create_target(session, options, diagnostics)))
+		goto error;
+
+	if (options->run) {
+		session->llvm_thread_safe_context = LLVMOrcCreateNewThreadSafeContext();
+		session->llvm_context = LLVMOrcThreadSafeContextGetContext(session->llvm_thread_safe_context);
+	} else {
+		session->llvm_context = LLVMContextCreate();
+	}
+	session->llvm_builder = LLVMCreateBuilderInContext(session->llvm_context);
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	zz_code_generator_session_free(session);
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_b zz_code_generator_session_equals(const rt_char8 *llvm_string1, const rt_char8 *llvm_string2)
+{
+	return rt_char8_equals(llvm_string1, rt_char8_get_size(llvm_string1), llvm_string2, rt_char8_get_size(llvm_string2));
+}
+
+rt_s zz_code_generator_session_matches(struct zz_code_generator_session *session, struct zz_options *options, rt_b *matches)
+{
+	rt_char8 *llvm_triple;
+	rt_char8 *llvm_cpu_name;
+	rt_char8 *llvm_cpu_features;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_code_generator_session_get_target_strings(options, &llvm_triple, &llvm_cpu_name, &llvm_cpu_features)))
+		goto error;
+
+	*matches = session->optimization_level == options->optimization_level &&
+		   session->llvm_reloc_mode == zz_code_generator_session_reloc_modes[options->reloc] &&
+		   session->llvm_code_model == zz_code_generator_session_code_models[options->code_model] &&
+		   (session->llvm_thread_safe_context != RT_NULL) == options->run &&
+		   zz_code_generator_session_equals(session->llvm_triple, llvm_triple) &&
+		   zz_code_generator_session_equals(session->llvm_cpu_name, llvm_cpu_name) &&
+		   zz_code_generator_session_equals(session->llvm_cpu_features, llvm_cpu_features);
+
+	ret = RT_OK;
+free:
+	zz_code_generator_session_dispose_target_strings(llvm_triple, llvm_cpu_name, llvm_cpu_features);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+void zz_code_generator_session_create_module(struct zz_code_generator_session *session, LLVMContextRef llvm_context, const rt_char8 *name, LLVMModuleRef *llvm_module)
+{
+	*llvm_module = LLVMModuleCreateWithNameInContext(name, llvm_context);
+	LLVMSetTarget(*llvm_module, session->llvm_triple);
+	/* The passes rely on the data layout. */
+	LLVMSetModuleDataLayout(*llvm_module, session->llvm_target_data);
+}
+
+rt_s zz_code_generator_session_free(struct zz_code_generator_session *session)
+{
+	if (session->llvm_builder) {
+		LLVMDisposeBuilder(session->llvm_builder);
+		session->llvm_builder = RT_NULL;
+	}
+	if (session->llvm_thread_safe_context) {
+		LLVMOrcDisposeThreadSafeContext(session->llvm_thread_safe_context);
+		session->llvm_thread_safe_context = RT_NULL;
+		session->llvm_context = RT_NULL;
+	} else if (session->llvm_context) {
+		LLVMContextDispose(session->llvm_context);
+		session->llvm_context = RT_NULL;
+	}
+	if (session->llvm_target_data) {
+		LLVMDisposeTargetData(session->llvm_target_data);
+		session->llvm_target_data = RT_NULL;
+	}
+	if (session->llvm_target_machine) {
+		LLVMDisposeTargetMachine(session->llvm_target_machine);
+		session->llvm_target_machine = RT_NULL;
+	}
+	if (session->llvm_cpu_features) {
+		LLVMDisposeMessage(session->llvm_cpu_features);
+		session->llvm_cpu_features = RT_NULL;
+	}
+	if (session->llvm_cpu_name) {
+		LLVMDisposeMessage(session->llvm_cpu_name);
+		session->llvm_cpu_name = RT_NULL;
+	}
+	if (session->llvm_triple) {
+		LLVMDisposeMessage(session->llvm_triple);
+		session->llvm_triple = RT_NULL;
+	}
+	return RT_OK;
+}
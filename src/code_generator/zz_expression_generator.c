@@ -1,20 +1,47 @@
 #include "code_generator/zz_expression_generator.h"
 
-static rt_s zz_expression_generator_generate_number(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMValueRef *llvm_value)
+#include "llvm-c/DebugInfo.h"
+
+LLVMTypeRef zz_expression_generator_get_type(enum zz_value_type value_type, LLVMContextRef llvm_context)
 {
-	*llvm_value = LLVMConstInt(LLVMInt32TypeInContext(llvm_context), node->u.number.value, RT_TRUE);
-	return RT_OK;
+	LLVMTypeRef llvm_lane_type;
+	rt_un lanes_count = zz_value_type_get_lanes_count(value_type);
+
+	if (zz_value_type_get_lane_type(value_type) == ZZ_VALUE_TYPE_I64)
+		llvm_lane_type = LLVMInt64TypeInContext(llvm_context);
+	else
+		llvm_lane_type = LLVMInt32TypeInContext(llvm_context);
+
+	return (lanes_count == 1) ? llvm_lane_type : LLVMVectorType(llvm_lane_type, (unsigned)lanes_count);
 }
 
-static rt_s zz_expression_generator_generate_unary_operator(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+LLVMValueRef zz_expression_generator_convert(LLVMValueRef llvm_value, LLVMTypeRef llvm_type, LLVMBuilderRef llvm_builder)
 {
-	LLVMValueRef operand;
-	rt_s ret;
+	LLVMTypeRef llvm_lane_type = llvm_type;
+	LLVMValueRef llvm_vector;
+	unsigned lanes_count;
 
-	if (RT_UNLIKELY(!zz_expression_generator_generate(node->u.unary_operator.operand, llvm_context, llvm_module, llvm_builder, &operand)))
-		goto error;
+	if (LLVMTypeOf(llvm_value) == llvm_type)
+		return llvm_value;
+
+	if (LLVMGetTypeKind(llvm_type) == LLVMVectorTypeKind)
+		llvm_lane_type = LLVMGetElementType(llvm_type);
+	if (LLVMTypeOf(llvm_value) != llvm_lane_type)
+		llvm_value = LLVMBuildSExt(llvm_builder, llvm_value, llvm_lane_type, "sext");
+	if (llvm_lane_type == llvm_type)
+		return llvm_value;
 
-	switch (node->u.unary_operator.unary_operator) {
+	/* Insert into the first lane then copy it with a zero mask, the usual splat pattern. */
+	lanes_count = LLVMGetVectorSize(llvm_type);
+	llvm_vector = LLVMBuildInsertElement(llvm_builder, LLVMGetPoison(llvm_type), llvm_value, LLVMConstInt(LLVMInt32TypeInContext(LLVMGetTypeContext(llvm_type)), 0, RT_FALSE), "insert");
+	return LLVMBuildShuffleVector(llvm_builder, llvm_vector, LLVMGetPoison(llvm_type), LLVMConstNull(LLVMVectorType(LLVMInt32TypeInContext(LLVMGetTypeContext(llvm_type)), lanes_count)), "splat");
+}
+
+static rt_s zz_expression_generator_generate_unary_operator(rt_un8 kind, LLVMValueRef operand, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+{
+	rt_s ret;
+
+	switch (ZZ_AST_NODE_KIND_GET_OPERATOR(kind)) {
 	case ZZ_UNARY_OPERATOR_NEGATE:
 		*llvm_value = LLVMBuildNeg(llvm_builder, operand, "neg");
 		break;
@@ -32,18 +59,25 @@ error:
 	goto free;
 }
 
-static rt_s zz_expression_generator_generate_binary_operator(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+/**
+ * Adding <tt>2^exponent - 1</tt> to negative dividends makes the arithmetic shift round toward zero, like <tt>sdiv</tt>.
+ */
+static LLVMValueRef zz_expression_generator_generate_rounding_bias(LLVMValueRef dividend, LLVMValueRef exponent, LLVMBuilderRef llvm_builder)
 {
-	LLVMValueRef left_side_operand;
-	LLVMValueRef right_side_operand;
+	LLVMTypeRef llvm_type = LLVMTypeOf(dividend);
+	LLVMValueRef sign;
 
-	if (RT_UNLIKELY(!zz_expression_generator_generate(node->u.binary_operator.left, llvm_context, llvm_module, llvm_builder, &left_side_operand)))
-		goto error;
-	
-	if (RT_UNLIKELY(!zz_expression_generator_generate(node->u.binary_operator.right, llvm_context, llvm_module, llvm_builder, &right_side_operand)))
-		goto error;
+	sign = LLVMBuildAShr(llvm_builder, dividend, LLVMConstInt(llvm_type, 31, RT_FALSE), "sign");
+	return LLVMBuildLShr(llvm_builder, sign, LLVMBuildSub(llvm_builder, LLVMConstInt(llvm_type, 32, RT_FALSE), exponent, "bits"), "bias");
+}
 
-	switch (node->u.binary_operator.binary_operator) {
+static rt_s zz_expression_generator_generate_binary_operator(rt_un8 kind, LLVMValueRef left_side_operand, LLVMValueRef right_side_operand, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+{
+	LLVMValueRef biased;
+	LLVMValueRef mask;
+	rt_s ret;
+
+	switch (ZZ_AST_NODE_KIND_GET_OPERATOR(kind)) {
 	case ZZ_BINARY_OPERATOR_ADD:
 		*llvm_value = LLVMBuildAdd(llvm_builder, left_side_operand, right_side_operand, "add");
 		break;
@@ -59,13 +93,45 @@ static rt_s zz_expression_generator_generate_binary_operator(struct zz_ast_node
 	case ZZ_BINARY_OPERATOR_MODULO:
 		*llvm_value = LLVMBuildSRem(llvm_builder, left_side_operand, right_side_operand, "mod");
 		break;
+	case ZZ_BINARY_OPERATOR_SHIFT_LEFT:
+		*llvm_value = LLVMBuildShl(llvm_builder, left_side_operand, right_side_operand, "shl");
+		break;
+	case ZZ_BINARY_OPERATOR_DIVIDE_BY_POWER_OF_TWO:
+		biased = LLVMBuildAdd(llvm_builder, left_side_operand, zz_expression_generator_generate_rounding_bias(left_side_operand, right_side_operand, llvm_builder), "biased");
+		*llvm_value = LLVMBuildAShr(llvm_builder, biased, right_side_operand, "div");
+		break;
+	case ZZ_BINARY_OPERATOR_MODULO_BY_POWER_OF_TWO:
+		/* x - ((x + bias) & -2^exponent) */
+		biased = LLVMBuildAdd(llvm_builder, left_side_operand, zz_expression_generator_generate_rounding_bias(left_side_operand, right_side_operand, llvm_builder), "biased");
+		mask = LLVMBuildShl(llvm_builder, LLVMConstAllOnes(LLVMTypeOf(left_side_operand)), right_side_operand, "mask");
+		*llvm_value = LLVMBuildSub(llvm_builder, left_side_operand, LLVMBuildAnd(llvm_builder, biased, mask, "truncated"), "mod");
+		break;
 	default:
 		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
 
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_expression_generator_generate_call(rt_un32 name, LLVMValueRef *llvm_functions, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+{
+	LLVMValueRef llvm_function = llvm_functions[name];
 	rt_s ret;
 
+	/* Undefined function. */
+	if (RT_UNLIKELY(!llvm_function)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	*llvm_value = LLVMBuildCall2(llvm_builder, LLVMGlobalGetValueType(llvm_function), llvm_function, RT_NULL, 0, "call");
+
 	ret = RT_OK;
 free:
 	return ret;
@@ -75,26 +141,249 @@ error:
 	goto free;
 }
 
-rt_s zz_expression_generator_generate(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+static LLVMValueRef zz_expression_generator_generate_vector(struct zz_ast *ast, rt_un32 node, LLVMTypeRef llvm_type)
+{
+	LLVMValueRef lanes[ZZ_VALUE_TYPE_MAX_LANES_COUNT];
+	LLVMTypeRef llvm_lane_type = LLVMGetElementType(llvm_type);
+	rt_n *literals = &ast->literals[ast->operands[2 * node]];
+	unsigned lanes_count = LLVMGetVectorSize(llvm_type);
+	unsigned i;
+
+	for (i = 0; i < lanes_count; i++)
+		lanes[i] = LLVMConstInt(llvm_lane_type, literals[i], RT_TRUE);
+	return LLVMConstVector(lanes, lanes_count);
+}
+
+/**
+ * Allocate the variables of the function at the current position, in the entry block so that <tt>mem2reg</tt> promotes the scalar ones.
+ */
+static void zz_expression_generator_generate_locals(struct zz_ast *ast, struct zz_ast_function *function, LLVMTypeRef *llvm_types, LLVMValueRef *llvm_locals, LLVMBuilderRef llvm_builder)
+{
+	struct zz_ast_local *local;
+	LLVMTypeRef llvm_type;
+	rt_un32 i;
+
+	for (i = 0; i < function->locals_count; i++) {
+		local = &ast->locals[function->first_local + i];
+		llvm_type = llvm_types[local->type];
+		if (local->array_size)
+			llvm_type = LLVMArrayType(llvm_type, local->array_size);
+		llvm_locals[i] = LLVMBuildAlloca(llvm_builder, llvm_type, local->array_size ? "array" : "local");
+	}
+}
+
+/**
+ * Fill an array with zeros, at its declaration.
+ */
+static void zz_expression_generator_generate_zero_fill(struct zz_ast_local *local, LLVMValueRef llvm_array, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder)
+{
+	rt_un64 size = (rt_un64)local->array_size * zz_value_type_get_lanes_count(local->type);
+
+	size *= (zz_value_type_get_lane_type(local->type) == ZZ_VALUE_TYPE_I64) ? 8 : 4;
+	LLVMBuildMemSet(llvm_builder, llvm_array, LLVMConstInt(LLVMInt8TypeInContext(llvm_context), 0, RT_FALSE), LLVMConstInt(LLVMInt64TypeInContext(llvm_context), size, RT_FALSE), LLVMGetAlignment(llvm_array));
+}
+
+/**
+ * Add a property like <tt>!{!"llvm.loop.unroll.count", i32 4}</tt> to <tt>llvm_properties</tt>.
+ */
+static void zz_expression_generator_add_loop_property(const rt_char8 *name, rt_un32 value, rt_b has_value, LLVMContextRef llvm_context, LLVMMetadataRef *llvm_properties, rt_un *properties_count)
+{
+	LLVMMetadataRef llvm_operands[2];
+	size_t operands_count = 1;
+
+	llvm_operands[0] = LLVMMDStringInContext2(llvm_context, name, rt_char8_get_size(name));
+	if (has_value) {
+		llvm_operands[1] = LLVMValueAsMetadata(LLVMConstInt(LLVMInt32TypeInContext(llvm_context), value, RT_FALSE));
+		operands_count = 2;
+	}
+	llvm_properties[(*properties_count)++] = LLVMMDNodeInContext2(llvm_context, llvm_operands, operands_count);
+}
+
+/**
+ * Attach the hints of <tt>loop</tt> to the branch back to its header, as <tt>llvm.loop</tt> metadata.
+ *
+ * <p>
+ * The first operand of the loop metadata is the metadata itself, so that two loops never share it.<br>
+ * <tt>unroll(1)</tt> disables the unrolling and <tt>vectorize(1)</tt> the vectorization, a greater width enables it even if the cost model disagrees.
+ * </p>
+ */
+static void zz_expression_generator_generate_loop_metadata(struct zz_ast_loop *loop, LLVMValueRef llvm_branch, LLVMContextRef llvm_context)
+{
+	LLVMMetadataRef llvm_properties[5];
+	LLVMMetadataRef llvm_temporary;
+	LLVMMetadataRef llvm_loop;
+	rt_un properties_count = 1;
+
+	if (loop->unroll == 1)
+		zz_expression_generator_add_loop_property("llvm.loop.unroll.disable", 0, RT_FALSE, llvm_context, llvm_properties, &properties_count);
+	else if (loop->unroll)
+		zz_expression_generator_add_loop_property("llvm.loop.unroll.count", loop->unroll, RT_TRUE, llvm_context, llvm_properties, &properties_count);
+	if (loop->vectorize) {
+		zz_expression_generator_add_loop_property("llvm.loop.vectorize.width", loop->vectorize, RT_TRUE, llvm_context, llvm_properties, &properties_count);
+		if (loop->vectorize > 1)
+			zz_expression_generator_add_loop_property("llvm.loop.vectorize.enable", 1, RT_TRUE, llvm_context, llvm_properties, &properties_count);
+	}
+	if (loop->interleave)
+		zz_expression_generator_add_loop_property("llvm.loop.interleave.count", loop->interleave, RT_TRUE, llvm_context, llvm_properties, &properties_count);
+
+	if (properties_count == 1)
+		return;
+
+	/* The temporary node is replaced by the loop metadata and deleted. */
+	llvm_temporary = LLVMTemporaryMDNode(llvm_context, RT_NULL, 0);
+	llvm_properties[0] = llvm_temporary;
+	llvm_loop = LLVMMDNodeInContext2(llvm_context, llvm_properties, properties_count);
+	LLVMMetadataReplaceAllUsesWith(llvm_temporary, llvm_loop);
+	LLVMSetMetadata(llvm_branch, LLVMGetMDKindIDInContext(llvm_context, "llvm.loop", 9), LLVMMetadataAsValue(llvm_context, llvm_loop));
+}
+
+/**
+ * Start a loop whose variable has been assigned its start: the header compares it to the end, then the body follows.
+ *
+ * @param llvm_value Receives the header, as a value.
+ */
+static void zz_expression_generator_generate_for(LLVMValueRef llvm_variable, LLVMValueRef llvm_end, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+{
+	LLVMValueRef llvm_function = LLVMGetBasicBlockParent(LLVMGetInsertBlock(llvm_builder));
+	LLVMBasicBlockRef llvm_header;
+	LLVMBasicBlockRef llvm_body;
+	LLVMBasicBlockRef llvm_exit;
+	LLVMValueRef llvm_index;
+
+	llvm_header = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "for");
+	llvm_body = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "body");
+	llvm_exit = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "end_for");
+	LLVMBuildBr(llvm_builder, llvm_header);
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_header);
+	llvm_index = LLVMBuildLoad2(llvm_builder, LLVMTypeOf(llvm_end), llvm_variable, "index");
+	LLVMBuildCondBr(llvm_builder, LLVMBuildICmp(llvm_builder, LLVMIntSLT, llvm_index, llvm_end, "in_range"), llvm_body, llvm_exit);
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_body);
+	*llvm_value = LLVMBasicBlockAsValue(llvm_header);
+}
+
+/**
+ * Increment the variable at the end of the body of a loop, branch back to its header then continue after the loop.
+ *
+ * <p>
+ * The increment cannot overflow as the variable is less than the end, which helps the analysis of the loop.
+ * </p>
+ */
+static void zz_expression_generator_generate_end_for(struct zz_ast_loop *loop, LLVMValueRef llvm_header_value, LLVMValueRef llvm_variable, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder)
 {
+	LLVMBasicBlockRef llvm_header = LLVMValueAsBasicBlock(llvm_header_value);
+	LLVMBasicBlockRef llvm_exit = LLVMGetSuccessor(LLVMGetBasicBlockTerminator(llvm_header), 1);
+	LLVMTypeRef llvm_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMValueRef llvm_index;
+
+	llvm_index = LLVMBuildLoad2(llvm_builder, llvm_type, llvm_variable, "index");
+	LLVMBuildStore(llvm_builder, LLVMBuildNSWAdd(llvm_builder, llvm_index, LLVMConstInt(llvm_type, 1, RT_FALSE), "next"), llvm_variable);
+	zz_expression_generator_generate_loop_metadata(loop, LLVMBuildBr(llvm_builder, llvm_header), llvm_context);
+
+	/* Keep the blocks in the order of the source, after the ones of the nested loops. */
+	LLVMMoveBasicBlockAfter(llvm_exit, LLVMGetInsertBlock(llvm_builder));
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_exit);
+}
+
+static rt_s zz_expression_generator_generate_nodes(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef *values, LLVMValueRef *llvm_locals, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder)
+{
+	LLVMTypeRef llvm_types[ZZ_VALUE_TYPES_COUNT];
+	LLVMTypeRef llvm_type;
+	LLVMValueRef left_side_operand;
+	LLVMValueRef right_side_operand;
+	LLVMValueRef llvm_indexes[2];
+	LLVMValueRef llvm_local;
+	struct zz_ast_local *local;
+	struct zz_ast_loop *loop;
+	rt_un8 *kinds = ast->kinds;
+	rt_un32 *operands = ast->operands;
+	rt_un32 first_node = function->first_node;
+	rt_un32 first_local = function->first_local;
+	rt_un32 root = function->body;
+	rt_un8 kind;
+	rt_un32 i;
 	rt_s ret;
 
-	switch (node->type) {
-	case ZZ_AST_NODE_TYPE_NUMBER:
-		if (RT_UNLIKELY(!zz_expression_generator_generate_number(node, llvm_context, llvm_value)))
-			goto error;
-		break;
-	case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
-		if (RT_UNLIKELY(!zz_expression_generator_generate_unary_operator(node, llvm_context, llvm_module, llvm_builder, llvm_value)))
-			goto error;
-		break;
-	case ZZ_AST_NODE_TYPE_BINARY_OPERATOR:
-		if (RT_UNLIKELY(!zz_expression_generator_generate_binary_operator(node, llvm_context, llvm_module, llvm_builder, llvm_value)))
+	for (i = 0; i < ZZ_VALUE_TYPES_COUNT; i++)
+		llvm_types[i] = zz_expression_generator_get_type(i, llvm_context);
+
+	zz_expression_generator_generate_locals(ast, function, llvm_types, llvm_locals, llvm_builder);
+
+	/* Post-order: the operands of a node have always been generated before it, the statements are in the order of the source. */
+	for (i = first_node; i <= root; i++) {
+		kind = kinds[i];
+		llvm_type = llvm_types[ast->types[i]];
+		switch (ZZ_AST_NODE_KIND_GET_TYPE(kind)) {
+		case ZZ_AST_NODE_TYPE_NUMBER:
+			values[i - first_node] = LLVMConstInt(llvm_type, ast->literals[operands[2 * i]], RT_TRUE);
+			break;
+		case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
+			if (RT_UNLIKELY(!zz_expression_generator_generate_unary_operator(kind, values[operands[2 * i] - first_node], llvm_builder, &values[i - first_node])))
+				goto error;
+			break;
+		case ZZ_AST_NODE_TYPE_BINARY_OPERATOR:
+			/* A scalar operand of a vector or i64 operation is converted first. */
+			left_side_operand = zz_expression_generator_convert(values[operands[2 * i] - first_node], llvm_type, llvm_builder);
+			right_side_operand = zz_expression_generator_convert(values[operands[2 * i + 1] - first_node], llvm_type, llvm_builder);
+			if (RT_UNLIKELY(!zz_expression_generator_generate_binary_operator(kind, left_side_operand, right_side_operand, llvm_builder, &values[i - first_node])))
+				goto error;
+			break;
+		case ZZ_AST_NODE_TYPE_CALL:
+			if (RT_UNLIKELY(!zz_expression_generator_generate_call(operands[2 * i], llvm_functions, llvm_builder, &values[i - first_node])))
+				goto error;
+			break;
+		case ZZ_AST_NODE_TYPE_VECTOR:
+			values[i - first_node] = zz_expression_generator_generate_vector(ast, i, llvm_type);
+			break;
+		case ZZ_AST_NODE_TYPE_EXTRACT:
+			values[i - first_node] = LLVMBuildExtractElement(llvm_builder, values[operands[2 * i] - first_node], LLVMConstInt(llvm_types[ZZ_VALUE_TYPE_I32], operands[2 * i + 1], RT_FALSE), "extract");
+			break;
+		case ZZ_AST_NODE_TYPE_SHUFFLE:
+			/* The mask is the constant vector just before. */
+			values[i - first_node] = LLVMBuildShuffleVector(llvm_builder, values[operands[2 * i] - first_node], values[operands[2 * i + 1] - first_node], values[i - 1 - first_node], "shuffle");
+			break;
+		case ZZ_AST_NODE_TYPE_CONVERSION:
+			/* Truncation or sign extension. */
+			values[i - first_node] = LLVMBuildIntCast2(llvm_builder, values[operands[2 * i] - first_node], llvm_type, RT_TRUE, "conversion");
+			break;
+		case ZZ_AST_NODE_TYPE_LOCAL:
+			values[i - first_node] = LLVMBuildLoad2(llvm_builder, llvm_type, llvm_locals[operands[2 * i] - first_local], "local");
+			break;
+		case ZZ_AST_NODE_TYPE_ADDRESS:
+			llvm_local = llvm_locals[operands[2 * i] - first_local];
+			llvm_indexes[0] = LLVMConstNull(llvm_types[ZZ_VALUE_TYPE_I32]);
+			llvm_indexes[1] = values[operands[2 * i + 1] - first_node];
+			values[i - first_node] = LLVMBuildInBoundsGEP2(llvm_builder, LLVMGetAllocatedType(llvm_local), llvm_local, llvm_indexes, 2, "address");
+			break;
+		case ZZ_AST_NODE_TYPE_LOAD:
+			values[i - first_node] = LLVMBuildLoad2(llvm_builder, llvm_type, values[operands[2 * i] - first_node], "element");
+			break;
+		case ZZ_AST_NODE_TYPE_ASSIGN:
+			local = &ast->locals[operands[2 * i]];
+			llvm_local = llvm_locals[operands[2 * i] - first_local];
+			if (local->array_size)
+				zz_expression_generator_generate_zero_fill(local, llvm_local, llvm_context, llvm_builder);
+			else
+				LLVMBuildStore(llvm_builder, zz_expression_generator_convert(values[operands[2 * i + 1] - first_node], llvm_types[local->type], llvm_builder), llvm_local);
+			break;
+		case ZZ_AST_NODE_TYPE_STORE:
+			llvm_type = llvm_types[ast->types[operands[2 * i]]];
+			LLVMBuildStore(llvm_builder, zz_expression_generator_convert(values[operands[2 * i + 1] - first_node], llvm_type, llvm_builder), values[operands[2 * i] - first_node]);
+			break;
+		case ZZ_AST_NODE_TYPE_FOR:
+			loop = &ast->loops[operands[2 * i + 1]];
+			zz_expression_generator_generate_for(llvm_locals[loop->variable - first_local], values[operands[2 * i] - first_node], llvm_context, llvm_builder, &values[i - first_node]);
+			break;
+		case ZZ_AST_NODE_TYPE_END_FOR:
+			/* The for node holds the header of the loop. */
+			loop = &ast->loops[operands[2 * operands[2 * i] + 1]];
+			zz_expression_generator_generate_end_for(loop, values[operands[2 * i] - first_node], llvm_locals[loop->variable - first_local], llvm_context, llvm_builder);
+			break;
+		default:
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 			goto error;
-		break;
-	default:
-		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
-		goto error;
+		}
 	}
 
 	ret = RT_OK;
@@ -105,3 +394,30 @@ error:
 	ret = RT_FAILED;
 	goto free;
 }
+
+rt_s zz_expression_generator_generate(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, LLVMValueRef *llvm_value)
+{
+	struct rt_heap *heap = ast->heap;
+	rt_un nodes_count = function->body - function->first_node + 1;
+	LLVMValueRef *values = RT_NULL;
+	rt_s ret;
+
+	/* LLVM value of each node of the function, then the allocation of each of its variables. */
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&values, (nodes_count + function->locals_count) * sizeof(LLVMValueRef))))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_expression_generator_generate_nodes(ast, function, values, &values[nodes_count], llvm_functions, llvm_context, llvm_builder)))
+		goto error;
+
+	*llvm_value = values[nodes_count - 1];
+
+	ret = RT_OK;
+free:
+	if (values && RT_UNLIKELY(!heap->free(heap, (void**)&values) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
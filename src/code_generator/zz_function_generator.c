@@ -1,30 +1,99 @@
 #include "code_generator/zz_function_generator.h"
 
 #include "code_generator/zz_expression_generator.h"
+#include "code_generator/zz_multiversion_generator.h"
 
-rt_s zz_function_generator_generate(struct zz_ast_node *node, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder)
+rt_s zz_function_generator_declare(struct zz_ast *ast, struct zz_symbol_table *symbol_table, LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMValueRef *llvm_functions)
 {
-	LLVMValueRef llvm_body_value;
-	LLVMTypeRef main_function_return_type;
-	LLVMTypeRef main_function_param_types[] = { };
-	LLVMTypeRef main_function_type;
-	LLVMValueRef main_function;
-	LLVMBasicBlockRef main_function_entry;
+	LLVMTypeRef function_param_types[] = { };
+	LLVMTypeRef function_types[ZZ_VALUE_TYPES_COUNT];
+	struct zz_ast_function *function;
+	rt_un i;
 	rt_s ret;
 
-	if (node->type != ZZ_AST_NODE_TYPE_FUNCTION) {
-		goto error;
+	RT_MEMORY_ZERO(llvm_functions, symbol_table->symbols_count * sizeof(LLVMValueRef));
+
+	for (i = 0; i < ZZ_VALUE_TYPES_COUNT; i++)
+		function_types[i] = LLVMFunctionType(zz_expression_generator_get_type(i, llvm_context), function_param_types, 0, RT_FALSE);
+
+	for (i = 0; i < ast->functions_count; i++) {
+		function = &ast->functions[i];
+		if (RT_UNLIKELY(llvm_functions[function->name])) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		llvm_functions[function->name] = LLVMAddFunction(llvm_module, ZZ_SYMBOL_TABLE_GET_NAME(symbol_table, function->name), function_types[function->type]);
 	}
 
-	if (RT_UNLIKELY(!zz_expression_generator_generate(node->u.function.body, llvm_context, llvm_module, llvm_builder, &llvm_body_value)))
+	/* Functions of other files, resolved by the link, they return an i32. */
+	for (i = 0; i < ast->nodes_count; i++) {
+		if (ZZ_AST_NODE_KIND_GET_TYPE(ast->kinds[i]) == ZZ_AST_NODE_TYPE_CALL && !llvm_functions[ast->operands[2 * i]])
+			llvm_functions[ast->operands[2 * i]] = LLVMAddFunction(llvm_module, ZZ_SYMBOL_TABLE_GET_NAME(symbol_table, ast->operands[2 * i]), function_types[ZZ_VALUE_TYPE_I32]);
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Generate the body of <tt>function</tt> into <tt>llvm_function</tt>, which is the function itself or one of its variants.
+ */
+static rt_s zz_function_generator_generate_body(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef llvm_function, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder)
+{
+	LLVMValueRef llvm_body_value;
+	LLVMTypeRef llvm_return_type;
+	LLVMBasicBlockRef function_entry;
+	rt_s ret;
+
+	function_entry = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "entry");
+	LLVMPositionBuilderAtEnd(llvm_builder, function_entry);
+
+	if (RT_UNLIKELY(!zz_expression_generator_generate(ast, function, llvm_functions, llvm_context, llvm_builder, &llvm_body_value)))
 		goto error;
 
-	main_function_return_type = LLVMInt32TypeInContext(llvm_context);
-	main_function_type = LLVMFunctionType(main_function_return_type, main_function_param_types, 0, RT_FALSE);
-	main_function = LLVMAddFunction(llvm_module, "main", main_function_type);
-	main_function_entry = LLVMAppendBasicBlockInContext(llvm_context, main_function, "entry");
-	LLVMPositionBuilderAtEnd(llvm_builder, main_function_entry);
-	LLVMBuildRet(llvm_builder, llvm_body_value);
+	/* An i32 body can be returned as a wider or vector type. */
+	llvm_return_type = LLVMGetReturnType(LLVMGlobalGetValueType(llvm_function));
+	LLVMBuildRet(llvm_builder, zz_expression_generator_convert(llvm_body_value, llvm_return_type, llvm_builder));
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_function_generator_generate(struct zz_ast *ast, struct zz_ast_function *function, LLVMValueRef *llvm_functions, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder)
+{
+	LLVMValueRef llvm_function = llvm_functions[function->name];
+	LLVMValueRef llvm_variants[ZZ_CPU_LEVELS_COUNT + 1];
+	rt_un i;
+	rt_s ret;
+
+	if (!function->cpu_levels || !zz_multiversion_generator_is_supported(LLVMGetGlobalParent(llvm_function))) {
+		if (RT_UNLIKELY(!zz_function_generator_generate_body(ast, function, llvm_function, llvm_functions, llvm_context, llvm_builder)))
+			goto error;
+	} else {
+		/* The baseline variant, after the levels, is always generated. */
+		for (i = 0; i <= ZZ_CPU_LEVELS_COUNT; i++) {
+			if (i < ZZ_CPU_LEVELS_COUNT && !(function->cpu_levels & (1 << i))) {
+				llvm_variants[i] = RT_NULL;
+				continue;
+			}
+			if (RT_UNLIKELY(!zz_multiversion_generator_add_variant(llvm_function, i, llvm_context, ast->heap, &llvm_variants[i])))
+				goto error;
+			if (RT_UNLIKELY(!zz_function_generator_generate_body(ast, function, llvm_variants[i], llvm_functions, llvm_context, llvm_builder)))
+				goto error;
+		}
+		if (RT_UNLIKELY(!zz_multiversion_generator_dispatch(llvm_function, llvm_variants, llvm_context, llvm_builder, ast->heap)))
+			goto error;
+	}
 
 	ret = RT_OK;
 free:
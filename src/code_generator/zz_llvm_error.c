@@ -0,0 +1,41 @@
+#include "code_generator/zz_llvm_error.h"
+
+#include "llvm-c/Core.h"
+
+rt_s zz_llvm_error_add_message(struct zz_diagnostics *diagnostics, rt_char8 *llvm_message)
+{
+	rt_s ret;
+
+	if (llvm_message) {
+		if (RT_UNLIKELY(!zz_diagnostics_add_message8(diagnostics, llvm_message)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (llvm_message)
+		LLVMDisposeMessage(llvm_message);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_llvm_error_add(struct zz_diagnostics *diagnostics, LLVMErrorRef llvm_error)
+{
+	rt_char8 *message = LLVMGetErrorMessage(llvm_error);
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_diagnostics_add_message8(diagnostics, message)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	LLVMDisposeErrorMessage(message);
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,285 @@
+#include "code_generator/zz_multiversion_generator.h"
+
+/* The first x86-64 processors, used for the baseline variants and for the resolvers. */
+#define ZZ_MULTIVERSION_GENERATOR_BASELINE_CPU "x86-64"
+
+/**
+ * Value of the <tt>target-features</tt> attribute of the variants of each level, then of the baseline variants.<br>
+ * The features implied by a level, like AVX by AVX2, are added by LLVM.
+ */
+static const rt_char8 *zz_multiversion_generator_features[ZZ_CPU_LEVELS_COUNT + 1] = {
+	[ZZ_CPU_LEVEL_SSE4_2] = "+sse4.2",
+	[ZZ_CPU_LEVEL_AVX2] = "+avx2",
+	[ZZ_CPU_LEVEL_AVX512F] = "+avx512f",
+	[ZZ_CPU_LEVELS_COUNT] = ""
+};
+
+/* Bits of the ECX register returned by cpuid for the leaf 1. */
+#define ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_SSE4_2 (1 << 20)
+#define ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_OSXSAVE (1 << 27)
+#define ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_AVX (1 << 28)
+
+/* Bits of the EBX register returned by cpuid for the leaf 7. */
+#define ZZ_MULTIVERSION_GENERATOR_CPUID_7_EBX_AVX2 (1 << 5)
+#define ZZ_MULTIVERSION_GENERATOR_CPUID_7_EBX_AVX512F (1 << 16)
+
+/* Registers saved by the operating system on context switches, given by xgetbv. */
+#define ZZ_MULTIVERSION_GENERATOR_XCR0_AVX 0x06
+#define ZZ_MULTIVERSION_GENERATOR_XCR0_AVX512 0xE6
+
+rt_b zz_multiversion_generator_is_supported(LLVMModuleRef llvm_module)
+{
+	const rt_char8 *llvm_triple = LLVMGetTarget(llvm_module);
+
+	return rt_char8_get_size(llvm_triple) >= 6 && rt_char8_equals(llvm_triple, 6, "x86_64", 6);
+}
+
+/**
+ * Name <tt>llvm_value</tt> like <tt>llvm_function</tt> followed by a dot and <tt>suffix</tt>.
+ */
+static rt_s zz_multiversion_generator_set_name(LLVMValueRef llvm_value, LLVMValueRef llvm_function, const rt_char8 *suffix, struct rt_heap *heap)
+{
+	rt_char8 buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *heap_buffer = RT_NULL;
+	rt_un heap_buffer_capacity = 0;
+	const rt_char8 *function_name;
+	size_t function_name_size;
+	rt_un suffix_size = rt_char8_get_size(suffix);
+	rt_char8 *name;
+	rt_s ret;
+
+	function_name = LLVMGetValueName2(llvm_function, &function_name_size);
+	if (RT_UNLIKELY(!rt_heap_alloc_if_needed(buffer, RT_CHAR8_BIG_STRING_SIZE, &heap_buffer, &heap_buffer_capacity, (void**)&name, function_name_size + 1 + suffix_size, heap)))
+		goto error;
+
+	RT_MEMORY_COPY(function_name, name, function_name_size);
+	name[function_name_size] = '.';
+	RT_MEMORY_COPY(suffix, &name[function_name_size + 1], suffix_size);
+	LLVMSetValueName2(llvm_value, name, function_name_size + 1 + suffix_size);
+
+	ret = RT_OK;
+free:
+	if (heap_buffer) {
+		if (RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static void zz_multiversion_generator_add_attribute(LLVMContextRef llvm_context, LLVMValueRef llvm_function, const rt_char8 *name, const rt_char8 *value)
+{
+	LLVMAttributeRef llvm_attribute;
+
+	llvm_attribute = LLVMCreateStringAttribute(llvm_context, name, (unsigned)rt_char8_get_size(name), value, (unsigned)rt_char8_get_size(value));
+	LLVMAddAttributeAtIndex(llvm_function, LLVMAttributeFunctionIndex, llvm_attribute);
+}
+
+/**
+ * Compile <tt>llvm_function</tt> for <tt>cpu_level</tt> rather than for the processor of the target machine.
+ */
+static void zz_multiversion_generator_set_level(LLVMContextRef llvm_context, LLVMValueRef llvm_function, enum zz_cpu_level cpu_level)
+{
+	zz_multiversion_generator_add_attribute(llvm_context, llvm_function, "target-cpu", ZZ_MULTIVERSION_GENERATOR_BASELINE_CPU);
+	zz_multiversion_generator_add_attribute(llvm_context, llvm_function, "target-features", zz_multiversion_generator_features[cpu_level]);
+}
+
+rt_s zz_multiversion_generator_add_variant(LLVMValueRef llvm_function, enum zz_cpu_level cpu_level, LLVMContextRef llvm_context, struct rt_heap *heap, LLVMValueRef *llvm_variant)
+{
+	rt_s ret;
+
+	*llvm_variant = LLVMAddFunction(LLVMGetGlobalParent(llvm_function), "", LLVMGlobalGetValueType(llvm_function));
+	LLVMSetLinkage(*llvm_variant, LLVMInternalLinkage);
+	if (RT_UNLIKELY(!zz_multiversion_generator_set_name(*llvm_variant, llvm_function, cpu_level == ZZ_CPU_LEVELS_COUNT ? "default" : zz_cpu_level_get_name8(cpu_level), heap)))
+		goto error;
+	zz_multiversion_generator_set_level(llvm_context, *llvm_variant, cpu_level);
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * @return An i1 that is true if all the bits of <tt>mask</tt> are set in <tt>llvm_value</tt>.
+ */
+static LLVMValueRef zz_multiversion_generator_build_test(LLVMBuilderRef llvm_builder, LLVMValueRef llvm_value, rt_un32 mask, const rt_char8 *name)
+{
+	LLVMValueRef llvm_mask = LLVMConstInt(LLVMTypeOf(llvm_value), mask, RT_FALSE);
+
+	return LLVMBuildICmp(llvm_builder, LLVMIntEQ, LLVMBuildAnd(llvm_builder, llvm_value, llvm_mask, name), llvm_mask, name);
+}
+
+/**
+ * @return An i32 with the bit of <tt>cpu_level</tt> set if <tt>llvm_condition</tt> is true, zero otherwise.
+ */
+static LLVMValueRef zz_multiversion_generator_build_level(LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, LLVMValueRef llvm_condition, enum zz_cpu_level cpu_level)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+
+	return LLVMBuildSelect(llvm_builder, llvm_condition, LLVMConstInt(llvm_i32_type, 1 << cpu_level, RT_FALSE), LLVMConstNull(llvm_i32_type), zz_cpu_level_get_name8(cpu_level));
+}
+
+/**
+ * @return The register <tt>index</tt> returned by <tt>cpuid</tt> for <tt>leaf</tt>, from EAX to EDX.
+ */
+static LLVMValueRef zz_multiversion_generator_build_cpuid(LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, rt_un32 leaf, rt_un index, const rt_char8 *name)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMTypeRef llvm_types[4] = { llvm_i32_type, llvm_i32_type, llvm_i32_type, llvm_i32_type };
+	LLVMTypeRef llvm_cpuid_type;
+	LLVMValueRef llvm_cpuid;
+	LLVMValueRef llvm_arguments[2];
+	LLVMValueRef llvm_registers;
+
+	llvm_cpuid_type = LLVMFunctionType(LLVMStructTypeInContext(llvm_context, llvm_types, 4, RT_FALSE), llvm_types, 2, RT_FALSE);
+	llvm_cpuid = LLVMGetInlineAsm(llvm_cpuid_type, "cpuid", 5, "={ax},={bx},={cx},={dx},{ax},{cx}", 33, RT_FALSE, RT_FALSE, LLVMInlineAsmDialectATT, RT_FALSE);
+
+	/* The sub-leaf is zero. */
+	llvm_arguments[0] = LLVMConstInt(llvm_i32_type, leaf, RT_FALSE);
+	llvm_arguments[1] = LLVMConstNull(llvm_i32_type);
+	llvm_registers = LLVMBuildCall2(llvm_builder, llvm_cpuid_type, llvm_cpuid, llvm_arguments, 2, "cpuid");
+	return LLVMBuildExtractValue(llvm_builder, llvm_registers, (unsigned)index, name);
+}
+
+/**
+ * Add to the module, unless it already did, the function that returns the levels supported by the processor.<br>
+ * Its result has the bit of each supported <tt>enum zz_cpu_level</tt> set.
+ *
+ * <p>
+ * AVX2 and AVX-512 also need the operating system to save their registers, which is checked with <tt>xgetbv</tt>.
+ * </p>
+ */
+static LLVMValueRef zz_multiversion_generator_get_levels_function(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMTypeRef llvm_types[2] = { llvm_i32_type, llvm_i32_type };
+	LLVMTypeRef llvm_xgetbv_type;
+	LLVMValueRef llvm_xgetbv;
+	LLVMValueRef llvm_function;
+	LLVMBasicBlockRef llvm_entry_block;
+	LLVMBasicBlockRef llvm_avx_block;
+	LLVMBasicBlockRef llvm_end_block;
+	LLVMValueRef llvm_max_leaf;
+	LLVMValueRef llvm_ecx;
+	LLVMValueRef llvm_ebx;
+	LLVMValueRef llvm_xcr0;
+	LLVMValueRef llvm_has_avx;
+	LLVMValueRef llvm_levels;
+	LLVMValueRef llvm_avx_levels;
+	LLVMValueRef llvm_condition;
+	LLVMValueRef llvm_result;
+	LLVMValueRef llvm_incoming_values[2];
+	LLVMBasicBlockRef llvm_incoming_blocks[2];
+
+	llvm_function = LLVMGetNamedFunction(llvm_module, "__stc_cpu_levels");
+	if (llvm_function)
+		return llvm_function;
+
+	llvm_function = LLVMAddFunction(llvm_module, "__stc_cpu_levels", LLVMFunctionType(llvm_i32_type, RT_NULL, 0, RT_FALSE));
+	LLVMSetLinkage(llvm_function, LLVMInternalLinkage);
+	zz_multiversion_generator_set_level(llvm_context, llvm_function, ZZ_CPU_LEVELS_COUNT);
+
+	llvm_entry_block = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "entry");
+	llvm_avx_block = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "avx");
+	llvm_end_block = LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "end");
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_entry_block);
+	llvm_max_leaf = zz_multiversion_generator_build_cpuid(llvm_context, llvm_builder, 0, 0, "max_leaf");
+	llvm_ecx = zz_multiversion_generator_build_cpuid(llvm_context, llvm_builder, 1, 2, "ecx");
+	llvm_levels = zz_multiversion_generator_build_level(llvm_context, llvm_builder, zz_multiversion_generator_build_test(llvm_builder, llvm_ecx, ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_SSE4_2, "has_sse4.2"), ZZ_CPU_LEVEL_SSE4_2);
+
+	/* xgetbv is only available with OSXSAVE, and the leaf 7 may not exist. */
+	llvm_has_avx = zz_multiversion_generator_build_test(llvm_builder, llvm_ecx, ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_OSXSAVE | ZZ_MULTIVERSION_GENERATOR_CPUID_1_ECX_AVX, "has_avx");
+	llvm_condition = LLVMBuildICmp(llvm_builder, LLVMIntUGE, llvm_max_leaf, LLVMConstInt(llvm_i32_type, 7, RT_FALSE), "has_leaf_7");
+	LLVMBuildCondBr(llvm_builder, LLVMBuildAnd(llvm_builder, llvm_has_avx, llvm_condition, "has_avx"), llvm_avx_block, llvm_end_block);
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_avx_block);
+	llvm_xgetbv_type = LLVMFunctionType(LLVMStructTypeInContext(llvm_context, llvm_types, 2, RT_FALSE), llvm_types, 1, RT_FALSE);
+	llvm_xgetbv = LLVMGetInlineAsm(llvm_xgetbv_type, "xgetbv", 6, "={ax},={dx},{cx}", 16, RT_TRUE, RT_FALSE, LLVMInlineAsmDialectATT, RT_FALSE);
+	llvm_condition = LLVMConstNull(llvm_i32_type);
+	llvm_xcr0 = LLVMBuildExtractValue(llvm_builder, LLVMBuildCall2(llvm_builder, llvm_xgetbv_type, llvm_xgetbv, &llvm_condition, 1, "xgetbv"), 0, "xcr0");
+	llvm_ebx = zz_multiversion_generator_build_cpuid(llvm_context, llvm_builder, 7, 1, "ebx");
+
+	llvm_condition = LLVMBuildAnd(llvm_builder, zz_multiversion_generator_build_test(llvm_builder, llvm_xcr0, ZZ_MULTIVERSION_GENERATOR_XCR0_AVX, "saves_avx"), zz_multiversion_generator_build_test(llvm_builder, llvm_ebx, ZZ_MULTIVERSION_GENERATOR_CPUID_7_EBX_AVX2, "has_avx2"), "has_avx2");
+	llvm_avx_levels = LLVMBuildOr(llvm_builder, llvm_levels, zz_multiversion_generator_build_level(llvm_context, llvm_builder, llvm_condition, ZZ_CPU_LEVEL_AVX2), "levels");
+	llvm_condition = LLVMBuildAnd(llvm_builder, zz_multiversion_generator_build_test(llvm_builder, llvm_xcr0, ZZ_MULTIVERSION_GENERATOR_XCR0_AVX512, "saves_avx512"), zz_multiversion_generator_build_test(llvm_builder, llvm_ebx, ZZ_MULTIVERSION_GENERATOR_CPUID_7_EBX_AVX512F, "has_avx512f"), "has_avx512f");
+	llvm_avx_levels = LLVMBuildOr(llvm_builder, llvm_avx_levels, zz_multiversion_generator_build_level(llvm_context, llvm_builder, llvm_condition, ZZ_CPU_LEVEL_AVX512F), "levels");
+	LLVMBuildBr(llvm_builder, llvm_end_block);
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_end_block);
+	llvm_result = LLVMBuildPhi(llvm_builder, llvm_i32_type, "levels");
+	llvm_incoming_values[0] = llvm_levels;
+	llvm_incoming_blocks[0] = llvm_entry_block;
+	llvm_incoming_values[1] = llvm_avx_levels;
+	llvm_incoming_blocks[1] = llvm_avx_block;
+	LLVMAddIncoming(llvm_result, llvm_incoming_values, llvm_incoming_blocks, 2);
+	LLVMBuildRet(llvm_builder, llvm_result);
+
+	return llvm_function;
+}
+
+rt_s zz_multiversion_generator_dispatch(LLVMValueRef llvm_function, LLVMValueRef *llvm_variants, LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, struct rt_heap *heap)
+{
+	LLVMModuleRef llvm_module = LLVMGetGlobalParent(llvm_function);
+	LLVMTypeRef llvm_function_type = LLVMGlobalGetValueType(llvm_function);
+	LLVMTypeRef llvm_pointer_type = LLVMPointerType(llvm_function_type, 0);
+	LLVMValueRef llvm_levels_function;
+	LLVMValueRef llvm_resolver;
+	LLVMValueRef llvm_pointer;
+	LLVMValueRef llvm_levels;
+	LLVMValueRef llvm_variant;
+	LLVMValueRef llvm_instruction;
+	LLVMValueRef llvm_result;
+	rt_un i;
+	rt_s ret;
+
+	llvm_levels_function = zz_multiversion_generator_get_levels_function(llvm_context, llvm_module, llvm_builder);
+
+	llvm_resolver = LLVMAddFunction(llvm_module, "", llvm_function_type);
+	LLVMSetLinkage(llvm_resolver, LLVMInternalLinkage);
+	if (RT_UNLIKELY(!zz_multiversion_generator_set_name(llvm_resolver, llvm_function, "resolve", heap)))
+		goto error;
+	zz_multiversion_generator_set_level(llvm_context, llvm_resolver, ZZ_CPU_LEVELS_COUNT);
+
+	llvm_pointer = LLVMAddGlobal(llvm_module, llvm_pointer_type, "");
+	LLVMSetLinkage(llvm_pointer, LLVMInternalLinkage);
+	LLVMSetInitializer(llvm_pointer, llvm_resolver);
+	if (RT_UNLIKELY(!zz_multiversion_generator_set_name(llvm_pointer, llvm_function, "variant", heap)))
+		goto error;
+
+	/* The resolver keeps the variant of the highest supported level then calls it. */
+	LLVMPositionBuilderAtEnd(llvm_builder, LLVMAppendBasicBlockInContext(llvm_context, llvm_resolver, "entry"));
+	llvm_levels = LLVMBuildCall2(llvm_builder, LLVMGlobalGetValueType(llvm_levels_function), llvm_levels_function, RT_NULL, 0, "levels");
+	llvm_variant = llvm_variants[ZZ_CPU_LEVELS_COUNT];
+	for (i = 0; i < ZZ_CPU_LEVELS_COUNT; i++) {
+		if (llvm_variants[i])
+			llvm_variant = LLVMBuildSelect(llvm_builder, zz_multiversion_generator_build_test(llvm_builder, llvm_levels, 1 << i, zz_cpu_level_get_name8(i)), llvm_variants[i], llvm_variant, "variant");
+	}
+	llvm_instruction = LLVMBuildStore(llvm_builder, llvm_variant, llvm_pointer);
+	LLVMSetOrdering(llvm_instruction, LLVMAtomicOrderingUnordered);
+	llvm_result = LLVMBuildCall2(llvm_builder, llvm_function_type, llvm_variant, RT_NULL, 0, "result");
+	LLVMSetTailCall(llvm_result, RT_TRUE);
+	LLVMBuildRet(llvm_builder, llvm_result);
+
+	LLVMPositionBuilderAtEnd(llvm_builder, LLVMAppendBasicBlockInContext(llvm_context, llvm_function, "entry"));
+	llvm_variant = LLVMBuildLoad2(llvm_builder, llvm_pointer_type, llvm_pointer, "variant");
+	LLVMSetOrdering(llvm_variant, LLVMAtomicOrderingUnordered);
+	llvm_result = LLVMBuildCall2(llvm_builder, llvm_function_type, llvm_variant, RT_NULL, 0, "result");
+	LLVMSetTailCall(llvm_result, RT_TRUE);
+	LLVMBuildRet(llvm_builder, llvm_result);
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,364 @@
+#include "code_generator/zz_profile_generator.h"
+
+#include "llvm-c/Target.h"
+
+/* Constructors priority of the C library and of clang, the lowest one. */
+#define ZZ_PROFILE_GENERATOR_CONSTRUCTOR_PRIORITY 65535
+
+static rt_b zz_profile_generator_is_branch(LLVMValueRef llvm_terminator)
+{
+	return llvm_terminator && LLVMIsABranchInst(llvm_terminator) && LLVMIsConditional(llvm_terminator);
+}
+
+static rt_un zz_profile_generator_count_branches(LLVMValueRef llvm_function)
+{
+	LLVMBasicBlockRef llvm_block;
+	rt_un result = 0;
+
+	for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+		if (zz_profile_generator_is_branch(LLVMGetBasicBlockTerminator(llvm_block)))
+			result++;
+	}
+	return result;
+}
+
+/**
+ * Add <tt>llvm_increment</tt> to a counter at the position of the builder.<br>
+ * Like with clang, the increments are not atomic, some can be lost if several threads run the same code.
+ */
+static void zz_profile_generator_increment(LLVMBuilderRef llvm_builder, LLVMValueRef llvm_counters, rt_un counter, LLVMValueRef llvm_increment)
+{
+	LLVMTypeRef llvm_counter_type = LLVMTypeOf(llvm_increment);
+	LLVMValueRef llvm_indices[2];
+	LLVMValueRef llvm_pointer;
+	LLVMValueRef llvm_count;
+
+	llvm_indices[0] = LLVMConstInt(llvm_counter_type, 0, RT_FALSE);
+	llvm_indices[1] = LLVMConstInt(llvm_counter_type, counter, RT_FALSE);
+	llvm_pointer = LLVMBuildInBoundsGEP2(llvm_builder, LLVMGlobalGetValueType(llvm_counters), llvm_counters, llvm_indices, 2, "profile_counter");
+	llvm_count = LLVMBuildLoad2(llvm_builder, llvm_counter_type, llvm_pointer, "profile_count");
+	LLVMBuildStore(llvm_builder, LLVMBuildAdd(llvm_builder, llvm_count, llvm_increment, "profile_count"), llvm_pointer);
+}
+
+/**
+ * Count the calls of the function and the directions of its branches, using its counters from <tt>first_counter</tt>.
+ */
+static void zz_profile_generator_instrument_function(LLVMContextRef llvm_context, LLVMBuilderRef llvm_builder, LLVMValueRef llvm_function, LLVMValueRef llvm_counters, rt_un first_counter)
+{
+	LLVMTypeRef llvm_counter_type = LLVMInt64TypeInContext(llvm_context);
+	LLVMValueRef llvm_one = LLVMConstInt(llvm_counter_type, 1, RT_FALSE);
+	LLVMBasicBlockRef llvm_block;
+	LLVMValueRef llvm_terminator;
+	LLVMValueRef llvm_taken;
+	rt_un counter = first_counter + 1;
+
+	LLVMPositionBuilderBefore(llvm_builder, LLVMGetFirstInstruction(LLVMGetEntryBasicBlock(llvm_function)));
+	zz_profile_generator_increment(llvm_builder, llvm_counters, first_counter, llvm_one);
+
+	for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+		llvm_terminator = LLVMGetBasicBlockTerminator(llvm_block);
+		if (!zz_profile_generator_is_branch(llvm_terminator))
+			continue;
+		LLVMPositionBuilderBefore(llvm_builder, llvm_terminator);
+		zz_profile_generator_increment(llvm_builder, llvm_counters, counter, llvm_one);
+		llvm_taken = LLVMBuildZExt(llvm_builder, LLVMGetCondition(llvm_terminator), llvm_counter_type, "profile_taken");
+		zz_profile_generator_increment(llvm_builder, llvm_counters, counter + 1, llvm_taken);
+		counter += 2;
+	}
+}
+
+/**
+ * Add a private constant initialized with <tt>llvm_value</tt>.
+ *
+ * @return The address of the constant, as a byte pointer.
+ */
+static LLVMValueRef zz_profile_generator_add_constant(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMValueRef llvm_value, const rt_char8 *name)
+{
+	LLVMValueRef llvm_global;
+
+	llvm_global = LLVMAddGlobal(llvm_module, LLVMTypeOf(llvm_value), name);
+	LLVMSetInitializer(llvm_global, llvm_value);
+	LLVMSetGlobalConstant(llvm_global, RT_TRUE);
+	LLVMSetLinkage(llvm_global, LLVMPrivateLinkage);
+	LLVMSetUnnamedAddress(llvm_global, LLVMGlobalUnnamedAddr);
+	return LLVMConstBitCast(llvm_global, LLVMPointerType(LLVMInt8TypeInContext(llvm_context), 0));
+}
+
+/**
+ * Declare a function of the C library, unless the module already did.
+ */
+static LLVMValueRef zz_profile_generator_declare(LLVMModuleRef llvm_module, const rt_char8 *name, LLVMTypeRef llvm_function_type)
+{
+	LLVMValueRef llvm_function;
+
+	llvm_function = LLVMGetNamedFunction(llvm_module, name);
+	if (!llvm_function)
+		llvm_function = LLVMAddFunction(llvm_module, name, llvm_function_type);
+	return llvm_function;
+}
+
+/**
+ * Register <tt>llvm_writer</tt> with <tt>atexit</tt> from a constructor of the module.
+ */
+static void zz_profile_generator_add_constructor(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, LLVMValueRef llvm_writer)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMTypeRef llvm_i8_pointer_type = LLVMPointerType(LLVMInt8TypeInContext(llvm_context), 0);
+	LLVMTypeRef llvm_function_type = LLVMGlobalGetValueType(llvm_writer);
+	LLVMTypeRef llvm_function_pointer_type = LLVMPointerType(llvm_function_type, 0);
+	LLVMTypeRef llvm_atexit_type;
+	LLVMTypeRef llvm_constructor_types[3];
+	LLVMTypeRef llvm_constructor_type;
+	LLVMValueRef llvm_constructor_values[3];
+	LLVMValueRef llvm_constructor;
+	LLVMValueRef llvm_atexit;
+	LLVMValueRef llvm_register;
+	LLVMValueRef llvm_constructors;
+
+	llvm_atexit_type = LLVMFunctionType(llvm_i32_type, &llvm_function_pointer_type, 1, RT_FALSE);
+	llvm_atexit = zz_profile_generator_declare(llvm_module, "atexit", llvm_atexit_type);
+
+	llvm_register = LLVMAddFunction(llvm_module, "__stc_profile_register", llvm_function_type);
+	LLVMSetLinkage(llvm_register, LLVMInternalLinkage);
+	LLVMPositionBuilderAtEnd(llvm_builder, LLVMAppendBasicBlockInContext(llvm_context, llvm_register, "entry"));
+	LLVMBuildCall2(llvm_builder, llvm_atexit_type, llvm_atexit, &llvm_writer, 1, "");
+	LLVMBuildRetVoid(llvm_builder);
+
+	llvm_constructor_types[0] = llvm_i32_type;
+	llvm_constructor_types[1] = llvm_function_pointer_type;
+	llvm_constructor_types[2] = llvm_i8_pointer_type;
+	llvm_constructor_type = LLVMStructTypeInContext(llvm_context, llvm_constructor_types, 3, RT_FALSE);
+	llvm_constructor_values[0] = LLVMConstInt(llvm_i32_type, ZZ_PROFILE_GENERATOR_CONSTRUCTOR_PRIORITY, RT_FALSE);
+	llvm_constructor_values[1] = llvm_register;
+	llvm_constructor_values[2] = LLVMConstNull(llvm_i8_pointer_type);
+	llvm_constructor = LLVMConstStructInContext(llvm_context, llvm_constructor_values, 3, RT_FALSE);
+
+	llvm_constructors = LLVMAddGlobal(llvm_module, LLVMArrayType(llvm_constructor_type, 1), "llvm.global_ctors");
+	LLVMSetInitializer(llvm_constructors, LLVMConstArray(llvm_constructor_type, &llvm_constructor, 1));
+	LLVMSetLinkage(llvm_constructors, LLVMAppendingLinkage);
+}
+
+rt_s zz_profile_generator_instrument(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, LLVMBuilderRef llvm_builder, const rt_char *profile_file_path, struct rt_heap *heap)
+{
+	LLVMTypeRef llvm_void_type = LLVMVoidTypeInContext(llvm_context);
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMTypeRef llvm_i64_type = LLVMInt64TypeInContext(llvm_context);
+	LLVMTypeRef llvm_i8_pointer_type = LLVMPointerType(LLVMInt8TypeInContext(llvm_context), 0);
+	LLVMTypeRef llvm_size_type = LLVMIntPtrTypeInContext(llvm_context, LLVMGetModuleDataLayout(llvm_module));
+	LLVMTypeRef llvm_types[4];
+	LLVMTypeRef llvm_writer_type;
+	LLVMTypeRef llvm_fopen_type;
+	LLVMTypeRef llvm_fwrite_type;
+	LLVMTypeRef llvm_fclose_type;
+	LLVMValueRef llvm_fopen;
+	LLVMValueRef llvm_fwrite;
+	LLVMValueRef llvm_fclose;
+	LLVMValueRef llvm_counters;
+	LLVMValueRef llvm_writer;
+	LLVMBasicBlockRef llvm_write_block;
+	LLVMBasicBlockRef llvm_end_block;
+	LLVMValueRef llvm_function;
+	LLVMValueRef llvm_values[4];
+	LLVMValueRef llvm_indices[2];
+	LLVMValueRef llvm_file;
+	LLVMValueRef llvm_header;
+	rt_char8 profile_file_path8_buffer[RT_CHAR8_BIG_STRING_SIZE];
+	void *profile_file_path8_heap_buffer = RT_NULL;
+	rt_un profile_file_path8_heap_buffer_capacity = 0;
+	rt_char8 *profile_file_path8;
+	rt_un profile_file_path8_size;
+	const rt_char8 *name;
+	size_t name_size;
+	rt_un counters_count = 0;
+	rt_un function_counters_count;
+	rt_un counter = 0;
+	rt_s ret;
+
+	for (llvm_function = LLVMGetFirstFunction(llvm_module); llvm_function; llvm_function = LLVMGetNextFunction(llvm_function)) {
+		if (!LLVMIsDeclaration(llvm_function))
+			counters_count += 1 + 2 * zz_profile_generator_count_branches(llvm_function);
+	}
+	if (!counters_count)
+		goto end;
+
+	/* Like the paths given to fopen by C programs. */
+	if (RT_UNLIKELY(!rt_encoding_encode(profile_file_path, rt_char_get_size(profile_file_path), RT_ENCODING_SYSTEM_DEFAULT, profile_file_path8_buffer, RT_CHAR8_BIG_STRING_SIZE,
+					    &profile_file_path8_heap_buffer, &profile_file_path8_heap_buffer_capacity, &profile_file_path8, &profile_file_path8_size, heap)))
+		goto error;
+
+	llvm_counters = LLVMAddGlobal(llvm_module, LLVMArrayType(llvm_i64_type, (unsigned)counters_count), "__stc_profile_counters");
+	LLVMSetInitializer(llvm_counters, LLVMConstNull(LLVMGlobalGetValueType(llvm_counters)));
+	LLVMSetLinkage(llvm_counters, LLVMInternalLinkage);
+
+	llvm_types[0] = llvm_i8_pointer_type;
+	llvm_types[1] = llvm_i8_pointer_type;
+	llvm_fopen_type = LLVMFunctionType(llvm_i8_pointer_type, llvm_types, 2, RT_FALSE);
+	llvm_types[1] = llvm_size_type;
+	llvm_types[2] = llvm_size_type;
+	llvm_types[3] = llvm_i8_pointer_type;
+	llvm_fwrite_type = LLVMFunctionType(llvm_size_type, llvm_types, 4, RT_FALSE);
+	llvm_fclose_type = LLVMFunctionType(llvm_i32_type, &llvm_i8_pointer_type, 1, RT_FALSE);
+	llvm_fopen = zz_profile_generator_declare(llvm_module, "fopen", llvm_fopen_type);
+	llvm_fwrite = zz_profile_generator_declare(llvm_module, "fwrite", llvm_fwrite_type);
+	llvm_fclose = zz_profile_generator_declare(llvm_module, "fclose", llvm_fclose_type);
+
+	/* Appends the records of the module, if the file can be opened. */
+	llvm_writer_type = LLVMFunctionType(llvm_void_type, RT_NULL, 0, RT_FALSE);
+	llvm_writer = LLVMAddFunction(llvm_module, "__stc_profile_write", llvm_writer_type);
+	LLVMSetLinkage(llvm_writer, LLVMInternalLinkage);
+	LLVMPositionBuilderAtEnd(llvm_builder, LLVMAppendBasicBlockInContext(llvm_context, llvm_writer, "entry"));
+	llvm_write_block = LLVMAppendBasicBlockInContext(llvm_context, llvm_writer, "write");
+	llvm_end_block = LLVMAppendBasicBlockInContext(llvm_context, llvm_writer, "end");
+	llvm_values[0] = zz_profile_generator_add_constant(llvm_context, llvm_module, LLVMConstStringInContext(llvm_context, profile_file_path8, (unsigned)profile_file_path8_size, RT_FALSE), "__stc_profile_path");
+	llvm_values[1] = zz_profile_generator_add_constant(llvm_context, llvm_module, LLVMConstStringInContext(llvm_context, "ab", 2, RT_FALSE), "__stc_profile_mode");
+	llvm_file = LLVMBuildCall2(llvm_builder, llvm_fopen_type, llvm_fopen, llvm_values, 2, "file");
+	LLVMBuildCondBr(llvm_builder, LLVMBuildIsNull(llvm_builder, llvm_file, "failed"), llvm_end_block, llvm_write_block);
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_end_block);
+	LLVMBuildRetVoid(llvm_builder);
+
+	/* The writer is the first function added after those of the sources. */
+	for (llvm_function = LLVMGetFirstFunction(llvm_module); llvm_function != llvm_writer; llvm_function = LLVMGetNextFunction(llvm_function)) {
+		if (LLVMIsDeclaration(llvm_function))
+			continue;
+
+		function_counters_count = 1 + 2 * zz_profile_generator_count_branches(llvm_function);
+		zz_profile_generator_instrument_function(llvm_context, llvm_builder, llvm_function, llvm_counters, counter);
+
+		/* The header of the record, then its counters. */
+		name = LLVMGetValueName2(llvm_function, &name_size);
+		llvm_values[0] = LLVMConstInt(llvm_i32_type, name_size, RT_FALSE);
+		llvm_values[1] = LLVMConstStringInContext(llvm_context, name, (unsigned)name_size, RT_TRUE);
+		llvm_values[2] = LLVMConstInt(llvm_i32_type, function_counters_count, RT_FALSE);
+		llvm_header = zz_profile_generator_add_constant(llvm_context, llvm_module, LLVMConstStructInContext(llvm_context, llvm_values, 3, RT_TRUE), "__stc_profile_header");
+
+		LLVMPositionBuilderAtEnd(llvm_builder, llvm_write_block);
+		llvm_values[0] = llvm_header;
+		llvm_values[1] = LLVMConstInt(llvm_size_type, 8 + name_size, RT_FALSE);
+		llvm_values[2] = LLVMConstInt(llvm_size_type, 1, RT_FALSE);
+		llvm_values[3] = llvm_file;
+		LLVMBuildCall2(llvm_builder, llvm_fwrite_type, llvm_fwrite, llvm_values, 4, "");
+		llvm_indices[0] = LLVMConstInt(llvm_i64_type, 0, RT_FALSE);
+		llvm_indices[1] = LLVMConstInt(llvm_i64_type, counter, RT_FALSE);
+		llvm_values[0] = LLVMConstBitCast(LLVMConstInBoundsGEP2(LLVMGlobalGetValueType(llvm_counters), llvm_counters, llvm_indices, 2), llvm_i8_pointer_type);
+		llvm_values[1] = LLVMConstInt(llvm_size_type, 8, RT_FALSE);
+		llvm_values[2] = LLVMConstInt(llvm_size_type, function_counters_count, RT_FALSE);
+		LLVMBuildCall2(llvm_builder, llvm_fwrite_type, llvm_fwrite, llvm_values, 4, "");
+
+		counter += function_counters_count;
+	}
+
+	LLVMPositionBuilderAtEnd(llvm_builder, llvm_write_block);
+	LLVMBuildCall2(llvm_builder, llvm_fclose_type, llvm_fclose, &llvm_file, 1, "");
+	LLVMBuildBr(llvm_builder, llvm_end_block);
+
+	zz_profile_generator_add_constructor(llvm_context, llvm_module, llvm_builder, llvm_writer);
+
+end:
+	ret = RT_OK;
+free:
+	if (profile_file_path8_heap_buffer && RT_UNLIKELY(!heap->free(heap, &profile_file_path8_heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static LLVMMetadataRef zz_profile_generator_get_count(LLVMContextRef llvm_context, const rt_char8 *name, rt_un64 count)
+{
+	LLVMMetadataRef llvm_operands[2];
+
+	llvm_operands[0] = LLVMMDStringInContext2(llvm_context, name, rt_char8_get_size(name));
+	llvm_operands[1] = LLVMValueAsMetadata(LLVMConstInt(LLVMInt64TypeInContext(llvm_context), count, RT_FALSE));
+	return LLVMMDNodeInContext2(llvm_context, llvm_operands, 2);
+}
+
+/**
+ * Same layout as the <tt>ProfileSummary</tt> flag written by clang, which the passes parse.
+ */
+static void zz_profile_generator_add_summary(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, struct zz_profile *profile)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMTypeRef llvm_i64_type = LLVMInt64TypeInContext(llvm_context);
+	LLVMMetadataRef llvm_fields[8];
+	LLVMMetadataRef llvm_cutoffs[ZZ_PROFILE_CUTOFFS_COUNT];
+	LLVMMetadataRef llvm_operands[3];
+	rt_un i;
+
+	llvm_operands[0] = LLVMMDStringInContext2(llvm_context, "ProfileFormat", 13);
+	llvm_operands[1] = LLVMMDStringInContext2(llvm_context, "InstrProf", 9);
+	llvm_fields[0] = LLVMMDNodeInContext2(llvm_context, llvm_operands, 2);
+	llvm_fields[1] = zz_profile_generator_get_count(llvm_context, "TotalCount", profile->total_count);
+	llvm_fields[2] = zz_profile_generator_get_count(llvm_context, "MaxCount", profile->max_count);
+	llvm_fields[3] = zz_profile_generator_get_count(llvm_context, "MaxInternalCount", profile->max_internal_count);
+	llvm_fields[4] = zz_profile_generator_get_count(llvm_context, "MaxFunctionCount", profile->max_function_count);
+	llvm_fields[5] = zz_profile_generator_get_count(llvm_context, "NumCounts", profile->counts_count);
+	llvm_fields[6] = zz_profile_generator_get_count(llvm_context, "NumFunctions", profile->symbol_table.symbols_count);
+
+	for (i = 0; i < ZZ_PROFILE_CUTOFFS_COUNT; i++) {
+		llvm_operands[0] = LLVMValueAsMetadata(LLVMConstInt(llvm_i32_type, profile->cutoffs[i].cutoff, RT_FALSE));
+		llvm_operands[1] = LLVMValueAsMetadata(LLVMConstInt(llvm_i64_type, profile->cutoffs[i].min_count, RT_FALSE));
+		llvm_operands[2] = LLVMValueAsMetadata(LLVMConstInt(llvm_i32_type, profile->cutoffs[i].counts_count, RT_FALSE));
+		llvm_cutoffs[i] = LLVMMDNodeInContext2(llvm_context, llvm_operands, 3);
+	}
+	llvm_operands[0] = LLVMMDStringInContext2(llvm_context, "DetailedSummary", 15);
+	llvm_operands[1] = LLVMMDNodeInContext2(llvm_context, llvm_cutoffs, ZZ_PROFILE_CUTOFFS_COUNT);
+	llvm_fields[7] = LLVMMDNodeInContext2(llvm_context, llvm_operands, 2);
+
+	LLVMAddModuleFlag(llvm_module, LLVMModuleFlagBehaviorError, "ProfileSummary", 14, LLVMMDNodeInContext2(llvm_context, llvm_fields, 8));
+}
+
+/**
+ * Weights are 32 bits, bigger counts are scaled down together.
+ */
+static void zz_profile_generator_set_weights(LLVMContextRef llvm_context, LLVMValueRef llvm_branch, unsigned llvm_kind, rt_un64 executions_count, rt_un64 taken_count)
+{
+	LLVMTypeRef llvm_i32_type = LLVMInt32TypeInContext(llvm_context);
+	LLVMMetadataRef llvm_operands[3];
+	rt_un64 scale;
+
+	if (taken_count > executions_count)
+		taken_count = executions_count;
+	scale = executions_count / RT_TYPE_MAX_UN32 + 1;
+
+	llvm_operands[0] = LLVMMDStringInContext2(llvm_context, "branch_weights", 14);
+	llvm_operands[1] = LLVMValueAsMetadata(LLVMConstInt(llvm_i32_type, taken_count / scale, RT_FALSE));
+	llvm_operands[2] = LLVMValueAsMetadata(LLVMConstInt(llvm_i32_type, (executions_count - taken_count) / scale, RT_FALSE));
+	LLVMSetMetadata(llvm_branch, llvm_kind, LLVMMetadataAsValue(llvm_context, LLVMMDNodeInContext2(llvm_context, llvm_operands, 3)));
+}
+
+void zz_profile_generator_annotate(LLVMContextRef llvm_context, LLVMModuleRef llvm_module, struct zz_profile *profile)
+{
+	unsigned llvm_kind = LLVMGetMDKindIDInContext(llvm_context, "prof", 4);
+	struct zz_profile_function *function;
+	LLVMBasicBlockRef llvm_block;
+	LLVMValueRef llvm_function;
+	LLVMValueRef llvm_terminator;
+	const rt_char8 *name;
+	size_t name_size;
+	rt_un64 *counters;
+
+	for (llvm_function = LLVMGetFirstFunction(llvm_module); llvm_function; llvm_function = LLVMGetNextFunction(llvm_function)) {
+		if (LLVMIsDeclaration(llvm_function))
+			continue;
+		name = LLVMGetValueName2(llvm_function, &name_size);
+		function = zz_profile_find(profile, name, name_size);
+		if (!function || function->counters_count != 1 + 2 * zz_profile_generator_count_branches(llvm_function))
+			continue;
+
+		counters = &profile->counters[function->first_counter];
+		LLVMGlobalSetMetadata(llvm_function, llvm_kind, zz_profile_generator_get_count(llvm_context, "function_entry_count", counters[0]));
+		counters++;
+
+		for (llvm_block = LLVMGetFirstBasicBlock(llvm_function); llvm_block; llvm_block = LLVMGetNextBasicBlock(llvm_block)) {
+			llvm_terminator = LLVMGetBasicBlockTerminator(llvm_block);
+			if (!zz_profile_generator_is_branch(llvm_terminator))
+				continue;
+			zz_profile_generator_set_weights(llvm_context, llvm_terminator, llvm_kind, counters[0], counters[1]);
+			counters += 2;
+		}
+	}
+
+	zz_profile_generator_add_summary(llvm_context, llvm_module, profile);
+}
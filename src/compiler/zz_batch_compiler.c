@@ -0,0 +1,379 @@
+#include "compiler/zz_batch_compiler.h"
+
+#include "cache/zz_object_cache.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "compiler/zz_compiler.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "memory/zz_arena.h"
+#include "profile/zz_profile.h"
+#include "stats/zz_counting_heap.h"
+#include "thread/zz_thread_pool.h"
+
+/* Most sources fit in a single block. */
+#define ZZ_BATCH_COMPILER_ARENA_BLOCK_SIZE (1024 * 1024)
+
+enum zz_batch_compiler_state {
+	ZZ_BATCH_COMPILER_STATE_PENDING,
+	ZZ_BATCH_COMPILER_STATE_SUCCEEDED,
+	ZZ_BATCH_COMPILER_STATE_FAILED
+};
+
+struct zz_batch_compiler_worker {
+	struct zz_code_generator_session session;
+	rt_b session_created;
+	/* Counts the blocks of the arena, only with statistics. */
+	struct zz_counting_heap counting_heap;
+	struct zz_arena arena;
+	rt_b arena_created;
+	struct zz_stats stats;
+};
+
+struct zz_batch_compiler {
+	struct zz_options *options;
+	struct zz_stats *stats;
+	struct zz_batch_compiler_worker *workers;
+	rt_un workers_count;
+	/* Shared by the workers, null without --cache. */
+	struct zz_object_cache *object_cache;
+	struct zz_object_cache object_cache_storage;
+	/* Read once and shared by the workers, null without --profile-use. */
+	struct zz_profile *profile;
+	struct zz_profile profile_storage;
+	/* One per input. */
+	struct zz_diagnostics *diagnostics;
+	rt_un8 *states;
+	/* Diagnostics are written in order, up to this input excluded. */
+	rt_un written_inputs_count;
+	/* Value returned by main with --run, which has a single input. */
+	rt_n32 exit_code;
+	struct rt_critical_section critical_section;
+	struct rt_heap *heap;
+};
+
+/**
+ * Record the result of <tt>input</tt>, then write the diagnostics of the inputs that are done, in order.
+ */
+static rt_s zz_batch_compiler_complete(struct zz_batch_compiler *batch_compiler, rt_un input, rt_b succeeded)
+{
+	rt_b entered = RT_FALSE;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_critical_section_enter(&batch_compiler->critical_section)))
+		goto error;
+	entered = RT_TRUE;
+
+	batch_compiler->states[input] = succeeded ? ZZ_BATCH_COMPILER_STATE_SUCCEEDED : ZZ_BATCH_COMPILER_STATE_FAILED;
+
+	while (batch_compiler->written_inputs_count < batch_compiler->options->input_files_count) {
+		i = batch_compiler->written_inputs_count;
+		if (batch_compiler->states[i] == ZZ_BATCH_COMPILER_STATE_PENDING)
+			break;
+		if (RT_UNLIKELY(!zz_diagnostics_write(&batch_compiler->diagnostics[i])))
+			goto error;
+		if (RT_UNLIKELY(!zz_diagnostics_free(&batch_compiler->diagnostics[i])))
+			goto error;
+		batch_compiler->written_inputs_count++;
+	}
+
+	ret = RT_OK;
+free:
+	if (entered) {
+		entered = RT_FALSE;
+		if (RT_UNLIKELY(!rt_critical_section_leave(&batch_compiler->critical_section) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_batch_compiler_worker_callback(struct zz_thread_pool *thread_pool, rt_un worker_index)
+{
+	struct zz_batch_compiler *batch_compiler = (struct zz_batch_compiler*)thread_pool->context;
+	struct zz_batch_compiler_worker *worker = &batch_compiler->workers[worker_index];
+	struct zz_options *options = batch_compiler->options;
+	struct zz_stats *stats = batch_compiler->stats ? &worker->stats : RT_NULL;
+	rt_b succeeded;
+	rt_un input;
+	rt_s ret;
+
+	while (RT_TRUE) {
+		if (RT_UNLIKELY(!zz_thread_pool_take_task(thread_pool, &input)))
+			goto error;
+		if (input == RT_TYPE_MAX_UN)
+			break;
+
+		succeeded = zz_compiler_compile(&worker->session, batch_compiler->object_cache, batch_compiler->profile, options->input_file_paths[input], options, &batch_compiler->diagnostics[input], stats, &batch_compiler->exit_code, &worker->arena.heap);
+
+		/* Keep the blocks for the next file. */
+		if (RT_UNLIKELY(!zz_arena_reset(&worker->arena)))
+			goto error;
+
+		if (RT_UNLIKELY(!zz_batch_compiler_complete(batch_compiler, input, succeeded)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Sessions are created here, by a single thread, as the LLVM targets registration is not thread safe.
+ */
+static rt_s zz_batch_compiler_create_workers(struct zz_batch_compiler *batch_compiler)
+{
+	struct zz_stats *stats = batch_compiler->stats;
+	struct zz_batch_compiler_worker *worker;
+	struct zz_diagnostics diagnostics;
+	struct rt_heap *arena_parent;
+	rt_un i;
+	rt_s ret;
+
+	zz_diagnostics_create(&diagnostics, RT_NULL, batch_compiler->heap);
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_SETUP)))
+		goto error;
+
+	for (i = 0; i < batch_compiler->workers_count; i++) {
+		worker = &batch_compiler->workers[i];
+
+		if (RT_UNLIKELY(!zz_code_generator_session_create(&worker->session, batch_compiler->options, &diagnostics))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("LLVM initialization failed: "));
+			goto error;
+		}
+		worker->session_created = RT_TRUE;
+
+		if (stats) {
+			zz_stats_create_child(&worker->stats, stats, i + 1);
+			zz_counting_heap_create(&worker->counting_heap, batch_compiler->heap);
+			arena_parent = &worker->counting_heap.heap;
+		} else {
+			arena_parent = batch_compiler->heap;
+		}
+		zz_arena_create(&worker->arena, arena_parent, ZZ_BATCH_COMPILER_ARENA_BLOCK_SIZE);
+		worker->arena_created = RT_TRUE;
+	}
+
+	if (batch_compiler->options->profile_use_file_path) {
+		batch_compiler->profile = &batch_compiler->profile_storage;
+		if (RT_UNLIKELY(!zz_profile_read(batch_compiler->profile, batch_compiler->options->profile_use_file_path, batch_compiler->heap))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("Profile reading failed: "));
+			goto error;
+		}
+	}
+
+	/* Only single object files are cached, and --run does not produce any. */
+	if (batch_compiler->options->cache_directory_path && !batch_compiler->options->run && batch_compiler->options->emit == ZZ_EMIT_OBJ && batch_compiler->options->codegen_units == 1 && !batch_compiler->options->standard_output) {
+		if (RT_UNLIKELY(!zz_object_cache_create(&batch_compiler->object_cache_storage, batch_compiler->options, &batch_compiler->workers[0].session, batch_compiler->profile))) {
+			zz_diagnostics_add_last_error(&diagnostics, _R("Object cache initialization failed: "));
+			goto error;
+		}
+		batch_compiler->object_cache = &batch_compiler->object_cache_storage;
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_SETUP)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_diagnostics_write(&diagnostics) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Merge the statistics of the workers, then free them.
+ */
+static rt_s zz_batch_compiler_free_workers(struct zz_batch_compiler *batch_compiler)
+{
+	struct zz_stats *stats = batch_compiler->stats;
+	struct zz_batch_compiler_worker *worker;
+	rt_un i;
+	rt_s ret = RT_OK;
+
+	for (i = 0; i < batch_compiler->workers_count; i++) {
+		worker = &batch_compiler->workers[i];
+		if (worker->arena_created) {
+			worker->arena_created = RT_FALSE;
+			if (RT_UNLIKELY(!zz_arena_free(&worker->arena)))
+				ret = RT_FAILED;
+			if (stats) {
+				zz_stats_merge(stats, &worker->stats);
+				/* Upper bound of the peak, the workers may not peak at the same time. */
+				stats->heap_allocated_bytes += worker->counting_heap.allocated_bytes;
+				stats->heap_allocations_count += worker->counting_heap.allocations_count;
+				stats->heap_peak_bytes += worker->counting_heap.peak_bytes;
+			}
+		}
+		if (worker->session_created) {
+			worker->session_created = RT_FALSE;
+			if (RT_UNLIKELY(!zz_code_generator_session_free(&worker->session)))
+				ret = RT_FAILED;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * Once all the inputs are compiled, so that the directory is scanned once per batch.
+ */
+static rt_s zz_batch_compiler_evict(struct zz_batch_compiler *batch_compiler)
+{
+	struct zz_diagnostics diagnostics;
+	rt_un evicted_count;
+	rt_s ret;
+
+	zz_diagnostics_create(&diagnostics, RT_NULL, batch_compiler->heap);
+
+	if (RT_UNLIKELY(!zz_object_cache_evict(batch_compiler->object_cache, &evicted_count, batch_compiler->heap))) {
+		zz_diagnostics_add_last_error(&diagnostics, _R("Object cache eviction failed: "));
+		goto error;
+	}
+	if (batch_compiler->stats)
+		batch_compiler->stats->cache_evictions += evicted_count;
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_diagnostics_write(&diagnostics) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_batch_compiler_compile_with_workers(struct zz_batch_compiler *batch_compiler)
+{
+	struct zz_thread_pool thread_pool;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < batch_compiler->workers_count; i++) {
+		batch_compiler->workers[i].session_created = RT_FALSE;
+		batch_compiler->workers[i].arena_created = RT_FALSE;
+	}
+
+	if (RT_UNLIKELY(!zz_batch_compiler_create_workers(batch_compiler)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_thread_pool_run(&thread_pool, batch_compiler->workers_count, batch_compiler->options->input_files_count, &zz_batch_compiler_worker_callback, batch_compiler, batch_compiler->heap)))
+		goto error;
+
+	if (batch_compiler->object_cache && RT_UNLIKELY(!zz_batch_compiler_evict(batch_compiler)))
+		goto error;
+
+	for (i = 0; i < batch_compiler->options->input_files_count; i++) {
+		if (batch_compiler->states[i] != ZZ_BATCH_COMPILER_STATE_SUCCEEDED) {
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_batch_compiler_free_workers(batch_compiler) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_batch_compiler_compile(struct zz_options *options, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap)
+{
+	struct zz_batch_compiler batch_compiler;
+	rt_un inputs_count = options->input_files_count;
+	rt_b critical_section_created = RT_FALSE;
+	rt_un i;
+	rt_s ret;
+
+	batch_compiler.options = options;
+	batch_compiler.stats = stats;
+	batch_compiler.workers = RT_NULL;
+	batch_compiler.object_cache = RT_NULL;
+	batch_compiler.profile = RT_NULL;
+	batch_compiler.diagnostics = RT_NULL;
+	batch_compiler.states = RT_NULL;
+	batch_compiler.written_inputs_count = 0;
+	batch_compiler.exit_code = 0;
+	batch_compiler.heap = heap;
+
+	batch_compiler.workers_count = options->jobs ? options->jobs : zz_thread_pool_get_processors_count();
+	if (options->trace)
+		batch_compiler.workers_count = 1;
+	if (batch_compiler.workers_count > inputs_count)
+		batch_compiler.workers_count = inputs_count;
+
+	if (RT_UNLIKELY(!rt_critical_section_create(&batch_compiler.critical_section, RT_FALSE)))
+		goto error;
+	critical_section_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&batch_compiler.workers, batch_compiler.workers_count * sizeof(struct zz_batch_compiler_worker))))
+		goto error;
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&batch_compiler.diagnostics, inputs_count * sizeof(struct zz_diagnostics))))
+		goto error;
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&batch_compiler.states, inputs_count * sizeof(rt_un8))))
+		goto error;
+
+	for (i = 0; i < inputs_count; i++) {
+		zz_diagnostics_create(&batch_compiler.diagnostics[i], options->input_file_paths[i], heap);
+		batch_compiler.states[i] = ZZ_BATCH_COMPILER_STATE_PENDING;
+	}
+
+	if (RT_UNLIKELY(!zz_batch_compiler_compile_with_workers(&batch_compiler)))
+		goto error;
+	*exit_code = batch_compiler.exit_code;
+
+	ret = RT_OK;
+free:
+	if (batch_compiler.diagnostics) {
+		/* Only the inputs that have not been written if a worker failed. */
+		/* The count is advanced first so that an input is not written nor freed twice when coming back from error. */
+		while (batch_compiler.written_inputs_count < inputs_count) {
+			i = batch_compiler.written_inputs_count++;
+			if (RT_UNLIKELY(!zz_diagnostics_write(&batch_compiler.diagnostics[i]) && ret)) {
+				zz_diagnostics_free(&batch_compiler.diagnostics[i]);
+				goto error;
+			}
+			if (RT_UNLIKELY(!zz_diagnostics_free(&batch_compiler.diagnostics[i]) && ret))
+				goto error;
+		}
+		if (RT_UNLIKELY(!heap->free(heap, (void**)&batch_compiler.diagnostics) && ret))
+			goto error;
+	}
+	if (batch_compiler.profile && RT_UNLIKELY(!zz_profile_free(batch_compiler.profile) && ret))
+		goto error;
+	if (batch_compiler.states && RT_UNLIKELY(!heap->free(heap, (void**)&batch_compiler.states) && ret))
+		goto error;
+	if (batch_compiler.workers && RT_UNLIKELY(!heap->free(heap, (void**)&batch_compiler.workers) && ret))
+		goto error;
+	if (critical_section_created) {
+		critical_section_created = RT_FALSE;
+		if (RT_UNLIKELY(!rt_critical_section_free(&batch_compiler.critical_section) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,233 @@
+#include "compiler/zz_compiler.h"
+
+#include "ast/zz_ast.h"
+#include "cache/zz_object_cache.h"
+#include "code_generator/zz_code_generator.h"
+#include "lexer/zz_lexer.h"
+#include "optimizer/zz_optimizer.h"
+#include "output/zz_output_file.h"
+#include "parser/zz_parser.h"
+#include "source/zz_source_file.h"
+
+static rt_s zz_compiler_compile_token_buffer(struct zz_code_generator_session *session, struct zz_profile *profile, rt_char8 *input, struct zz_token_buffer *token_buffer, struct zz_symbol_table *symbol_table, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap)
+{
+	struct zz_ast ast;
+	rt_s ret;
+
+	zz_ast_create(&ast, heap);
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_PARSE)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_parser_parse(input, token_buffer, &ast))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Compilation failed: "));
+		goto error;
+	}
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_PARSE)))
+			goto error;
+		stats->ast_nodes_count += ast.nodes_count;
+		stats->ast_size += zz_ast_get_size(&ast);
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_OPTIMIZE)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_optimizer_optimize(&ast))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Optimization failed: "));
+		goto error;
+	}
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_OPTIMIZE)))
+			goto error;
+		stats->optimized_ast_nodes_count += ast.nodes_count;
+	}
+
+	if (RT_UNLIKELY(!zz_code_generator_generate(session, &ast, symbol_table, profile, input_file_path, options, diagnostics, stats, exit_code))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Code generation failed: "));
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_ast_free(&ast) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_compiler_compile_input(struct zz_code_generator_session *session, struct zz_profile *profile, rt_char8 *input, rt_un input_size, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap)
+{
+	struct zz_token_buffer token_buffer;
+	struct zz_symbol_table symbol_table;
+	rt_s ret;
+
+	zz_token_buffer_create(&token_buffer, heap);
+	zz_symbol_table_create(&symbol_table, heap);
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_LEX)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_lexer_tokenize(input, input_size, &token_buffer, &symbol_table))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Compilation failed: "));
+		goto error;
+	}
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_LEX)))
+			goto error;
+		stats->tokens_count += token_buffer.size;
+		stats->symbols_count += symbol_table.symbols_count;
+	}
+
+	if (options->trace & ZZ_TRACE_TOKENS) {
+		if (RT_UNLIKELY(!zz_lexer_write_tokens(input, &token_buffer, heap)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_compiler_compile_token_buffer(session, profile, input, &token_buffer, &symbol_table, input_file_path, options, diagnostics, stats, exit_code, heap)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_symbol_table_free(&symbol_table) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_token_buffer_free(&token_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Restore the object file from the cache, if possible.
+ *
+ * @param key Used to store the object file once compiled.
+ */
+static rt_s zz_compiler_restore(struct zz_object_cache *object_cache, struct zz_source_file *source_file, rt_char *output_file_path, struct zz_object_cache_key *key, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_b *restored)
+{
+	rt_s ret;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_CACHE)))
+		goto error;
+
+	zz_object_cache_get_key(object_cache, source_file->data, source_file->size, key);
+	if (RT_UNLIKELY(!zz_object_cache_restore(object_cache, key, output_file_path, restored))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Object cache failed: "));
+		goto error;
+	}
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_CACHE)))
+			goto error;
+		if (*restored)
+			stats->cache_hits++;
+		else
+			stats->cache_misses++;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * A failure to store the object file is reported but the compilation succeeds.
+ */
+static rt_s zz_compiler_store(struct zz_object_cache *object_cache, rt_char *output_file_path, struct zz_object_cache_key *key, struct zz_diagnostics *diagnostics, struct zz_stats *stats)
+{
+	rt_s ret;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_CACHE)))
+		goto error;
+
+	if (!zz_object_cache_store(object_cache, key, output_file_path)) {
+		if (RT_UNLIKELY(!zz_diagnostics_add_last_error(diagnostics, _R("Warning, object cache update failed: "))))
+			goto error;
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_CACHE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_compiler_compile(struct zz_code_generator_session *session, struct zz_object_cache *object_cache, struct zz_profile *profile, const rt_char *input_file_path, struct zz_options *options, struct zz_diagnostics *diagnostics, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap)
+{
+	struct zz_source_file source_file;
+	rt_b source_file_opened = RT_FALSE;
+	rt_char output_file_path[RT_FILE_PATH_SIZE];
+	rt_un output_file_path_size;
+	struct zz_object_cache_key key;
+	rt_b restored;
+	rt_s ret;
+
+	/* Also checks the extension of the input file, without -o. */
+	if (RT_UNLIKELY(!zz_output_file_get_path(input_file_path, options, ZZ_EMIT_OBJ, 0, output_file_path, RT_FILE_PATH_SIZE, &output_file_path_size))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Compilation failed: "));
+		goto error;
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_READ)))
+		goto error;
+
+	/* The tokens and the AST point directly into the mapped UTF-8 file. */
+	if (RT_UNLIKELY(!zz_source_file_open(&source_file, input_file_path, heap))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Compilation failed: "));
+		goto error;
+	}
+	source_file_opened = RT_TRUE;
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_READ)))
+			goto error;
+		stats->input_size += source_file.size;
+		stats->files_count++;
+	}
+
+	if (object_cache) {
+		if (RT_UNLIKELY(!zz_compiler_restore(object_cache, &source_file, output_file_path, &key, diagnostics, stats, &restored)))
+			goto error;
+		if (restored)
+			goto end;
+	}
+
+	if (RT_UNLIKELY(!zz_compiler_compile_input(session, profile, source_file.data, source_file.size, input_file_path, options, diagnostics, stats, exit_code, heap)))
+		goto error;
+
+	if (object_cache) {
+		if (RT_UNLIKELY(!zz_compiler_store(object_cache, output_file_path, &key, diagnostics, stats)))
+			goto error;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	if (source_file_opened) {
+		source_file_opened = RT_FALSE;
+		if (RT_UNLIKELY(!zz_source_file_close(&source_file) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
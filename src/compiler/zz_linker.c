@@ -0,0 +1,232 @@
+#include "compiler/zz_linker.h"
+
+#include "code_generator/zz_code_generator.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "code_generator/zz_llvm_error.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "source/zz_source_file.h"
+#include "stats/zz_counting_heap.h"
+
+#include "llvm-c/BitReader.h"
+#include "llvm-c/Linker.h"
+
+struct zz_linker {
+	struct zz_code_generator_session session;
+	/* Receives the LLVM diagnostics, those of the current input while linking. */
+	struct zz_diagnostics *diagnostics;
+	/* A diagnostic could not be added by the handler, which cannot fail. */
+	rt_b diagnostics_failed;
+	struct zz_options *options;
+	struct zz_stats *stats;
+	struct rt_heap *heap;
+};
+
+/**
+ * Without a handler, LLVM writes its errors on the console then exits the process.
+ */
+static void zz_linker_handle_diagnostic(LLVMDiagnosticInfoRef llvm_diagnostic_info, void *context)
+{
+	struct zz_linker *linker = (struct zz_linker*)context;
+	LLVMDiagnosticSeverity llvm_severity = LLVMGetDiagInfoSeverity(llvm_diagnostic_info);
+
+	if (llvm_severity == LLVMDSError || llvm_severity == LLVMDSWarning) {
+		if (RT_UNLIKELY(!zz_llvm_error_add_message(linker->diagnostics, LLVMGetDiagInfoDescription(llvm_diagnostic_info))))
+			linker->diagnostics_failed = RT_TRUE;
+	}
+}
+
+/**
+ * Parse the bitcode file <tt>input_file_path</tt> then link it into <tt>llvm_module</tt>, or make it <tt>llvm_module</tt> if it is the first one.
+ */
+static rt_s zz_linker_add_input(struct zz_linker *linker, const rt_char *input_file_path, struct zz_diagnostics *diagnostics, LLVMModuleRef *llvm_module)
+{
+	struct zz_stats *stats = linker->stats;
+	struct zz_source_file source_file;
+	rt_b source_file_opened = RT_FALSE;
+	LLVMMemoryBufferRef llvm_memory_buffer = RT_NULL;
+	LLVMModuleRef llvm_input_module;
+	rt_s ret;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_READ)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_source_file_open(&source_file, input_file_path, linker->heap))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Link failed: "));
+		goto error;
+	}
+	source_file_opened = RT_TRUE;
+
+	if (stats) {
+		if (RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_READ)))
+			goto error;
+		stats->input_size += source_file.size;
+		stats->files_count++;
+		if (RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_LINK)))
+			goto error;
+	}
+
+	linker->diagnostics = diagnostics;
+
+	/* The buffer does not copy the mapped file. */
+	llvm_memory_buffer = LLVMCreateMemoryBufferWithMemoryRange(source_file.data, source_file.size, "stc_input", 0);
+	if (RT_UNLIKELY(LLVMParseBitcodeInContext2(linker->session.llvm_context, llvm_memory_buffer, &llvm_input_module))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		zz_diagnostics_add_last_error(diagnostics, _R("Link failed: "));
+		goto error;
+	}
+
+	if (!*llvm_module) {
+		*llvm_module = llvm_input_module;
+	} else if (RT_UNLIKELY(LLVMLinkModules2(*llvm_module, llvm_input_module))) {
+		/* The input module is destroyed even on failure. */
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		zz_diagnostics_add_last_error(diagnostics, _R("Link failed: "));
+		goto error;
+	}
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_LINK)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (llvm_memory_buffer)
+		LLVMDisposeMemoryBuffer(llvm_memory_buffer);
+	if (source_file_opened) {
+		source_file_opened = RT_FALSE;
+		if (RT_UNLIKELY(!zz_source_file_close(&source_file) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Link all the inputs, writing the diagnostics of each input once it is linked.
+ */
+static rt_s zz_linker_add_inputs(struct zz_linker *linker, LLVMModuleRef *llvm_module)
+{
+	struct zz_options *options = linker->options;
+	struct zz_diagnostics diagnostics;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < options->input_files_count; i++) {
+		zz_diagnostics_create(&diagnostics, options->input_file_paths[i], linker->heap);
+		ret = zz_linker_add_input(linker, options->input_file_paths[i], &diagnostics, llvm_module);
+		linker->diagnostics = RT_NULL;
+		if (RT_UNLIKELY(!zz_diagnostics_write(&diagnostics)))
+			ret = RT_FAILED;
+		if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics)))
+			ret = RT_FAILED;
+		if (RT_UNLIKELY(!ret))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_linker_link_with_heap(struct zz_linker *linker, struct zz_diagnostics *diagnostics)
+{
+	struct zz_options *options = linker->options;
+	struct zz_stats *stats = linker->stats;
+	rt_b session_created = RT_FALSE;
+	LLVMModuleRef llvm_module = RT_NULL;
+	rt_s ret;
+
+	if (stats && RT_UNLIKELY(!zz_stats_begin_phase(stats, ZZ_STATS_PHASE_SETUP)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_code_generator_session_create(&linker->session, options, diagnostics))) {
+		zz_diagnostics_add_last_error(diagnostics, _R("LLVM initialization failed: "));
+		goto error;
+	}
+	session_created = RT_TRUE;
+	LLVMContextSetDiagnosticHandler(linker->session.llvm_context, &zz_linker_handle_diagnostic, linker);
+
+	if (stats && RT_UNLIKELY(!zz_stats_end_phase(stats, ZZ_STATS_PHASE_SETUP)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_linker_add_inputs(linker, &llvm_module)))
+		goto error;
+
+	/* The module is disposed by the code generator. */
+	linker->diagnostics = diagnostics;
+	ret = zz_code_generator_generate_linked(&linker->session, llvm_module, options->input_file_paths[0], options, diagnostics, stats, linker->heap);
+	llvm_module = RT_NULL;
+	if (RT_UNLIKELY(!ret)) {
+		zz_diagnostics_add_last_error(diagnostics, _R("Code generation failed: "));
+		goto error;
+	}
+
+	if (RT_UNLIKELY(linker->diagnostics_failed)) {
+		rt_error_set_last(RT_ERROR_NOT_ENOUGH_MEMORY);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	linker->diagnostics = RT_NULL;
+	if (llvm_module)
+		LLVMDisposeModule(llvm_module);
+	if (session_created) {
+		session_created = RT_FALSE;
+		if (RT_UNLIKELY(!zz_code_generator_session_free(&linker->session) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_linker_link(struct zz_options *options, struct zz_stats *stats, struct rt_heap *heap)
+{
+	struct zz_linker linker;
+	struct zz_counting_heap counting_heap;
+	struct zz_diagnostics diagnostics;
+	rt_s ret;
+
+	if (stats) {
+		zz_counting_heap_create(&counting_heap, heap);
+		heap = &counting_heap.heap;
+	}
+
+	linker.diagnostics = RT_NULL;
+	linker.diagnostics_failed = RT_FALSE;
+	linker.options = options;
+	linker.stats = stats;
+	linker.heap = heap;
+
+	zz_diagnostics_create(&diagnostics, RT_NULL, heap);
+
+	if (RT_UNLIKELY(!zz_linker_link_with_heap(&linker, &diagnostics)))
+		goto error;
+
+	if (stats) {
+		stats->heap_allocated_bytes += counting_heap.allocated_bytes;
+		stats->heap_allocations_count += counting_heap.allocations_count;
+		stats->heap_peak_bytes += counting_heap.peak_bytes;
+	}
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_diagnostics_write(&diagnostics) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
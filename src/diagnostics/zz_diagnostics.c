@@ -0,0 +1,174 @@
+#include "diagnostics/zz_diagnostics.h"
+
+/**
+ * Make room for <tt>size</tt> more characters.
+ */
+static rt_s zz_diagnostics_reserve(struct zz_diagnostics *diagnostics, rt_un size)
+{
+	struct rt_heap *heap = diagnostics->heap;
+	rt_un capacity;
+	rt_s ret;
+
+	if (diagnostics->size + size <= diagnostics->capacity)
+		goto end;
+
+	capacity = diagnostics->capacity ? diagnostics->capacity * 2 : RT_CHAR_BIG_STRING_SIZE;
+	while (capacity < diagnostics->size + size)
+		capacity *= 2;
+
+	if (diagnostics->buffer) {
+		if (RT_UNLIKELY(!heap->realloc(heap, (void**)&diagnostics->buffer, capacity * sizeof(rt_char))))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)&diagnostics->buffer, capacity * sizeof(rt_char))))
+			goto error;
+	}
+	diagnostics->capacity = capacity;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_diagnostics_append(struct zz_diagnostics *diagnostics, const rt_char *str, rt_un str_size)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_diagnostics_reserve(diagnostics, str_size)))
+		goto error;
+	RT_MEMORY_COPY(str, &diagnostics->buffer[diagnostics->size], str_size * sizeof(rt_char));
+	diagnostics->size += str_size;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_diagnostics_append_prefix(struct zz_diagnostics *diagnostics)
+{
+	rt_s ret;
+
+	if (diagnostics->prefix) {
+		if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, diagnostics->prefix, rt_char_get_size(diagnostics->prefix))))
+			goto error;
+		if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, _R(": "), 2)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+void zz_diagnostics_create(struct zz_diagnostics *diagnostics, const rt_char *prefix, struct rt_heap *heap)
+{
+	diagnostics->buffer = RT_NULL;
+	diagnostics->size = 0;
+	diagnostics->capacity = 0;
+	diagnostics->prefix = prefix;
+	diagnostics->heap = heap;
+}
+
+rt_s zz_diagnostics_add_last_error(struct zz_diagnostics *diagnostics, const rt_char *message)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size = 0;
+	rt_s ret;
+
+	/* Read the last error before it is overwritten. */
+	if (RT_UNLIKELY(!rt_char_append(message, rt_char_get_size(message), buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_error_message_append_last(buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_diagnostics_append_prefix(diagnostics)))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, buffer, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, _R("\n"), 1)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_diagnostics_add_message8(struct zz_diagnostics *diagnostics, const rt_char8 *message)
+{
+	struct rt_heap *heap = diagnostics->heap;
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	void *heap_buffer = RT_NULL;
+	rt_un heap_buffer_capacity = 0;
+	rt_char *output;
+	rt_un output_size;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_encoding_decode(message, rt_char8_get_size(message), RT_ENCODING_SYSTEM_DEFAULT, buffer, RT_CHAR_BIG_STRING_SIZE, &heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_diagnostics_append_prefix(diagnostics)))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, output, output_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_diagnostics_append(diagnostics, _R("\n"), 1)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (heap_buffer && RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_diagnostics_write(struct zz_diagnostics *diagnostics)
+{
+	rt_s ret;
+
+	if (diagnostics->size) {
+		if (RT_UNLIKELY(!rt_console_write_error_with_size(diagnostics->buffer, diagnostics->size)))
+			goto error;
+		diagnostics->size = 0;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_diagnostics_free(struct zz_diagnostics *diagnostics)
+{
+	struct rt_heap *heap = diagnostics->heap;
+	rt_s ret = RT_OK;
+
+	if (diagnostics->buffer && RT_UNLIKELY(!heap->free(heap, (void**)&diagnostics->buffer)))
+		ret = RT_FAILED;
+	diagnostics->size = 0;
+	diagnostics->capacity = 0;
+
+	return ret;
+}
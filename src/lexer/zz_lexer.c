@@ -1,115 +1,413 @@
 #include "lexer/zz_lexer.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ZZ_LEXER_SIMD
+#define ZZ_LEXER_BLOCK_SIZE 32
+typedef __m256i zz_lexer_block;
+#define ZZ_LEXER_BLOCK_LOAD(address) _mm256_load_si256((const __m256i*)(address))
+#define ZZ_LEXER_BLOCK_SET(character) _mm256_set1_epi8(character)
+#define ZZ_LEXER_BLOCK_EQUALS(block1, block2) _mm256_cmpeq_epi8(block1, block2)
+#define ZZ_LEXER_BLOCK_GREATER(block1, block2) _mm256_cmpgt_epi8(block1, block2)
+#define ZZ_LEXER_BLOCK_AND(block1, block2) _mm256_and_si256(block1, block2)
+#define ZZ_LEXER_BLOCK_OR(block1, block2) _mm256_or_si256(block1, block2)
+#define ZZ_LEXER_BLOCK_MASK(block) ((rt_un32)_mm256_movemask_epi8(block))
+#define ZZ_LEXER_BLOCK_FULL_MASK 0xFFFFFFFF
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ZZ_LEXER_SIMD
+#define ZZ_LEXER_BLOCK_SIZE 16
+typedef __m128i zz_lexer_block;
+#define ZZ_LEXER_BLOCK_LOAD(address) _mm_load_si128((const __m128i*)(address))
+#define ZZ_LEXER_BLOCK_SET(character) _mm_set1_epi8(character)
+#define ZZ_LEXER_BLOCK_EQUALS(block1, block2) _mm_cmpeq_epi8(block1, block2)
+#define ZZ_LEXER_BLOCK_GREATER(block1, block2) _mm_cmpgt_epi8(block1, block2)
+#define ZZ_LEXER_BLOCK_AND(block1, block2) _mm_and_si128(block1, block2)
+#define ZZ_LEXER_BLOCK_OR(block1, block2) _mm_or_si128(block1, block2)
+#define ZZ_LEXER_BLOCK_MASK(block) ((rt_un32)_mm_movemask_epi8(block))
+#define ZZ_LEXER_BLOCK_FULL_MASK 0xFFFF
+#endif
+
+enum zz_lexer_char_class {
+	ZZ_LEXER_CHAR_CLASS_INVALID,
+	ZZ_LEXER_CHAR_CLASS_END_OF_FILE,
+	ZZ_LEXER_CHAR_CLASS_BLANK,
+	ZZ_LEXER_CHAR_CLASS_ALPHA,
+	ZZ_LEXER_CHAR_CLASS_DIGIT,
+	ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	/* Only valid in "..". */
+	ZZ_LEXER_CHAR_CLASS_DOT
+};
+
 /**
- * Read something that starts with a letter or an underscore and is composed of letters, digits, and underscores.
+ * Class of each byte.<br>
+ * The underscore is considered as a letter, the bytes of UTF-8 multi-bytes sequences are invalid.
+ */
+static const rt_un8 zz_lexer_char_classes[256] = {
+	[0] = ZZ_LEXER_CHAR_CLASS_END_OF_FILE,
+	[' '] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['\t'] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['\n'] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['\r'] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['\v'] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['\f'] = ZZ_LEXER_CHAR_CLASS_BLANK,
+	['a' ... 'z'] = ZZ_LEXER_CHAR_CLASS_ALPHA,
+	['A' ... 'Z'] = ZZ_LEXER_CHAR_CLASS_ALPHA,
+	['_'] = ZZ_LEXER_CHAR_CLASS_ALPHA,
+	['0' ... '9'] = ZZ_LEXER_CHAR_CLASS_DIGIT,
+	['+'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['-'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['*'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['/'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['%'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['{'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['}'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['('] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	[')'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['['] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	[']'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	[','] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	[':'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	[';'] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['='] = ZZ_LEXER_CHAR_CLASS_PUNCTUATION,
+	['.'] = ZZ_LEXER_CHAR_CLASS_DOT
+};
+
+/**
+ * Token type of the characters of class <tt>ZZ_LEXER_CHAR_CLASS_PUNCTUATION</tt>.
+ */
+static const rt_un8 zz_lexer_punctuation_token_types[256] = {
+	['+'] = ZZ_TOKEN_TYPE_PLUS,
+	['-'] = ZZ_TOKEN_TYPE_MINUS,
+	['*'] = ZZ_TOKEN_TYPE_ASTERISK,
+	['/'] = ZZ_TOKEN_TYPE_SLASH,
+	['%'] = ZZ_TOKEN_TYPE_PERCENT,
+	['{'] = ZZ_TOKEN_TYPE_OPEN_BRACE,
+	['}'] = ZZ_TOKEN_TYPE_CLOSE_BRACE,
+	['('] = ZZ_TOKEN_TYPE_OPEN_PARENTHESIS,
+	[')'] = ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS,
+	['['] = ZZ_TOKEN_TYPE_OPEN_BRACKET,
+	[']'] = ZZ_TOKEN_TYPE_CLOSE_BRACKET,
+	[','] = ZZ_TOKEN_TYPE_COMMA,
+	[':'] = ZZ_TOKEN_TYPE_COLON,
+	[';'] = ZZ_TOKEN_TYPE_SEMICOLON,
+	['='] = ZZ_TOKEN_TYPE_EQUALS
+};
+
+#define ZZ_LEXER_GET_CHAR_CLASS(character) (zz_lexer_char_classes[(rt_un8)(character)])
+
+#define ZZ_LEXER_IS_IDENTIFIER_CHAR(character) (ZZ_LEXER_GET_CHAR_CLASS(character) == ZZ_LEXER_CHAR_CLASS_ALPHA || ZZ_LEXER_GET_CHAR_CLASS(character) == ZZ_LEXER_CHAR_CLASS_DIGIT)
+
+struct zz_lexer_keyword {
+	const rt_char8 *str;
+	rt_un str_size;
+	enum zz_token_type type;
+};
+
+/**
+ * Perfect hash of the keywords, using their first two characters, last character and size.<br>
+ * The second character tells apart the types like <tt>i32x4</tt> and <tt>i64x4</tt>.
+ *
+ * <p>
+ * The keywords table is indexed by this hash at compile time so two colliding keywords are reported by -Woverride-init.<br>
+ * When adding a keyword, the factors may have to be adjusted so that the hash stays perfect.
+ * </p>
  */
-static rt_s zz_lexer_read_alpha(rt_char *input, struct zz_token *token)
+#define ZZ_LEXER_KEYWORD_HASH(first, second, last, size) (((rt_un)(first) * 3 + (rt_un)(second) + (rt_un)(last) + (rt_un)(size) * 5) & (ZZ_LEXER_KEYWORDS_TABLE_SIZE - 1))
+
+#define ZZ_LEXER_KEYWORDS_TABLE_SIZE 32
+
+#define ZZ_LEXER_KEYWORD_MIN_SIZE 2
+#define ZZ_LEXER_KEYWORD_MAX_SIZE 12
+
+static const struct zz_lexer_keyword zz_lexer_keywords[ZZ_LEXER_KEYWORDS_TABLE_SIZE] = {
+	[ZZ_LEXER_KEYWORD_HASH('f', 'n', 'n', 2)] = { "fn", 2, ZZ_TOKEN_TYPE_FUNCTION },
+	[ZZ_LEXER_KEYWORD_HASH('v', 'a', 'r', 3)] = { "var", 3, ZZ_TOKEN_TYPE_VAR },
+	[ZZ_LEXER_KEYWORD_HASH('f', 'o', 'r', 3)] = { "for", 3, ZZ_TOKEN_TYPE_FOR },
+	[ZZ_LEXER_KEYWORD_HASH('i', 'n', 'n', 2)] = { "in", 2, ZZ_TOKEN_TYPE_IN },
+	[ZZ_LEXER_KEYWORD_HASH('u', 'n', 'l', 6)] = { "unroll", 6, ZZ_TOKEN_TYPE_UNROLL },
+	[ZZ_LEXER_KEYWORD_HASH('v', 'e', 'e', 9)] = { "vectorize", 9, ZZ_TOKEN_TYPE_VECTORIZE },
+	[ZZ_LEXER_KEYWORD_HASH('i', 'n', 'e', 10)] = { "interleave", 10, ZZ_TOKEN_TYPE_INTERLEAVE },
+	[ZZ_LEXER_KEYWORD_HASH('m', 'u', 'n', 12)] = { "multiversion", 12, ZZ_TOKEN_TYPE_MULTIVERSION },
+	[ZZ_LEXER_KEYWORD_HASH('s', 'h', 'e', 7)] = { "shuffle", 7, ZZ_TOKEN_TYPE_SHUFFLE },
+	[ZZ_LEXER_KEYWORD_HASH('i', '3', '2', 3)] = { "i32", 3, ZZ_TOKEN_TYPE_I32 },
+	[ZZ_LEXER_KEYWORD_HASH('i', '6', '4', 3)] = { "i64", 3, ZZ_TOKEN_TYPE_I64 },
+	[ZZ_LEXER_KEYWORD_HASH('i', '3', '4', 5)] = { "i32x4", 5, ZZ_TOKEN_TYPE_I32X4 },
+	[ZZ_LEXER_KEYWORD_HASH('i', '3', '8', 5)] = { "i32x8", 5, ZZ_TOKEN_TYPE_I32X8 },
+	[ZZ_LEXER_KEYWORD_HASH('i', '6', '4', 5)] = { "i64x4", 5, ZZ_TOKEN_TYPE_I64X4 }
+};
+
+#ifdef ZZ_LEXER_SIMD
+
+/**
+ * Bit <tt>i</tt> is set if the byte <tt>i</tt> of the block is not a letter, a digit or an underscore.
+ */
+static rt_un32 zz_lexer_get_non_identifier_mask(zz_lexer_block block)
+{
+	zz_lexer_block lower_case = ZZ_LEXER_BLOCK_OR(block, ZZ_LEXER_BLOCK_SET(0x20));
+	zz_lexer_block alpha = ZZ_LEXER_BLOCK_AND(ZZ_LEXER_BLOCK_GREATER(lower_case, ZZ_LEXER_BLOCK_SET('a' - 1)), ZZ_LEXER_BLOCK_GREATER(ZZ_LEXER_BLOCK_SET('z' + 1), lower_case));
+	zz_lexer_block digit = ZZ_LEXER_BLOCK_AND(ZZ_LEXER_BLOCK_GREATER(block, ZZ_LEXER_BLOCK_SET('0' - 1)), ZZ_LEXER_BLOCK_GREATER(ZZ_LEXER_BLOCK_SET('9' + 1), block));
+	zz_lexer_block underscore = ZZ_LEXER_BLOCK_EQUALS(block, ZZ_LEXER_BLOCK_SET('_'));
+
+	return ZZ_LEXER_BLOCK_FULL_MASK ^ ZZ_LEXER_BLOCK_MASK(ZZ_LEXER_BLOCK_OR(ZZ_LEXER_BLOCK_OR(alpha, digit), underscore));
+}
+
+static rt_un32 zz_lexer_get_non_digit_mask(zz_lexer_block block)
 {
-	rt_char *in_identifier = input;
+	zz_lexer_block digit = ZZ_LEXER_BLOCK_AND(ZZ_LEXER_BLOCK_GREATER(block, ZZ_LEXER_BLOCK_SET('0' - 1)), ZZ_LEXER_BLOCK_GREATER(ZZ_LEXER_BLOCK_SET('9' + 1), block));
 
-	while (RT_CHAR_IS_ALPHANUM(*in_identifier) || *in_identifier == _R('_'))
-		in_identifier++;
-	
-	token->str = input;
-	token->str_size = in_identifier - input;
+	return ZZ_LEXER_BLOCK_FULL_MASK ^ ZZ_LEXER_BLOCK_MASK(digit);
+}
 
-	if (rt_char_equals(token->str, token->str_size, _R("fn"), 2))
-		token->type = ZZ_TOKEN_TYPE_FUNCTION;
-	else
-		token->type = ZZ_TOKEN_TYPE_IDENTIFIER;
+static rt_un32 zz_lexer_get_non_blank_mask(zz_lexer_block block)
+{
+	zz_lexer_block blank = ZZ_LEXER_BLOCK_OR(ZZ_LEXER_BLOCK_EQUALS(block, ZZ_LEXER_BLOCK_SET(' ')), ZZ_LEXER_BLOCK_EQUALS(block, ZZ_LEXER_BLOCK_SET('\n')));
+	/* '\t', '\v', '\f' and '\r' are contiguous. */
+	zz_lexer_block control = ZZ_LEXER_BLOCK_AND(ZZ_LEXER_BLOCK_GREATER(block, ZZ_LEXER_BLOCK_SET('\t' - 1)), ZZ_LEXER_BLOCK_GREATER(ZZ_LEXER_BLOCK_SET('\r' + 1), block));
 
-	return RT_OK;
+	return ZZ_LEXER_BLOCK_FULL_MASK ^ ZZ_LEXER_BLOCK_MASK(ZZ_LEXER_BLOCK_OR(blank, control));
 }
 
-static rt_s zz_lexer_read_num(rt_char *input, struct zz_token *token)
+/**
+ * Return the address of the first character of <tt>input</tt> for which the bit is set by <tt>get_mask</tt>.
+ *
+ * <p>
+ * Only aligned blocks are loaded, so they never cross a page boundary.<br>
+ * As the input is zero terminated and zero is never skipped, the block holding the terminating zero is the last one read.
+ * </p>
+ */
+static const rt_un8 *zz_lexer_skip(const rt_un8 *input, rt_un32 (*get_mask)(zz_lexer_block block))
 {
-	rt_char *in_identifier = input;
+	rt_un offset = (rt_un)input & (ZZ_LEXER_BLOCK_SIZE - 1);
+	const rt_un8 *block = input - offset;
+	rt_un32 mask;
 
-	token->type = ZZ_TOKEN_TYPE_NUMBER;
-	token->str = input;
+	/* Ignore the characters before the input in the first block. */
+	mask = get_mask(ZZ_LEXER_BLOCK_LOAD(block)) >> offset;
+	if (mask)
+		return input + __builtin_ctz(mask);
 
-	while (RT_CHAR_IS_NUM(*in_identifier))
-		in_identifier++;
-	
-	token->str_size = in_identifier - input;
+	do {
+		block += ZZ_LEXER_BLOCK_SIZE;
+		mask = get_mask(ZZ_LEXER_BLOCK_LOAD(block));
+	} while (!mask);
 
-	return RT_OK;
+	return block + __builtin_ctz(mask);
 }
 
-rt_s zz_lexer_read_next_token(struct zz_lexer *lexer)
+#endif
+
+/**
+ * Below this size, the runs are scanned character by character as most tokens are short.
+ */
+#define ZZ_LEXER_SCALAR_RUN_SIZE 8
+
+static rt_char8 *zz_lexer_skip_identifier_chars(rt_char8 *input)
 {
-	rt_char *input = lexer->input;
-	struct zz_token *current_token = &lexer->current_token;
-	rt_char character;
-	rt_s ret;
+	rt_un i;
 
-	while (*input && RT_CHAR_IS_BLANK(*input))
+	for (i = 0; i < ZZ_LEXER_SCALAR_RUN_SIZE; i++) {
+		if (!ZZ_LEXER_IS_IDENTIFIER_CHAR(*input))
+			return input;
 		input++;
+	}
+#ifdef ZZ_LEXER_SIMD
+	return (rt_char8*)zz_lexer_skip((const rt_un8*)input, &zz_lexer_get_non_identifier_mask);
+#else
+	while (ZZ_LEXER_IS_IDENTIFIER_CHAR(*input))
+		input++;
+	return input;
+#endif
+}
 
-	character = *input;
-	if (RT_CHAR_IS_ALPHA(character) || character == _R('_')) {
-		if (RT_UNLIKELY(!zz_lexer_read_alpha(input, current_token)))
-			goto error;
-	} else if (RT_CHAR_IS_NUM(character)) {
-		if (RT_UNLIKELY(!zz_lexer_read_num(input, &lexer->current_token)))
-			goto error;
-	} else if (character == _R('+')) {
-		current_token->type = ZZ_TOKEN_TYPE_PLUS;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('-')) {
-		current_token->type = ZZ_TOKEN_TYPE_MINUS;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('*')) {
-		current_token->type = ZZ_TOKEN_TYPE_ASTERISK;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('/')) {
-		current_token->type = ZZ_TOKEN_TYPE_SLASH;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('%')) {
-		current_token->type = ZZ_TOKEN_TYPE_PERCENT;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('{')) {
-		current_token->type = ZZ_TOKEN_TYPE_OPEN_BRACE;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('}')) {
-		current_token->type = ZZ_TOKEN_TYPE_CLOSE_BRACE;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R('(')) {
-		current_token->type = ZZ_TOKEN_TYPE_OPEN_PARENTHESIS;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (character == _R(')')) {
-		current_token->type = ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS;
-		current_token->str = input;
-		current_token->str_size = 1;
-	} else if (!character) {
-		current_token->type = ZZ_TOKEN_TYPE_END_OF_FILE;
-		current_token->str = RT_NULL;
-		current_token->str_size = 0;
-	} else {
-		/* TODO. */
+static rt_char8 *zz_lexer_skip_digits(rt_char8 *input)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_LEXER_SCALAR_RUN_SIZE; i++) {
+		if (ZZ_LEXER_GET_CHAR_CLASS(*input) != ZZ_LEXER_CHAR_CLASS_DIGIT)
+			return input;
+		input++;
 	}
-	lexer->input = input + current_token->str_size;
+#ifdef ZZ_LEXER_SIMD
+	return (rt_char8*)zz_lexer_skip((const rt_un8*)input, &zz_lexer_get_non_digit_mask);
+#else
+	while (ZZ_LEXER_GET_CHAR_CLASS(*input) == ZZ_LEXER_CHAR_CLASS_DIGIT)
+		input++;
+	return input;
+#endif
+}
 
-	if (current_token->type != ZZ_TOKEN_TYPE_END_OF_FILE) {
-		if (RT_UNLIKELY(!rt_console_write_str_with_size(current_token->str, current_token->str_size)))
-			goto error;
-		if (RT_UNLIKELY(!rt_console_write_str_with_size(_R("\n"), 1)))
-			goto error;
-	} else {
-		if (RT_UNLIKELY(!rt_console_write_str_with_size(_R("EOF\n"), 4)))
+static rt_char8 *zz_lexer_skip_blanks(rt_char8 *input)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_LEXER_SCALAR_RUN_SIZE; i++) {
+		if (ZZ_LEXER_GET_CHAR_CLASS(*input) != ZZ_LEXER_CHAR_CLASS_BLANK)
+			return input;
+		input++;
+	}
+#ifdef ZZ_LEXER_SIMD
+	return (rt_char8*)zz_lexer_skip((const rt_un8*)input, &zz_lexer_get_non_blank_mask);
+#else
+	while (ZZ_LEXER_GET_CHAR_CLASS(*input) == ZZ_LEXER_CHAR_CLASS_BLANK)
+		input++;
+	return input;
+#endif
+}
+
+/**
+ * Read something that starts with a letter or an underscore and is composed of letters, digits, and underscores.
+ */
+static rt_un zz_lexer_read_alpha(rt_char8 *input, rt_un8 *type)
+{
+	const struct zz_lexer_keyword *keyword;
+	rt_un str_size;
+
+	str_size = zz_lexer_skip_identifier_chars(input + 1) - input;
+
+	*type = ZZ_TOKEN_TYPE_IDENTIFIER;
+
+	if (str_size >= ZZ_LEXER_KEYWORD_MIN_SIZE && str_size <= ZZ_LEXER_KEYWORD_MAX_SIZE) {
+		keyword = &zz_lexer_keywords[ZZ_LEXER_KEYWORD_HASH(input[0], input[1], input[str_size - 1], str_size)];
+		if (keyword->str_size == str_size && rt_char8_equals(input, str_size, keyword->str, str_size))
+			*type = keyword->type;
+	}
+
+	return str_size;
+}
+
+rt_s zz_lexer_tokenize(rt_char8 *input, rt_un input_size, struct zz_token_buffer *token_buffer, struct zz_symbol_table *symbol_table)
+{
+	rt_char8 *in_input = input;
+	rt_un8 *types;
+	rt_un32 *offsets;
+	rt_un32 *sizes;
+	rt_un32 *symbols;
+	rt_un i = 0;
+	rt_un char_class;
+	rt_un8 type;
+	rt_un str_size;
+	rt_s ret;
+
+	if (RT_UNLIKELY(input_size > RT_TYPE_MAX_UN32)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Generated sources have about one token every three bytes. */
+	if (RT_UNLIKELY(!zz_token_buffer_reserve(token_buffer, input_size / 3 + 16)))
+		goto error;
+
+	types = token_buffer->types;
+	offsets = token_buffer->offsets;
+	sizes = token_buffer->sizes;
+	symbols = token_buffer->symbols;
+
+	while (RT_TRUE) {
+		char_class = ZZ_LEXER_GET_CHAR_CLASS(*in_input);
+		if (char_class == ZZ_LEXER_CHAR_CLASS_BLANK) {
+			in_input = zz_lexer_skip_blanks(in_input);
+			char_class = ZZ_LEXER_GET_CHAR_CLASS(*in_input);
+		}
+
+		switch (char_class) {
+		case ZZ_LEXER_CHAR_CLASS_ALPHA:
+			str_size = zz_lexer_read_alpha(in_input, &type);
+			break;
+		case ZZ_LEXER_CHAR_CLASS_DIGIT:
+			type = ZZ_TOKEN_TYPE_NUMBER;
+			str_size = zz_lexer_skip_digits(in_input + 1) - in_input;
+			break;
+		case ZZ_LEXER_CHAR_CLASS_PUNCTUATION:
+			type = zz_lexer_punctuation_token_types[(rt_un8)*in_input];
+			str_size = 1;
+			break;
+		case ZZ_LEXER_CHAR_CLASS_DOT:
+			if (in_input[1] == '.') {
+				type = ZZ_TOKEN_TYPE_DOT_DOT;
+				str_size = 2;
+			} else {
+				type = ZZ_TOKEN_TYPE_DOT;
+				str_size = 1;
+			}
+			break;
+		case ZZ_LEXER_CHAR_CLASS_END_OF_FILE:
+			type = ZZ_TOKEN_TYPE_END_OF_FILE;
+			str_size = 0;
+			break;
+		default:
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 			goto error;
+		}
+
+		if (RT_UNLIKELY(i == token_buffer->capacity)) {
+			if (RT_UNLIKELY(!zz_token_buffer_reserve(token_buffer, token_buffer->capacity * 2)))
+				goto error;
+			types = token_buffer->types;
+			offsets = token_buffer->offsets;
+			sizes = token_buffer->sizes;
+			symbols = token_buffer->symbols;
+		}
+
+		/* Identifiers are hashed once, here, then compared as integers. */
+		if (type == ZZ_TOKEN_TYPE_IDENTIFIER) {
+			if (RT_UNLIKELY(!zz_symbol_table_intern(symbol_table, in_input, str_size, &symbols[i])))
+				goto error;
+		}
+
+		types[i] = type;
+		offsets[i] = (rt_un32)(in_input - input);
+		sizes[i] = (rt_un32)str_size;
+		i++;
+
+		if (type == ZZ_TOKEN_TYPE_END_OF_FILE)
+			break;
+
+		in_input += str_size;
+	}
+	token_buffer->size = i;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	token_buffer->size = 0;
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_lexer_write_tokens(rt_char8 *input, struct zz_token_buffer *token_buffer, struct rt_heap *heap)
+{
+	rt_char buffer[RT_CHAR_HALF_BIG_STRING_SIZE];
+	void *heap_buffer = RT_NULL;
+	rt_un heap_buffer_capacity = 0;
+	rt_char *output;
+	rt_un output_size;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < token_buffer->size; i++) {
+		if (token_buffer->types[i] != ZZ_TOKEN_TYPE_END_OF_FILE) {
+			if (RT_UNLIKELY(!rt_encoding_decode(&input[token_buffer->offsets[i]], token_buffer->sizes[i], RT_ENCODING_UTF_8, buffer, RT_CHAR_HALF_BIG_STRING_SIZE, &heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
+				goto error;
+			if (RT_UNLIKELY(!rt_console_write_str_with_size(output, output_size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_console_write_str_with_size(_R("\n"), 1)))
+				goto error;
+		} else {
+			if (RT_UNLIKELY(!rt_console_write_str_with_size(_R("EOF\n"), 4)))
+				goto error;
+		}
 	}
 
 	ret = RT_OK;
 free:
+	if (heap_buffer) {
+		if (RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
+			goto error;
+	}
 	return ret;
 
 error:
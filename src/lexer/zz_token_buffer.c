@@ -0,0 +1,69 @@
+#include "lexer/zz_token_buffer.h"
+
+static void *zz_token_buffer_resize(struct rt_heap *heap, void **area, rt_un size)
+{
+	if (*area)
+		return heap->realloc(heap, area, size);
+	else
+		return heap->alloc(heap, area, size);
+}
+
+void zz_token_buffer_create(struct zz_token_buffer *token_buffer, struct rt_heap *heap)
+{
+	token_buffer->types = RT_NULL;
+	token_buffer->offsets = RT_NULL;
+	token_buffer->sizes = RT_NULL;
+	token_buffer->symbols = RT_NULL;
+	token_buffer->size = 0;
+	token_buffer->capacity = 0;
+	token_buffer->heap = heap;
+}
+
+rt_s zz_token_buffer_free(struct zz_token_buffer *token_buffer)
+{
+	struct rt_heap *heap = token_buffer->heap;
+	rt_s ret = RT_OK;
+
+	if (token_buffer->types && RT_UNLIKELY(!heap->free(heap, (void**)&token_buffer->types)))
+		ret = RT_FAILED;
+	if (token_buffer->offsets && RT_UNLIKELY(!heap->free(heap, (void**)&token_buffer->offsets)))
+		ret = RT_FAILED;
+	if (token_buffer->sizes && RT_UNLIKELY(!heap->free(heap, (void**)&token_buffer->sizes)))
+		ret = RT_FAILED;
+	if (token_buffer->symbols && RT_UNLIKELY(!heap->free(heap, (void**)&token_buffer->symbols)))
+		ret = RT_FAILED;
+	token_buffer->size = 0;
+	token_buffer->capacity = 0;
+
+	return ret;
+}
+
+rt_s zz_token_buffer_reserve(struct zz_token_buffer *token_buffer, rt_un capacity)
+{
+	struct rt_heap *heap = token_buffer->heap;
+	rt_s ret;
+
+	if (capacity <= token_buffer->capacity)
+		goto end;
+
+	if (RT_UNLIKELY(!zz_token_buffer_resize(heap, (void**)&token_buffer->types, capacity * sizeof(rt_un8))))
+		goto error;
+	if (RT_UNLIKELY(!zz_token_buffer_resize(heap, (void**)&token_buffer->offsets, capacity * sizeof(rt_un32))))
+		goto error;
+	if (RT_UNLIKELY(!zz_token_buffer_resize(heap, (void**)&token_buffer->sizes, capacity * sizeof(rt_un32))))
+		goto error;
+	if (RT_UNLIKELY(!zz_token_buffer_resize(heap, (void**)&token_buffer->symbols, capacity * sizeof(rt_un32))))
+		goto error;
+	token_buffer->capacity = capacity;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	/* The arrays might not have the same capacity anymore. */
+	zz_token_buffer_free(token_buffer);
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,275 @@
+#include "memory/zz_arena.h"
+
+/* Keep the areas aligned as the ones of the runtime heap. */
+#define ZZ_ARENA_ALIGNMENT 16
+#define ZZ_ARENA_ALIGN(size) (((size) + ZZ_ARENA_ALIGNMENT - 1) & ~((rt_un)ZZ_ARENA_ALIGNMENT - 1))
+
+struct zz_arena_block {
+	struct zz_arena_block *next;
+};
+
+#define ZZ_ARENA_BLOCK_HEADER_SIZE ZZ_ARENA_ALIGN(sizeof(struct zz_arena_block))
+
+/**
+ * Large areas have their own block from the parent heap, linked into <tt>large_blocks</tt>.
+ */
+struct zz_arena_large_block {
+	struct zz_arena_large_block *previous;
+	struct zz_arena_large_block *next;
+};
+
+#define ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE ZZ_ARENA_ALIGN(sizeof(struct zz_arena_large_block))
+
+/**
+ * Prefix of each area.
+ */
+struct zz_arena_area_header {
+	rt_un size;
+	rt_b large;
+};
+
+#define ZZ_ARENA_AREA_HEADER_SIZE ZZ_ARENA_ALIGN(sizeof(struct zz_arena_area_header))
+
+#define ZZ_ARENA_GET_AREA_HEADER(area) ((struct zz_arena_area_header*)((rt_un8*)(area) - ZZ_ARENA_AREA_HEADER_SIZE))
+#define ZZ_ARENA_GET_LARGE_BLOCK(area) ((struct zz_arena_large_block*)((rt_un8*)(area) - ZZ_ARENA_AREA_HEADER_SIZE - ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE))
+
+/**
+ * Make the block following the current one the current one.
+ *
+ * <p>
+ * The blocks kept by a reset are reused before new ones are requested from the parent heap.
+ * </p>
+ */
+static rt_s zz_arena_next_block(struct zz_arena *arena)
+{
+	struct zz_arena_block *block;
+	rt_s ret;
+
+	block = arena->current_block ? arena->current_block->next : arena->first_block;
+
+	if (!block) {
+		if (RT_UNLIKELY(!arena->parent->alloc(arena->parent, (void**)&block, ZZ_ARENA_BLOCK_HEADER_SIZE + arena->block_size)))
+			goto error;
+		block->next = RT_NULL;
+		if (arena->current_block)
+			arena->current_block->next = block;
+		else
+			arena->first_block = block;
+	}
+
+	arena->current_block = block;
+	arena->position = (rt_un8*)block + ZZ_ARENA_BLOCK_HEADER_SIZE;
+	arena->end = arena->position + arena->block_size;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static void zz_arena_link_large_block(struct zz_arena *arena, struct zz_arena_large_block *large_block)
+{
+	large_block->previous = RT_NULL;
+	large_block->next = arena->large_blocks;
+	if (arena->large_blocks)
+		arena->large_blocks->previous = large_block;
+	arena->large_blocks = large_block;
+}
+
+static void zz_arena_unlink_large_block(struct zz_arena *arena, struct zz_arena_large_block *large_block)
+{
+	if (large_block->previous)
+		large_block->previous->next = large_block->next;
+	else
+		arena->large_blocks = large_block->next;
+	if (large_block->next)
+		large_block->next->previous = large_block->previous;
+}
+
+/**
+ * Large areas are not carved from the blocks so that they can be resized and given back by the parent heap.<br>
+ * This avoids copies and waste for the big arrays of the lexer and the parser.
+ */
+static void *zz_arena_alloc_large(struct zz_arena *arena, void **area, rt_un size)
+{
+	struct zz_arena_large_block *large_block;
+	struct zz_arena_area_header *header;
+
+	if (RT_UNLIKELY(!arena->parent->alloc(arena->parent, (void**)&large_block, ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE + ZZ_ARENA_AREA_HEADER_SIZE + size))) {
+		*area = RT_NULL;
+		goto end;
+	}
+	zz_arena_link_large_block(arena, large_block);
+
+	header = (struct zz_arena_area_header*)((rt_un8*)large_block + ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE);
+	header->size = size;
+	header->large = RT_TRUE;
+	*area = (rt_un8*)header + ZZ_ARENA_AREA_HEADER_SIZE;
+end:
+	return *area;
+}
+
+static void *zz_arena_realloc_large(struct zz_arena *arena, void **area, rt_un size)
+{
+	struct zz_arena_large_block *large_block = ZZ_ARENA_GET_LARGE_BLOCK(*area);
+	struct zz_arena_area_header *header;
+
+	/* The block might move. */
+	zz_arena_unlink_large_block(arena, large_block);
+
+	if (RT_UNLIKELY(!arena->parent->realloc(arena->parent, (void**)&large_block, ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE + ZZ_ARENA_AREA_HEADER_SIZE + size))) {
+		/* The parent might have released the original area. */
+		if (large_block)
+			zz_arena_link_large_block(arena, large_block);
+		else
+			*area = RT_NULL;
+		return RT_NULL;
+	}
+	zz_arena_link_large_block(arena, large_block);
+
+	header = (struct zz_arena_area_header*)((rt_un8*)large_block + ZZ_ARENA_LARGE_BLOCK_HEADER_SIZE);
+	header->size = size;
+	*area = (rt_un8*)header + ZZ_ARENA_AREA_HEADER_SIZE;
+
+	return *area;
+}
+
+static rt_s zz_arena_free_large(struct zz_arena *arena, struct zz_arena_large_block *large_block)
+{
+	zz_arena_unlink_large_block(arena, large_block);
+	return arena->parent->free(arena->parent, (void**)&large_block);
+}
+
+static void *zz_arena_alloc(struct rt_heap *heap, void **area, rt_un size)
+{
+	struct zz_arena *arena = (struct zz_arena*)heap;
+	struct zz_arena_area_header *header;
+	rt_un needed;
+
+	if (size > arena->large_area_size)
+		return zz_arena_alloc_large(arena, area, size);
+
+	needed = ZZ_ARENA_AREA_HEADER_SIZE + ZZ_ARENA_ALIGN(size);
+	if (RT_UNLIKELY((rt_un)(arena->end - arena->position) < needed)) {
+		if (RT_UNLIKELY(!zz_arena_next_block(arena))) {
+			*area = RT_NULL;
+			goto end;
+		}
+	}
+
+	header = (struct zz_arena_area_header*)arena->position;
+	header->size = size;
+	header->large = RT_FALSE;
+	*area = arena->position + ZZ_ARENA_AREA_HEADER_SIZE;
+	arena->position += needed;
+	arena->last_area = *area;
+end:
+	return *area;
+}
+
+static void *zz_arena_realloc(struct rt_heap *heap, void **area, rt_un size)
+{
+	struct zz_arena *arena = (struct zz_arena*)heap;
+	struct zz_arena_area_header *header;
+	void *new_area;
+
+	if (!*area)
+		return zz_arena_alloc(heap, area, size);
+
+	header = ZZ_ARENA_GET_AREA_HEADER(*area);
+	if (header->large)
+		return zz_arena_realloc_large(arena, area, size);
+
+	if (*area == arena->last_area && size <= arena->large_area_size && (rt_un)(arena->end - arena->last_area) >= ZZ_ARENA_ALIGN(size)) {
+		/* Grow or shrink the last area in place. */
+		arena->position = arena->last_area + ZZ_ARENA_ALIGN(size);
+		header->size = size;
+	} else if (size > header->size) {
+		if (RT_UNLIKELY(!zz_arena_alloc(heap, &new_area, size)))
+			return RT_NULL;
+		RT_MEMORY_COPY(*area, new_area, header->size);
+		*area = new_area;
+	} else {
+		header->size = size;
+	}
+
+	return *area;
+}
+
+static rt_s zz_arena_free_area(struct rt_heap *heap, void **area)
+{
+	struct zz_arena *arena = (struct zz_arena*)heap;
+	rt_s ret = RT_OK;
+
+	if (*area) {
+		if (ZZ_ARENA_GET_AREA_HEADER(*area)->large) {
+			ret = zz_arena_free_large(arena, ZZ_ARENA_GET_LARGE_BLOCK(*area));
+		} else if (*area == arena->last_area) {
+			arena->position = arena->last_area - ZZ_ARENA_AREA_HEADER_SIZE;
+			arena->last_area = RT_NULL;
+		}
+		*area = RT_NULL;
+	}
+
+	return ret;
+}
+
+static rt_s zz_arena_close(struct rt_heap *heap)
+{
+	return zz_arena_free((struct zz_arena*)heap);
+}
+
+void zz_arena_create(struct zz_arena *arena, struct rt_heap *parent, rt_un block_size)
+{
+	arena->heap.alloc = &zz_arena_alloc;
+	arena->heap.realloc = &zz_arena_realloc;
+	arena->heap.free = &zz_arena_free_area;
+	arena->heap.close = &zz_arena_close;
+	arena->parent = parent;
+	arena->first_block = RT_NULL;
+	arena->current_block = RT_NULL;
+	arena->position = RT_NULL;
+	arena->end = RT_NULL;
+	arena->last_area = RT_NULL;
+	arena->large_blocks = RT_NULL;
+	arena->block_size = block_size;
+	arena->large_area_size = (block_size - ZZ_ARENA_AREA_HEADER_SIZE) / 4;
+}
+
+rt_s zz_arena_reset(struct zz_arena *arena)
+{
+	rt_s ret = RT_OK;
+
+	while (arena->large_blocks) {
+		if (RT_UNLIKELY(!zz_arena_free_large(arena, arena->large_blocks)))
+			ret = RT_FAILED;
+	}
+
+	arena->current_block = RT_NULL;
+	arena->position = RT_NULL;
+	arena->end = RT_NULL;
+	arena->last_area = RT_NULL;
+
+	return ret;
+}
+
+rt_s zz_arena_free(struct zz_arena *arena)
+{
+	struct rt_heap *parent = arena->parent;
+	struct zz_arena_block *block;
+	rt_s ret;
+
+	ret = zz_arena_reset(arena);
+
+	while (arena->first_block) {
+		block = arena->first_block;
+		arena->first_block = block->next;
+		if (RT_UNLIKELY(!parent->free(parent, (void**)&block)))
+			ret = RT_FAILED;
+	}
+
+	return ret;
+}
@@ -0,0 +1,460 @@
+#include "optimizer/zz_optimizer.h"
+
+/* Marks the nodes that are not reachable from the body of their function. */
+#define ZZ_OPTIMIZER_DEAD_NODE RT_TYPE_MAX_UN32
+#define ZZ_OPTIMIZER_LIVE_NODE 0
+
+/* Minimum 32 bits signed value, as stored in the unsigned values. */
+#define ZZ_OPTIMIZER_MIN_VALUE ((rt_un32)0x80000000)
+
+#define ZZ_OPTIMIZER_NEGATE_KIND ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_UNARY_OPERATOR, ZZ_UNARY_OPERATOR_NEGATE)
+
+static rt_b zz_optimizer_is_number(struct zz_ast *ast, rt_un32 node)
+{
+	return ZZ_AST_NODE_KIND_GET_TYPE(ast->kinds[node]) == ZZ_AST_NODE_TYPE_NUMBER;
+}
+
+static rt_b zz_optimizer_is_binary_operator(struct zz_ast *ast, rt_un32 node, enum zz_binary_operator binary_operator)
+{
+	return ast->kinds[node] == ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_BINARY_OPERATOR, binary_operator);
+}
+
+/**
+ * Values are handled as unsigned integers so that they wrap like the LLVM instructions.<br>
+ * Like <tt>LLVMConstInt</tt> with a 32 bits type, only the low bits of the literals are used.
+ */
+static rt_un32 zz_optimizer_get_value(struct zz_ast *ast, rt_un32 number_node)
+{
+	return (rt_un32)ast->literals[ast->operands[2 * number_node]];
+}
+
+static void zz_optimizer_set_value(struct zz_ast *ast, rt_un32 number_node, rt_un32 value)
+{
+	ast->literals[ast->operands[2 * number_node]] = (rt_n32)value;
+}
+
+/**
+ * Turn <tt>node</tt> into a number, reusing the literal of <tt>number_node</tt> which must be discarded.
+ */
+static void zz_optimizer_replace_by_number(struct zz_ast *ast, rt_un32 node, rt_un32 number_node, rt_un32 value)
+{
+	ast->kinds[node] = ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_NUMBER, 0);
+	ast->operands[2 * node] = ast->operands[2 * number_node];
+	ast->operands[2 * node + 1] = 0;
+	zz_optimizer_set_value(ast, node, value);
+}
+
+/**
+ * Exponent of <tt>value</tt> if it is a power of two greater than one, zero otherwise.
+ */
+static rt_un32 zz_optimizer_get_exponent(rt_un32 value)
+{
+	rt_un32 exponent = 0;
+
+	if (value < 2 || (value & (value - 1)))
+		return 0;
+
+	while (value >>= 1)
+		exponent++;
+	return exponent;
+}
+
+/**
+ * Returns <tt>RT_FALSE</tt> if the operation must be left to LLVM.
+ */
+static rt_b zz_optimizer_fold_binary_operator(enum zz_binary_operator binary_operator, rt_un32 left, rt_un32 right, rt_un32 *value)
+{
+	switch (binary_operator) {
+	case ZZ_BINARY_OPERATOR_ADD:
+		*value = left + right;
+		break;
+	case ZZ_BINARY_OPERATOR_SUBTRACT:
+		*value = left - right;
+		break;
+	case ZZ_BINARY_OPERATOR_MULTIPLY:
+		*value = left * right;
+		break;
+	case ZZ_BINARY_OPERATOR_DIVIDE:
+	case ZZ_BINARY_OPERATOR_MODULO:
+		/* No defined result for sdiv and srem, LLVM decides. */
+		if (!right || (left == ZZ_OPTIMIZER_MIN_VALUE && right == RT_TYPE_MAX_UN32))
+			return RT_FALSE;
+		if (binary_operator == ZZ_BINARY_OPERATOR_DIVIDE)
+			*value = (rt_un32)((rt_n32)left / (rt_n32)right);
+		else
+			*value = (rt_un32)((rt_n32)left % (rt_n32)right);
+		break;
+	default:
+		return RT_FALSE;
+	}
+	return RT_TRUE;
+}
+
+/**
+ * Simplify <tt>node</tt> as the negation of <tt>operand</tt>.<br>
+ * If <tt>node</tt> is the same as an existing node, it is recorded in <tt>replacements</tt>.
+ */
+static void zz_optimizer_optimize_negate(struct zz_ast *ast, rt_un32 node, rt_un32 operand, rt_un32 *replacements)
+{
+	if (zz_optimizer_is_number(ast, operand)) {
+		zz_optimizer_replace_by_number(ast, node, operand, 0 - zz_optimizer_get_value(ast, operand));
+	} else if (ast->kinds[operand] == ZZ_OPTIMIZER_NEGATE_KIND) {
+		replacements[node] = ast->operands[2 * operand];
+	} else {
+		ast->kinds[node] = ZZ_OPTIMIZER_NEGATE_KIND;
+		ast->operands[2 * node] = operand;
+		ast->operands[2 * node + 1] = 0;
+	}
+}
+
+/**
+ * @param calls Whether the sub-tree of each node contains a call, which may not return and must be kept.
+ */
+static void zz_optimizer_optimize_binary_operator(struct zz_ast *ast, rt_un32 node, rt_un32 *replacements, rt_un8 *calls)
+{
+	enum zz_binary_operator binary_operator = ZZ_AST_NODE_KIND_GET_OPERATOR(ast->kinds[node]);
+	rt_un32 left = ast->operands[2 * node];
+	rt_un32 right = ast->operands[2 * node + 1];
+	rt_un32 inner_right;
+	rt_un32 exponent;
+	rt_un32 value;
+
+	if (zz_optimizer_is_number(ast, left) && zz_optimizer_is_number(ast, right)) {
+		if (zz_optimizer_fold_binary_operator(binary_operator, zz_optimizer_get_value(ast, left), zz_optimizer_get_value(ast, right), &value))
+			zz_optimizer_replace_by_number(ast, node, left, value);
+		return;
+	}
+
+	/* Constants of commutative operators go to the right. */
+	if ((binary_operator == ZZ_BINARY_OPERATOR_ADD || binary_operator == ZZ_BINARY_OPERATOR_MULTIPLY) && zz_optimizer_is_number(ast, left)) {
+		value = left;
+		left = right;
+		right = value;
+	}
+	if (!zz_optimizer_is_number(ast, right))
+		goto end;
+
+	value = zz_optimizer_get_value(ast, right);
+
+	/* x - c is x + -c, so that it can be gathered with other additions. */
+	if (binary_operator == ZZ_BINARY_OPERATOR_SUBTRACT) {
+		binary_operator = ZZ_BINARY_OPERATOR_ADD;
+		value = 0 - value;
+		zz_optimizer_set_value(ast, right, value);
+	}
+
+	/* (x + c1) + c2 is x + (c1 + c2), the same for multiplications, the left node is discarded. */
+	inner_right = ast->operands[2 * left + 1];
+	if (binary_operator == ZZ_BINARY_OPERATOR_ADD && zz_optimizer_is_binary_operator(ast, left, ZZ_BINARY_OPERATOR_ADD) && zz_optimizer_is_number(ast, inner_right)) {
+		value += zz_optimizer_get_value(ast, inner_right);
+	} else if (binary_operator == ZZ_BINARY_OPERATOR_MULTIPLY && zz_optimizer_is_binary_operator(ast, left, ZZ_BINARY_OPERATOR_MULTIPLY) && zz_optimizer_is_number(ast, inner_right)) {
+		value *= zz_optimizer_get_value(ast, inner_right);
+	} else if (binary_operator == ZZ_BINARY_OPERATOR_MULTIPLY && zz_optimizer_is_binary_operator(ast, left, ZZ_BINARY_OPERATOR_SHIFT_LEFT)) {
+		value <<= zz_optimizer_get_value(ast, inner_right);
+	} else {
+		inner_right = ZZ_OPTIMIZER_DEAD_NODE;
+	}
+	if (inner_right != ZZ_OPTIMIZER_DEAD_NODE) {
+		left = ast->operands[2 * left];
+		right = inner_right;
+		zz_optimizer_set_value(ast, right, value);
+	}
+
+	switch (binary_operator) {
+	case ZZ_BINARY_OPERATOR_ADD:
+		if (!value) {
+			replacements[node] = left;
+			return;
+		}
+		break;
+	case ZZ_BINARY_OPERATOR_MULTIPLY:
+		/* x * 0 can be discarded, unless it calls a function. */
+		if (!value && !calls[left]) {
+			zz_optimizer_replace_by_number(ast, node, right, 0);
+			return;
+		}
+		if (value == 1) {
+			replacements[node] = left;
+			return;
+		}
+		if (value == RT_TYPE_MAX_UN32) {
+			zz_optimizer_optimize_negate(ast, node, left, replacements);
+			return;
+		}
+		/* Both wrap the same way. */
+		exponent = zz_optimizer_get_exponent(value);
+		if (exponent) {
+			binary_operator = ZZ_BINARY_OPERATOR_SHIFT_LEFT;
+			zz_optimizer_set_value(ast, right, exponent);
+		}
+		break;
+	case ZZ_BINARY_OPERATOR_DIVIDE:
+	case ZZ_BINARY_OPERATOR_MODULO:
+		/* x / -1 overflows for the minimum value, it is left as is. */
+		if (value == 1) {
+			if (binary_operator == ZZ_BINARY_OPERATOR_DIVIDE) {
+				replacements[node] = left;
+				return;
+			}
+			if (!calls[left]) {
+				zz_optimizer_replace_by_number(ast, node, right, 0);
+				return;
+			}
+		}
+		exponent = zz_optimizer_get_exponent(value);
+		if (exponent && value != ZZ_OPTIMIZER_MIN_VALUE) {
+			if (binary_operator == ZZ_BINARY_OPERATOR_DIVIDE)
+				binary_operator = ZZ_BINARY_OPERATOR_DIVIDE_BY_POWER_OF_TWO;
+			else
+				binary_operator = ZZ_BINARY_OPERATOR_MODULO_BY_POWER_OF_TWO;
+			zz_optimizer_set_value(ast, right, exponent);
+		}
+		break;
+	default:
+		break;
+	}
+
+end:
+	ast->kinds[node] = ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_BINARY_OPERATOR, binary_operator);
+	ast->operands[2 * node] = left;
+	ast->operands[2 * node + 1] = right;
+}
+
+/**
+ * Single pass over the nodes of the function: the operands of a node are simplified before it.<br>
+ * Nodes that become useless are left in place, they are removed by <tt>zz_optimizer_compact</tt>.
+ *
+ * <p>
+ * Only the i32 nodes are simplified, the operands of the other ones are replaced but the 64 bits and vector operations are left to LLVM.<br>
+ * The variables and the array elements are not values known by the optimizer, they are left to LLVM too.
+ * </p>
+ */
+static void zz_optimizer_optimize_function(struct zz_ast *ast, struct zz_ast_function *function, rt_un32 *replacements, rt_un8 *calls)
+{
+	rt_un32 *operands = ast->operands;
+	rt_un8 kind;
+	rt_un32 i;
+
+	for (i = function->first_node; i <= function->body; i++) {
+		replacements[i] = i;
+		kind = ast->kinds[i];
+		switch (ZZ_AST_NODE_KIND_GET_TYPE(kind)) {
+		case ZZ_AST_NODE_TYPE_NUMBER:
+		case ZZ_AST_NODE_TYPE_VECTOR:
+		case ZZ_AST_NODE_TYPE_LOCAL:
+		case ZZ_AST_NODE_TYPE_END_FOR:
+			calls[i] = RT_FALSE;
+			break;
+		case ZZ_AST_NODE_TYPE_ADDRESS:
+		case ZZ_AST_NODE_TYPE_ASSIGN:
+			operands[2 * i + 1] = replacements[operands[2 * i + 1]];
+			calls[i] = calls[operands[2 * i + 1]];
+			break;
+		case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
+		case ZZ_AST_NODE_TYPE_EXTRACT:
+		case ZZ_AST_NODE_TYPE_CONVERSION:
+		case ZZ_AST_NODE_TYPE_LOAD:
+		case ZZ_AST_NODE_TYPE_FOR:
+			operands[2 * i] = replacements[operands[2 * i]];
+			calls[i] = calls[operands[2 * i]];
+			if (kind == ZZ_OPTIMIZER_NEGATE_KIND && ast->types[i] == ZZ_VALUE_TYPE_I32)
+				zz_optimizer_optimize_negate(ast, i, operands[2 * i], replacements);
+			break;
+		case ZZ_AST_NODE_TYPE_BINARY_OPERATOR:
+		case ZZ_AST_NODE_TYPE_SHUFFLE:
+		case ZZ_AST_NODE_TYPE_STORE:
+			operands[2 * i] = replacements[operands[2 * i]];
+			operands[2 * i + 1] = replacements[operands[2 * i + 1]];
+			calls[i] = calls[operands[2 * i]] || calls[operands[2 * i + 1]];
+			if (ZZ_AST_NODE_KIND_GET_TYPE(kind) == ZZ_AST_NODE_TYPE_BINARY_OPERATOR && ast->types[i] == ZZ_VALUE_TYPE_I32)
+				zz_optimizer_optimize_binary_operator(ast, i, replacements, calls);
+			break;
+		case ZZ_AST_NODE_TYPE_CALL:
+			calls[i] = RT_TRUE;
+			break;
+		}
+	}
+}
+
+/**
+ * Mark the nodes from <tt>first_node</tt> to <tt>last_node</tt> that are reachable from <tt>root</tt> or from a statement.<br>
+ * Operands being before their node, a single backward pass is enough.
+ */
+static void zz_optimizer_mark_live_nodes(struct zz_ast *ast, rt_un32 first_node, rt_un32 last_node, rt_un32 root, rt_un32 *indexes)
+{
+	rt_un32 *operands = ast->operands;
+	rt_un8 type;
+	rt_un32 i;
+
+	for (i = first_node; i <= last_node; i++)
+		indexes[i] = ZZ_OPTIMIZER_DEAD_NODE;
+	indexes[root] = ZZ_OPTIMIZER_LIVE_NODE;
+
+	for (i = root + 1; i-- > first_node;) {
+		type = ZZ_AST_NODE_KIND_GET_TYPE(ast->kinds[i]);
+		if (ZZ_AST_NODE_TYPE_IS_STATEMENT(type))
+			indexes[i] = ZZ_OPTIMIZER_LIVE_NODE;
+		else if (indexes[i] == ZZ_OPTIMIZER_DEAD_NODE)
+			continue;
+		switch (type) {
+		case ZZ_AST_NODE_TYPE_ADDRESS:
+		case ZZ_AST_NODE_TYPE_ASSIGN:
+			indexes[operands[2 * i + 1]] = ZZ_OPTIMIZER_LIVE_NODE;
+			break;
+		case ZZ_AST_NODE_TYPE_SHUFFLE:
+			/* The mask. */
+			indexes[i - 1] = ZZ_OPTIMIZER_LIVE_NODE;
+			/* Fall through. */
+		case ZZ_AST_NODE_TYPE_BINARY_OPERATOR:
+		case ZZ_AST_NODE_TYPE_STORE:
+			indexes[operands[2 * i + 1]] = ZZ_OPTIMIZER_LIVE_NODE;
+			/* Fall through. */
+		case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
+		case ZZ_AST_NODE_TYPE_EXTRACT:
+		case ZZ_AST_NODE_TYPE_CONVERSION:
+		case ZZ_AST_NODE_TYPE_LOAD:
+		case ZZ_AST_NODE_TYPE_FOR:
+		case ZZ_AST_NODE_TYPE_END_FOR:
+			indexes[operands[2 * i]] = ZZ_OPTIMIZER_LIVE_NODE;
+			break;
+		}
+	}
+}
+
+/**
+ * Move the live nodes down, keeping their order, then their literals.<br>
+ * A number only uses a literal from its own former sub-tree, so literals are also kept in order and can be moved down.<br>
+ * The mask of a shuffle stays just before it, as both are live.
+ */
+static void zz_optimizer_compact(struct zz_ast *ast, rt_un32 *indexes)
+{
+	rt_un8 *kinds = ast->kinds;
+	rt_un8 *types = ast->types;
+	rt_un32 *operands = ast->operands;
+	rt_n *literals = ast->literals;
+	struct zz_ast_function *function;
+	rt_un32 nodes_count = 0;
+	rt_un32 literals_count = 0;
+	rt_un32 first_node;
+	rt_un32 first_operand;
+	rt_un32 second_operand;
+	rt_un32 end;
+	rt_un8 kind;
+	rt_un lanes_count;
+	rt_un32 i;
+	rt_un j;
+	rt_un k;
+
+	for (j = 0; j < ast->functions_count; j++) {
+		function = &ast->functions[j];
+		end = (j + 1 < ast->functions_count) ? ast->functions[j + 1].first_node : (rt_un32)ast->nodes_count;
+		first_node = nodes_count;
+
+		for (i = function->first_node; i < end; i++) {
+			if (indexes[i] == ZZ_OPTIMIZER_DEAD_NODE)
+				continue;
+			kind = kinds[i];
+			switch (ZZ_AST_NODE_KIND_GET_TYPE(kind)) {
+			case ZZ_AST_NODE_TYPE_NUMBER:
+				literals[literals_count] = literals[operands[2 * i]];
+				first_operand = literals_count++;
+				second_operand = 0;
+				break;
+			case ZZ_AST_NODE_TYPE_VECTOR:
+				lanes_count = zz_value_type_get_lanes_count(ZZ_AST_NODE_KIND_GET_OPERATOR(kind));
+				for (k = 0; k < lanes_count; k++)
+					literals[literals_count + k] = literals[operands[2 * i] + k];
+				first_operand = literals_count;
+				literals_count += (rt_un32)lanes_count;
+				second_operand = 0;
+				break;
+			case ZZ_AST_NODE_TYPE_EXTRACT:
+			case ZZ_AST_NODE_TYPE_FOR:
+				/* The lane or the loop. */
+				first_operand = indexes[operands[2 * i]];
+				second_operand = operands[2 * i + 1];
+				break;
+			case ZZ_AST_NODE_TYPE_ADDRESS:
+			case ZZ_AST_NODE_TYPE_ASSIGN:
+				/* The local. */
+				first_operand = operands[2 * i];
+				second_operand = indexes[operands[2 * i + 1]];
+				break;
+			case ZZ_AST_NODE_TYPE_LOCAL:
+				first_operand = operands[2 * i];
+				second_operand = 0;
+				break;
+			case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
+			case ZZ_AST_NODE_TYPE_CONVERSION:
+			case ZZ_AST_NODE_TYPE_LOAD:
+			case ZZ_AST_NODE_TYPE_END_FOR:
+				first_operand = indexes[operands[2 * i]];
+				second_operand = 0;
+				break;
+			case ZZ_AST_NODE_TYPE_CALL:
+				first_operand = operands[2 * i];
+				second_operand = 0;
+				break;
+			default:
+				first_operand = indexes[operands[2 * i]];
+				second_operand = indexes[operands[2 * i + 1]];
+				break;
+			}
+			kinds[nodes_count] = kind;
+			types[nodes_count] = types[i];
+			operands[2 * nodes_count] = first_operand;
+			operands[2 * nodes_count + 1] = second_operand;
+			indexes[i] = nodes_count++;
+		}
+
+		function->first_node = first_node;
+		function->body = indexes[function->body];
+	}
+
+	ast->nodes_count = nodes_count;
+	ast->literals_count = literals_count;
+}
+
+rt_s zz_optimizer_optimize(struct zz_ast *ast)
+{
+	struct rt_heap *heap = ast->heap;
+	struct zz_ast_function *function;
+	rt_un32 *indexes = RT_NULL;
+	rt_un8 *calls = RT_NULL;
+	rt_un32 last_node;
+	rt_un i;
+	rt_s ret;
+
+	if (!ast->nodes_count)
+		goto end;
+
+	/* Replacement of each node while optimizing, then liveness, then new index. */
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&indexes, ast->nodes_count * sizeof(rt_un32))))
+		goto error;
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&calls, ast->nodes_count * sizeof(rt_un8))))
+		goto error;
+
+	for (i = 0; i < ast->functions_count; i++) {
+		function = &ast->functions[i];
+		zz_optimizer_optimize_function(ast, function, indexes, calls);
+		last_node = function->body;
+		/* The body can now be one of its former operands. */
+		function->body = indexes[function->body];
+		zz_optimizer_mark_live_nodes(ast, function->first_node, last_node, function->body, indexes);
+	}
+
+	zz_optimizer_compact(ast, indexes);
+
+end:
+	ret = RT_OK;
+free:
+	if (calls && RT_UNLIKELY(!heap->free(heap, (void**)&calls) && ret))
+		goto error;
+	if (indexes && RT_UNLIKELY(!heap->free(heap, (void**)&indexes) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
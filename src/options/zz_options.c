@@ -0,0 +1,506 @@
+#include "options/zz_options.h"
+
+static rt_s zz_options_parse_trace(const rt_char *value, rt_un value_size, rt_un *trace)
+{
+	const rt_char *item = value;
+	rt_un item_size;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i <= value_size; i++) {
+		if (i < value_size && value[i] != _R(','))
+			continue;
+
+		item_size = &value[i] - item;
+		if (rt_char_equals(item, item_size, _R("tokens"), 6)) {
+			*trace |= ZZ_TRACE_TOKENS;
+		} else if (rt_char_equals(item, item_size, _R("ir"), 2)) {
+			*trace |= ZZ_TRACE_IR;
+		} else {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		item = &value[i + 1];
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_options_parse_emit(const rt_char *value, rt_un value_size, rt_un *emit)
+{
+	const rt_char *item = value;
+	rt_un item_size;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i <= value_size; i++) {
+		if (i < value_size && value[i] != _R(','))
+			continue;
+
+		item_size = &value[i] - item;
+		if (rt_char_equals(item, item_size, _R("obj"), 3)) {
+			*emit |= ZZ_EMIT_OBJ;
+		} else if (rt_char_equals(item, item_size, _R("asm"), 3)) {
+			*emit |= ZZ_EMIT_ASM;
+		} else if (rt_char_equals(item, item_size, _R("llvm-ir"), 7)) {
+			*emit |= ZZ_EMIT_LLVM_IR;
+		} else if (rt_char_equals(item, item_size, _R("llvm-bc"), 7)) {
+			*emit |= ZZ_EMIT_LLVM_BC;
+		} else {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		item = &value[i + 1];
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_options_parse_lto(const rt_char *value, rt_un value_size, enum zz_lto *lto)
+{
+	rt_s ret;
+
+	if (rt_char_equals(value, value_size, _R("full"), 4)) {
+		*lto = ZZ_LTO_FULL;
+	} else if (rt_char_equals(value, value_size, _R("thin"), 4)) {
+		*lto = ZZ_LTO_THIN;
+	} else {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_options_parse_reloc(const rt_char *value, rt_un value_size, enum zz_reloc *reloc)
+{
+	rt_s ret;
+
+	if (rt_char_equals(value, value_size, _R("static"), 6)) {
+		*reloc = ZZ_RELOC_STATIC;
+	} else if (rt_char_equals(value, value_size, _R("pic"), 3)) {
+		*reloc = ZZ_RELOC_PIC;
+	} else {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_options_parse_code_model(const rt_char *value, rt_un value_size, enum zz_code_model *code_model)
+{
+	rt_s ret;
+
+	if (rt_char_equals(value, value_size, _R("tiny"), 4)) {
+		*code_model = ZZ_CODE_MODEL_TINY;
+	} else if (rt_char_equals(value, value_size, _R("small"), 5)) {
+		*code_model = ZZ_CODE_MODEL_SMALL;
+	} else if (rt_char_equals(value, value_size, _R("kernel"), 6)) {
+		*code_model = ZZ_CODE_MODEL_KERNEL;
+	} else if (rt_char_equals(value, value_size, _R("medium"), 6)) {
+		*code_model = ZZ_CODE_MODEL_MEDIUM;
+	} else if (rt_char_equals(value, value_size, _R("large"), 5)) {
+		*code_model = ZZ_CODE_MODEL_LARGE;
+	} else {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Make room for one more item in an array of pointers.
+ */
+static rt_s zz_options_grow(void ***items, rt_un items_count, rt_un *items_capacity, struct rt_heap *heap)
+{
+	rt_un capacity;
+	rt_s ret;
+
+	if (items_count < *items_capacity)
+		goto end;
+
+	capacity = *items_capacity ? *items_capacity * 2 : 16;
+	if (*items) {
+		if (RT_UNLIKELY(!heap->realloc(heap, (void**)items, capacity * sizeof(void*))))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)items, capacity * sizeof(void*))))
+			goto error;
+	}
+	*items_capacity = capacity;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_options_add_input_file_path(struct zz_options *options, const rt_char *input_file_path)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_options_grow((void***)&options->input_file_paths, options->input_files_count, &options->input_files_capacity, options->heap)))
+		goto error;
+	options->input_file_paths[options->input_files_count++] = input_file_path;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Split the decoded file list in place, one path per line.<br>
+ * Blank lines and the spaces around the paths are ignored.
+ */
+static rt_s zz_options_add_file_list_paths(struct zz_options *options, rt_char *file_list, rt_un file_list_size)
+{
+	rt_un line_start = 0;
+	rt_un line_end;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i <= file_list_size; i++) {
+		if (i < file_list_size && file_list[i] != _R('\n'))
+			continue;
+
+		line_end = i;
+		while (line_start < line_end && RT_CHAR_IS_BLANK(file_list[line_start]))
+			line_start++;
+		while (line_end > line_start && RT_CHAR_IS_BLANK(file_list[line_end - 1]))
+			line_end--;
+
+		if (line_end > line_start) {
+			file_list[line_end] = 0;
+			if (RT_UNLIKELY(!zz_options_add_input_file_path(options, &file_list[line_start])))
+				goto error;
+		}
+		line_start = i + 1;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Read the UTF-8 file list, keep its decoded content in <tt>options</tt> and add its paths.
+ */
+static rt_s zz_options_parse_file_list(struct zz_options *options, const rt_char *file_list_path)
+{
+	struct rt_heap *heap = options->heap;
+	void *data_heap_buffer = RT_NULL;
+	rt_un data_heap_buffer_capacity = 0;
+	void *file_list_heap_buffer = RT_NULL;
+	rt_un file_list_heap_buffer_capacity = 0;
+	rt_char8 *data;
+	rt_un data_size;
+	rt_char *file_list;
+	rt_un file_list_size;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_small_file_read(file_list_path, RT_NULL, 0, &data_heap_buffer, &data_heap_buffer_capacity, &data, &data_size, heap)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_encoding_decode(data, data_size, RT_ENCODING_UTF_8, RT_NULL, 0, &file_list_heap_buffer, &file_list_heap_buffer_capacity, &file_list, &file_list_size, heap)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_options_grow((void***)&options->file_lists, options->file_lists_count, &options->file_lists_capacity, heap)))
+		goto error;
+	options->file_lists[options->file_lists_count++] = file_list;
+	file_list_heap_buffer = RT_NULL;
+
+	if (RT_UNLIKELY(!zz_options_add_file_list_paths(options, file_list, file_list_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (file_list_heap_buffer && RT_UNLIKELY(!heap->free(heap, &file_list_heap_buffer) && ret))
+		goto error;
+	if (data_heap_buffer && RT_UNLIKELY(!heap->free(heap, &data_heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_options_parse(rt_un argc, const rt_char *argv[], struct rt_heap *heap, struct zz_options *options)
+{
+	const rt_char *arg;
+	rt_un arg_size;
+	rt_un i;
+	rt_s ret;
+
+	options->input_file_paths = RT_NULL;
+	options->input_files_count = 0;
+	options->input_files_capacity = 0;
+	options->file_lists = RT_NULL;
+	options->file_lists_count = 0;
+	options->file_lists_capacity = 0;
+	options->help = RT_FALSE;
+	options->stats = RT_FALSE;
+	options->trace = 0;
+	options->time_trace_file_path = RT_NULL;
+	options->optimization_level = ZZ_OPTIMIZATION_LEVEL_O0;
+	options->passes = RT_NULL;
+	options->target = RT_NULL;
+	options->cpu = RT_NULL;
+	options->features = RT_NULL;
+	options->reloc = ZZ_RELOC_DEFAULT;
+	options->code_model = ZZ_CODE_MODEL_DEFAULT;
+	options->run = RT_FALSE;
+	options->emit = 0;
+	options->output_file_path = RT_NULL;
+	options->standard_output = RT_FALSE;
+	options->lto = ZZ_LTO_NONE;
+	options->lto_link = RT_FALSE;
+	options->codegen_units = 1;
+	options->profile_generate_file_path = RT_NULL;
+	options->profile_use_file_path = RT_NULL;
+	options->jobs = 0;
+	options->cache_directory_path = RT_NULL;
+	options->cache_max_size = ZZ_OPTIONS_DEFAULT_CACHE_SIZE * 1024 * 1024;
+	options->server_socket_path = RT_NULL;
+	options->client_socket_path = RT_NULL;
+	options->heap = heap;
+
+	for (i = 1; i < argc; i++) {
+		arg = argv[i];
+		arg_size = rt_char_get_size(arg);
+
+		if (rt_char_equals(arg, arg_size, _R("--help"), 6) ||
+		    rt_char_equals(arg, arg_size, _R("-h"), 2) ||
+		    rt_char_equals(arg, arg_size, _R("/?"), 2)) {
+			options->help = RT_TRUE;
+		} else if (rt_char_equals(arg, arg_size, _R("--stats"), 7)) {
+			options->stats = RT_TRUE;
+		} else if (arg_size > 8 && rt_char_equals(arg, 8, _R("--trace="), 8)) {
+			if (RT_UNLIKELY(!zz_options_parse_trace(&arg[8], arg_size - 8, &options->trace)))
+				goto error;
+		} else if (arg_size > 13 && rt_char_equals(arg, 13, _R("--time-trace="), 13)) {
+			options->time_trace_file_path = &arg[13];
+		} else if (rt_char_equals(arg, arg_size, _R("-O0"), 3)) {
+			options->optimization_level = ZZ_OPTIMIZATION_LEVEL_O0;
+		} else if (rt_char_equals(arg, arg_size, _R("-O1"), 3)) {
+			options->optimization_level = ZZ_OPTIMIZATION_LEVEL_O1;
+		} else if (rt_char_equals(arg, arg_size, _R("-O2"), 3)) {
+			options->optimization_level = ZZ_OPTIMIZATION_LEVEL_O2;
+		} else if (rt_char_equals(arg, arg_size, _R("-O3"), 3)) {
+			options->optimization_level = ZZ_OPTIMIZATION_LEVEL_O3;
+		} else if (rt_char_equals(arg, arg_size, _R("-Os"), 3)) {
+			options->optimization_level = ZZ_OPTIMIZATION_LEVEL_OS;
+		} else if (arg_size > 9 && rt_char_equals(arg, 9, _R("--target="), 9)) {
+			options->target = &arg[9];
+		} else if (arg_size > 6 && rt_char_equals(arg, 6, _R("--cpu="), 6)) {
+			options->cpu = &arg[6];
+		} else if (arg_size > 11 && rt_char_equals(arg, 11, _R("--features="), 11)) {
+			options->features = &arg[11];
+		} else if (arg_size > 8 && rt_char_equals(arg, 8, _R("--reloc="), 8)) {
+			if (RT_UNLIKELY(!zz_options_parse_reloc(&arg[8], arg_size - 8, &options->reloc)))
+				goto error;
+		} else if (arg_size > 13 && rt_char_equals(arg, 13, _R("--code-model="), 13)) {
+			if (RT_UNLIKELY(!zz_options_parse_code_model(&arg[13], arg_size - 13, &options->code_model)))
+				goto error;
+		} else if (rt_char_equals(arg, arg_size, _R("--run"), 5)) {
+			options->run = RT_TRUE;
+		} else if (arg_size > 9 && rt_char_equals(arg, 9, _R("--passes="), 9)) {
+			options->passes = &arg[9];
+		} else if (arg_size > 7 && rt_char_equals(arg, 7, _R("--emit="), 7)) {
+			if (RT_UNLIKELY(!zz_options_parse_emit(&arg[7], arg_size - 7, &options->emit)))
+				goto error;
+		} else if (rt_char_equals(arg, arg_size, _R("-o"), 2)) {
+			if (RT_UNLIKELY(i + 1 >= argc)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			i++;
+			if (rt_char_equals(argv[i], rt_char_get_size(argv[i]), _R("-"), 1)) {
+				options->output_file_path = RT_NULL;
+				options->standard_output = RT_TRUE;
+			} else {
+				options->output_file_path = argv[i];
+				options->standard_output = RT_FALSE;
+			}
+		} else if (rt_char_equals(arg, arg_size, _R("--lto"), 5)) {
+			options->lto = ZZ_LTO_FULL;
+			options->lto_link = RT_FALSE;
+		} else if (arg_size > 6 && rt_char_equals(arg, 6, _R("--lto="), 6)) {
+			if (RT_UNLIKELY(!zz_options_parse_lto(&arg[6], arg_size - 6, &options->lto)))
+				goto error;
+			options->lto_link = RT_FALSE;
+		} else if (rt_char_equals(arg, arg_size, _R("--lto-link"), 10)) {
+			options->lto = ZZ_LTO_FULL;
+			options->lto_link = RT_TRUE;
+		} else if (arg_size > 11 && rt_char_equals(arg, 11, _R("--lto-link="), 11)) {
+			if (RT_UNLIKELY(!zz_options_parse_lto(&arg[11], arg_size - 11, &options->lto)))
+				goto error;
+			options->lto_link = RT_TRUE;
+		} else if (arg_size > 16 && rt_char_equals(arg, 16, _R("--codegen-units="), 16)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un_with_size(&arg[16], arg_size - 16, &options->codegen_units)))
+				goto error;
+			if (RT_UNLIKELY(!options->codegen_units)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+		} else if (rt_char_equals(arg, arg_size, _R("--profile-generate"), 18)) {
+			options->profile_generate_file_path = ZZ_OPTIONS_DEFAULT_PROFILE_FILE_PATH;
+		} else if (arg_size > 19 && rt_char_equals(arg, 19, _R("--profile-generate="), 19)) {
+			options->profile_generate_file_path = &arg[19];
+		} else if (arg_size > 14 && rt_char_equals(arg, 14, _R("--profile-use="), 14)) {
+			options->profile_use_file_path = &arg[14];
+		} else if (arg_size > 7 && rt_char_equals(arg, 7, _R("--jobs="), 7)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un_with_size(&arg[7], arg_size - 7, &options->jobs)))
+				goto error;
+			if (RT_UNLIKELY(!options->jobs)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+		} else if (arg_size > 8 && rt_char_equals(arg, 8, _R("--cache="), 8)) {
+			options->cache_directory_path = &arg[8];
+		} else if (arg_size > 13 && rt_char_equals(arg, 13, _R("--cache-size="), 13)) {
+			if (RT_UNLIKELY(!rt_char_convert_to_un_with_size(&arg[13], arg_size - 13, &options->cache_max_size)))
+				goto error;
+			if (RT_UNLIKELY(options->cache_max_size > RT_TYPE_MAX_UN / (1024 * 1024))) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			options->cache_max_size *= 1024 * 1024;
+		} else if (arg_size > 9 && rt_char_equals(arg, 9, _R("--server="), 9)) {
+			options->server_socket_path = &arg[9];
+		} else if (arg_size > 9 && rt_char_equals(arg, 9, _R("--client="), 9)) {
+			options->client_socket_path = &arg[9];
+		} else if (arg_size > 1 && arg[0] == _R('@')) {
+			if (RT_UNLIKELY(!zz_options_parse_file_list(options, &arg[1])))
+				goto error;
+		} else if (arg[0] != _R('-')) {
+			if (RT_UNLIKELY(!zz_options_add_input_file_path(options, arg)))
+				goto error;
+		} else {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	}
+
+	/* --run produces no artifact. */
+	if (RT_UNLIKELY(options->run && (options->emit || options->output_file_path || options->standard_output || options->codegen_units > 1))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	/* The JIT loads the code anywhere in the address space of the compiler. */
+	if (RT_UNLIKELY(options->run && (options->target || options->reloc))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	/* The link is done on the bitcode of --lto, which replaces the artifacts and the partitions. */
+	if (RT_UNLIKELY(options->lto && (options->run || options->codegen_units > 1))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	if (RT_UNLIKELY(options->lto && !options->lto_link && (options->emit & ~ZZ_EMIT_LLVM_BC))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	/* The instrumented program writes its profile at exit, after the JIT is gone with --run. The link reuses the counts of the compilation. */
+	if (RT_UNLIKELY(options->profile_generate_file_path && (options->profile_use_file_path || options->run))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	if (RT_UNLIKELY((options->profile_generate_file_path || options->profile_use_file_path) && options->lto_link)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	if (!options->emit)
+		options->emit = (options->lto && !options->lto_link) ? ZZ_EMIT_LLVM_BC : ZZ_EMIT_OBJ;
+
+	if (options->server_socket_path) {
+		if (RT_UNLIKELY(options->client_socket_path || options->run || options->lto_link || options->input_files_count || options->output_file_path || options->standard_output)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	} else if (!options->help && !options->input_files_count) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	} else if (RT_UNLIKELY(options->run && options->input_files_count > 1)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	} else if (RT_UNLIKELY((options->output_file_path || options->standard_output) && options->input_files_count > 1 && !options->lto_link)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	} else if (RT_UNLIKELY(options->standard_output && ((options->emit & (options->emit - 1)) || options->codegen_units > 1 || (options->lto_link && options->lto == ZZ_LTO_THIN)))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_options_free(struct zz_options *options)
+{
+	struct rt_heap *heap = options->heap;
+	rt_un i;
+	rt_s ret = RT_OK;
+
+	for (i = 0; i < options->file_lists_count; i++) {
+		if (RT_UNLIKELY(!heap->free(heap, (void**)&options->file_lists[i])))
+			ret = RT_FAILED;
+	}
+	if (options->file_lists && RT_UNLIKELY(!heap->free(heap, (void**)&options->file_lists)))
+		ret = RT_FAILED;
+	if (options->input_file_paths && RT_UNLIKELY(!heap->free(heap, (void**)&options->input_file_paths)))
+		ret = RT_FAILED;
+	options->file_lists_count = 0;
+	options->input_files_count = 0;
+
+	return ret;
+}
@@ -0,0 +1,170 @@
+#include "output/zz_output_file.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+/* Keeps the sizes of the writes in a DWORD. */
+#define ZZ_OUTPUT_FILE_CHUNK_SIZE (1024 * 1024 * 1024)
+
+static const rt_char *zz_output_file_get_extension(enum zz_emit emit)
+{
+	switch (emit) {
+	case ZZ_EMIT_ASM:
+		return _R(".s");
+	case ZZ_EMIT_LLVM_IR:
+		return _R(".ll");
+	case ZZ_EMIT_LLVM_BC:
+		return _R(".bc");
+	default:
+		return _R(".o");
+	}
+}
+
+rt_s zz_output_file_get_path(const rt_char *input_file_path, struct zz_options *options, enum zz_emit emit, rt_un partition, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	const rt_char *input_extension;
+	rt_un input_extension_size;
+	const rt_char *extension;
+	rt_un i;
+	rt_s ret;
+
+	*buffer_size = 0;
+	if (options->output_file_path) {
+		if (RT_UNLIKELY(!rt_char_append(options->output_file_path, rt_char_get_size(options->output_file_path), buffer, buffer_capacity, buffer_size)))
+			goto error;
+
+		/* Several artifacts cannot share the path. */
+		if (!(options->emit & (options->emit - 1)) && !partition)
+			goto end;
+
+		for (i = *buffer_size; i > 0; i--) {
+			if (buffer[i - 1] == _R('.')) {
+				*buffer_size = i - 1;
+				break;
+			}
+			if (buffer[i - 1] == _R('/') || buffer[i - 1] == _R('\\'))
+				break;
+		}
+	} else {
+		if (RT_UNLIKELY(!rt_file_path_get_name(input_file_path, rt_char_get_size(input_file_path), buffer, buffer_capacity, buffer_size)))
+			goto error;
+		input_extension = options->lto_link ? _R(".bc") : _R(".stc");
+		input_extension_size = rt_char_get_size(input_extension);
+		if (RT_UNLIKELY(!rt_char_ends_with(buffer, *buffer_size, input_extension, input_extension_size))) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		*buffer_size -= input_extension_size;
+	}
+	buffer[*buffer_size] = 0;
+
+	if (partition) {
+		if (RT_UNLIKELY(!rt_char_append_char(_R('.'), buffer, buffer_capacity, buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!rt_char_append_un(partition, 10, buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+
+	extension = zz_output_file_get_extension(emit);
+	if (RT_UNLIKELY(!rt_char_append(extension, rt_char_get_size(extension), buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#ifdef RT_DEFINE_WINDOWS
+
+static rt_s zz_output_file_write_standard_output(const rt_char8 *data, rt_un data_size)
+{
+	HANDLE standard_output = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD chunk_size;
+	DWORD written;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!standard_output || standard_output == INVALID_HANDLE_VALUE))
+		goto error;
+
+	while (data_size) {
+		chunk_size = data_size < ZZ_OUTPUT_FILE_CHUNK_SIZE ? (DWORD)data_size : ZZ_OUTPUT_FILE_CHUNK_SIZE;
+		if (RT_UNLIKELY(!WriteFile(standard_output, data, chunk_size, &written, RT_NULL)))
+			goto error;
+		data += written;
+		data_size -= written;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#else
+
+static rt_s zz_output_file_write_standard_output(const rt_char8 *data, rt_un data_size)
+{
+	rt_un chunk_size;
+	ssize_t written;
+	rt_s ret;
+
+	while (data_size) {
+		chunk_size = data_size < ZZ_OUTPUT_FILE_CHUNK_SIZE ? data_size : ZZ_OUTPUT_FILE_CHUNK_SIZE;
+		written = write(STDOUT_FILENO, data, chunk_size);
+		if (RT_UNLIKELY(written == -1)) {
+			if (errno == EINTR)
+				continue;
+			goto error;
+		}
+		data += written;
+		data_size -= written;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#endif
+
+rt_s zz_output_file_write(const rt_char *file_path, const rt_char8 *data, rt_un data_size)
+{
+	rt_s ret;
+
+	if (!file_path) {
+		if (RT_UNLIKELY(!zz_output_file_write_standard_output(data, data_size)))
+			goto error;
+		goto end;
+	}
+
+	if (rt_file_system_is_file(file_path) && RT_UNLIKELY(!rt_file_system_delete_file(file_path)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_small_file_write(file_path, RT_SMALL_FILE_MODE_TRUNCATE, data, data_size)))
+		goto error;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -1,6 +1,88 @@
 #include "parser/zz_parser.h"
 
-static const rt_un zz_parser_binary_operators_precedence[] = {
+/**
+ * Binary operator of each token type, <tt>ZZ_PARSER_NO_BINARY_OPERATOR</tt> if the token is not a binary operator.
+ */
+#define ZZ_PARSER_NO_BINARY_OPERATOR 0xFF
+
+static const rt_un8 zz_parser_token_binary_operators[] = {
+	[ZZ_TOKEN_TYPE_END_OF_FILE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_IDENTIFIER] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_FUNCTION] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_VAR] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_FOR] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_IN] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_UNROLL] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_VECTORIZE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_INTERLEAVE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_MULTIVERSION] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_SHUFFLE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_I32] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_I64] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_I32X4] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_I32X8] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_I64X4] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_NUMBER] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_PLUS] = ZZ_BINARY_OPERATOR_ADD,
+	[ZZ_TOKEN_TYPE_MINUS] = ZZ_BINARY_OPERATOR_SUBTRACT,
+	[ZZ_TOKEN_TYPE_ASTERISK] = ZZ_BINARY_OPERATOR_MULTIPLY,
+	[ZZ_TOKEN_TYPE_SLASH] = ZZ_BINARY_OPERATOR_DIVIDE,
+	[ZZ_TOKEN_TYPE_PERCENT] = ZZ_BINARY_OPERATOR_MODULO,
+	[ZZ_TOKEN_TYPE_OPEN_BRACE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_CLOSE_BRACE] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_OPEN_PARENTHESIS] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_OPEN_BRACKET] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_CLOSE_BRACKET] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_COMMA] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_COLON] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_SEMICOLON] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_EQUALS] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_DOT] = ZZ_PARSER_NO_BINARY_OPERATOR,
+	[ZZ_TOKEN_TYPE_DOT_DOT] = ZZ_PARSER_NO_BINARY_OPERATOR
+};
+
+/**
+ * Value type named by each type keyword, <tt>ZZ_VALUE_TYPES_COUNT</tt> if the token is not a type.
+ */
+static const rt_un8 zz_parser_token_value_types[] = {
+	[ZZ_TOKEN_TYPE_END_OF_FILE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_IDENTIFIER] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_FUNCTION] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_VAR] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_FOR] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_IN] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_UNROLL] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_VECTORIZE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_INTERLEAVE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_MULTIVERSION] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_SHUFFLE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_I32] = ZZ_VALUE_TYPE_I32,
+	[ZZ_TOKEN_TYPE_I64] = ZZ_VALUE_TYPE_I64,
+	[ZZ_TOKEN_TYPE_I32X4] = ZZ_VALUE_TYPE_I32X4,
+	[ZZ_TOKEN_TYPE_I32X8] = ZZ_VALUE_TYPE_I32X8,
+	[ZZ_TOKEN_TYPE_I64X4] = ZZ_VALUE_TYPE_I64X4,
+	[ZZ_TOKEN_TYPE_NUMBER] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_PLUS] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_MINUS] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_ASTERISK] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_SLASH] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_PERCENT] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_OPEN_BRACE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_CLOSE_BRACE] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_OPEN_PARENTHESIS] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_OPEN_BRACKET] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_CLOSE_BRACKET] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_COMMA] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_COLON] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_SEMICOLON] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_EQUALS] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_DOT] = ZZ_VALUE_TYPES_COUNT,
+	[ZZ_TOKEN_TYPE_DOT_DOT] = ZZ_VALUE_TYPES_COUNT
+};
+
+static const rt_un8 zz_parser_binary_operators_precedence[] = {
 	[ZZ_BINARY_OPERATOR_ADD] = 1,
 	[ZZ_BINARY_OPERATOR_SUBTRACT] = 1,
 	[ZZ_BINARY_OPERATOR_MULTIPLY] = 2,
@@ -8,23 +90,977 @@ static const rt_un zz_parser_binary_operators_precedence[] = {
 	[ZZ_BINARY_OPERATOR_MODULO] = 2
 };
 
-static rt_s zz_parser_parse_expression(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result);
+/**
+ * Prefix operators bind tighter than any binary operator.
+ */
+#define ZZ_PARSER_UNARY_OPERATOR_PRECEDENCE 3
+
+enum zz_parser_operator_type {
+	ZZ_PARSER_OPERATOR_TYPE_BINARY,
+	ZZ_PARSER_OPERATOR_TYPE_NEGATE,
+	ZZ_PARSER_OPERATOR_TYPE_PARENTHESIS,
+	/* Opening parenthesis of a shuffle, whose vectors are separated by commas. */
+	ZZ_PARSER_OPERATOR_TYPE_SHUFFLE,
+	/* Opening parenthesis of a conversion like i32(x). */
+	ZZ_PARSER_OPERATOR_TYPE_CONVERSION,
+	/* Opening bracket of an array element like a[i + 1]. */
+	ZZ_PARSER_OPERATOR_TYPE_ELEMENT
+};
+
+/**
+ * Entry of the operators stack of the expressions parser.
+ *
+ * <p>
+ * A binary operator holds its left operand until its right operand has been parsed.<br>
+ * A shuffle holds its first vector the same way, until its second vector has been parsed.<br>
+ * An array element holds the local of its array until its index has been parsed.
+ * </p>
+ */
+struct zz_parser_operator {
+	rt_un32 left;
+	rt_un8 type;
+	/* The enum zz_binary_operator, or the enum zz_value_type of a conversion. */
+	rt_un8 binary_operator;
+	rt_un8 precedence;
+	/* Number of vectors of a shuffle already parsed. */
+	rt_un8 arguments_count;
+};
+
+/**
+ * Local variable visible from the current statement.
+ */
+struct zz_parser_variable {
+	/* Symbol id of the name. */
+	rt_un32 symbol;
+	rt_un32 local;
+	/* Loop variables cannot be assigned. */
+	rt_b read_only;
+};
+
+/**
+ * Loop whose body is being parsed.
+ */
+struct zz_parser_loop {
+	/* The for node, closed by an end for node. */
+	rt_un32 node;
+	/* Number of variables visible before the loop, the loop variable and the ones of the body are removed at the end of the body. */
+	rt_un variables_size;
+};
+
+struct zz_parser {
+	rt_char8 *input;
+	rt_un8 *types;
+	rt_un32 *offsets;
+	rt_un32 *sizes;
+	rt_un32 *symbols;
+	/* Index of the current token. */
+	rt_un position;
+	struct zz_ast *ast;
+	struct rt_heap *heap;
+	/* Explicit stack of the expressions parser, so that the native stack does not grow with the nesting. */
+	struct zz_parser_operator *operators;
+	rt_un operators_size;
+	rt_un operators_capacity;
+	/* Scopes of the current function, innermost variables last. */
+	struct zz_parser_variable *variables;
+	rt_un variables_size;
+	rt_un variables_capacity;
+	/* Loops are parsed without recursion too. */
+	struct zz_parser_loop *loops;
+	rt_un loops_size;
+	rt_un loops_capacity;
+};
+
+#define ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) ((parser)->types[(parser)->position])
+
+/* Levels of operators of the constant array indexes that are checked, the deeper ones are left to LLVM. */
+#define ZZ_PARSER_MAX_CONSTANT_DEPTH 8
+
+/**
+ * Make sure that one more item of <tt>item_size</tt> bytes can be pushed on the stack <tt>items</tt>.
+ */
+static rt_s zz_parser_reserve(struct rt_heap *heap, void **items, rt_un item_size, rt_un size, rt_un *capacity)
+{
+	rt_un new_capacity;
+	rt_s ret;
+
+	if (RT_UNLIKELY(size == *capacity)) {
+		new_capacity = *capacity ? *capacity * 2 : 64;
+		if (*items) {
+			if (RT_UNLIKELY(!heap->realloc(heap, items, new_capacity * item_size)))
+				goto error;
+		} else {
+			if (RT_UNLIKELY(!heap->alloc(heap, items, new_capacity * item_size)))
+				goto error;
+		}
+		*capacity = new_capacity;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_parser_push_operator(struct zz_parser *parser, enum zz_parser_operator_type type, rt_un8 binary_operator, rt_un8 precedence, rt_un32 left)
+{
+	struct zz_parser_operator *operator;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_parser_reserve(parser->heap, (void**)&parser->operators, sizeof(struct zz_parser_operator), parser->operators_size, &parser->operators_capacity)))
+		goto error;
+	operator = &parser->operators[parser->operators_size++];
+	operator->left = left;
+	operator->type = type;
+	operator->binary_operator = binary_operator;
+	operator->precedence = precedence;
+	operator->arguments_count = 0;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Make the local visible under the name <tt>symbol</tt>, until the end of the current block.
+ */
+static rt_s zz_parser_push_variable(struct zz_parser *parser, rt_un32 symbol, rt_un32 local, rt_b read_only)
+{
+	struct zz_parser_variable *variable;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_parser_reserve(parser->heap, (void**)&parser->variables, sizeof(struct zz_parser_variable), parser->variables_size, &parser->variables_capacity)))
+		goto error;
+	variable = &parser->variables[parser->variables_size++];
+	variable->symbol = symbol;
+	variable->local = local;
+	variable->read_only = read_only;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Few variables are visible at once, a linear search from the innermost one is enough.
+ *
+ * @return The visible variable named <tt>symbol</tt>, <tt>RT_NULL</tt> if there is none.
+ */
+static struct zz_parser_variable *zz_parser_find_variable(struct zz_parser *parser, rt_un32 symbol)
+{
+	rt_un i;
+
+	for (i = parser->variables_size; i-- > 0;) {
+		if (parser->variables[i].symbol == symbol)
+			return &parser->variables[i];
+	}
+	return RT_NULL;
+}
+
+/**
+ * Pop the top operator, which must not be a parenthesis, and apply it to <tt>operand</tt>.
+ */
+static rt_s zz_parser_reduce(struct zz_parser *parser, rt_un32 *operand)
+{
+	struct zz_parser_operator *operator = &parser->operators[--parser->operators_size];
+	rt_s ret;
+
+	if (operator->type == ZZ_PARSER_OPERATOR_TYPE_NEGATE) {
+		if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_UNARY_OPERATOR, ZZ_UNARY_OPERATOR_NEGATE), *operand, 0, operand)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_BINARY_OPERATOR, operator->binary_operator), operator->left, *operand, operand)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * The lexer ensures that the token is only made of digits.
+ */
+static rt_s zz_parser_convert_number(rt_char8 *str, rt_un str_size, rt_n *result)
+{
+	rt_un value = 0;
+	rt_un digit;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < str_size; i++) {
+		digit = str[i] - '0';
+		if (RT_UNLIKELY(value > (RT_TYPE_MAX_N - digit) / 10)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		value = value * 10 + digit;
+	}
+	*result = value;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a number.
+ * 
+ * <p>
+ * The possible minus must have been parsed already.
+ * </p>
+ */
+static rt_s zz_parser_parse_number(struct zz_parser *parser, rt_un32 *result)
+{
+	rt_n value;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_parser_convert_number(&parser->input[parser->offsets[parser->position]], parser->sizes[parser->position], &value)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_ast_add_number(parser->ast, value, result)))
+		goto error;
+
+	parser->position++;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a call like <tt>name()</tt>, the functions have no arguments for now.
+ */
+static rt_s zz_parser_parse_call(struct zz_parser *parser, rt_un32 *result)
+{
+	rt_un32 name = parser->symbols[parser->position];
+	rt_s ret;
+
+	/* Consume the function name. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the opening parenthesis. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the closing parenthesis. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_CALL, 0), name, 0, result)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse the lanes of a vector, like <tt>1, -2, 3, 4)</tt>, up to the closing parenthesis included.
+ *
+ * @param lanes Receives up to <tt>ZZ_VALUE_TYPE_MAX_LANES_COUNT</tt> lanes.
+ */
+static rt_s zz_parser_parse_lanes(struct zz_parser *parser, rt_n *lanes, rt_un *lanes_count)
+{
+	rt_un count = 0;
+	rt_b negative;
+	rt_s ret;
+
+	while (RT_TRUE) {
+		negative = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) == ZZ_TOKEN_TYPE_MINUS;
+		if (negative)
+			parser->position++;
+
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_NUMBER || count == ZZ_VALUE_TYPE_MAX_LANES_COUNT)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		if (RT_UNLIKELY(!zz_parser_convert_number(&parser->input[parser->offsets[parser->position]], parser->sizes[parser->position], &lanes[count])))
+			goto error;
+		if (negative)
+			lanes[count] = -lanes[count];
+		count++;
+
+		/* Consume the number. */
+		parser->position++;
+
+		if (ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) == ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS)
+			break;
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_COMMA)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the comma. */
+		parser->position++;
+	}
+
+	/* Consume the closing parenthesis. */
+	parser->position++;
+
+	*lanes_count = count;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a vector literal like <tt>i32x4(1, 2, 3, 4)</tt>.<br>
+ * With a single lane, like <tt>i32x4(7)</tt>, the value is copied into all the lanes.
+ */
+static rt_s zz_parser_parse_vector(struct zz_parser *parser, rt_un32 *result)
+{
+	enum zz_value_type value_type = zz_parser_token_value_types[ZZ_PARSER_CURRENT_TOKEN_TYPE(parser)];
+	rt_n lanes[ZZ_VALUE_TYPE_MAX_LANES_COUNT];
+	rt_un lanes_count;
+	rt_un i;
+	rt_s ret;
+
+	/* Consume the type. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the opening parenthesis. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_parser_parse_lanes(parser, lanes, &lanes_count)))
+		goto error;
+
+	if (lanes_count == 1) {
+		for (i = 1; i < zz_value_type_get_lanes_count(value_type); i++)
+			lanes[i] = lanes[0];
+	} else if (RT_UNLIKELY(lanes_count != zz_value_type_get_lanes_count(value_type))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_ast_add_vector(parser->ast, value_type, lanes, result)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
 
 /**
- * Parse minus as a unary operator.
+ * Parse the mask of a shuffle, following its second vector, and add the mask and the shuffle.
+ *
+ * @param operand The second vector, replaced by the shuffle.
+ */
+static rt_s zz_parser_parse_shuffle_mask(struct zz_parser *parser, rt_un32 first_vector, rt_un32 *operand)
+{
+	rt_n lanes[ZZ_VALUE_TYPE_MAX_LANES_COUNT];
+	rt_un lanes_count;
+	enum zz_value_type mask_type;
+	rt_un32 mask;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_parser_parse_lanes(parser, lanes, &lanes_count)))
+		goto error;
+
+	mask_type = zz_value_type_get_vector_type(ZZ_VALUE_TYPE_I32, lanes_count);
+	if (RT_UNLIKELY(mask_type == ZZ_VALUE_TYPES_COUNT)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* The mask must be just before the shuffle. */
+	if (RT_UNLIKELY(!zz_ast_add_vector(parser->ast, mask_type, lanes, &mask)))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_SHUFFLE, 0), first_vector, *operand, operand)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a lane extraction like <tt>[2]</tt>, applied to <tt>operand</tt>.
+ */
+static rt_s zz_parser_parse_extract(struct zz_parser *parser, rt_un32 *operand)
+{
+	rt_n lane;
+	rt_s ret;
+
+	/* Consume the opening bracket. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_NUMBER)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	if (RT_UNLIKELY(!zz_parser_convert_number(&parser->input[parser->offsets[parser->position]], parser->sizes[parser->position], &lane)))
+		goto error;
+
+	/* Consume the lane. */
+	parser->position++;
+
+	if (RT_UNLIKELY(lane >= ZZ_VALUE_TYPE_MAX_LANES_COUNT || ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_BRACKET)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the closing bracket. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_EXTRACT, 0), *operand, (rt_un32)lane, operand)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Reduce the operators up to the innermost parenthesis, shuffle, conversion or array element, which is left on the stack.
+ */
+static rt_s zz_parser_reduce_group(struct zz_parser *parser, rt_un32 *operand)
+{
+	rt_un8 type;
+	rt_s ret;
+
+	while (RT_TRUE) {
+		type = parser->operators[parser->operators_size - 1].type;
+		if (type == ZZ_PARSER_OPERATOR_TYPE_PARENTHESIS || type == ZZ_PARSER_OPERATOR_TYPE_SHUFFLE || type == ZZ_PARSER_OPERATOR_TYPE_CONVERSION || type == ZZ_PARSER_OPERATOR_TYPE_ELEMENT)
+			break;
+		if (RT_UNLIKELY(!zz_parser_reduce(parser, operand)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Operator-precedence parsing of an expression, with an explicit operators stack.
+ *
+ * <p>
+ * The native stack usage does not depend on the nesting of the parenthesis and operators.<br>
+ * Binary operators are left associative and unary minus only applies to the following primary.<br>
+ * Lane extractions apply to the primary or the parenthesis before them, before any unary minus.<br>
+ * The index of an array element is parsed like a parenthesized expression.
+ * </p>
+ *
+ * <p>
+ * The expression ends at the first token that cannot continue it, which is left to the caller.
+ * </p>
+ */
+static rt_s zz_parser_parse_expression(struct zz_parser *parser, rt_un32 *result)
+{
+	rt_un operators_base = parser->operators_size;
+	rt_un parenthesis_depth = 0;
+	struct zz_parser_operator *operator;
+	struct zz_parser_variable *variable = RT_NULL;
+	rt_un32 address;
+	rt_un32 operand;
+	rt_un8 token_type;
+	rt_un8 value_type;
+	rt_un8 binary_operator;
+	rt_un8 precedence;
+	rt_s ret;
+
+	while (RT_TRUE) {
+
+		/* Prefix operators, opening parenthesis and array elements, then the number, the vector, the variable or the call. */
+		while (RT_TRUE) {
+			token_type = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser);
+			value_type = zz_parser_token_value_types[token_type];
+			if (token_type == ZZ_TOKEN_TYPE_IDENTIFIER && parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
+				variable = zz_parser_find_variable(parser, parser->symbols[parser->position]);
+				if (RT_UNLIKELY(!variable)) {
+					rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+					goto error;
+				}
+				if (!parser->ast->locals[variable->local].array_size)
+					break;
+				if (RT_UNLIKELY(parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_OPEN_BRACKET)) {
+					rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+					goto error;
+				}
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_ELEMENT, 0, 0, variable->local)))
+					goto error;
+				parenthesis_depth++;
+				/* Consume the array name. */
+				parser->position++;
+			} else if (token_type == ZZ_TOKEN_TYPE_NUMBER || token_type == ZZ_TOKEN_TYPE_IDENTIFIER || (value_type != ZZ_VALUE_TYPES_COUNT && zz_value_type_get_lanes_count(value_type) > 1)) {
+				break;
+			} else if (token_type == ZZ_TOKEN_TYPE_MINUS) {
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_NEGATE, 0, ZZ_PARSER_UNARY_OPERATOR_PRECEDENCE, 0)))
+					goto error;
+			} else if (token_type == ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
+				/* Precedence zero so that it is never reduced by a binary operator. */
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_PARENTHESIS, 0, 0, 0)))
+					goto error;
+				parenthesis_depth++;
+			} else if (token_type == ZZ_TOKEN_TYPE_SHUFFLE && parser->types[parser->position + 1] == ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
+				/* The vectors are parsed like parenthesized expressions. */
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_SHUFFLE, 0, 0, 0)))
+					goto error;
+				parenthesis_depth++;
+				/* Consume the shuffle keyword. */
+				parser->position++;
+			} else if (value_type != ZZ_VALUE_TYPES_COUNT && parser->types[parser->position + 1] == ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
+				/* Conversion to a scalar type. */
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_CONVERSION, value_type, 0, 0)))
+					goto error;
+				parenthesis_depth++;
+				/* Consume the type. */
+				parser->position++;
+			} else {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			parser->position++;
+		}
+		if (token_type == ZZ_TOKEN_TYPE_NUMBER) {
+			if (RT_UNLIKELY(!zz_parser_parse_number(parser, &operand)))
+				goto error;
+		} else if (token_type == ZZ_TOKEN_TYPE_IDENTIFIER && parser->types[parser->position + 1] == ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
+			if (RT_UNLIKELY(!zz_parser_parse_call(parser, &operand)))
+				goto error;
+		} else if (token_type == ZZ_TOKEN_TYPE_IDENTIFIER) {
+			/* A scalar or vector variable, found by the loop above. */
+			if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_LOCAL, 0), variable->local, 0, &operand)))
+				goto error;
+			/* Consume the variable name. */
+			parser->position++;
+		} else {
+			if (RT_UNLIKELY(!zz_parser_parse_vector(parser, &operand)))
+				goto error;
+		}
+
+		/* Closing parenthesis or brackets and lane extractions, then either a binary operator, a comma of a shuffle, or the end of the expression. */
+		while (RT_TRUE) {
+			token_type = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser);
+			binary_operator = zz_parser_token_binary_operators[token_type];
+			if (binary_operator != ZZ_PARSER_NO_BINARY_OPERATOR) {
+				precedence = zz_parser_binary_operators_precedence[binary_operator];
+				while (parser->operators_size > operators_base && parser->operators[parser->operators_size - 1].precedence >= precedence) {
+					if (RT_UNLIKELY(!zz_parser_reduce(parser, &operand)))
+						goto error;
+				}
+				if (RT_UNLIKELY(!zz_parser_push_operator(parser, ZZ_PARSER_OPERATOR_TYPE_BINARY, binary_operator, precedence, operand)))
+					goto error;
+				parser->position++;
+				break;
+			} else if (token_type == ZZ_TOKEN_TYPE_OPEN_BRACKET) {
+				/* Binds tighter than the prefix operators, which are still on the stack. */
+				if (RT_UNLIKELY(!zz_parser_parse_extract(parser, &operand)))
+					goto error;
+			} else if (token_type == ZZ_TOKEN_TYPE_CLOSE_BRACKET && parenthesis_depth) {
+				if (RT_UNLIKELY(!zz_parser_reduce_group(parser, &operand)))
+					goto error;
+				operator = &parser->operators[parser->operators_size - 1];
+				if (RT_UNLIKELY(operator->type != ZZ_PARSER_OPERATOR_TYPE_ELEMENT)) {
+					rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+					goto error;
+				}
+				if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_ADDRESS, 0), operator->left, operand, &address)))
+					goto error;
+				if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_LOAD, 0), address, 0, &operand)))
+					goto error;
+				parser->operators_size--;
+				parenthesis_depth--;
+				parser->position++;
+			} else if (token_type == ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS && parenthesis_depth) {
+				if (RT_UNLIKELY(!zz_parser_reduce_group(parser, &operand)))
+					goto error;
+				operator = &parser->operators[parser->operators_size - 1];
+				if (RT_UNLIKELY(operator->type == ZZ_PARSER_OPERATOR_TYPE_SHUFFLE || operator->type == ZZ_PARSER_OPERATOR_TYPE_ELEMENT)) {
+					rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+					goto error;
+				}
+				if (operator->type == ZZ_PARSER_OPERATOR_TYPE_CONVERSION) {
+					if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_CONVERSION, operator->binary_operator), operand, 0, &operand)))
+						goto error;
+				}
+				parser->operators_size--;
+				parenthesis_depth--;
+				parser->position++;
+			} else if (token_type == ZZ_TOKEN_TYPE_COMMA && parenthesis_depth) {
+				if (RT_UNLIKELY(!zz_parser_reduce_group(parser, &operand)))
+					goto error;
+				operator = &parser->operators[parser->operators_size - 1];
+				if (RT_UNLIKELY(operator->type != ZZ_PARSER_OPERATOR_TYPE_SHUFFLE)) {
+					rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+					goto error;
+				}
+				/* Consume the comma. */
+				parser->position++;
+				if (!operator->arguments_count) {
+					/* Parse the second vector. */
+					operator->left = operand;
+					operator->arguments_count++;
+					break;
+				}
+				if (RT_UNLIKELY(!zz_parser_parse_shuffle_mask(parser, operator->left, &operand)))
+					goto error;
+				parser->operators_size--;
+				parenthesis_depth--;
+			} else {
+				goto end_of_expression;
+			}
+		}
+	}
+
+end_of_expression:
+	if (RT_UNLIKELY(parenthesis_depth)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	while (parser->operators_size > operators_base) {
+		if (RT_UNLIKELY(!zz_parser_reduce(parser, &operand)))
+			goto error;
+	}
+
+	*result = operand;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a count like the size of an array or the <tt>8</tt> of <tt>vectorize(8)</tt>, which must be at least one.
+ */
+static rt_s zz_parser_parse_count(struct zz_parser *parser, rt_un32 *count)
+{
+	rt_n value;
+	rt_s ret;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_NUMBER)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	if (RT_UNLIKELY(!zz_parser_convert_number(&parser->input[parser->offsets[parser->position]], parser->sizes[parser->position], &value)))
+		goto error;
+	if (RT_UNLIKELY(!value || value > RT_TYPE_MAX_N32)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	*count = (rt_un32)value;
+
+	/* Consume the number. */
+	parser->position++;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse a declaration like <tt>var x = 1;</tt>, whose type is the one of its value, or like <tt>var a: i32[256];</tt>, an array filled with zeros.
+ *
+ * <p>
+ * A variable cannot be used in its own value, nor hide another variable.
+ * </p>
+ */
+static rt_s zz_parser_parse_declaration(struct zz_parser *parser)
+{
+	enum zz_value_type type = ZZ_VALUE_TYPES_COUNT;
+	rt_un32 array_size = 0;
+	rt_un32 symbol;
+	rt_un32 value;
+	rt_un32 local;
+	rt_un32 node;
+	rt_s ret;
+
+	/* Consume the var keyword. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_IDENTIFIER || zz_parser_find_variable(parser, parser->symbols[parser->position]))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	symbol = parser->symbols[parser->position];
+
+	/* Consume the variable name. */
+	parser->position++;
+
+	if (ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) == ZZ_TOKEN_TYPE_COLON) {
+		parser->position++;
+		type = zz_parser_token_value_types[ZZ_PARSER_CURRENT_TOKEN_TYPE(parser)];
+		if (RT_UNLIKELY(type == ZZ_VALUE_TYPES_COUNT || parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_OPEN_BRACKET)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the type and the opening bracket. */
+		parser->position += 2;
+
+		if (RT_UNLIKELY(!zz_parser_parse_count(parser, &array_size)))
+			goto error;
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_BRACKET)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the closing bracket. */
+		parser->position++;
+
+		if (RT_UNLIKELY(!zz_ast_add_number(parser->ast, 0, &value)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_EQUALS)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the equals sign. */
+		parser->position++;
+
+		if (RT_UNLIKELY(!zz_parser_parse_expression(parser, &value)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_SEMICOLON)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the semicolon. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_ast_add_local(parser->ast, type, array_size, &local)))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_ASSIGN, 0), local, value, &node)))
+		goto error;
+	if (RT_UNLIKELY(!zz_parser_push_variable(parser, symbol, local, RT_FALSE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Whether the statement starting with the current identifier is an assignment, looking ahead over the index of an array element.
+ */
+static rt_b zz_parser_is_assignment(struct zz_parser *parser)
+{
+	rt_un position = parser->position + 1;
+	rt_un depth = 0;
+
+	if (parser->types[position] == ZZ_TOKEN_TYPE_OPEN_BRACKET) {
+		do {
+			if (parser->types[position] == ZZ_TOKEN_TYPE_OPEN_BRACKET)
+				depth++;
+			else if (parser->types[position] == ZZ_TOKEN_TYPE_CLOSE_BRACKET)
+				depth--;
+			else if (parser->types[position] == ZZ_TOKEN_TYPE_END_OF_FILE)
+				return RT_FALSE;
+			position++;
+		} while (depth);
+	}
+	return parser->types[position] == ZZ_TOKEN_TYPE_EQUALS;
+}
+
+/**
+ * Parse an assignment like <tt>x = x + 1;</tt> or <tt>a[i] = x;</tt>.
+ */
+static rt_s zz_parser_parse_assignment(struct zz_parser *parser)
+{
+	struct zz_parser_variable *variable = zz_parser_find_variable(parser, parser->symbols[parser->position]);
+	rt_un32 local;
+	rt_un32 index;
+	rt_un32 address;
+	rt_un32 value;
+	rt_un32 node;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!variable || variable->read_only)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	local = variable->local;
+
+	/* Consume the variable name. */
+	parser->position++;
+
+	if (parser->ast->locals[local].array_size) {
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_BRACKET)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the opening bracket. */
+		parser->position++;
+
+		if (RT_UNLIKELY(!zz_parser_parse_expression(parser, &index)))
+			goto error;
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_BRACKET)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the closing bracket. */
+		parser->position++;
+
+		if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_ADDRESS, 0), local, index, &address)))
+			goto error;
+	}
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_EQUALS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the equals sign. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_parser_parse_expression(parser, &value)))
+		goto error;
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_SEMICOLON)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the semicolon. */
+	parser->position++;
+
+	if (parser->ast->locals[local].array_size) {
+		if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_STORE, 0), address, value, &node)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_ASSIGN, 0), local, value, &node)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Parse the hints following the range of a loop, like <tt>unroll(4) vectorize(8) interleave(2)</tt>, in any order.
+ *
+ * <p>
+ * LLVM ignores the vectorization widths and the interleave counts that are not powers of two, they are rejected.
+ * </p>
  */
-static rt_s zz_parser_parse_minus(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+static rt_s zz_parser_parse_hints(struct zz_parser *parser, rt_un32 *unroll, rt_un32 *vectorize, rt_un32 *interleave)
 {
+	rt_un8 token_type;
+	rt_un32 *hint;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!rt_list_new_item(ast_nodes_list, (void**)result)))
-		goto error;
+	*unroll = 0;
+	*vectorize = 0;
+	*interleave = 0;
+
+	while (RT_TRUE) {
+		token_type = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser);
+		if (token_type == ZZ_TOKEN_TYPE_UNROLL)
+			hint = unroll;
+		else if (token_type == ZZ_TOKEN_TYPE_VECTORIZE)
+			hint = vectorize;
+		else if (token_type == ZZ_TOKEN_TYPE_INTERLEAVE)
+			hint = interleave;
+		else
+			break;
+
+		if (RT_UNLIKELY(*hint || parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
 
-	(*result)->type = ZZ_AST_NODE_TYPE_UNARY_OPERATOR;
-	(*result)->u.unary_operator.unary_operator = ZZ_UNARY_OPERATOR_NEGATE;
+		/* Consume the hint and the opening parenthesis. */
+		parser->position += 2;
 
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
+		if (RT_UNLIKELY(!zz_parser_parse_count(parser, hint)))
+			goto error;
+		if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+
+		/* Consume the closing parenthesis. */
+		parser->position++;
+	}
+
+	if (RT_UNLIKELY((*vectorize & (*vectorize - 1)) || (*interleave & (*interleave - 1)))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
+	}
 
 	ret = RT_OK;
 free:
@@ -36,28 +1072,76 @@ error:
 }
 
 /**
- * Parse a number.
- * 
+ * Parse the head of a loop like <tt>for i in 0..n vectorize(8) {</tt>, its body is made of the following statements.
+ *
  * <p>
- * The possible minus must have been parsed already.
+ * The loop variable is an i32 that cannot be assigned, from the start of the range included to its end excluded.<br>
+ * The end is evaluated once, before the loop.
  * </p>
  */
-static rt_s zz_parser_parse_number(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+static rt_s zz_parser_parse_for(struct zz_parser *parser)
 {
-	struct zz_token *current_token = &lexer->current_token;
-	rt_n value;
+	struct zz_parser_loop *loop;
+	rt_un32 symbol;
+	rt_un32 start;
+	rt_un32 end;
+	rt_un32 unroll;
+	rt_un32 vectorize;
+	rt_un32 interleave;
+	rt_un32 local;
+	rt_un32 loop_index;
+	rt_un32 node;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!rt_char_convert_to_n_with_size(current_token->str, current_token->str_size, &value)))
+	/* Consume the for keyword. */
+	parser->position++;
+
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_IDENTIFIER || zz_parser_find_variable(parser, parser->symbols[parser->position]) || parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_IN)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+	symbol = parser->symbols[parser->position];
+
+	/* Consume the variable name and the in keyword. */
+	parser->position += 2;
+
+	if (RT_UNLIKELY(!zz_parser_parse_expression(parser, &start)))
 		goto error;
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_DOT_DOT)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the dots. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_parser_parse_expression(parser, &end)))
+		goto error;
+	if (RT_UNLIKELY(!zz_parser_parse_hints(parser, &unroll, &vectorize, &interleave)))
+		goto error;
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_BRACE)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
 
-	if (RT_UNLIKELY(!rt_list_new_item(ast_nodes_list, (void**)result)))
+	/* Consume the opening brace. */
+	parser->position++;
+
+	if (RT_UNLIKELY(!zz_ast_add_local(parser->ast, ZZ_VALUE_TYPE_I32, 0, &local)))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_ASSIGN, 0), local, start, &node)))
+		goto error;
+	if (RT_UNLIKELY(!zz_ast_add_loop(parser->ast, local, unroll, vectorize, interleave, &loop_index)))
 		goto error;
 
-	(*result)->type = ZZ_AST_NODE_TYPE_NUMBER;
-	(*result)->u.number.value = value;
+	if (RT_UNLIKELY(!zz_parser_reserve(parser->heap, (void**)&parser->loops, sizeof(struct zz_parser_loop), parser->loops_size, &parser->loops_capacity)))
+		goto error;
+	loop = &parser->loops[parser->loops_size++];
+	loop->variables_size = parser->variables_size;
+	if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_FOR, 0), end, loop_index, &loop->node)))
+		goto error;
 
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
+	if (RT_UNLIKELY(!zz_parser_push_variable(parser, symbol, local, RT_TRUE)))
 		goto error;
 
 	ret = RT_OK;
@@ -69,26 +1153,58 @@ error:
 	goto free;
 }
 
-static rt_s zz_parser_parse_parenthesis(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+/**
+ * Parse the statements of a function body then its result, up to the closing brace included.
+ *
+ * <p>
+ * The bodies of the loops are parsed with the <tt>loops</tt> stack rather than recursion, like the expressions.<br>
+ * They are only made of statements, their closing brace adds the end for node.
+ * </p>
+ */
+static rt_s zz_parser_parse_body(struct zz_parser *parser, rt_un32 *body)
 {
-	struct zz_token *current_token = &lexer->current_token;
+	struct zz_parser_loop *loop;
+	rt_un8 token_type;
+	rt_un32 node;
 	rt_s ret;
 
-	/* Consume the opening parenthesis. */
-	if (!zz_lexer_read_next_token(lexer))
-		return RT_FAILED;
+	while (RT_TRUE) {
+		token_type = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser);
+		if (token_type == ZZ_TOKEN_TYPE_VAR) {
+			if (RT_UNLIKELY(!zz_parser_parse_declaration(parser)))
+				goto error;
+		} else if (token_type == ZZ_TOKEN_TYPE_FOR) {
+			if (RT_UNLIKELY(!zz_parser_parse_for(parser)))
+				goto error;
+		} else if (token_type == ZZ_TOKEN_TYPE_IDENTIFIER && zz_parser_is_assignment(parser)) {
+			if (RT_UNLIKELY(!zz_parser_parse_assignment(parser)))
+				goto error;
+		} else if (token_type == ZZ_TOKEN_TYPE_CLOSE_BRACE && parser->loops_size) {
+			loop = &parser->loops[--parser->loops_size];
+			if (RT_UNLIKELY(!zz_ast_add_node(parser->ast, ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_END_FOR, 0), loop->node, 0, &node)))
+				goto error;
+			/* The variables of the loop go out of scope. */
+			parser->variables_size = loop->variables_size;
+			parser->position++;
+		} else if (RT_UNLIKELY(parser->loops_size)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		} else {
+			break;
+		}
+	}
 
-	if (RT_UNLIKELY(!zz_parser_parse_expression(lexer, ast_nodes_list, result)))
+	/* The result of the function. */
+	if (RT_UNLIKELY(!zz_parser_parse_expression(parser, body)))
 		goto error;
 
-	if (current_token->type != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS) {
-		/* TODO: Better error handling. */
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_BRACE)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
 
-	/* Consume the closing parenthesis. */
-	if (!zz_lexer_read_next_token(lexer))
-		return RT_FAILED;
+	/* Consume the closing brace. */
+	parser->position++;
 
 	ret = RT_OK;
 free:
@@ -100,33 +1216,59 @@ error:
 }
 
 /**
- * A binary operator is not a primary.
+ * Parse the variants of a function like <tt>multiversion(sse4.2, avx2)</tt>, see <tt>enum zz_cpu_level</tt>.
+ *
+ * <p>
+ * A level name like <tt>sse4.2</tt> is made of several tokens, it is read from the input up to the following comma or parenthesis.
+ * </p>
+ *
+ * @param cpu_levels Receives a bit for each level, see <tt>struct zz_ast_function</tt>.
  */
-static rt_s zz_parser_parse_primary(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+static rt_s zz_parser_parse_multiversion(struct zz_parser *parser, rt_un8 *cpu_levels)
 {
-	struct zz_token *current_token = &lexer->current_token;
-	struct zz_ast_node *ast_node;
+	rt_un first_token;
+	rt_un last_token;
+	rt_un8 token_type;
+	enum zz_cpu_level cpu_level;
 	rt_s ret;
 
-	switch (current_token->type) {
-	case ZZ_TOKEN_TYPE_MINUS:
-		/* Unary minus. */
-		if (RT_UNLIKELY(!zz_parser_parse_minus(lexer, ast_nodes_list, result)))
-			goto error;
-		if (RT_UNLIKELY(!zz_parser_parse_primary(lexer, ast_nodes_list, &ast_node)))
-			goto error;
-		(*result)->u.unary_operator.operand = ast_node;
-		break;
-	case ZZ_TOKEN_TYPE_NUMBER:
-		if (RT_UNLIKELY(!zz_parser_parse_number(lexer, ast_nodes_list, result)))
+	*cpu_levels = 0;
+
+	if (RT_UNLIKELY(parser->types[parser->position + 1] != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the multiversion keyword and the opening parenthesis. */
+	parser->position += 2;
+
+	do {
+		first_token = parser->position;
+		while (RT_TRUE) {
+			token_type = ZZ_PARSER_CURRENT_TOKEN_TYPE(parser);
+			if (token_type == ZZ_TOKEN_TYPE_COMMA || token_type == ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS || token_type == ZZ_TOKEN_TYPE_END_OF_FILE)
+				break;
+			parser->position++;
+		}
+		if (RT_UNLIKELY(parser->position == first_token)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 			goto error;
-		break;
-	case ZZ_TOKEN_TYPE_OPEN_PARENTHESIS:
-		if (RT_UNLIKELY(!zz_parser_parse_parenthesis(lexer, ast_nodes_list, result)))
+		}
+		last_token = parser->position - 1;
+
+		cpu_level = zz_cpu_level_find(&parser->input[parser->offsets[first_token]], parser->offsets[last_token] + parser->sizes[last_token] - parser->offsets[first_token]);
+		if (RT_UNLIKELY(cpu_level == ZZ_CPU_LEVELS_COUNT || (*cpu_levels & (1 << cpu_level)))) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 			goto error;
-		break;
-	default:
-		/* TODO: Better error handling. */
+		}
+		*cpu_levels |= 1 << cpu_level;
+
+		/* Consume the comma or the closing parenthesis. */
+		parser->position++;
+	} while (token_type == ZZ_TOKEN_TYPE_COMMA);
+
+	if (RT_UNLIKELY(token_type != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
 
@@ -139,119 +1281,91 @@ error:
 	goto free;
 }
 
-static rt_s zz_parser_parse_binary_operator(struct zz_lexer *lexer, rt_un parent_operator_precedence, struct zz_ast_node *left_hand_side, void **ast_nodes_list, struct zz_ast_node **result)
+static rt_s zz_parser_parse_function(struct zz_parser *parser)
 {
-	struct zz_token *current_token = &lexer->current_token;
-	enum zz_binary_operator current_operator;
-	rt_un current_operator_precedence;
-	enum zz_binary_operator next_operator;
-	rt_un next_operator_precedence;
-	struct zz_ast_node *right_hand_side;
-	struct zz_ast_node *ast_node;
+	enum zz_value_type type = ZZ_VALUE_TYPE_I32;
+	rt_un8 cpu_levels = 0;
+	rt_un32 name;
+	rt_un32 first_node;
+	rt_un32 first_local;
+	rt_un32 body;
 	rt_s ret;
 
-	while (RT_TRUE) {
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_FUNCTION)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
 
-		/* TODO: I probably want end of instruction here. */
-		if (current_token->type == ZZ_TOKEN_TYPE_END_OF_FILE ||
-		    current_token->type == ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS ||
-		    current_token->type == ZZ_TOKEN_TYPE_CLOSE_BRACE) {
-			*result = left_hand_side;
-			break;
-		}
+	/* Consume the fn keyword. */
+	parser->position++;
 
-		switch (current_token->type) {
-		case ZZ_TOKEN_TYPE_PLUS:
-			current_operator = ZZ_BINARY_OPERATOR_ADD;
-			break;
-		case ZZ_TOKEN_TYPE_MINUS:
-			current_operator = ZZ_BINARY_OPERATOR_SUBTRACT;
-			break;
-		case ZZ_TOKEN_TYPE_ASTERISK:
-			current_operator = ZZ_BINARY_OPERATOR_MULTIPLY;
-			break;
-		case ZZ_TOKEN_TYPE_SLASH:
-			current_operator = ZZ_BINARY_OPERATOR_DIVIDE;
-			break;
-		case ZZ_TOKEN_TYPE_PERCENT:
-			current_operator = ZZ_BINARY_OPERATOR_MODULO;
-			break;
-		case ZZ_TOKEN_TYPE_END_OF_FILE:
-		case ZZ_TOKEN_TYPE_IDENTIFIER:
-		case ZZ_TOKEN_TYPE_FUNCTION:
-		case ZZ_TOKEN_TYPE_NUMBER:
-		default:
-			/* TODO: Better error handling. */
-			goto error;
-		}
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_IDENTIFIER)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
 
-		/* TODO: And now I probably really want a binary operator here. */
-		current_operator_precedence = zz_parser_binary_operators_precedence[current_operator];
-		if (current_operator_precedence < parent_operator_precedence) {
-			*result = left_hand_side;
-			break;
-		}
+	name = parser->symbols[parser->position];
 
-		/* We switch from the operator to the first primary after it. */
-		if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-			goto error;
+	/* Consume the function name. */
+	parser->position++;
 
-		/* We must have a primary after a binary operator. */
-		if (RT_UNLIKELY(!zz_parser_parse_primary(lexer, ast_nodes_list, &right_hand_side)))
-			goto error;
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	/* Consume the opening parenthesis. */
+	parser->position++;
 
-		/* Now we expect either a binary operator or the end of the expression. */
-		if (current_token->type != ZZ_TOKEN_TYPE_END_OF_FILE &&
-		    current_token->type != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS &&
-		    current_token->type != ZZ_TOKEN_TYPE_CLOSE_BRACE) {
+	/* TODO: Parse arguments. */
 
-			switch (current_token->type) {
-			case ZZ_TOKEN_TYPE_PLUS:
-				next_operator = ZZ_BINARY_OPERATOR_ADD;
-				break;
-			case ZZ_TOKEN_TYPE_MINUS:
-				next_operator = ZZ_BINARY_OPERATOR_SUBTRACT;
-				break;
-			case ZZ_TOKEN_TYPE_ASTERISK:
-				next_operator = ZZ_BINARY_OPERATOR_MULTIPLY;
-				break;
-			case ZZ_TOKEN_TYPE_SLASH:
-				next_operator = ZZ_BINARY_OPERATOR_DIVIDE;
-				break;
-			case ZZ_TOKEN_TYPE_PERCENT:
-				next_operator = ZZ_BINARY_OPERATOR_MODULO;
-				break;
-			case ZZ_TOKEN_TYPE_END_OF_FILE:
-			case ZZ_TOKEN_TYPE_IDENTIFIER:
-			case ZZ_TOKEN_TYPE_FUNCTION:
-			case ZZ_TOKEN_TYPE_NUMBER:
-			case ZZ_TOKEN_TYPE_OPEN_PARENTHESIS:
-			case ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS:
-			case ZZ_TOKEN_TYPE_OPEN_BRACE:
-			case ZZ_TOKEN_TYPE_CLOSE_BRACE:
-			default:
-				/* TODO: Better error handling. */
-				goto error;
-			}
+	if (RT_UNLIKELY(ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
 
-			next_operator_precedence = zz_parser_binary_operators_precedence[next_operator];
-			if (current_operator_precedence < next_operator_precedence) {
-				if (RT_UNLIKELY(!zz_parser_parse_binary_operator(lexer, current_operator_precedence + 1, right_hand_side, ast_nodes_list, result)))
-					goto error;
-				right_hand_side = *result;
-			}
+	/* Consume the closing parenthesis. */
+	parser->position++;
+
+	/* Optional return type, i32 by default. */
+	if (ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) == ZZ_TOKEN_TYPE_COLON) {
+		parser->position++;
+		type = zz_parser_token_value_types[ZZ_PARSER_CURRENT_TOKEN_TYPE(parser)];
+		if (RT_UNLIKELY(type == ZZ_VALUE_TYPES_COUNT)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
 		}
+		parser->position++;
+	}
 
-		if (RT_UNLIKELY(!rt_list_new_item(ast_nodes_list, (void**)&ast_node)))
+	if (ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) == ZZ_TOKEN_TYPE_MULTIVERSION) {
+		if (RT_UNLIKELY(!zz_parser_parse_multiversion(parser, &cpu_levels)))
 			goto error;
+		/* The variants must return their value in the same registers, which is not the case of the AVX vectors. */
+		if (zz_value_type_get_size(type) > 16) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	}
 
-		ast_node->type = ZZ_AST_NODE_TYPE_BINARY_OPERATOR;
-		ast_node->u.binary_operator.binary_operator = current_operator;
-		ast_node->u.binary_operator.left = left_hand_side;
-		ast_node->u.binary_operator.right = right_hand_side;
-		left_hand_side = ast_node;
+	if (ZZ_PARSER_CURRENT_TOKEN_TYPE(parser) != ZZ_TOKEN_TYPE_OPEN_BRACE) {
+		/* TODO: Better error handling. */
+		goto error;
 	}
 
+	/* Consume the opening brace. */
+	parser->position++;
+
+	/* The variables of the previous function are not visible. */
+	parser->variables_size = 0;
+	first_node = (rt_un32)parser->ast->nodes_count;
+	first_local = (rt_un32)parser->ast->locals_count;
+	if (RT_UNLIKELY(!zz_parser_parse_body(parser, &body)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_ast_add_function(parser->ast, name, type, first_node, body, first_local, cpu_levels)))
+		goto error;
+
 	ret = RT_OK;
 free:
 	return ret;
@@ -261,36 +1375,49 @@ error:
 	goto free;
 }
 
-static rt_s zz_parser_parse_expression(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+/**
+ * Make a literal, possibly negated, that is the operand of a 64 bits operation a 64 bits literal, so that it is not truncated to 32 bits.
+ */
+static void zz_parser_widen_literal(struct zz_ast *ast, rt_un32 node)
+{
+	rt_un8 negate_kind = ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_UNARY_OPERATOR, ZZ_UNARY_OPERATOR_NEGATE);
+	rt_un32 operand = node;
+
+	while (ast->kinds[operand] == negate_kind)
+		operand = ast->operands[2 * operand];
+	if (ZZ_AST_NODE_KIND_GET_TYPE(ast->kinds[operand]) != ZZ_AST_NODE_TYPE_NUMBER)
+		return;
+
+	while (node != operand) {
+		ast->types[node] = ZZ_VALUE_TYPE_I64;
+		node = ast->operands[2 * node];
+	}
+	ast->types[operand] = ZZ_VALUE_TYPE_I64;
+}
+
+static rt_s zz_parser_type_binary_operator(struct zz_ast *ast, rt_un32 node)
 {
-	struct zz_token *current_token = &lexer->current_token;
-	struct zz_ast_node *left_hand_side;
+	rt_un32 left = ast->operands[2 * node];
+	rt_un32 right = ast->operands[2 * node + 1];
+	enum zz_value_type type;
 	rt_s ret;
 
-	/* Parse the left hand side. */
-	if (RT_UNLIKELY(!zz_parser_parse_primary(lexer, ast_nodes_list, &left_hand_side)))
-		goto error;
-
-	switch (current_token->type) {
-	case ZZ_TOKEN_TYPE_END_OF_FILE:
-	case ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS:
-	case ZZ_TOKEN_TYPE_CLOSE_BRACE:
-		/* It was just a primary, without binary operator and right hand side expression. */
-		*result = left_hand_side;
-		break;
-	case ZZ_TOKEN_TYPE_PLUS:
-	case ZZ_TOKEN_TYPE_MINUS:
-	case ZZ_TOKEN_TYPE_ASTERISK:
-	case ZZ_TOKEN_TYPE_SLASH:
-	case ZZ_TOKEN_TYPE_PERCENT:
-		if (RT_UNLIKELY(!zz_parser_parse_binary_operator(lexer, 0, left_hand_side, ast_nodes_list, result)))
-			goto error;
-		break;
-	default:
-		/* TODO: Handle error. */
+	/* The scalar operand is converted to the type of the other one. */
+	if (zz_value_type_is_convertible(ast->types[right], ast->types[left])) {
+		type = ast->types[left];
+	} else if (zz_value_type_is_convertible(ast->types[left], ast->types[right])) {
+		type = ast->types[right];
+	} else {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
 
+	if (zz_value_type_get_lane_type(type) == ZZ_VALUE_TYPE_I64) {
+		zz_parser_widen_literal(ast, left);
+		zz_parser_widen_literal(ast, right);
+	}
+	ast->types[node] = type;
+
 	ret = RT_OK;
 free:
 	return ret;
@@ -300,84 +1427,274 @@ error:
 	goto free;
 }
 
-static rt_s zz_parser_parse_function(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **result)
+static rt_s zz_parser_type_shuffle(struct zz_ast *ast, rt_un32 node)
 {
-	struct zz_token *current_token = &lexer->current_token;
-	struct zz_ast_node *ast_node;
+	enum zz_value_type vector_type = ast->types[ast->operands[2 * node]];
+	rt_un lanes_count = zz_value_type_get_lanes_count(vector_type);
+	rt_un32 mask = node - 1;
+	rt_n *lanes = &ast->literals[ast->operands[2 * mask]];
+	rt_un mask_lanes_count = zz_value_type_get_lanes_count(ast->types[mask]);
+	enum zz_value_type type;
+	rt_un i;
 	rt_s ret;
 
-	if (current_token->type != ZZ_TOKEN_TYPE_FUNCTION) {
-		/* TODO: Better error handling. */
+	if (RT_UNLIKELY(lanes_count == 1 || ast->types[ast->operands[2 * node + 1]] != vector_type)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
+	for (i = 0; i < mask_lanes_count; i++) {
+		if (RT_UNLIKELY(lanes[i] < 0 || (rt_un)lanes[i] >= 2 * lanes_count)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	}
 
-	/* Consume the fn keyword. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
-
-	if (current_token->type != ZZ_TOKEN_TYPE_IDENTIFIER) {
-		/* TODO: Better error handling. */
+	/* The result has the lanes of the vectors and the size of the mask. */
+	type = zz_value_type_get_vector_type(zz_value_type_get_lane_type(vector_type), mask_lanes_count);
+	if (RT_UNLIKELY(type == ZZ_VALUE_TYPES_COUNT)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
-	
-	if (RT_UNLIKELY(!rt_list_new_item(ast_nodes_list, (void**)&ast_node)))
-		goto error;
-	
-	ast_node->type = ZZ_AST_NODE_TYPE_FUNCTION;
-	ast_node->u.function.name = current_token->str;
-	ast_node->u.function.name_size = current_token->str_size;
+	ast->types[node] = type;
 
-	/* Consume the function name. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
+	ret = RT_OK;
+free:
+	return ret;
 
-	if (current_token->type != ZZ_TOKEN_TYPE_OPEN_PARENTHESIS) {
-		/* TODO: Better error handling. */
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Check that <tt>value</tt> can be stored into a variable or an array element of type <tt>type</tt>.
+ */
+static rt_s zz_parser_type_store(struct zz_ast *ast, enum zz_value_type type, rt_un32 value)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_value_type_is_convertible(ast->types[value], type))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
 		goto error;
 	}
+	if (zz_value_type_get_lane_type(type) == ZZ_VALUE_TYPE_I64)
+		zz_parser_widen_literal(ast, value);
 
-	/* Consume the opening parenthesis. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
+	ret = RT_OK;
+free:
+	return ret;
 
-	/* TODO: Parse arguments. */
+error:
+	ret = RT_FAILED;
+	goto free;
+}
 
-	if (current_token->type != ZZ_TOKEN_TYPE_CLOSE_PARENTHESIS) {
-		/* TODO: Better error handling. */
-		goto error;
+/**
+ * Whether the i32 expression <tt>node</tt> is made of literals, negations, additions, subtractions and multiplications only.<br>
+ * Its value then wraps like the generated instructions.
+ *
+ * @param depth Levels of operators that can still be folded.
+ */
+static rt_b zz_parser_get_constant(struct zz_ast *ast, rt_un32 node, rt_un depth, rt_un32 *value)
+{
+	rt_un8 kind = ast->kinds[node];
+	rt_un32 left;
+	rt_un32 right;
+
+	if (ZZ_AST_NODE_KIND_GET_TYPE(kind) == ZZ_AST_NODE_TYPE_NUMBER) {
+		*value = (rt_un32)ast->literals[ast->operands[2 * node]];
+		return RT_TRUE;
 	}
+	if (!depth)
+		return RT_FALSE;
+
+	if (kind == ZZ_AST_NODE_KIND(ZZ_AST_NODE_TYPE_UNARY_OPERATOR, ZZ_UNARY_OPERATOR_NEGATE)) {
+		if (!zz_parser_get_constant(ast, ast->operands[2 * node], depth - 1, &left))
+			return RT_FALSE;
+		*value = 0 - left;
+		return RT_TRUE;
+	}
+	if (ZZ_AST_NODE_KIND_GET_TYPE(kind) != ZZ_AST_NODE_TYPE_BINARY_OPERATOR)
+		return RT_FALSE;
+	if (!zz_parser_get_constant(ast, ast->operands[2 * node], depth - 1, &left) || !zz_parser_get_constant(ast, ast->operands[2 * node + 1], depth - 1, &right))
+		return RT_FALSE;
+
+	switch (ZZ_AST_NODE_KIND_GET_OPERATOR(kind)) {
+	case ZZ_BINARY_OPERATOR_ADD:
+		*value = left + right;
+		return RT_TRUE;
+	case ZZ_BINARY_OPERATOR_SUBTRACT:
+		*value = left - right;
+		return RT_TRUE;
+	case ZZ_BINARY_OPERATOR_MULTIPLY:
+		*value = left * right;
+		return RT_TRUE;
+	default:
+		return RT_FALSE;
+	}
+}
 
-	/* Consume the closing parenthesis. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
+/**
+ * Set the type of all the nodes, in a single pass as the operands of a node are before it.
+ *
+ * <p>
+ * It cannot be done while parsing as a function can be called before being defined.<br>
+ * The functions that are not in <tt>ast</tt> are expected to return an i32.<br>
+ * A variable gets the type of the value of its declaration, which is always before its uses.<br>
+ * A constant array index must be within the array, the access would otherwise be undefined behavior for LLVM.
+ * </p>
+ *
+ * @param function_types Type returned by each function, indexed by the symbol id of its name.
+ */
+static rt_s zz_parser_type_nodes(struct zz_ast *ast, rt_un8 *function_types)
+{
+	rt_un8 *kinds = ast->kinds;
+	rt_un8 *types = ast->types;
+	rt_un32 *operands = ast->operands;
+	struct zz_ast_function *function;
+	struct zz_ast_local *local;
+	enum zz_value_type vector_type;
+	rt_un32 index;
+	rt_un i;
+	rt_s ret;
 
-	if (current_token->type != ZZ_TOKEN_TYPE_OPEN_BRACE) {
-		/* TODO: Better error handling. */
-		goto error;
+	for (i = 0; i < ast->nodes_count; i++) {
+		switch (ZZ_AST_NODE_KIND_GET_TYPE(kinds[i])) {
+		case ZZ_AST_NODE_TYPE_NUMBER:
+			types[i] = ZZ_VALUE_TYPE_I32;
+			break;
+		case ZZ_AST_NODE_TYPE_UNARY_OPERATOR:
+			types[i] = types[operands[2 * i]];
+			break;
+		case ZZ_AST_NODE_TYPE_BINARY_OPERATOR:
+			if (RT_UNLIKELY(!zz_parser_type_binary_operator(ast, (rt_un32)i)))
+				goto error;
+			break;
+		case ZZ_AST_NODE_TYPE_CALL:
+			types[i] = function_types[operands[2 * i]];
+			break;
+		case ZZ_AST_NODE_TYPE_VECTOR:
+			types[i] = ZZ_AST_NODE_KIND_GET_OPERATOR(kinds[i]);
+			break;
+		case ZZ_AST_NODE_TYPE_EXTRACT:
+			vector_type = types[operands[2 * i]];
+			if (RT_UNLIKELY(zz_value_type_get_lanes_count(vector_type) == 1 || operands[2 * i + 1] >= zz_value_type_get_lanes_count(vector_type))) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			types[i] = zz_value_type_get_lane_type(vector_type);
+			break;
+		case ZZ_AST_NODE_TYPE_SHUFFLE:
+			if (RT_UNLIKELY(!zz_parser_type_shuffle(ast, (rt_un32)i)))
+				goto error;
+			break;
+		case ZZ_AST_NODE_TYPE_CONVERSION:
+			/* Between scalars only. */
+			if (RT_UNLIKELY(zz_value_type_get_lanes_count(types[operands[2 * i]]) != 1)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			types[i] = ZZ_AST_NODE_KIND_GET_OPERATOR(kinds[i]);
+			break;
+		case ZZ_AST_NODE_TYPE_LOCAL:
+			types[i] = ast->locals[operands[2 * i]].type;
+			break;
+		case ZZ_AST_NODE_TYPE_ADDRESS:
+			/* The type of the element. */
+			if (RT_UNLIKELY(types[operands[2 * i + 1]] != ZZ_VALUE_TYPE_I32)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			/* Negative indexes are also above the size once unsigned. */
+			if (RT_UNLIKELY(zz_parser_get_constant(ast, operands[2 * i + 1], ZZ_PARSER_MAX_CONSTANT_DEPTH, &index) && index >= ast->locals[operands[2 * i]].array_size)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			types[i] = ast->locals[operands[2 * i]].type;
+			break;
+		case ZZ_AST_NODE_TYPE_LOAD:
+			types[i] = types[operands[2 * i]];
+			break;
+		case ZZ_AST_NODE_TYPE_ASSIGN:
+			local = &ast->locals[operands[2 * i]];
+			if (local->type == ZZ_VALUE_TYPES_COUNT)
+				local->type = types[operands[2 * i + 1]];
+			else if (RT_UNLIKELY(!zz_parser_type_store(ast, local->type, operands[2 * i + 1])))
+				goto error;
+			types[i] = ZZ_VALUE_TYPE_I32;
+			break;
+		case ZZ_AST_NODE_TYPE_STORE:
+			if (RT_UNLIKELY(!zz_parser_type_store(ast, types[operands[2 * i]], operands[2 * i + 1])))
+				goto error;
+			types[i] = ZZ_VALUE_TYPE_I32;
+			break;
+		case ZZ_AST_NODE_TYPE_FOR:
+			if (RT_UNLIKELY(types[operands[2 * i]] != ZZ_VALUE_TYPE_I32)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			types[i] = ZZ_VALUE_TYPE_I32;
+			break;
+		case ZZ_AST_NODE_TYPE_END_FOR:
+			types[i] = ZZ_VALUE_TYPE_I32;
+			break;
+		}
 	}
 
-	/* Consume the opening brace. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
+	for (i = 0; i < ast->functions_count; i++) {
+		function = &ast->functions[i];
+		if (RT_UNLIKELY(!zz_value_type_is_convertible(types[function->body], function->type))) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+	}
 
-	/* Parse the body, an expression for now. */
-	/* TODO: The body won't remain as just an expression for long. */
-	if (RT_UNLIKELY(!zz_parser_parse_expression(lexer, ast_nodes_list, &ast_node->u.function.body)))
-		goto error;
+	ret = RT_OK;
+free:
+	return ret;
 
-	if (current_token->type != ZZ_TOKEN_TYPE_CLOSE_BRACE) {
-		/* TODO: Better error handling. */
-		goto error;
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Type the nodes of <tt>ast</tt>, see <tt>zz_parser_type_nodes</tt>.
+ */
+static rt_s zz_parser_type(struct zz_ast *ast)
+{
+	struct rt_heap *heap = ast->heap;
+	rt_un8 *function_types = RT_NULL;
+	rt_un symbols_count = 0;
+	rt_un i;
+	rt_s ret;
+
+	/* Only the symbols of the functions and calls are needed. */
+	for (i = 0; i < ast->functions_count; i++) {
+		if (ast->functions[i].name >= symbols_count)
+			symbols_count = ast->functions[i].name + 1;
+	}
+	for (i = 0; i < ast->nodes_count; i++) {
+		if (ZZ_AST_NODE_KIND_GET_TYPE(ast->kinds[i]) == ZZ_AST_NODE_TYPE_CALL && ast->operands[2 * i] >= symbols_count)
+			symbols_count = ast->operands[2 * i] + 1;
 	}
 
-	/* Consume the closing brace. */
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
-		goto error;
+	if (symbols_count) {
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)&function_types, symbols_count * sizeof(rt_un8))))
+			goto error;
+		/* ZZ_VALUE_TYPE_I32 for the functions of other files. */
+		RT_MEMORY_ZERO(function_types, symbols_count * sizeof(rt_un8));
+		for (i = 0; i < ast->functions_count; i++)
+			function_types[ast->functions[i].name] = ast->functions[i].type;
+	}
 
-	*result = ast_node;
+	if (RT_UNLIKELY(!zz_parser_type_nodes(ast, function_types)))
+		goto error;
 
 	ret = RT_OK;
 free:
+	if (function_types && RT_UNLIKELY(!heap->free(heap, (void**)&function_types) && ret))
+		goto error;
 	return ret;
 
 error:
@@ -385,28 +1702,50 @@ error:
 	goto free;
 }
 
-rt_s zz_parser_parse(struct zz_lexer *lexer, void **ast_nodes_list, struct zz_ast_node **root)
+rt_s zz_parser_parse(rt_char8 *input, struct zz_token_buffer *token_buffer, struct zz_ast *ast)
 {
-	struct zz_token *current_token = &lexer->current_token;
+	struct rt_heap *heap = ast->heap;
+	struct zz_parser parser;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!zz_lexer_read_next_token(lexer)))
+	parser.input = input;
+	parser.types = token_buffer->types;
+	parser.offsets = token_buffer->offsets;
+	parser.sizes = token_buffer->sizes;
+	parser.symbols = token_buffer->symbols;
+	parser.position = 0;
+	parser.ast = ast;
+	parser.heap = heap;
+	parser.operators = RT_NULL;
+	parser.operators_size = 0;
+	parser.operators_capacity = 0;
+	parser.variables = RT_NULL;
+	parser.variables_size = 0;
+	parser.variables_capacity = 0;
+	parser.loops = RT_NULL;
+	parser.loops_size = 0;
+	parser.loops_capacity = 0;
+
+	/* Each node consumes at least a token, so the nodes are never reallocated while parsing. */
+	if (RT_UNLIKELY(!zz_ast_reserve(ast, token_buffer->size)))
 		goto error;
 
-	if (current_token->type == ZZ_TOKEN_TYPE_END_OF_FILE) {
-		/* Empty file. */
-		*root = RT_NULL;
-	} else {
-		if (RT_UNLIKELY(!zz_parser_parse_function(lexer, ast_nodes_list, root)))
-			goto error;
-
-		/* TODO: We assume that there is a single expression for now. */
-		if (RT_UNLIKELY(current_token->type != ZZ_TOKEN_TYPE_END_OF_FILE))
+	while (ZZ_PARSER_CURRENT_TOKEN_TYPE(&parser) != ZZ_TOKEN_TYPE_END_OF_FILE) {
+		if (RT_UNLIKELY(!zz_parser_parse_function(&parser)))
 			goto error;
 	}
 
+	if (RT_UNLIKELY(!zz_parser_type(ast)))
+		goto error;
+
 	ret = RT_OK;
 free:
+	if (parser.operators && RT_UNLIKELY(!heap->free(heap, (void**)&parser.operators) && ret))
+		goto error;
+	if (parser.variables && RT_UNLIKELY(!heap->free(heap, (void**)&parser.variables) && ret))
+		goto error;
+	if (parser.loops && RT_UNLIKELY(!heap->free(heap, (void**)&parser.loops) && ret))
+		goto error;
 	return ret;
 
 error:
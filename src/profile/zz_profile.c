@@ -0,0 +1,329 @@
+#include "profile/zz_profile.h"
+
+#define ZZ_PROFILE_CUTOFF_SCALE 1000000
+
+static const rt_un32 zz_profile_cutoffs[ZZ_PROFILE_CUTOFFS_COUNT] = {
+	10000, 100000, 200000, 300000, 400000, 500000, 600000, 700000, 800000, 900000, 950000, 990000, 999000, 999900, 999990, 999999
+};
+
+static void *zz_profile_resize(struct rt_heap *heap, void **area, rt_un size)
+{
+	if (*area)
+		return heap->realloc(heap, area, size);
+	else
+		return heap->alloc(heap, area, size);
+}
+
+static rt_un32 zz_profile_read32(const rt_char8 *data)
+{
+	rt_un32 value;
+
+	RT_MEMORY_COPY(data, &value, sizeof(value));
+	return value;
+}
+
+static rt_un64 zz_profile_read64(const rt_char8 *data)
+{
+	rt_un64 value;
+
+	RT_MEMORY_COPY(data, &value, sizeof(value));
+	return value;
+}
+
+/**
+ * Add the counters of a record to those of its function, adding the function if it is new.
+ *
+ * @param counters Unaligned.
+ */
+static rt_s zz_profile_add_record(struct zz_profile *profile, const rt_char8 *name, rt_un name_size, const rt_char8 *counters, rt_un counters_count)
+{
+	struct rt_heap *heap = profile->heap;
+	rt_un symbols_count = profile->symbol_table.symbols_count;
+	struct zz_profile_function *function;
+	rt_un64 count;
+	rt_un32 symbol;
+	rt_un capacity;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_symbol_table_intern(&profile->symbol_table, name, name_size, &symbol)))
+		goto error;
+
+	if (symbols_count == profile->symbol_table.symbols_count) {
+		function = &profile->functions[symbol];
+		if (function->counters_count != counters_count)
+			goto end;
+		for (i = 0; i < counters_count; i++) {
+			count = profile->counters[function->first_counter + i] + zz_profile_read64(&counters[i * 8]);
+			/* Saturate rather than wrap. */
+			if (count >= profile->counters[function->first_counter + i])
+				profile->counters[function->first_counter + i] = count;
+			else
+				profile->counters[function->first_counter + i] = RT_TYPE_MAX_UN64;
+		}
+		goto end;
+	}
+
+	if (symbol >= profile->functions_capacity) {
+		capacity = profile->functions_capacity ? profile->functions_capacity * 2 : 256;
+		if (RT_UNLIKELY(!zz_profile_resize(heap, (void**)&profile->functions, capacity * sizeof(struct zz_profile_function))))
+			goto error;
+		profile->functions_capacity = capacity;
+	}
+
+	if (profile->counters_count + counters_count > profile->counters_capacity) {
+		capacity = profile->counters_capacity ? profile->counters_capacity * 2 : 1024;
+		while (capacity < profile->counters_count + counters_count)
+			capacity *= 2;
+		if (RT_UNLIKELY(!zz_profile_resize(heap, (void**)&profile->counters, capacity * sizeof(rt_un64))))
+			goto error;
+		profile->counters_capacity = capacity;
+	}
+
+	function = &profile->functions[symbol];
+	function->first_counter = profile->counters_count;
+	function->counters_count = counters_count;
+	for (i = 0; i < counters_count; i++)
+		profile->counters[profile->counters_count + i] = zz_profile_read64(&counters[i * 8]);
+	profile->counters_count += counters_count;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_profile_parse(struct zz_profile *profile, const rt_char8 *data, rt_un data_size)
+{
+	rt_un position = 0;
+	const rt_char8 *name;
+	rt_un name_size;
+	rt_un counters_count;
+	rt_s ret;
+
+	while (position < data_size) {
+		if (RT_UNLIKELY(data_size - position < 4)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		name_size = zz_profile_read32(&data[position]);
+		position += 4;
+
+		if (RT_UNLIKELY(data_size - position < name_size + 4)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		name = &data[position];
+		position += name_size;
+		counters_count = zz_profile_read32(&data[position]);
+		position += 4;
+
+		/* The entry counter then two counters per branch. */
+		if (RT_UNLIKELY(!(counters_count & 1) || (data_size - position) / 8 < counters_count)) {
+			rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+			goto error;
+		}
+		if (RT_UNLIKELY(!zz_profile_add_record(profile, name, name_size, &data[position], counters_count)))
+			goto error;
+		position += counters_count * 8;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static void zz_profile_sift_down(rt_un64 *counts, rt_un root, rt_un counts_count)
+{
+	rt_un64 count;
+	rt_un child;
+
+	while ((child = root * 2 + 1) < counts_count) {
+		if (child + 1 < counts_count && counts[child + 1] < counts[child])
+			child++;
+		if (counts[root] <= counts[child])
+			break;
+		count = counts[root];
+		counts[root] = counts[child];
+		counts[child] = count;
+		root = child;
+	}
+}
+
+/**
+ * Heap sort in decreasing order, which does not need more memory.
+ */
+static void zz_profile_sort(rt_un64 *counts, rt_un counts_count)
+{
+	rt_un64 count;
+	rt_un i;
+
+	for (i = counts_count / 2; i > 0; i--)
+		zz_profile_sift_down(counts, i - 1, counts_count);
+	for (i = counts_count; i > 1; i--) {
+		count = counts[0];
+		counts[0] = counts[i - 1];
+		counts[i - 1] = count;
+		zz_profile_sift_down(counts, 0, i - 1);
+	}
+}
+
+/**
+ * Compute the summary like the <tt>ProfileSummaryBuilder</tt> of LLVM.<br>
+ * A branch has as many counts as counters: its two edges.
+ */
+static rt_s zz_profile_summarize(struct zz_profile *profile)
+{
+	struct rt_heap *heap = profile->heap;
+	struct zz_profile_function *function;
+	rt_un64 *counts = RT_NULL;
+	rt_un64 *counters;
+	rt_un64 desired_count;
+	rt_un64 taken;
+	rt_un64 sum = 0;
+	rt_un64 min_count = 0;
+	rt_un counts_count = 0;
+	rt_un i;
+	rt_un j;
+	rt_s ret;
+
+	if (!profile->counters_count)
+		goto end;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&counts, profile->counters_count * sizeof(rt_un64))))
+		goto error;
+
+	for (i = 0; i < profile->symbol_table.symbols_count; i++) {
+		function = &profile->functions[i];
+		counters = &profile->counters[function->first_counter];
+		counts[counts_count++] = counters[0];
+		if (counters[0] > profile->max_function_count)
+			profile->max_function_count = counters[0];
+		for (j = 1; j < function->counters_count; j += 2) {
+			taken = counters[j + 1] < counters[j] ? counters[j + 1] : counters[j];
+			counts[counts_count++] = taken;
+			counts[counts_count++] = counters[j] - taken;
+			if (counters[j] > profile->max_internal_count)
+				profile->max_internal_count = counters[j];
+		}
+	}
+
+	for (i = 0; i < counts_count; i++) {
+		profile->total_count += counts[i];
+		if (counts[i] > profile->max_count)
+			profile->max_count = counts[i];
+	}
+	profile->counts_count = counts_count;
+
+	zz_profile_sort(counts, counts_count);
+
+	/* Equal counts are taken together. */
+	j = 0;
+	for (i = 0; i < ZZ_PROFILE_CUTOFFS_COUNT; i++) {
+		desired_count = profile->total_count / ZZ_PROFILE_CUTOFF_SCALE * zz_profile_cutoffs[i] +
+				profile->total_count % ZZ_PROFILE_CUTOFF_SCALE * zz_profile_cutoffs[i] / ZZ_PROFILE_CUTOFF_SCALE;
+		while (sum < desired_count && j < counts_count) {
+			min_count = counts[j];
+			while (j < counts_count && counts[j] == min_count) {
+				sum += min_count;
+				j++;
+			}
+		}
+		profile->cutoffs[i].cutoff = zz_profile_cutoffs[i];
+		profile->cutoffs[i].min_count = min_count;
+		profile->cutoffs[i].counts_count = j;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	if (counts && RT_UNLIKELY(!heap->free(heap, (void**)&counts) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_profile_read(struct zz_profile *profile, const rt_char *file_path, struct rt_heap *heap)
+{
+	void *data_heap_buffer = RT_NULL;
+	rt_un data_heap_buffer_capacity = 0;
+	rt_char8 *data;
+	rt_un data_size;
+	rt_un i;
+	rt_s ret;
+
+	zz_symbol_table_create(&profile->symbol_table, heap);
+	profile->functions = RT_NULL;
+	profile->functions_capacity = 0;
+	profile->counters = RT_NULL;
+	profile->counters_count = 0;
+	profile->counters_capacity = 0;
+	profile->total_count = 0;
+	profile->max_count = 0;
+	profile->max_internal_count = 0;
+	profile->max_function_count = 0;
+	profile->counts_count = 0;
+	for (i = 0; i < ZZ_PROFILE_CUTOFFS_COUNT; i++) {
+		profile->cutoffs[i].cutoff = zz_profile_cutoffs[i];
+		profile->cutoffs[i].min_count = 0;
+		profile->cutoffs[i].counts_count = 0;
+	}
+	profile->heap = heap;
+
+	if (RT_UNLIKELY(!rt_small_file_read(file_path, RT_NULL, 0, &data_heap_buffer, &data_heap_buffer_capacity, &data, &data_size, heap)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_profile_parse(profile, data, data_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_profile_summarize(profile)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (data_heap_buffer && RT_UNLIKELY(!heap->free(heap, &data_heap_buffer) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+struct zz_profile_function *zz_profile_find(struct zz_profile *profile, const rt_char8 *name, rt_un name_size)
+{
+	rt_un32 symbol;
+
+	if (!zz_symbol_table_find(&profile->symbol_table, name, name_size, &symbol))
+		return RT_NULL;
+	return &profile->functions[symbol];
+}
+
+rt_s zz_profile_free(struct zz_profile *profile)
+{
+	struct rt_heap *heap = profile->heap;
+	rt_s ret = RT_OK;
+
+	if (profile->counters && RT_UNLIKELY(!heap->free(heap, (void**)&profile->counters)))
+		ret = RT_FAILED;
+	if (profile->functions && RT_UNLIKELY(!heap->free(heap, (void**)&profile->functions)))
+		ret = RT_FAILED;
+	if (RT_UNLIKELY(!zz_symbol_table_free(&profile->symbol_table)))
+		ret = RT_FAILED;
+	profile->functions_capacity = 0;
+	profile->counters_count = 0;
+	profile->counters_capacity = 0;
+
+	return ret;
+}
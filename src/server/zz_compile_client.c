@@ -0,0 +1,209 @@
+#include "server/zz_compile_client.h"
+
+#include "server/zz_compile_protocol.h"
+#include "server/zz_local_socket.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static rt_s zz_compile_client_get_current_directory(rt_char *buffer, rt_un buffer_capacity)
+{
+#ifdef RT_DEFINE_WINDOWS
+	DWORD size;
+	rt_s ret;
+
+	size = GetCurrentDirectoryW((DWORD)buffer_capacity, buffer);
+	if (RT_UNLIKELY(!size))
+		goto error;
+	if (RT_UNLIKELY(size >= buffer_capacity)) {
+		rt_error_set_last(RT_ERROR_INSUFFICIENT_BUFFER);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+#else
+	return getcwd(buffer, buffer_capacity) != RT_NULL;
+#endif
+}
+
+/**
+ * The <tt>--client</tt> argument is not forwarded.
+ */
+static rt_b zz_compile_client_is_forwarded(const rt_char *arg)
+{
+	rt_un arg_size = rt_char_get_size(arg);
+
+	return !(arg_size > 9 && rt_char_equals(arg, 9, _R("--client="), 9));
+}
+
+/**
+ * Send the current directory then the arguments.
+ */
+static rt_s zz_compile_client_send_request(struct zz_local_socket *connection, rt_un argc, const rt_char *argv[], struct rt_heap *heap)
+{
+	rt_char current_directory[RT_FILE_PATH_SIZE];
+	struct zz_compile_request_header header;
+	rt_char *strings = RT_NULL;
+	rt_un strings_size;
+	rt_un strings_count;
+	rt_un arg_size;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_compile_client_get_current_directory(current_directory, RT_FILE_PATH_SIZE)))
+		goto error;
+
+	strings_size = rt_char_get_size(current_directory) + 1;
+	strings_count = 1;
+	for (i = 0; i < argc; i++) {
+		if (zz_compile_client_is_forwarded(argv[i])) {
+			strings_size += rt_char_get_size(argv[i]) + 1;
+			strings_count++;
+		}
+	}
+
+	if (RT_UNLIKELY(strings_size * sizeof(rt_char) > ZZ_COMPILE_PROTOCOL_MAX_REQUEST_SIZE)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&strings, strings_size * sizeof(rt_char))))
+		goto error;
+
+	strings_size = 0;
+	arg_size = rt_char_get_size(current_directory) + 1;
+	RT_MEMORY_COPY(current_directory, strings, arg_size * sizeof(rt_char));
+	strings_size += arg_size;
+	for (i = 0; i < argc; i++) {
+		if (zz_compile_client_is_forwarded(argv[i])) {
+			arg_size = rt_char_get_size(argv[i]) + 1;
+			RT_MEMORY_COPY(argv[i], &strings[strings_size], arg_size * sizeof(rt_char));
+			strings_size += arg_size;
+		}
+	}
+
+	header.magic = ZZ_COMPILE_PROTOCOL_MAGIC;
+	header.size = (rt_un32)(strings_size * sizeof(rt_char));
+	header.strings_count = (rt_un32)strings_count;
+
+	if (RT_UNLIKELY(!zz_local_socket_send(connection, &header, sizeof(header))))
+		goto error;
+	if (RT_UNLIKELY(!zz_local_socket_send(connection, strings, header.size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (strings && RT_UNLIKELY(!heap->free(heap, (void**)&strings) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Write the messages of the server as they come, until it is done.
+ */
+static rt_s zz_compile_client_receive_responses(struct zz_local_socket *connection, rt_b *failed, struct rt_heap *heap)
+{
+	struct zz_compile_response_header header;
+	rt_char *messages = RT_NULL;
+	rt_un messages_capacity = 0;
+	rt_s ret;
+
+	*failed = RT_FALSE;
+
+	while (RT_TRUE) {
+		if (RT_UNLIKELY(!zz_local_socket_receive(connection, &header, sizeof(header))))
+			goto error;
+		if (header.status == ZZ_COMPILE_RESPONSE_STATUS_DONE)
+			break;
+		if (header.status != ZZ_COMPILE_RESPONSE_STATUS_SUCCEEDED)
+			*failed = RT_TRUE;
+
+		if (header.size) {
+			if (RT_UNLIKELY(header.size % sizeof(rt_char) || header.size > ZZ_COMPILE_PROTOCOL_MAX_REQUEST_SIZE)) {
+				rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+				goto error;
+			}
+			if (header.size > messages_capacity) {
+				if (messages) {
+					if (RT_UNLIKELY(!heap->realloc(heap, (void**)&messages, header.size)))
+						goto error;
+				} else {
+					if (RT_UNLIKELY(!heap->alloc(heap, (void**)&messages, header.size)))
+						goto error;
+				}
+				messages_capacity = header.size;
+			}
+			if (RT_UNLIKELY(!zz_local_socket_receive(connection, messages, header.size)))
+				goto error;
+			if (RT_UNLIKELY(!rt_console_write_error_with_size(messages, header.size / sizeof(rt_char))))
+				goto error;
+		}
+	}
+
+	ret = RT_OK;
+free:
+	if (messages && RT_UNLIKELY(!heap->free(heap, (void**)&messages) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_compile_client_compile(const rt_char *socket_path, rt_un argc, const rt_char *argv[], rt_b *forwarded, struct rt_heap *heap)
+{
+	struct zz_local_socket connection;
+	rt_b connected = RT_FALSE;
+	rt_b failed;
+	rt_s ret;
+
+	*forwarded = RT_FALSE;
+
+	if (RT_UNLIKELY(!zz_local_socket_connect(&connection, socket_path, &connected))) {
+		rt_error_message_write_last(_R("Connection failed: "));
+		goto error;
+	}
+	if (!connected)
+		goto end;
+	*forwarded = RT_TRUE;
+
+	if (RT_UNLIKELY(!zz_compile_client_send_request(&connection, argc, argv, heap) ||
+			!zz_compile_client_receive_responses(&connection, &failed, heap))) {
+		rt_error_message_write_last(_R("Server request failed: "));
+		goto error;
+	}
+
+	/* The messages have already been written. */
+	if (failed) {
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+
+end:
+	ret = RT_OK;
+free:
+	if (connected) {
+		connected = RT_FALSE;
+		if (RT_UNLIKELY(!zz_local_socket_close(&connection, RT_NULL) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
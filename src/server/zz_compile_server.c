@@ -0,0 +1,404 @@
+#include "server/zz_compile_server.h"
+
+#include "cache/zz_object_cache.h"
+#include "code_generator/zz_code_generator_session.h"
+#include "compiler/zz_compiler.h"
+#include "diagnostics/zz_diagnostics.h"
+#include "memory/zz_arena.h"
+#include "options/zz_options.h"
+#include "server/zz_compile_protocol.h"
+#include "server/zz_local_socket.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/* Most sources fit in a single block. */
+#define ZZ_COMPILE_SERVER_ARENA_BLOCK_SIZE (1024 * 1024)
+
+struct zz_compile_server {
+	struct zz_local_socket listening_socket;
+	/* One per optimization level and target options, created on demand. */
+	struct zz_code_generator_session *sessions;
+	rt_un sessions_count;
+	rt_un sessions_capacity;
+	/* For the compilations, reset after each file. */
+	struct zz_arena arena;
+	struct rt_heap *heap;
+};
+
+static rt_s zz_compile_server_set_current_directory(const rt_char *directory_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return SetCurrentDirectoryW(directory_path);
+#else
+	return !chdir(directory_path);
+#endif
+}
+
+static rt_s zz_compile_server_send_response(struct zz_local_socket *connection, enum zz_compile_response_status status, struct zz_diagnostics *diagnostics)
+{
+	struct zz_compile_response_header header;
+	rt_s ret;
+
+	header.status = status;
+	header.size = diagnostics ? (rt_un32)(diagnostics->size * sizeof(rt_char)) : 0;
+
+	if (RT_UNLIKELY(!zz_local_socket_send(connection, &header, sizeof(header))))
+		goto error;
+	if (header.size && RT_UNLIKELY(!zz_local_socket_send(connection, diagnostics->buffer, header.size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Send a failed response with the last error.
+ */
+static rt_s zz_compile_server_send_last_error(struct zz_compile_server *server, struct zz_local_socket *connection, const rt_char *message)
+{
+	struct zz_diagnostics diagnostics;
+	rt_s ret;
+
+	zz_diagnostics_create(&diagnostics, RT_NULL, server->heap);
+
+	if (RT_UNLIKELY(!zz_diagnostics_add_last_error(&diagnostics, message)))
+		goto error;
+	if (RT_UNLIKELY(!zz_compile_server_send_response(connection, ZZ_COMPILE_RESPONSE_STATUS_FAILED, &diagnostics)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Make room for one more session.
+ */
+static rt_s zz_compile_server_grow_sessions(struct zz_compile_server *server)
+{
+	struct rt_heap *heap = server->heap;
+	rt_un capacity;
+	rt_s ret;
+
+	if (server->sessions_count < server->sessions_capacity)
+		goto end;
+
+	capacity = server->sessions_capacity ? server->sessions_capacity * 2 : 4;
+	if (server->sessions) {
+		if (RT_UNLIKELY(!heap->realloc(heap, (void**)&server->sessions, capacity * sizeof(struct zz_code_generator_session))))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!heap->alloc(heap, (void**)&server->sessions, capacity * sizeof(struct zz_code_generator_session))))
+			goto error;
+	}
+	server->sessions_capacity = capacity;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Sessions are created on demand so that a server only used with one configuration creates a single target machine.<br>
+ * The sessions are looked up linearly, there are few distinct configurations.
+ */
+static rt_s zz_compile_server_get_session(struct zz_compile_server *server, struct zz_local_socket *connection, struct zz_options *options, struct zz_code_generator_session **session)
+{
+	struct zz_diagnostics diagnostics;
+	rt_b matches;
+	rt_un i;
+	rt_s ret;
+
+	zz_diagnostics_create(&diagnostics, RT_NULL, server->heap);
+
+	for (i = 0; i < server->sessions_count; i++) {
+		if (RT_UNLIKELY(!zz_code_generator_session_matches(&server->sessions[i], options, &matches))) {
+			zz_compile_server_send_last_error(server, connection, _R("LLVM initialization failed: "));
+			goto error;
+		}
+		if (matches) {
+			*session = &server->sessions[i];
+			goto end;
+		}
+	}
+
+	if (RT_UNLIKELY(!zz_compile_server_grow_sessions(server))) {
+		zz_compile_server_send_last_error(server, connection, _R("LLVM initialization failed: "));
+		goto error;
+	}
+	if (RT_UNLIKELY(!zz_code_generator_session_create(&server->sessions[server->sessions_count], options, &diagnostics))) {
+		zz_diagnostics_add_last_error(&diagnostics, _R("LLVM initialization failed: "));
+		zz_compile_server_send_response(connection, ZZ_COMPILE_RESPONSE_STATUS_FAILED, &diagnostics);
+		goto error;
+	}
+	*session = &server->sessions[server->sessions_count++];
+
+end:
+	ret = RT_OK;
+free:
+	if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Compile the input files of <tt>options</tt>, sending a response for each.
+ */
+static rt_s zz_compile_server_compile(struct zz_compile_server *server, struct zz_local_socket *connection, struct zz_options *options)
+{
+	struct zz_code_generator_session *session;
+	struct zz_object_cache object_cache;
+	struct zz_object_cache *object_cache_pointer = RT_NULL;
+	struct zz_diagnostics diagnostics;
+	enum zz_compile_response_status status;
+	rt_un evicted_count;
+	rt_un i;
+	rt_s ret;
+
+	/* The server has no console for the traces and the artifacts, does not collect statistics, does not run nor link programs, and leaves the profiles to the clients. */
+	if (RT_UNLIKELY(options->help || options->stats || options->trace || options->time_trace_file_path || options->run || options->lto_link || options->standard_output ||
+			 options->profile_generate_file_path || options->profile_use_file_path)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		zz_compile_server_send_last_error(server, connection, _R("Invalid arguments: "));
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_compile_server_get_session(server, connection, options, &session)))
+		goto error;
+
+	if (options->cache_directory_path && options->emit == ZZ_EMIT_OBJ && options->codegen_units == 1) {
+		if (RT_UNLIKELY(!zz_object_cache_create(&object_cache, options, session, RT_NULL))) {
+			zz_compile_server_send_last_error(server, connection, _R("Object cache initialization failed: "));
+			goto error;
+		}
+		object_cache_pointer = &object_cache;
+	}
+
+	for (i = 0; i < options->input_files_count; i++) {
+		zz_diagnostics_create(&diagnostics, options->input_file_paths[i], server->heap);
+
+		if (zz_compiler_compile(session, object_cache_pointer, RT_NULL, options->input_file_paths[i], options, &diagnostics, RT_NULL, RT_NULL, &server->arena.heap))
+			status = ZZ_COMPILE_RESPONSE_STATUS_SUCCEEDED;
+		else
+			status = ZZ_COMPILE_RESPONSE_STATUS_FAILED;
+
+		if (RT_UNLIKELY(!zz_arena_reset(&server->arena))) {
+			zz_diagnostics_free(&diagnostics);
+			goto error;
+		}
+
+		if (RT_UNLIKELY(!zz_compile_server_send_response(connection, status, &diagnostics))) {
+			zz_diagnostics_free(&diagnostics);
+			goto error;
+		}
+		if (RT_UNLIKELY(!zz_diagnostics_free(&diagnostics)))
+			goto error;
+	}
+
+	if (object_cache_pointer && RT_UNLIKELY(!zz_object_cache_evict(object_cache_pointer, &evicted_count, server->heap)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Split the received strings, go to the directory of the client, then compile with its arguments.
+ */
+static rt_s zz_compile_server_process_strings(struct zz_compile_server *server, struct zz_local_socket *connection, rt_char *strings, rt_un strings_size, rt_un strings_count)
+{
+	struct rt_heap *heap = server->heap;
+	const rt_char **items = RT_NULL;
+	struct zz_options options;
+	rt_b options_parsed = RT_FALSE;
+	rt_un items_count = 0;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(strings_count < 2 || !strings_size || strings[strings_size - 1])) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&items, strings_count * sizeof(rt_char*))))
+		goto error;
+	items[items_count++] = strings;
+	for (i = 0; i < strings_size - 1 && items_count < strings_count; i++) {
+		if (!strings[i])
+			items[items_count++] = &strings[i + 1];
+	}
+	if (RT_UNLIKELY(items_count != strings_count)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_compile_server_set_current_directory(items[0]))) {
+		zz_compile_server_send_last_error(server, connection, _R("Invalid directory: "));
+		goto error;
+	}
+
+	/* The arguments start with the executable path, like argv. */
+	options_parsed = RT_TRUE;
+	if (RT_UNLIKELY(!zz_options_parse(strings_count - 1, &items[1], heap, &options) || options.server_socket_path || options.client_socket_path)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		zz_compile_server_send_last_error(server, connection, _R("Invalid arguments: "));
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_compile_server_compile(server, connection, &options)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (options_parsed) {
+		options_parsed = RT_FALSE;
+		if (RT_UNLIKELY(!zz_options_free(&options) && ret))
+			goto error;
+	}
+	if (items && RT_UNLIKELY(!heap->free(heap, (void**)&items) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_compile_server_process_request(struct zz_compile_server *server, struct zz_local_socket *connection)
+{
+	struct rt_heap *heap = server->heap;
+	struct zz_compile_request_header header;
+	rt_char *strings = RT_NULL;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_local_socket_receive(connection, &header, sizeof(header))))
+		goto error;
+
+	if (RT_UNLIKELY(header.magic != ZZ_COMPILE_PROTOCOL_MAGIC || header.size > ZZ_COMPILE_PROTOCOL_MAX_REQUEST_SIZE || header.size % sizeof(rt_char))) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&strings, header.size + sizeof(rt_char))))
+		goto error;
+	if (RT_UNLIKELY(!zz_local_socket_receive(connection, strings, header.size)))
+		goto error;
+
+	/* Failures have been sent to the client. */
+	zz_compile_server_process_strings(server, connection, strings, header.size / sizeof(rt_char), header.strings_count);
+
+	if (RT_UNLIKELY(!zz_compile_server_send_response(connection, ZZ_COMPILE_RESPONSE_STATUS_DONE, RT_NULL)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (strings && RT_UNLIKELY(!heap->free(heap, (void**)&strings) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_compile_server_serve(struct zz_compile_server *server)
+{
+	struct zz_local_socket connection;
+	rt_s ret;
+
+	while (RT_TRUE) {
+		if (RT_UNLIKELY(!zz_local_socket_accept(&server->listening_socket, &connection)))
+			goto error;
+
+		/* A bad client must not stop the server. */
+		if (!zz_compile_server_process_request(server, &connection))
+			rt_error_message_write_last(_R("Request failed: "));
+
+		if (RT_UNLIKELY(!zz_local_socket_close(&connection, RT_NULL)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_compile_server_run(const rt_char *socket_path, struct rt_heap *heap)
+{
+	struct zz_compile_server server;
+	rt_b listening = RT_FALSE;
+	rt_un i;
+	rt_s ret;
+
+	server.sessions = RT_NULL;
+	server.sessions_count = 0;
+	server.sessions_capacity = 0;
+	zz_arena_create(&server.arena, heap, ZZ_COMPILE_SERVER_ARENA_BLOCK_SIZE);
+	server.heap = heap;
+
+	if (RT_UNLIKELY(!zz_local_socket_listen(&server.listening_socket, socket_path))) {
+		rt_error_message_write_last(_R("Server failed: "));
+		goto error;
+	}
+	listening = RT_TRUE;
+
+	if (RT_UNLIKELY(!zz_compile_server_serve(&server))) {
+		rt_error_message_write_last(_R("Server failed: "));
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	if (listening) {
+		listening = RT_FALSE;
+		if (RT_UNLIKELY(!zz_local_socket_close(&server.listening_socket, socket_path) && ret))
+			goto error;
+	}
+	for (i = 0; i < server.sessions_count; i++) {
+		if (RT_UNLIKELY(!zz_code_generator_session_free(&server.sessions[i]) && ret))
+			goto error;
+	}
+	server.sessions_count = 0;
+	if (server.sessions && RT_UNLIKELY(!heap->free(heap, (void**)&server.sessions) && ret))
+		goto error;
+	if (RT_UNLIKELY(!zz_arena_free(&server.arena) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
@@ -0,0 +1,372 @@
+#include "server/zz_local_socket.h"
+
+#ifdef RT_DEFINE_WINDOWS
+/* Winsock must come before windows.h. */
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef RT_DEFINE_WINDOWS
+
+#define ZZ_LOCAL_SOCKET_INVALID_HANDLE INVALID_SOCKET
+#define ZZ_LOCAL_SOCKET_FAILED SOCKET_ERROR
+#define ZZ_LOCAL_SOCKET_CLOSE closesocket
+#define ZZ_LOCAL_SOCKET_SEND_FLAGS 0
+/* Winsock sizes are ints. */
+#define ZZ_LOCAL_SOCKET_CHUNK_SIZE 0x40000000
+
+#define ZZ_LOCAL_SOCKET_IS_NOT_LISTENING() (WSAGetLastError() == WSAECONNREFUSED)
+#define ZZ_LOCAL_SOCKET_SET_ADDRESS_IN_USE() WSASetLastError(WSAEADDRINUSE)
+#define ZZ_LOCAL_SOCKET_SET_CONNECTION_RESET() WSASetLastError(WSAECONNRESET)
+
+typedef SOCKET zz_local_socket_handle_t;
+
+#else
+
+#define ZZ_LOCAL_SOCKET_INVALID_HANDLE -1
+#define ZZ_LOCAL_SOCKET_FAILED -1
+#define ZZ_LOCAL_SOCKET_CLOSE close
+/* A client that goes away must not kill the server with SIGPIPE. */
+#ifdef MSG_NOSIGNAL
+#define ZZ_LOCAL_SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define ZZ_LOCAL_SOCKET_SEND_FLAGS 0
+#endif
+#define ZZ_LOCAL_SOCKET_CHUNK_SIZE 0x40000000
+
+#define ZZ_LOCAL_SOCKET_IS_NOT_LISTENING() (errno == ENOENT || errno == ECONNREFUSED)
+#define ZZ_LOCAL_SOCKET_SET_ADDRESS_IN_USE() (errno = EADDRINUSE)
+#define ZZ_LOCAL_SOCKET_SET_CONNECTION_RESET() (errno = ECONNRESET)
+
+typedef int zz_local_socket_handle_t;
+
+#endif
+
+/**
+ * Winsock must be initialized once per socket, the calls are counted.
+ */
+static rt_s zz_local_socket_startup(void)
+{
+#ifdef RT_DEFINE_WINDOWS
+	WSADATA wsa_data;
+	int error;
+	rt_s ret;
+
+	error = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+	if (RT_UNLIKELY(error)) {
+		SetLastError(error);
+		goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+#else
+	return RT_OK;
+#endif
+}
+
+static rt_s zz_local_socket_cleanup(void)
+{
+#ifdef RT_DEFINE_WINDOWS
+	return !WSACleanup();
+#else
+	return RT_OK;
+#endif
+}
+
+static rt_s zz_local_socket_create_address(const rt_char *socket_path, struct sockaddr_un *address)
+{
+	rt_char8 *output;
+	rt_un output_size;
+	rt_s ret;
+
+	RT_MEMORY_ZERO(address, sizeof(struct sockaddr_un));
+	address->sun_family = AF_UNIX;
+
+	/* Keep room for the terminating zero. */
+	if (RT_UNLIKELY(!rt_encoding_encode(socket_path, rt_char_get_size(socket_path), RT_ENCODING_UTF_8, address->sun_path, sizeof(address->sun_path) - 1, RT_NULL, RT_NULL, &output, &output_size, RT_NULL)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Create a socket, with Winsock initialized on success.
+ */
+static rt_s zz_local_socket_create(struct zz_local_socket *local_socket)
+{
+	zz_local_socket_handle_t handle;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_local_socket_startup()))
+		goto error;
+
+	handle = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (RT_UNLIKELY(handle == ZZ_LOCAL_SOCKET_INVALID_HANDLE)) {
+		zz_local_socket_cleanup();
+		goto error;
+	}
+	local_socket->handle = (rt_un)handle;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Remove <tt>socket_path</tt> if it is a socket, whose process has been verified not to be listening anymore.
+ */
+static rt_s zz_local_socket_remove_stale(const rt_char *socket_path)
+{
+#ifdef RT_DEFINE_WINDOWS
+	DWORD attributes;
+#else
+	struct stat file_status;
+#endif
+	rt_s ret;
+
+#ifdef RT_DEFINE_WINDOWS
+	/* Windows sockets files are reparse points. */
+	attributes = GetFileAttributesW(socket_path);
+	if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+		if (RT_UNLIKELY(!DeleteFileW(socket_path)))
+			goto error;
+	}
+#else
+	if (!lstat(socket_path, &file_status) && S_ISSOCK(file_status.st_mode)) {
+		if (RT_UNLIKELY(unlink(socket_path)))
+			goto error;
+	}
+#endif
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_listen(struct zz_local_socket *local_socket, const rt_char *socket_path)
+{
+	struct zz_local_socket probe_socket;
+	struct sockaddr_un address;
+	rt_b created = RT_FALSE;
+	rt_b connected;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_local_socket_create_address(socket_path, &address)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_local_socket_connect(&probe_socket, socket_path, &connected)))
+		goto error;
+	if (connected) {
+		if (RT_UNLIKELY(!zz_local_socket_close(&probe_socket, RT_NULL)))
+			goto error;
+		ZZ_LOCAL_SOCKET_SET_ADDRESS_IN_USE();
+		goto error;
+	}
+
+	if (RT_UNLIKELY(!zz_local_socket_remove_stale(socket_path)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_local_socket_create(local_socket)))
+		goto error;
+	created = RT_TRUE;
+
+	if (RT_UNLIKELY(bind((zz_local_socket_handle_t)local_socket->handle, (struct sockaddr*)&address, sizeof(address)) == ZZ_LOCAL_SOCKET_FAILED))
+		goto error;
+
+	if (RT_UNLIKELY(listen((zz_local_socket_handle_t)local_socket->handle, SOMAXCONN) == ZZ_LOCAL_SOCKET_FAILED))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	if (created) {
+		created = RT_FALSE;
+		zz_local_socket_close(local_socket, RT_NULL);
+	}
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_accept(struct zz_local_socket *listening_socket, struct zz_local_socket *local_socket)
+{
+	zz_local_socket_handle_t handle;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!zz_local_socket_startup()))
+		goto error;
+
+	while (RT_TRUE) {
+		handle = accept((zz_local_socket_handle_t)listening_socket->handle, RT_NULL, RT_NULL);
+		if (handle != ZZ_LOCAL_SOCKET_INVALID_HANDLE)
+			break;
+#ifndef RT_DEFINE_WINDOWS
+		if (errno == EINTR)
+			continue;
+#endif
+		zz_local_socket_cleanup();
+		goto error;
+	}
+	local_socket->handle = (rt_un)handle;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_connect(struct zz_local_socket *local_socket, const rt_char *socket_path, rt_b *connected)
+{
+	struct sockaddr_un address;
+	rt_b created = RT_FALSE;
+	rt_s ret;
+
+	*connected = RT_FALSE;
+
+	if (RT_UNLIKELY(!zz_local_socket_create_address(socket_path, &address)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_local_socket_create(local_socket)))
+		goto error;
+	created = RT_TRUE;
+
+	if (connect((zz_local_socket_handle_t)local_socket->handle, (struct sockaddr*)&address, sizeof(address)) == ZZ_LOCAL_SOCKET_FAILED) {
+		if (RT_UNLIKELY(!ZZ_LOCAL_SOCKET_IS_NOT_LISTENING()))
+			goto error;
+		created = RT_FALSE;
+		if (RT_UNLIKELY(!zz_local_socket_close(local_socket, RT_NULL)))
+			goto error;
+		goto end;
+	}
+	*connected = RT_TRUE;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	if (created) {
+		created = RT_FALSE;
+		zz_local_socket_close(local_socket, RT_NULL);
+	}
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_send(struct zz_local_socket *local_socket, const void *data, rt_un size)
+{
+	const rt_char8 *remaining = (const rt_char8*)data;
+	rt_un chunk_size;
+	rt_n sent;
+	rt_s ret;
+
+	while (size) {
+		chunk_size = size < ZZ_LOCAL_SOCKET_CHUNK_SIZE ? size : ZZ_LOCAL_SOCKET_CHUNK_SIZE;
+		sent = send((zz_local_socket_handle_t)local_socket->handle, remaining, chunk_size, ZZ_LOCAL_SOCKET_SEND_FLAGS);
+		if (RT_UNLIKELY(sent == ZZ_LOCAL_SOCKET_FAILED)) {
+#ifndef RT_DEFINE_WINDOWS
+			if (errno == EINTR)
+				continue;
+#endif
+			goto error;
+		}
+		remaining += sent;
+		size -= sent;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_receive(struct zz_local_socket *local_socket, void *data, rt_un size)
+{
+	rt_char8 *remaining = (rt_char8*)data;
+	rt_un chunk_size;
+	rt_n received;
+	rt_s ret;
+
+	while (size) {
+		chunk_size = size < ZZ_LOCAL_SOCKET_CHUNK_SIZE ? size : ZZ_LOCAL_SOCKET_CHUNK_SIZE;
+		received = recv((zz_local_socket_handle_t)local_socket->handle, remaining, chunk_size, 0);
+		if (RT_UNLIKELY(received == ZZ_LOCAL_SOCKET_FAILED)) {
+#ifndef RT_DEFINE_WINDOWS
+			if (errno == EINTR)
+				continue;
+#endif
+			goto error;
+		}
+		if (RT_UNLIKELY(!received)) {
+			ZZ_LOCAL_SOCKET_SET_CONNECTION_RESET();
+			goto error;
+		}
+		remaining += received;
+		size -= received;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_local_socket_close(struct zz_local_socket *local_socket, const rt_char *socket_path)
+{
+	rt_s ret = RT_OK;
+
+	if (RT_UNLIKELY(ZZ_LOCAL_SOCKET_CLOSE((zz_local_socket_handle_t)local_socket->handle) == ZZ_LOCAL_SOCKET_FAILED))
+		ret = RT_FAILED;
+	if (RT_UNLIKELY(!zz_local_socket_cleanup()))
+		ret = RT_FAILED;
+
+	if (socket_path) {
+#ifdef RT_DEFINE_WINDOWS
+		if (RT_UNLIKELY(!DeleteFileW(socket_path)))
+			ret = RT_FAILED;
+#else
+		if (RT_UNLIKELY(unlink(socket_path)))
+			ret = RT_FAILED;
+#endif
+	}
+
+	return ret;
+}
@@ -0,0 +1,196 @@
+#include "source/zz_source_file.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static rt_s zz_source_file_read(struct zz_source_file *source_file, const rt_char *file_path, struct rt_heap *heap)
+{
+	rt_un heap_buffer_capacity = 0;
+	rt_char8 *output;
+	rt_un output_size;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_small_file_read(file_path, RT_NULL, 0, &source_file->heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
+		goto error;
+
+	/* Make room for the terminating zero. */
+	if (RT_UNLIKELY(!heap->realloc(heap, &source_file->heap_buffer, output_size + 1)))
+		goto error;
+
+	source_file->data = source_file->heap_buffer;
+	source_file->data[output_size] = 0;
+	source_file->size = output_size;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+#ifdef RT_DEFINE_WINDOWS
+
+static rt_s zz_source_file_map(struct zz_source_file *source_file, const rt_char *file_path, rt_b *mapped)
+{
+	HANDLE file_handle = INVALID_HANDLE_VALUE;
+	SYSTEM_INFO system_info;
+	LARGE_INTEGER file_size;
+	rt_s ret;
+
+	*mapped = RT_FALSE;
+
+	file_handle = CreateFileW(file_path, GENERIC_READ, FILE_SHARE_READ, RT_NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, RT_NULL);
+	if (RT_UNLIKELY(file_handle == INVALID_HANDLE_VALUE))
+		goto error;
+
+	if (RT_UNLIKELY(!GetFileSizeEx(file_handle, &file_size)))
+		goto error;
+
+	GetSystemInfo(&system_info);
+	if (!file_size.QuadPart || !(file_size.QuadPart % system_info.dwPageSize))
+		goto end;
+
+	source_file->mapping_handle = CreateFileMappingW(file_handle, RT_NULL, PAGE_READONLY, 0, 0, RT_NULL);
+	if (RT_UNLIKELY(!source_file->mapping_handle))
+		goto error;
+
+	source_file->data = MapViewOfFile(source_file->mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (RT_UNLIKELY(!source_file->data)) {
+		CloseHandle(source_file->mapping_handle);
+		goto error;
+	}
+	source_file->size = file_size.QuadPart;
+	*mapped = RT_TRUE;
+
+end:
+	ret = RT_OK;
+free:
+	if (file_handle != INVALID_HANDLE_VALUE) {
+		if (RT_UNLIKELY(!CloseHandle(file_handle) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_source_file_unmap(struct zz_source_file *source_file)
+{
+	rt_s ret = RT_OK;
+
+	if (RT_UNLIKELY(!UnmapViewOfFile(source_file->data)))
+		ret = RT_FAILED;
+	if (RT_UNLIKELY(!CloseHandle(source_file->mapping_handle)))
+		ret = RT_FAILED;
+
+	return ret;
+}
+
+#else
+
+static rt_s zz_source_file_map(struct zz_source_file *source_file, const rt_char *file_path, rt_b *mapped)
+{
+	int file_descriptor;
+	struct stat file_status;
+	void *data;
+	rt_s ret;
+
+	*mapped = RT_FALSE;
+
+	file_descriptor = open(file_path, O_RDONLY | O_CLOEXEC);
+	if (RT_UNLIKELY(file_descriptor == -1))
+		goto error;
+
+	if (RT_UNLIKELY(fstat(file_descriptor, &file_status)))
+		goto error;
+
+	if (!file_status.st_size || !(file_status.st_size % sysconf(_SC_PAGESIZE)))
+		goto end;
+
+	data = mmap(RT_NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if (RT_UNLIKELY(data == MAP_FAILED))
+		goto error;
+
+	/* The lexer reads the file once, from start to end. */
+	madvise(data, file_status.st_size, MADV_SEQUENTIAL);
+
+	source_file->data = data;
+	source_file->size = file_status.st_size;
+	*mapped = RT_TRUE;
+
+end:
+	ret = RT_OK;
+free:
+	if (file_descriptor != -1) {
+		if (RT_UNLIKELY(close(file_descriptor) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_source_file_unmap(struct zz_source_file *source_file)
+{
+	return !munmap(source_file->data, source_file->size);
+}
+
+#endif
+
+rt_s zz_source_file_open(struct zz_source_file *source_file, const rt_char *file_path, struct rt_heap *heap)
+{
+	rt_s ret;
+
+	source_file->data = RT_NULL;
+	source_file->size = 0;
+	source_file->heap_buffer = RT_NULL;
+	source_file->heap = heap;
+
+	if (RT_UNLIKELY(!zz_source_file_map(source_file, file_path, &source_file->mapped)))
+		goto error;
+
+	if (!source_file->mapped) {
+		if (RT_UNLIKELY(!zz_source_file_read(source_file, file_path, heap)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	if (source_file->heap_buffer)
+		heap->free(heap, &source_file->heap_buffer);
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_source_file_close(struct zz_source_file *source_file)
+{
+	struct rt_heap *heap = source_file->heap;
+	rt_s ret = RT_OK;
+
+	if (source_file->mapped) {
+		if (RT_UNLIKELY(!zz_source_file_unmap(source_file))) {
+			rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+			ret = RT_FAILED;
+		}
+	} else if (source_file->heap_buffer) {
+		if (RT_UNLIKELY(!heap->free(heap, &source_file->heap_buffer)))
+			ret = RT_FAILED;
+	}
+
+	return ret;
+}
@@ -0,0 +1,103 @@
+#include "stats/zz_counting_heap.h"
+
+/* Keep the areas returned to the callers aligned as the parent ones. */
+#define ZZ_COUNTING_HEAP_HEADER_SIZE 16
+
+static void zz_counting_heap_add(struct zz_counting_heap *counting_heap, rt_un size)
+{
+	counting_heap->allocated_bytes += size;
+	counting_heap->allocations_count++;
+	counting_heap->live_bytes += size;
+	if (counting_heap->live_bytes > counting_heap->peak_bytes)
+		counting_heap->peak_bytes = counting_heap->live_bytes;
+}
+
+static void *zz_counting_heap_alloc(struct rt_heap *heap, void **area, rt_un size)
+{
+	struct zz_counting_heap *counting_heap = (struct zz_counting_heap*)heap;
+	struct rt_heap *parent = counting_heap->parent;
+	rt_un8 *raw;
+
+	if (RT_UNLIKELY(!parent->alloc(parent, (void**)&raw, size + ZZ_COUNTING_HEAP_HEADER_SIZE))) {
+		*area = RT_NULL;
+		goto end;
+	}
+	*(rt_un*)raw = size;
+	zz_counting_heap_add(counting_heap, size);
+	*area = raw + ZZ_COUNTING_HEAP_HEADER_SIZE;
+end:
+	return *area;
+}
+
+static void *zz_counting_heap_realloc(struct rt_heap *heap, void **area, rt_un size)
+{
+	struct zz_counting_heap *counting_heap = (struct zz_counting_heap*)heap;
+	struct rt_heap *parent = counting_heap->parent;
+	rt_un8 *raw;
+	rt_un old_size;
+
+	if (!*area)
+		return zz_counting_heap_alloc(heap, area, size);
+
+	raw = (rt_un8*)*area - ZZ_COUNTING_HEAP_HEADER_SIZE;
+	old_size = *(rt_un*)raw;
+
+	if (RT_UNLIKELY(!parent->realloc(parent, (void**)&raw, size + ZZ_COUNTING_HEAP_HEADER_SIZE))) {
+		/* The parent might have released the original area. */
+		if (!raw) {
+			counting_heap->live_bytes -= old_size;
+			*area = RT_NULL;
+		}
+		return RT_NULL;
+	}
+	*(rt_un*)raw = size;
+	counting_heap->live_bytes -= old_size;
+	zz_counting_heap_add(counting_heap, size);
+	*area = raw + ZZ_COUNTING_HEAP_HEADER_SIZE;
+
+	return *area;
+}
+
+static rt_s zz_counting_heap_free(struct rt_heap *heap, void **area)
+{
+	struct zz_counting_heap *counting_heap = (struct zz_counting_heap*)heap;
+	struct rt_heap *parent = counting_heap->parent;
+	rt_un8 *raw;
+	rt_s ret;
+
+	if (*area) {
+		raw = (rt_un8*)*area - ZZ_COUNTING_HEAP_HEADER_SIZE;
+		counting_heap->live_bytes -= *(rt_un*)raw;
+		*area = RT_NULL;
+		if (RT_UNLIKELY(!parent->free(parent, (void**)&raw)))
+			goto error;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_counting_heap_close(struct rt_heap *heap)
+{
+	/* The parent heap is closed by its owner. */
+	(void)heap;
+	return RT_OK;
+}
+
+void zz_counting_heap_create(struct zz_counting_heap *counting_heap, struct rt_heap *parent)
+{
+	counting_heap->heap.alloc = &zz_counting_heap_alloc;
+	counting_heap->heap.realloc = &zz_counting_heap_realloc;
+	counting_heap->heap.free = &zz_counting_heap_free;
+	counting_heap->heap.close = &zz_counting_heap_close;
+	counting_heap->parent = parent;
+	counting_heap->allocated_bytes = 0;
+	counting_heap->allocations_count = 0;
+	counting_heap->live_bytes = 0;
+	counting_heap->peak_bytes = 0;
+}
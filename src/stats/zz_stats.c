@@ -0,0 +1,370 @@
+#include "stats/zz_stats.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const rt_char *const zz_stats_phase_names[] = {
+	[ZZ_STATS_PHASE_SETUP] = _R("setup"),
+	[ZZ_STATS_PHASE_READ] = _R("read"),
+	[ZZ_STATS_PHASE_LINK] = _R("link"),
+	[ZZ_STATS_PHASE_CACHE] = _R("cache"),
+	[ZZ_STATS_PHASE_LEX] = _R("lex"),
+	[ZZ_STATS_PHASE_PARSE] = _R("parse"),
+	[ZZ_STATS_PHASE_OPTIMIZE] = _R("optimize"),
+	[ZZ_STATS_PHASE_CODEGEN] = _R("codegen"),
+	[ZZ_STATS_PHASE_PASSES] = _R("passes"),
+	[ZZ_STATS_PHASE_EMIT] = _R("emit"),
+	[ZZ_STATS_PHASE_RUN] = _R("run")
+};
+
+static const rt_char8 *const zz_stats_phase_names8[] = {
+	[ZZ_STATS_PHASE_SETUP] = "setup",
+	[ZZ_STATS_PHASE_READ] = "read",
+	[ZZ_STATS_PHASE_LINK] = "link",
+	[ZZ_STATS_PHASE_CACHE] = "cache",
+	[ZZ_STATS_PHASE_LEX] = "lex",
+	[ZZ_STATS_PHASE_PARSE] = "parse",
+	[ZZ_STATS_PHASE_OPTIMIZE] = "optimize",
+	[ZZ_STATS_PHASE_CODEGEN] = "codegen",
+	[ZZ_STATS_PHASE_PASSES] = "passes",
+	[ZZ_STATS_PHASE_EMIT] = "emit",
+	[ZZ_STATS_PHASE_RUN] = "run"
+};
+
+static void zz_stats_init(struct zz_stats *stats, rt_un thread)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_STATS_PHASES_COUNT; i++) {
+		stats->phase_starts[i] = 0;
+		stats->phase_durations[i] = 0;
+	}
+	stats->events_count = 0;
+	stats->thread = thread;
+	stats->files_count = 0;
+	stats->cache_hits = 0;
+	stats->cache_misses = 0;
+	stats->cache_evictions = 0;
+	stats->input_size = 0;
+	stats->tokens_count = 0;
+	stats->symbols_count = 0;
+	stats->ast_nodes_count = 0;
+	stats->optimized_ast_nodes_count = 0;
+	stats->ast_size = 0;
+	stats->heap_allocated_bytes = 0;
+	stats->heap_allocations_count = 0;
+	stats->heap_peak_bytes = 0;
+}
+
+rt_s zz_stats_create(struct zz_stats *stats)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_chrono_create(&stats->chrono)))
+		goto error;
+
+	zz_stats_init(stats, 1);
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+void zz_stats_create_child(struct zz_stats *stats, struct zz_stats *parent, rt_un thread)
+{
+	stats->chrono = parent->chrono;
+	zz_stats_init(stats, thread);
+}
+
+void zz_stats_merge(struct zz_stats *stats, struct zz_stats *child)
+{
+	rt_un i;
+
+	for (i = 0; i < ZZ_STATS_PHASES_COUNT; i++)
+		stats->phase_durations[i] += child->phase_durations[i];
+
+	/* The timeline is truncated rather than growing. */
+	for (i = 0; i < child->events_count && stats->events_count < ZZ_STATS_EVENTS_CAPACITY; i++)
+		stats->events[stats->events_count++] = child->events[i];
+
+	stats->files_count += child->files_count;
+	stats->cache_hits += child->cache_hits;
+	stats->cache_misses += child->cache_misses;
+	stats->cache_evictions += child->cache_evictions;
+	stats->input_size += child->input_size;
+	stats->tokens_count += child->tokens_count;
+	stats->symbols_count += child->symbols_count;
+	stats->ast_nodes_count += child->ast_nodes_count;
+	stats->optimized_ast_nodes_count += child->optimized_ast_nodes_count;
+	stats->ast_size += child->ast_size;
+}
+
+rt_s zz_stats_begin_phase(struct zz_stats *stats, enum zz_stats_phase phase)
+{
+	return rt_chrono_get_duration(&stats->chrono, &stats->phase_starts[phase]);
+}
+
+rt_s zz_stats_end_phase(struct zz_stats *stats, enum zz_stats_phase phase)
+{
+	struct zz_stats_event *event;
+	rt_un now;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_chrono_get_duration(&stats->chrono, &now)))
+		goto error;
+
+	stats->phase_durations[phase] += now - stats->phase_starts[phase];
+
+	/* The timeline is truncated rather than growing. */
+	if (stats->events_count < ZZ_STATS_EVENTS_CAPACITY) {
+		event = &stats->events[stats->events_count];
+		event->phase = phase;
+		event->thread = stats->thread;
+		event->start = stats->phase_starts[phase];
+		event->duration = now - stats->phase_starts[phase];
+		stats->events_count++;
+	}
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Peak resident set size of the process, in kibibytes.
+ */
+static rt_s zz_stats_get_peak_rss(rt_un *peak_rss)
+{
+#ifdef RT_DEFINE_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (RT_UNLIKELY(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))))
+		return RT_FAILED;
+	*peak_rss = counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+
+	if (RT_UNLIKELY(getrusage(RUSAGE_SELF, &usage)))
+		return RT_FAILED;
+	/* Kibibytes on Linux. */
+	*peak_rss = usage.ru_maxrss;
+#endif
+	return RT_OK;
+}
+
+static rt_s zz_stats_append_line(const rt_char *name, rt_un name_size, rt_un value, const rt_char *unit, rt_un unit_size, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char_append(name, name_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(_R(": "), 2, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_un(value, 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(unit, unit_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('\n'), buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+/**
+ * Append a line with <tt>numerator</tt> divided by <tt>denominator</tt>, with two decimals.
+ */
+static rt_s zz_stats_append_ratio_line(const rt_char *name, rt_un name_size, rt_un numerator, rt_un denominator, const rt_char *unit, rt_un unit_size, rt_char *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	rt_un hundredths;
+	rt_s ret;
+
+	hundredths = denominator ? (numerator * 100 + denominator / 2) / denominator : 0;
+
+	if (RT_UNLIKELY(!rt_char_append(name, name_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(_R(": "), 2, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_un(hundredths / 100, 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('.'), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('0') + (hundredths / 10) % 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('0') + hundredths % 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append(unit, unit_size, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char_append_char(_R('\n'), buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_stats_write(struct zz_stats *stats)
+{
+	rt_char buffer[RT_CHAR_BIG_STRING_SIZE];
+	rt_un buffer_size = 0;
+	rt_un total = 0;
+	rt_un wall;
+	rt_un peak_rss;
+	rt_un i;
+	rt_s ret;
+
+	for (i = 0; i < ZZ_STATS_PHASES_COUNT; i++) {
+		if (RT_UNLIKELY(!zz_stats_append_line(zz_stats_phase_names[i], rt_char_get_size(zz_stats_phase_names[i]), stats->phase_durations[i], _R(" us"), 3, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		total += stats->phase_durations[i];
+	}
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("total"), 5, total, _R(" us"), 3, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	/* Less than the total when the files are compiled in parallel. */
+	if (RT_UNLIKELY(!rt_chrono_get_duration(&stats->chrono, &wall)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("wall"), 4, wall, _R(" us"), 3, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("files"), 5, stats->files_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (stats->cache_hits || stats->cache_misses) {
+		if (RT_UNLIKELY(!zz_stats_append_line(_R("cache hits"), 10, stats->cache_hits, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_stats_append_line(_R("cache misses"), 12, stats->cache_misses, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+		if (RT_UNLIKELY(!zz_stats_append_line(_R("cache evictions"), 15, stats->cache_evictions, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+			goto error;
+	}
+
+	/* The buffer is written in two parts as the lines would not fit. */
+	if (RT_UNLIKELY(!rt_console_write(buffer, RT_TRUE)))
+		goto error;
+	buffer_size = 0;
+	buffer[0] = 0;
+
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("input"), 5, stats->input_size, _R(" bytes"), 6, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("tokens"), 6, stats->tokens_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("symbols"), 7, stats->symbols_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("ast nodes"), 9, stats->ast_nodes_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("optimized ast nodes"), 19, stats->optimized_ast_nodes_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("ast size"), 8, stats->ast_size, _R(" bytes"), 6, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_ratio_line(_R("ast size per input byte"), 23, stats->ast_size, stats->input_size, _R(" bytes"), 6, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("heap allocated"), 14, stats->heap_allocated_bytes, _R(" bytes"), 6, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("heap allocations"), 16, stats->heap_allocations_count, _R(""), 0, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("heap peak"), 9, stats->heap_peak_bytes, _R(" bytes"), 6, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_stats_get_peak_rss(&peak_rss))) {
+		rt_error_set_last(RT_ERROR_FUNCTION_FAILED);
+		goto error;
+	}
+	if (RT_UNLIKELY(!zz_stats_append_line(_R("peak rss"), 8, peak_rss, _R(" KiB"), 4, buffer, RT_CHAR_BIG_STRING_SIZE, &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_console_write(buffer, RT_TRUE)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_stats_append_event(struct zz_stats_event *event, rt_b first, rt_char8 *buffer, rt_un buffer_capacity, rt_un *buffer_size)
+{
+	const rt_char8 *name = zz_stats_phase_names8[event->phase];
+	rt_s ret;
+
+	if (!first) {
+		if (RT_UNLIKELY(!rt_char8_append(",\n", 2, buffer, buffer_capacity, buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char8_append("{\"name\":\"", 9, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append(name, rt_char8_get_size(name), buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append("\",\"cat\":\"stc\",\"ph\":\"X\",\"pid\":1,\"tid\":", 37, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_un(event->thread, 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append(",\"ts\":", 6, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_un(event->start, 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append(",\"dur\":", 7, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_un(event->duration, 10, buffer, buffer_capacity, buffer_size)))
+		goto error;
+	if (RT_UNLIKELY(!rt_char8_append_char('}', buffer, buffer_capacity, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_stats_write_time_trace(struct zz_stats *stats, const rt_char *file_path)
+{
+	/* Each event takes less than 128 bytes. */
+	rt_char8 buffer[ZZ_STATS_EVENTS_CAPACITY * 128 + 64];
+	rt_un buffer_size = 0;
+	rt_un i;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_char8_append("{\"traceEvents\":[\n", 17, buffer, sizeof(buffer), &buffer_size)))
+		goto error;
+	for (i = 0; i < stats->events_count; i++) {
+		if (RT_UNLIKELY(!zz_stats_append_event(&stats->events[i], i == 0, buffer, sizeof(buffer), &buffer_size)))
+			goto error;
+	}
+	if (RT_UNLIKELY(!rt_char8_append("\n],\"displayTimeUnit\":\"ms\"}\n", 27, buffer, sizeof(buffer), &buffer_size)))
+		goto error;
+
+	if (RT_UNLIKELY(!rt_small_file_write(file_path, RT_SMALL_FILE_MODE_TRUNCATE, buffer, buffer_size)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
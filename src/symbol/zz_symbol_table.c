@@ -0,0 +1,225 @@
+#include "symbol/zz_symbol_table.h"
+
+#define ZZ_SYMBOL_TABLE_EMPTY_SLOT RT_TYPE_MAX_UN32
+
+#define ZZ_SYMBOL_TABLE_INITIAL_SLOTS_CAPACITY 256
+
+static void *zz_symbol_table_resize(struct rt_heap *heap, void **area, rt_un size)
+{
+	if (*area)
+		return heap->realloc(heap, area, size);
+	else
+		return heap->alloc(heap, area, size);
+}
+
+/**
+ * 32 bits FNV-1a, identifiers are short.
+ */
+static rt_un32 zz_symbol_table_hash(const rt_char8 *name, rt_un name_size)
+{
+	rt_un32 hash = 2166136261u;
+	rt_un i;
+
+	for (i = 0; i < name_size; i++) {
+		hash ^= (rt_un8)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Double the slots and insert the symbols again, using their stored hashes.
+ */
+static rt_s zz_symbol_table_grow_slots(struct zz_symbol_table *symbol_table)
+{
+	struct rt_heap *heap = symbol_table->heap;
+	struct zz_symbol_table_slot *slots = RT_NULL;
+	rt_un capacity;
+	rt_un mask;
+	rt_un index;
+	rt_un i;
+	rt_s ret;
+
+	capacity = symbol_table->slots_capacity ? symbol_table->slots_capacity * 2 : ZZ_SYMBOL_TABLE_INITIAL_SLOTS_CAPACITY;
+	mask = capacity - 1;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&slots, capacity * sizeof(struct zz_symbol_table_slot))))
+		goto error;
+	for (i = 0; i < capacity; i++)
+		slots[i].symbol = ZZ_SYMBOL_TABLE_EMPTY_SLOT;
+
+	for (i = 0; i < symbol_table->symbols_count; i++) {
+		index = symbol_table->symbols[i].hash & mask;
+		while (slots[index].symbol != ZZ_SYMBOL_TABLE_EMPTY_SLOT)
+			index = (index + 1) & mask;
+		slots[index].hash = symbol_table->symbols[i].hash;
+		slots[index].symbol = (rt_un32)i;
+		slots[index].name_offset = symbol_table->symbols[i].name_offset;
+		slots[index].name_size = symbol_table->symbols[i].name_size;
+	}
+
+	if (symbol_table->slots && RT_UNLIKELY(!heap->free(heap, (void**)&symbol_table->slots)))
+		goto error;
+	symbol_table->slots = slots;
+	symbol_table->slots_capacity = capacity;
+	slots = RT_NULL;
+
+	ret = RT_OK;
+free:
+	if (slots && RT_UNLIKELY(!heap->free(heap, (void**)&slots) && ret))
+		goto error;
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+static rt_s zz_symbol_table_add(struct zz_symbol_table *symbol_table, const rt_char8 *name, rt_un name_size, rt_un32 hash, rt_un32 *symbol)
+{
+	struct rt_heap *heap = symbol_table->heap;
+	struct zz_symbol *new_symbol;
+	rt_un capacity;
+	rt_s ret;
+
+	/* Offsets and ids are 32 bits, the empty slot marker is reserved. */
+	if (RT_UNLIKELY(symbol_table->names_size + name_size + 1 > RT_TYPE_MAX_UN32 || symbol_table->symbols_count + 1 >= ZZ_SYMBOL_TABLE_EMPTY_SLOT)) {
+		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+		goto error;
+	}
+
+	if (symbol_table->symbols_count == symbol_table->symbols_capacity) {
+		capacity = symbol_table->symbols_capacity ? symbol_table->symbols_capacity * 2 : ZZ_SYMBOL_TABLE_INITIAL_SLOTS_CAPACITY / 2;
+		if (RT_UNLIKELY(!zz_symbol_table_resize(heap, (void**)&symbol_table->symbols, capacity * sizeof(struct zz_symbol))))
+			goto error;
+		symbol_table->symbols_capacity = capacity;
+	}
+
+	if (symbol_table->names_size + name_size + 1 > symbol_table->names_capacity) {
+		capacity = symbol_table->names_capacity ? symbol_table->names_capacity * 2 : 4096;
+		while (capacity < symbol_table->names_size + name_size + 1)
+			capacity *= 2;
+		if (RT_UNLIKELY(!zz_symbol_table_resize(heap, (void**)&symbol_table->names, capacity)))
+			goto error;
+		symbol_table->names_capacity = capacity;
+	}
+
+	new_symbol = &symbol_table->symbols[symbol_table->symbols_count];
+	new_symbol->name_offset = (rt_un32)symbol_table->names_size;
+	new_symbol->name_size = (rt_un32)name_size;
+	new_symbol->hash = hash;
+
+	RT_MEMORY_COPY(name, &symbol_table->names[symbol_table->names_size], name_size);
+	symbol_table->names[symbol_table->names_size + name_size] = 0;
+	symbol_table->names_size += name_size + 1;
+
+	*symbol = (rt_un32)symbol_table->symbols_count++;
+
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+void zz_symbol_table_create(struct zz_symbol_table *symbol_table, struct rt_heap *heap)
+{
+	symbol_table->slots = RT_NULL;
+	symbol_table->slots_capacity = 0;
+	symbol_table->symbols = RT_NULL;
+	symbol_table->symbols_count = 0;
+	symbol_table->symbols_capacity = 0;
+	symbol_table->names = RT_NULL;
+	symbol_table->names_size = 0;
+	symbol_table->names_capacity = 0;
+	symbol_table->heap = heap;
+}
+
+rt_s zz_symbol_table_intern(struct zz_symbol_table *symbol_table, const rt_char8 *name, rt_un name_size, rt_un32 *symbol)
+{
+	rt_un32 hash = zz_symbol_table_hash(name, name_size);
+	struct zz_symbol_table_slot *slot;
+	rt_un mask;
+	rt_un index;
+	rt_s ret;
+
+	if (RT_UNLIKELY(symbol_table->symbols_count >= symbol_table->slots_capacity / 2)) {
+		if (RT_UNLIKELY(!zz_symbol_table_grow_slots(symbol_table)))
+			goto error;
+	}
+
+	mask = symbol_table->slots_capacity - 1;
+	index = hash & mask;
+	while (RT_TRUE) {
+		slot = &symbol_table->slots[index];
+		if (slot->symbol == ZZ_SYMBOL_TABLE_EMPTY_SLOT)
+			break;
+		if (slot->hash == hash && slot->name_size == name_size && rt_char8_equals(&symbol_table->names[slot->name_offset], name_size, name, name_size)) {
+			*symbol = slot->symbol;
+			goto end;
+		}
+		index = (index + 1) & mask;
+	}
+
+	if (RT_UNLIKELY(!zz_symbol_table_add(symbol_table, name, name_size, hash, symbol)))
+		goto error;
+	slot->hash = hash;
+	slot->symbol = *symbol;
+	slot->name_offset = symbol_table->symbols[*symbol].name_offset;
+	slot->name_size = (rt_un32)name_size;
+
+end:
+	ret = RT_OK;
+free:
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_b zz_symbol_table_find(struct zz_symbol_table *symbol_table, const rt_char8 *name, rt_un name_size, rt_un32 *symbol)
+{
+	rt_un32 hash = zz_symbol_table_hash(name, name_size);
+	struct zz_symbol_table_slot *slot;
+	rt_un mask;
+	rt_un index;
+
+	if (!symbol_table->slots_capacity)
+		return RT_FALSE;
+
+	mask = symbol_table->slots_capacity - 1;
+	index = hash & mask;
+	while (RT_TRUE) {
+		slot = &symbol_table->slots[index];
+		if (slot->symbol == ZZ_SYMBOL_TABLE_EMPTY_SLOT)
+			return RT_FALSE;
+		if (slot->hash == hash && slot->name_size == name_size && rt_char8_equals(&symbol_table->names[slot->name_offset], name_size, name, name_size)) {
+			*symbol = slot->symbol;
+			return RT_TRUE;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+rt_s zz_symbol_table_free(struct zz_symbol_table *symbol_table)
+{
+	struct rt_heap *heap = symbol_table->heap;
+	rt_s ret = RT_OK;
+
+	if (symbol_table->slots && RT_UNLIKELY(!heap->free(heap, (void**)&symbol_table->slots)))
+		ret = RT_FAILED;
+	if (symbol_table->symbols && RT_UNLIKELY(!heap->free(heap, (void**)&symbol_table->symbols)))
+		ret = RT_FAILED;
+	if (symbol_table->names && RT_UNLIKELY(!heap->free(heap, (void**)&symbol_table->names)))
+		ret = RT_FAILED;
+	symbol_table->slots_capacity = 0;
+	symbol_table->symbols_count = 0;
+	symbol_table->symbols_capacity = 0;
+	symbol_table->names_size = 0;
+	symbol_table->names_capacity = 0;
+
+	return ret;
+}
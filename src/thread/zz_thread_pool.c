@@ -0,0 +1,139 @@
+#include "thread/zz_thread_pool.h"
+
+#ifdef RT_DEFINE_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+struct zz_thread_pool_worker {
+	struct zz_thread_pool *thread_pool;
+	rt_un index;
+	struct rt_thread thread;
+	rt_b thread_created;
+};
+
+rt_un zz_thread_pool_get_processors_count(void)
+{
+#ifdef RT_DEFINE_WINDOWS
+	SYSTEM_INFO system_info;
+
+	GetSystemInfo(&system_info);
+	return system_info.dwNumberOfProcessors ? system_info.dwNumberOfProcessors : 1;
+#else
+	long processors_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return processors_count > 0 ? (rt_un)processors_count : 1;
+#endif
+}
+
+static rt_un32 RT_STDCALL zz_thread_pool_thread_callback(void *parameter)
+{
+	struct zz_thread_pool_worker *worker = (struct zz_thread_pool_worker*)parameter;
+	struct zz_thread_pool *thread_pool = worker->thread_pool;
+
+	return thread_pool->callback(thread_pool, worker->index) ? 0 : 1;
+}
+
+static rt_s zz_thread_pool_run_workers(struct zz_thread_pool *thread_pool, struct zz_thread_pool_worker *workers, rt_un workers_count)
+{
+	rt_un32 exit_code;
+	rt_un i;
+	rt_s ret = RT_OK;
+
+	for (i = 0; i < workers_count; i++) {
+		workers[i].thread_pool = thread_pool;
+		workers[i].index = i;
+		workers[i].thread_created = RT_FALSE;
+	}
+
+	/* Continue with the threads already created if one cannot be created. */
+	for (i = 1; i < workers_count; i++) {
+		if (RT_UNLIKELY(!rt_thread_create(&workers[i].thread, &zz_thread_pool_thread_callback, &workers[i]))) {
+			ret = RT_FAILED;
+			break;
+		}
+		workers[i].thread_created = RT_TRUE;
+	}
+
+	if (RT_UNLIKELY(!thread_pool->callback(thread_pool, 0)))
+		ret = RT_FAILED;
+
+	for (i = 1; i < workers_count; i++) {
+		if (!workers[i].thread_created)
+			continue;
+		if (RT_UNLIKELY(!rt_thread_join(&workers[i].thread)))
+			ret = RT_FAILED;
+		else if (RT_UNLIKELY(!rt_thread_get_exit_code(&workers[i].thread, &exit_code) || exit_code))
+			ret = RT_FAILED;
+		if (RT_UNLIKELY(!rt_thread_free(&workers[i].thread)))
+			ret = RT_FAILED;
+	}
+
+	return ret;
+}
+
+rt_s zz_thread_pool_run(struct zz_thread_pool *thread_pool, rt_un workers_count, rt_un tasks_count, zz_thread_pool_worker_callback_t callback, void *context, struct rt_heap *heap)
+{
+	struct zz_thread_pool_worker *workers = RT_NULL;
+	rt_b critical_section_created = RT_FALSE;
+	rt_s ret;
+
+	thread_pool->next_task = 0;
+	thread_pool->tasks_count = tasks_count;
+	thread_pool->callback = callback;
+	thread_pool->context = context;
+
+	if (RT_UNLIKELY(!rt_critical_section_create(&thread_pool->critical_section, RT_FALSE)))
+		goto error;
+	critical_section_created = RT_TRUE;
+
+	if (RT_UNLIKELY(!heap->alloc(heap, (void**)&workers, workers_count * sizeof(struct zz_thread_pool_worker))))
+		goto error;
+
+	if (RT_UNLIKELY(!zz_thread_pool_run_workers(thread_pool, workers, workers_count)))
+		goto error;
+
+	ret = RT_OK;
+free:
+	if (workers && RT_UNLIKELY(!heap->free(heap, (void**)&workers) && ret))
+		goto error;
+	if (critical_section_created) {
+		critical_section_created = RT_FALSE;
+		if (RT_UNLIKELY(!rt_critical_section_free(&thread_pool->critical_section) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
+
+rt_s zz_thread_pool_take_task(struct zz_thread_pool *thread_pool, rt_un *task)
+{
+	rt_b entered = RT_FALSE;
+	rt_s ret;
+
+	if (RT_UNLIKELY(!rt_critical_section_enter(&thread_pool->critical_section)))
+		goto error;
+	entered = RT_TRUE;
+
+	if (thread_pool->next_task < thread_pool->tasks_count)
+		*task = thread_pool->next_task++;
+	else
+		*task = RT_TYPE_MAX_UN;
+
+	ret = RT_OK;
+free:
+	if (entered) {
+		entered = RT_FALSE;
+		if (RT_UNLIKELY(!rt_critical_section_leave(&thread_pool->critical_section) && ret))
+			goto error;
+	}
+	return ret;
+
+error:
+	ret = RT_FAILED;
+	goto free;
+}
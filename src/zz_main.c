@@ -3,44 +3,78 @@
 #include <rpr.h>
 #include <rpr_main.h>
 
-#include "lexer/zz_lexer.h"
-#include "parser/zz_parser.h"
-#include "ast/zz_ast.h"
-#include "code_generator/zz_code_generator.h"
+#include "compiler/zz_batch_compiler.h"
+#include "compiler/zz_linker.h"
+#include "options/zz_options.h"
+#include "server/zz_compile_client.h"
+#include "server/zz_compile_server.h"
+#include "stats/zz_stats.h"
 
 static rt_s zz_display_help(rt_s ret)
 {
 	rt_b error = !ret;
 
-	if (!rt_console_write(_R("stc <FILE>\n"), error))
+	if (!rt_console_write(_R("stc [OPTIONS] <FILE>... | @<FILE_LIST>\n"
+				 "\n"
+				 "  -O0, -O1, -O2, -O3, -Os Optimization level, -O0 by default.\n"
+				 "  --passes=<PIPELINE>     Run this LLVM pass pipeline instead of the one of the level.\n"
+				 "  --emit=obj,asm,llvm-ir,llvm-bc\n"
+				 "                          Artifacts to write, the object file by default.\n"
+				 "  -o <FILE>               Write the artifact to FILE, or to the standard output with -o -.\n"
+				 "  --target=<TRIPLE>       Generate code for TRIPLE, like aarch64-linux-gnu, the host by default.\n"
+				 "  --cpu=<CPU>             Tune for and use the instructions of CPU, like x86-64-v3 or skylake,\n"
+				 "                          the host one by default, or a generic one with --target.\n"
+				 "  --features=<FEATURES>   Enable or disable instruction sets after the ones of the CPU,\n"
+				 "                          like +avx2,-fma.\n"
+				 "  --reloc=static|pic      Relocation model, the default one of the target by default.\n"
+				 "  --code-model=tiny|small|kernel|medium|large\n"
+				 "                          Code model, the default one of the target by default.\n"
+				 "  --codegen-units=<N>     Split each module in N parts optimized and emitted in parallel,\n"
+				 "                          written as name.o, name.1.o... Calls between parts are not inlined.\n"
+				 "  --lto[=full|thin]       Write bitcode prepared for --lto-link instead of the artifacts.\n"
+				 "  --lto-link[=full|thin]  Link the bitcode FILEs, then optimize them as a whole program.\n"
+				 "                          Only main remains visible. With thin, the program is split in a part\n"
+				 "                          per job optimized in parallel, written as name.o, name.1.o...\n"
+				 "  --profile-generate[=<FILE>]\n"
+				 "                          Count the calls and the branches of the functions, the program\n"
+				 "                          appends them to FILE when it exits, default.stcprof by default.\n"
+				 "  --profile-use=<FILE>    Optimize the hot and the cold code according to the counts of FILE.\n"
+				 "  --jobs=<N>              Compile N files in parallel, all the processors by default.\n"
+				 "  --run                   JIT-compile the file, run its main and exit with its result.\n"
+				 "  --cache=<DIR>           Reuse the object files compiled from the same sources in DIR.\n"
+				 "  --cache-size=<MIB>      Maximum size of the cache, 1024 MiB by default.\n"
+				 "  --server=<SOCKET>       Keep LLVM ready and compile the files sent by clients on SOCKET.\n"
+				 "  --client=<SOCKET>       Send the compilation to the server on SOCKET, if it is running.\n"
+				 "  --stats                 Write the phases durations and the memory usage.\n"
+				 "  --trace=tokens,ir       Write the tokens and/or the LLVM IR.\n"
+				 "  --time-trace=<FILE>     Write the phases timeline in Chrome trace format.\n"
+				 "\n"
+				 "A file list contains one path per line.\n"
+				 "With --lto-link, the artifacts are named after the first FILE.\n"
+				 "With -o and several artifacts, their extensions replace the one of FILE.\n"
+				 "With --stats, --trace, --time-trace, --run, --lto-link, --profile-* or -o -, a client compiles the files itself.\n"), error))
 		ret = RT_FAILED;
 
 	return ret;
 }
 
-static rt_s zz_stc_with_lexer(struct zz_lexer *lexer, rt_char *output_file_path, struct rt_heap *heap)
+/**
+ * Link the bitcode files with --lto-link, otherwise compile the sources.
+ */
+static rt_s zz_stc_compile(struct zz_options *options, struct zz_stats *stats, rt_n32 *exit_code, struct rt_heap *heap)
 {
-	void *ast_nodes_list = RT_NULL;
-	struct zz_ast_node *root;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!rt_list_create(&ast_nodes_list, 0, sizeof(struct zz_ast_node), 16384, 0, heap)))
-		goto error;
-
-	if (RT_UNLIKELY(!zz_parser_parse(lexer, &ast_nodes_list, &root))) {
-		rt_error_message_write_last(_R("Compilation failed: "));
-		goto error;
-	}
-
-	if (RT_UNLIKELY(!zz_code_generator_generate(root, output_file_path))) {
-		rt_error_message_write_last(_R("Code generation failed: "));
-		goto error;
+	if (options->lto_link) {
+		if (RT_UNLIKELY(!zz_linker_link(options, stats, heap)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_batch_compiler_compile(options, stats, exit_code, heap)))
+			goto error;
 	}
 
 	ret = RT_OK;
 free:
-	if (RT_UNLIKELY(!rt_list_free((void**)&ast_nodes_list) && ret))
-		goto error;
 	return ret;
 
 error:
@@ -48,16 +82,30 @@ error:
 	goto free;
 }
 
-static rt_s zz_stc_with_char(rt_char *input, rt_char *output_file_path, struct rt_heap *heap)
+/**
+ * Statistics are collected only if they are requested so that the instrumentation costs nothing otherwise.
+ */
+static rt_s zz_stc_with_stats(struct zz_options *options, rt_n32 *exit_code, struct rt_heap *heap)
 {
-	struct zz_lexer lexer;
+	struct zz_stats stats;
 	rt_s ret;
 
-	lexer.input = input;
+	if (RT_UNLIKELY(!zz_stats_create(&stats)))
+		goto error;
 
-	if (RT_UNLIKELY(!zz_stc_with_lexer(&lexer, output_file_path, heap)))
+	if (RT_UNLIKELY(!zz_stc_compile(options, &stats, exit_code, heap)))
 		goto error;
 
+	if (options->stats) {
+		if (RT_UNLIKELY(!zz_stats_write(&stats)))
+			goto error;
+	}
+
+	if (options->time_trace_file_path) {
+		if (RT_UNLIKELY(!zz_stats_write_time_trace(&stats, options->time_trace_file_path)))
+			goto error;
+	}
+
 	ret = RT_OK;
 free:
 	return ret;
@@ -67,26 +115,31 @@ error:
 	goto free;
 }
 
-static rt_s zz_stc_with_char8(rt_char8 *input, rt_un input_size, rt_char *output_file_path, struct rt_heap *heap)
+static rt_s zz_stc(rt_un argc, const rt_char *argv[], struct zz_options *options, rt_n32 *exit_code, struct rt_heap *heap)
 {
-	void *heap_buffer = RT_NULL;
-	rt_un heap_buffer_capacity = 0;
-	rt_char *output;
-	rt_un output_size;
+	rt_b forwarded = RT_FALSE;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!rt_encoding_decode(input, input_size, RT_ENCODING_UTF_8, RT_NULL, 0, &heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
-		goto error;
+	/* The server cannot write the traces, the statistics nor the standard output of the client, nor run or link its program, nor find its profile. */
+	if (options->client_socket_path && !options->stats && !options->trace && !options->time_trace_file_path && !options->run && !options->lto_link && !options->standard_output &&
+	    !options->profile_generate_file_path && !options->profile_use_file_path) {
+		if (RT_UNLIKELY(!zz_compile_client_compile(options->client_socket_path, argc, argv, &forwarded, heap)))
+			goto error;
+		if (forwarded)
+			goto end;
+	}
 
-	if (RT_UNLIKELY(!zz_stc_with_char(output, output_file_path, heap)))
-		goto error;
+	if (options->stats || options->time_trace_file_path) {
+		if (RT_UNLIKELY(!zz_stc_with_stats(options, exit_code, heap)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_stc_compile(options, RT_NULL, exit_code, heap)))
+			goto error;
+	}
 
+end:
 	ret = RT_OK;
 free:
-	if (heap_buffer) {
-		if (RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
-			goto error;
-	}
 	return ret;
 
 error:
@@ -94,38 +147,32 @@ error:
 	goto free;
 }
 
-static rt_s zz_stc_with_heap(const rt_char *input_file_path, struct rt_heap *heap)
+static rt_s zz_main_with_heap(rt_un argc, const rt_char *argv[], rt_n32 *exit_code, struct rt_heap *heap)
 {
-	void *heap_buffer = RT_NULL;
-	rt_un heap_buffer_capacity = 0;
-	rt_char8 *output;
-	rt_un output_size;
-	rt_char output_file_path[RT_FILE_PATH_SIZE];
-	rt_un output_file_path_size;
+	struct zz_options options;
 	rt_s ret;
 
-	if (RT_UNLIKELY(!rt_small_file_read(input_file_path, RT_NULL, 0, &heap_buffer, &heap_buffer_capacity, &output, &output_size, heap)))
-		goto error;
-
-	if (RT_UNLIKELY(!rt_file_path_get_name(input_file_path, rt_char_get_size(input_file_path), output_file_path, RT_FILE_PATH_SIZE, &output_file_path_size)))
-		goto error;
-	
-	if (RT_UNLIKELY(!rt_char_ends_with(output_file_path, output_file_path_size, _R(".stc"), 4))) {
-		rt_error_set_last(RT_ERROR_BAD_ARGUMENTS);
+	if (RT_UNLIKELY(!zz_options_parse(argc, argv, heap, &options))) {
+		if (!zz_display_help(RT_FAILED))
+			goto error;
 		goto error;
 	}
-	output_file_path[output_file_path_size - 3] = _R('o');
-	output_file_path[output_file_path_size - 2] = 0;
 
-	if (RT_UNLIKELY(!zz_stc_with_char8(output, output_size, output_file_path, heap)))
-		goto error;
+	if (options.help) {
+		if (RT_UNLIKELY(!zz_display_help(RT_OK)))
+			goto error;
+	} else if (options.server_socket_path) {
+		if (RT_UNLIKELY(!zz_compile_server_run(options.server_socket_path, heap)))
+			goto error;
+	} else {
+		if (RT_UNLIKELY(!zz_stc(argc, argv, &options, exit_code, heap)))
+			goto error;
+	}
 
 	ret = RT_OK;
 free:
-	if (heap_buffer) {
-		if (RT_UNLIKELY(!heap->free(heap, &heap_buffer) && ret))
-			goto error;
-	}
+	if (RT_UNLIKELY(!zz_options_free(&options) && ret))
+		goto error;
 	return ret;
 
 error:
@@ -133,7 +180,10 @@ error:
 	goto free;
 }
 
-static rt_s zz_stc(const rt_char *input_file_path)
+/**
+ * @param exit_code Value returned by the program with <tt>--run</tt>, zero otherwise.
+ */
+static rt_s zz_main(rt_un argc, const rt_char *argv[], rt_n32 *exit_code)
 {
 	struct rt_runtime_heap runtime_heap;
 	rt_b runtime_heap_created = RT_FALSE;
@@ -143,7 +193,7 @@ static rt_s zz_stc(const rt_char *input_file_path)
 		goto error;
 	runtime_heap_created = RT_TRUE;
 
-	if (RT_UNLIKELY(!zz_stc_with_heap(input_file_path, &runtime_heap.heap)))
+	if (RT_UNLIKELY(!zz_main_with_heap(argc, argv, exit_code, &runtime_heap.heap)))
 		goto error;
 
 	ret = RT_OK;
@@ -160,43 +210,13 @@ error:
 	goto free;
 }
 
-static rt_s zz_main(rt_un argc, const rt_char *argv[])
-{
-	rt_un arg_size;
-	rt_s ret;
-
-	if (argc == 2) {
-		arg_size = rt_char_get_size(argv[1]);
-		if (rt_char_equals(argv[1], arg_size, _R("--help"), 6) ||
-			rt_char_equals(argv[1], arg_size, _R("-h"), 2) ||
-			rt_char_equals(argv[1], arg_size, _R("/?"), 2)) {
-
-			if (RT_UNLIKELY(!zz_display_help(RT_OK)))
-				goto error;
-		} else {
-			if (RT_UNLIKELY(!zz_stc(argv[1])))
-				goto error;
-		}
-	} else {
-		if (!zz_display_help(RT_FAILED))
-			goto error;
-	}
-
-	ret = RT_OK;
-free:
-	return ret;
-
-error:
-	ret = RT_FAILED;
-	goto free;
-}
-
 rt_un16 rpr_main(rt_un argc, const rt_char *argv[])
 {
+	rt_n32 exit_code = 0;
 	int ret;
 
-	if (zz_main(argc, argv))
-		ret = 0;
+	if (zz_main(argc, argv, &exit_code))
+		ret = exit_code;
 	else
 		ret = 1;
 	return ret;